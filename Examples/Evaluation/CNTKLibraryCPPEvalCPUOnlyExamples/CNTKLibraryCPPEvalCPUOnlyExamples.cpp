@@ -8,12 +8,14 @@
 #include <stdio.h>
 
 void MultiThreadsEvaluation(bool);
+void BatchingEvaluation(bool);
 
 int main()
 {
 
     fprintf(stderr, "\n##### Run CNTKLibraryCPPEvalCPUOnlyExamples on CPU. #####\n");
     MultiThreadsEvaluation(false);
+    BatchingEvaluation(false);
 
     fprintf(stderr, "Evaluation complete.\n");
     fflush(stderr);
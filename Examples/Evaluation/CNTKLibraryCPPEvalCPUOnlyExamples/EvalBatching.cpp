@@ -0,0 +1,82 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// EvalBatching.cpp : Sample application shows how to serve many concurrent single-sample evaluation requests
+// with a BatchingEvaluator, and measures the resulting throughput and latency with a local load generator.
+//
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "CNTKLibrary.h"
+
+using namespace CNTK;
+
+/// <summary>
+/// Runs a closed-loop load generator against a BatchingEvaluator and prints throughput and latency percentiles.
+/// </summary>
+/// <description>
+/// Each client thread submits a single-sample request and waits for its result before submitting the next one.
+/// With maxBatchSize = 1 this is equivalent to evaluating every request on its own.
+/// </description>
+void RunBatchingLoadGenerator(const FunctionPtr& modelFunc, size_t maxBatchSize, size_t maxLatencyInMicroseconds, int clientThreadCount, size_t requestsPerThread, const DeviceDescriptor& device)
+{
+    auto inputVar = modelFunc->Arguments()[0];
+    auto evaluator = CreateBatchingEvaluator(modelFunc, { modelFunc->Output() }, maxBatchSize, maxLatencyInMicroseconds, device);
+
+    auto startTime = std::chrono::steady_clock::now();
+    std::vector<std::thread> clients(clientThreadCount);
+    for (int th = 0; th < clientThreadCount; ++th)
+    {
+        clients[th] = std::thread([&, th]() {
+            auto sample = NDArrayView::RandomUniform<float>(inputVar.Shape(), -0.5, 0.5, th + 1, DeviceDescriptor::CPUDevice());
+            for (size_t i = 0; i < requestsPerThread; ++i)
+                evaluator->Evaluate({ { inputVar, sample } });
+        });
+    }
+
+    for (auto& client : clients)
+        client.join();
+
+    auto elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    auto statistics = evaluator->Statistics();
+    fprintf(stderr, "maxBatchSize=%d maxLatency=%dus clients=%d: %.1f requests/s, average batch %.1f, latency p50=%.0fus p99=%.0fus max=%dus, queueing p99=%.0fus\n",
+            (int)maxBatchSize, (int)maxLatencyInMicroseconds, clientThreadCount,
+            statistics.m_numRequests / elapsedSeconds, statistics.AverageBatchSize(),
+            statistics.m_requestLatency.Percentile(50), statistics.m_requestLatency.Percentile(99), (int)statistics.m_requestLatency.MaxMicroseconds(),
+            statistics.m_queueLatency.Percentile(99));
+    fflush(stderr);
+}
+
+void BatchingEvaluationBenchmark(const DeviceDescriptor& device, int clientThreadCount)
+{
+    const size_t inputDim = 937;
+    const size_t numOutputClasses = 9304;
+    const size_t hiddenLayersDim = 512;
+
+    auto inputVar = InputVariable({ inputDim }, DataType::Float, L"features");
+    auto hiddenTimesParam = Parameter(NDArrayView::RandomUniform<float>({ hiddenLayersDim, inputDim }, -0.5, 0.5, 1, device));
+    auto hiddenPlusParam = Parameter({ hiddenLayersDim }, 0.0f, device);
+    auto outputTimesParam = Parameter(NDArrayView::RandomUniform<float>({ numOutputClasses, hiddenLayersDim }, -0.5, 0.5, 1, device));
+    auto modelFunc = Times(outputTimesParam, Sigmoid(Plus(hiddenPlusParam, Times(hiddenTimesParam, inputVar))), L"classifierOutput");
+
+    fprintf(stderr, "BatchingEvaluationBenchmark on device=%d\n", device.Id());
+    const size_t requestsPerThread = 200;
+    RunBatchingLoadGenerator(modelFunc, 1, 0, clientThreadCount, requestsPerThread, device);
+    RunBatchingLoadGenerator(modelFunc, 16, 1000, clientThreadCount, requestsPerThread, device);
+    RunBatchingLoadGenerator(modelFunc, 64, 5000, clientThreadCount, requestsPerThread, device);
+}
+
+void BatchingEvaluation(bool isGPUAvailable)
+{
+    // The number of concurrent clients issuing requests.
+    const int numOfClients = 32;
+
+    fprintf(stderr, "\n##### Run batched evaluation on CPU with %d clients. #####\n", numOfClients);
+    BatchingEvaluationBenchmark(DeviceDescriptor::CPUDevice(), numOfClients);
+    if (isGPUAvailable)
+    {
+        fprintf(stderr, "\n##### Run batched evaluation on GPU with %d clients. #####\n", numOfClients);
+        BatchingEvaluationBenchmark(DeviceDescriptor::GPUDevice(0), numOfClients);
+    }
+}
@@ -8,12 +8,14 @@
 #include <stdio.h>
 
 void MultiThreadsEvaluation(bool);
+void BatchingEvaluation(bool);
 
 int main()
 {
 
     fprintf(stderr, "\n##### Run CNTKLibraryCPPEvalGPUExamples on CPU and GPU. #####\n");
     MultiThreadsEvaluation(true);
+    BatchingEvaluation(true);
 
     fprintf(stderr, "Evaluation complete.\n");
     fflush(stderr);
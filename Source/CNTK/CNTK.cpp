@@ -36,6 +36,7 @@
 #include "BrainScriptEvaluator.h"
 #include "BrainScriptParser.h"
 #include "PerformanceProfiler.h"
+#include "ProfilerClockSync.h"
 #include "CNTKLibrary.h"
 
 #include <string>
@@ -71,16 +72,18 @@ template <typename ElemType>
 void TestCn(const ConfigParameters& config);
 
 // Setup profiling
+// In parallel training ('mpi' not null), the timelines of all ranks are aligned to the clock of the main node.
 template <typename ConfigParamType>
-void SetupProfiling(ProfilerContext& profilerContext, const ConfigParamType& config, int nodeRank)
+void SetupProfiling(ProfilerContext& profilerContext, const ConfigParamType& config, const MPIWrapperPtr& mpi)
 {
     if (config(L"profilerEnabled", false))
     {
         wstring workDir = config(L"WorkDir", L".");
         profilerContext.Init(workDir + L"/profiler",
                              config(L"profilerBufferSize", static_cast<uint64_t>(32 * 1024 * 1024)),
-                             std::to_wstring(nodeRank),
+                             std::to_wstring(mpi ? (int)mpi->CurrentNodeRank() : 0),
                              config(L"profilerSyncGpu", true));
+        SynchronizeProfilerTimelines(mpi);
     }
 }
 
@@ -554,7 +557,7 @@ int wmainWithBS(int argc, wchar_t* argv[]) // called from wmain which is a wrapp
 
     // Setup profiling
     ProfilerContext profilerContext;
-    SetupProfiling(profilerContext, config, paralleltrain ? (int)mpi->CurrentNodeRank() : 0);
+    SetupProfiling(profilerContext, config, paralleltrain ? mpi : nullptr);
 
     // execute the actions
     // std::string type = config(L"precision", "float");
@@ -746,7 +749,7 @@ int wmainOldCNTKConfig(int argc, wchar_t* argv[])
 
     // Setup profiling
     ProfilerContext profilerContext;
-    SetupProfiling(profilerContext, config, paralleltrain ? (int)mpi->CurrentNodeRank() : 0);
+    SetupProfiling(profilerContext, config, paralleltrain ? mpi : nullptr);
 
     // run commands
     std::string type = config(L"precision", "float");
@@ -22,6 +22,8 @@
 #include <mutex>
 #include <future>
 #include <cstddef>
+#include <cmath>
+#include <limits>
 
 #ifdef SWIG
 #define final
@@ -2863,6 +2865,32 @@ namespace CNTK
         Invalid,
     };
 
+    ///
+    /// The file format of a saved Function. Function::Load detects the format automatically.
+    ///
+    enum class ModelFormat
+    {
+        ///
+        /// A single protobuf message. Limited to models of less than 2 GB.
+        ///
+        CNTKv2,
+
+        ///
+        /// A protobuf message with the graph, plus the parameter values as raw, aligned payloads next to it.
+        /// The model is written as a stream without a serialized copy in memory, and there is no limit on its size.
+        /// Loading memory-maps the file and copies every parameter value once, directly to the compute device.
+        /// Not readable by versions of CNTK that predate it.
+        ///
+        CNTKv2Streaming,
+
+        ///
+        /// Like CNTKv2Streaming, but dense single precision values are stored in IEEE half precision, which halves
+        /// the size of the file. Loading converts them back to single precision. The conversion is lossy
+        /// (about 3 significant decimal digits), so this format is meant for models used for inference only.
+        ///
+        CNTKv2StreamingFloat16,
+    };
+
     ///
     /// Represents a function (optionally differentiable w.r.t. its inputs)
     /// A Function denotes a symbolic computation with zero or more input arguments and one or more outputs. 
@@ -3212,7 +3240,7 @@ namespace CNTK
         ///
         /// Save this Function graph into a model file.
         ///
-        CNTK_API void Save(const std::wstring& filepath);
+        CNTK_API void Save(const std::wstring& filepath, ModelFormat format = ModelFormat::CNTKv2);
 
         ///
         /// Restore the models parameters (in-place) from a model file
@@ -4696,6 +4724,144 @@ namespace CNTK
     ///
     CNTK_API EvaluatorPtr CreateEvaluator(const FunctionPtr& evaluationFunction, const std::vector<ProgressWriterPtr>& progressWriters = {});
 
+    ///
+    /// Histogram of latencies (in microseconds) with exponentially growing bucket boundaries.
+    /// Bucket 'i' counts the latencies in (BucketUpperBound(i - 1), BucketUpperBound(i)]; the last bucket is unbounded.
+    ///
+    struct LatencyHistogram
+    {
+        static const size_t NumBuckets = 32;
+
+        LatencyHistogram() : m_counts(NumBuckets, 0), m_totalCount(0), m_totalMicroseconds(0), m_maxMicroseconds(0) {}
+
+        static double BucketUpperBound(size_t bucketIndex)
+        {
+            return (bucketIndex + 1 < NumBuckets) ? (double)(1ull << bucketIndex) : std::numeric_limits<double>::infinity();
+        }
+
+        void Add(size_t microseconds)
+        {
+            size_t bucketIndex = 0;
+            while ((bucketIndex + 1 < NumBuckets) && (microseconds > (1ull << bucketIndex)))
+                bucketIndex++;
+
+            m_counts[bucketIndex]++;
+            m_totalCount++;
+            m_totalMicroseconds += microseconds;
+            m_maxMicroseconds = std::max(m_maxMicroseconds, microseconds);
+        }
+
+        size_t TotalCount() const { return m_totalCount; }
+        size_t MaxMicroseconds() const { return m_maxMicroseconds; }
+        double MeanMicroseconds() const { return (m_totalCount == 0) ? 0.0 : (double)m_totalMicroseconds / m_totalCount; }
+        const std::vector<size_t>& Counts() const { return m_counts; }
+
+        ///
+        /// Returns an upper bound of the specified percentile (in [0, 100]) of the recorded latencies.
+        ///
+        double Percentile(double percentile) const
+        {
+            if (m_totalCount == 0)
+                return 0.0;
+
+            size_t rank = (size_t)std::ceil(m_totalCount * std::min(std::max(percentile, 0.0), 100.0) / 100.0);
+            size_t seen = 0;
+            for (size_t i = 0; i < NumBuckets; ++i)
+            {
+                seen += m_counts[i];
+                if ((seen >= rank) && (seen > 0))
+                    return std::min(BucketUpperBound(i), (double)m_maxMicroseconds);
+            }
+
+            return (double)m_maxMicroseconds;
+        }
+
+    private:
+        std::vector<size_t> m_counts;
+        size_t m_totalCount;
+        size_t m_totalMicroseconds;
+        size_t m_maxMicroseconds;
+    };
+
+    ///
+    /// Statistics collected by a BatchingEvaluator since its creation or the last call to ResetStatistics().
+    ///
+    struct BatchingEvaluatorStatistics
+    {
+        size_t m_numRequests = 0;
+        size_t m_numBatches = 0;
+        size_t m_maxBatchSize = 0;
+
+        // Time spent by requests in the queue before their batch was started.
+        LatencyHistogram m_queueLatency;
+
+        // Duration of the batched forward passes.
+        LatencyHistogram m_batchLatency;
+
+        // End-to-end time from submitting a request until its outputs are available.
+        LatencyHistogram m_requestLatency;
+
+        double AverageBatchSize() const { return (m_numBatches == 0) ? 0.0 : (double)m_numRequests / m_numBatches; }
+    };
+
+    ///
+    /// BatchingEvaluator serves single-sample evaluation requests (typically submitted concurrently from many threads)
+    /// by collecting them into minibatches and running one forward pass of the model per minibatch.
+    /// A minibatch is started as soon as either 'maxBatchSize' requests are queued or the oldest queued request
+    /// has waited 'maxLatencyInMicroseconds'. The outputs of the batched forward pass are split back into per-request values.
+    /// Requests are stacked along the batch axis, so all arguments and outputs must have the batch axis as their last dynamic axis.
+    ///
+    class BatchingEvaluator
+    {
+    public:
+        ///
+        /// Enqueues a request for evaluation of the 'outputs' specified at construction for a single sample.
+        /// 'sample' must contain a CPU NDArrayView for each argument of the function, holding exactly one sample or,
+        /// for arguments with a sequence axis, one sequence of samples. Outputs with a sequence axis hold that request's sequence.
+        ///
+        CNTK_API std::future<std::unordered_map<Variable, ValuePtr>> EvaluateAsync(const std::unordered_map<Variable, NDArrayViewPtr>& sample);
+
+        ///
+        /// Blocking version of EvaluateAsync.
+        ///
+        std::unordered_map<Variable, ValuePtr> Evaluate(const std::unordered_map<Variable, NDArrayViewPtr>& sample)
+        {
+            return EvaluateAsync(sample).get();
+        }
+
+        ///
+        /// Returns a snapshot of the batching and latency statistics.
+        ///
+        CNTK_API BatchingEvaluatorStatistics Statistics() const;
+
+        ///
+        /// Resets the batching and latency statistics.
+        ///
+        CNTK_API void ResetStatistics();
+
+        ///
+        /// Destructor. Outstanding requests are completed before the background evaluation thread is stopped.
+        ///
+        CNTK_API ~BatchingEvaluator();
+
+    private:
+        template <typename T1, typename ...CtorArgTypes>
+        friend std::shared_ptr<T1> MakeSharedObject(CtorArgTypes&& ...ctorArgs);
+
+        BatchingEvaluator(const FunctionPtr& function, const std::vector<Variable>& outputs, size_t maxBatchSize, size_t maxLatencyInMicroseconds, const DeviceDescriptor& device);
+
+        // Disallow copy and move construction and assignment
+        BatchingEvaluator(const BatchingEvaluator&) = delete; BatchingEvaluator(BatchingEvaluator&&) = delete; BatchingEvaluator& operator=(const BatchingEvaluator&) = delete; BatchingEvaluator& operator=(BatchingEvaluator&&) = delete;
+
+        class Impl;
+        std::unique_ptr<Impl> m_impl;
+    };
+
+    ///
+    /// Construct a BatchingEvaluator for the specified function and outputs. An empty 'outputs' list denotes all outputs of the function.
+    ///
+    CNTK_API BatchingEvaluatorPtr CreateBatchingEvaluator(const FunctionPtr& function, const std::vector<Variable>& outputs = {}, size_t maxBatchSize = 64, size_t maxLatencyInMicroseconds = 2000, const DeviceDescriptor& device = DeviceDescriptor::UseDefaultDevice());
+
     ///
     /// Trainer is the top-level abstraction responsible for the orchestration of the training of a model
     /// using the specified learners and training data either explicitly supplied as Value objects or from
@@ -4799,8 +4965,10 @@ namespace CNTK
         bool TrainLocalMinibatch(const std::unordered_map<Variable, ValuePtr>& arguments, std::unordered_map<Variable, ValuePtr>& outputsToFetch, bool sweepEnd, const DeviceDescriptor& computeDevice);
         bool TrainDistributedMinibatch(const std::unordered_map<Variable, ValuePtr>& arguments, std::unordered_map<Variable, ValuePtr>& outputsToFetch, bool sweepEnd, const DeviceDescriptor& computeDevice);
 
+        void SaveCheckpoint(const std::wstring& filePath, Dictionary externalState, bool writeInBackground, bool sharded = false);
+        void WaitForCheckpoint();
         void Save(const std::wstring& modelFilePath, const std::vector<DictionaryValue>& learnerState, 
-            const Dictionary& externalState, const Dictionary& distributedState = {});
+            const Dictionary& externalState, const Dictionary& distributedState = {}, bool writeInBackground = false, bool sharded = false);
 
         void UpdateTrainingProgress(size_t numSamples, const ValuePtr& loss, const ValuePtr& evalCriterion, const DeviceDescriptor& computeDevice);
         void AddProgressWriters(const std::vector<ProgressWriterPtr>& progressWriters);
@@ -4824,6 +4992,9 @@ namespace CNTK
         AccumulatorPtr m_aggregatedTrainingEvalCriterionValue;
 
         size_t m_prevDistributedTotalNumSamples;
+
+        // Writes the checkpoints that are saved in the background.
+        std::shared_ptr<Microsoft::MSR::CNTK::AsyncCheckpointWriter> m_checkpointWriter;
     };
 
     ///
@@ -4948,6 +5119,15 @@ namespace CNTK
         ///
         virtual void RestoreFromCheckpoint(const Dictionary& /*checkpoint*/) {}
 
+        ///
+        /// Optionally overridable method returning the total time in seconds GetNextMinibatch() has spent waiting for data
+        /// the reader had not prefetched yet, i.e. the time the reader has not kept up with the consumer.
+        ///
+        virtual double ReaderWaitSeconds() const
+        {
+            return 0;
+        }
+
     public:
         ///
         /// Gets the description of the stream with given name. 
@@ -5043,6 +5223,12 @@ namespace CNTK
         ///
         bool isMultithreaded { false };
 
+        ///
+        /// The number of minibatches the reader reads ahead on its background thread (at least 1). Reading further ahead
+        /// hides the variance of the reading time, at the cost of one set of input buffers per minibatch on the compute device.
+        ///
+        size_t prefetchDepth { 1 };
+
         ///
         /// Deserializers to be used in the composite reader.
         ///
@@ -5054,6 +5240,42 @@ namespace CNTK
     ///
     CNTK_API MinibatchSourcePtr CreateCompositeMinibatchSource(const MinibatchSourceConfig& configuration);
 
+    ///
+    /// A MinibatchSource that interleaves the minibatches of several independent MinibatchSources (e.g. one per corpus),
+    /// each of which keeps its own randomizer and prefetching reader. Every minibatch comes from one of the sources, chosen
+    /// so that the share of the requested samples that each source serves follows its sampling weight.
+    /// All sources must produce the same streams (by name, shape, element type and storage format).
+    ///
+    class WeightedMinibatchSource : public MinibatchSource
+    {
+    public:
+        ///
+        /// Changes the sampling weights, e.g. between epochs. The sources keep their positions; the new weights apply from the next minibatch on.
+        ///
+        virtual void SetWeights(const std::vector<double>& weights) = 0;
+
+        ///
+        /// The current sampling weights.
+        ///
+        virtual const std::vector<double>& Weights() const = 0;
+
+        ///
+        /// Per source: the number of samples read so far (of the stream with the most samples).
+        ///
+        virtual const std::vector<size_t>& NumSamplesRead() const = 0;
+
+        ///
+        /// Per source: the time in seconds spent in GetNextMinibatch of the source, i.e. waiting for data its reader has not prefetched yet.
+        ///
+        virtual const std::vector<double>& SecondsReading() const = 0;
+    };
+
+    ///
+    /// Instantiate a WeightedMinibatchSource over the specified sources, with one non-negative sampling weight per source.
+    /// A source that has no more data drops out; the WeightedMinibatchSource has no more data when all of its sources are exhausted.
+    ///
+    CNTK_API WeightedMinibatchSourcePtr CreateWeightedMinibatchSource(const std::vector<MinibatchSourcePtr>& sources, const std::vector<double>& weights);
+
     struct StreamConfiguration
     {
         StreamConfiguration(const std::wstring& streamName, size_t dim, bool isSparse = false, const std::wstring& streamAlias = L"")
@@ -5157,6 +5379,18 @@ namespace CNTK
         std::unordered_map<StreamInformation, std::pair<NDArrayViewPtr, NDArrayViewPtr>>& computedMeanAndVariances,
         const DeviceDescriptor& device = DeviceDescriptor::CPUDevice());
 
+    ///
+    /// Same as above, but reads at most 'maxNumSamples' samples (MinibatchSource::InfinitelyRepeat for all of them); reading stops as soon as
+    /// one of the specified streams has reached the limit. With a 'communicator', every worker reads its own partition of the data
+    /// (and an equal share of 'maxNumSamples'), and the per-worker statistics are merged into the statistics of the whole data.
+    /// All workers of the communicator must call this function.
+    ///
+    CNTK_API void ComputeInputPerDimMeansAndInvStdDevs(const MinibatchSourcePtr& minibatchSource,
+        std::unordered_map<StreamInformation, std::pair<NDArrayViewPtr, NDArrayViewPtr>>& computedMeanAndInvStdDevs,
+        size_t maxNumSamples,
+        const DistributedCommunicatorPtr& communicator = nullptr,
+        const DeviceDescriptor& device = DeviceDescriptor::CPUDevice());
+
     ///
     /// Set the process-wide setting for maximum number of CPU threads to be used by any individual compute operation
     /// Note that this is a per compute operation limit and if the user performs multiple compute operations concurrently
@@ -5311,12 +5545,23 @@ namespace CNTK
         /// checkpointFrequencyInSamples: frequency in samples when to perform checkpointing.
         /// restoreFromCheckpointIfExists: if flag is set, the training session will try to restore before training.
         /// preserveAllCheckpoints: if flag is set, all checkpoints will be preserved.
+        /// checkpointOnTermination: if flag is set, a termination signal (SIGTERM, e.g. sent by a scheduler on preemption)
+        ///     to any of the workers makes all workers save a checkpoint after the current minibatch and stop training.
+        /// asyncCheckpointing: if flag is set, the periodic checkpoints are written on a background thread. Training only
+        ///     waits for a snapshot of the model and trainer state, or for the previous checkpoint if it is still being written.
+        /// shardedCheckpointing: if flag is set, every worker of distributed training writes a part of the parameters and
+        ///     learner state to a shard file of its own (<checkPointFileName>.shard<N>), in parallel.
+        ///
+        /// A checkpoint of distributed training can be restored on a different number of workers.
         ///
         CNTK_API CheckpointConfig(
             const std::wstring& checkPointFileName,
             size_t checkpointFrequencyInSamples = std::numeric_limits<size_t>::max(),
             bool restoreFromCheckpointIfExists = true,
-            bool preserveAllCheckpoints = false);
+            bool preserveAllCheckpoints = false,
+            bool checkpointOnTermination = false,
+            bool asyncCheckpointing = false,
+            bool shardedCheckpointing = false);
 
     private:
         friend class TrainingSession;
@@ -5324,6 +5569,9 @@ namespace CNTK
         const bool m_restore;
         const bool m_preserveAll;
         const size_t m_frequency;
+        const bool m_checkpointOnTermination;
+        const bool m_async;
+        const bool m_sharded;
     };
 
     ///
@@ -5453,8 +5701,9 @@ namespace CNTK
         void GetCrossValidationMinibatch(std::unordered_map<Variable, ValuePtr>& minibatch, size_t maxMbSize, const DeviceDescriptor& computeDevice);
 
         void RestoreFromCheckpoint();
-        void SaveCheckpoint(size_t currentIndex);
+        void SaveCheckpoint(size_t currentIndex, bool writeInBackground = false);
         void SaveFinalCheckpoint();
+        bool IsTerminationRequested(const DeviceDescriptor& computeDevice);
 
         bool CrossValidate(size_t currentIndex, const DeviceDescriptor& computeDevice);
         void ReportProgress(size_t currentIndex);
@@ -5463,6 +5712,7 @@ namespace CNTK
         size_t m_parallelAfterSamples;
         size_t m_workerRank;
         size_t m_numberOfWorkers;
+        DistributedCommunicatorPtr m_communicator;
 
         std::vector<PeriodicAction> m_actions;
 
@@ -58,6 +58,8 @@ namespace Microsoft { namespace MSR { namespace CNTK {
 
     class ComputationNodeBase;
     typedef std::shared_ptr<ComputationNodeBase> ComputationNodeBasePtr;
+
+    class AsyncCheckpointWriter;
 }}}
 
 // TODO: The following should be reconciled with the equivalent code in the CNTK implementation
@@ -185,6 +187,9 @@ namespace CNTK
     class MinibatchSource;
     typedef std::shared_ptr<MinibatchSource> MinibatchSourcePtr;
 
+    class WeightedMinibatchSource;
+    typedef std::shared_ptr<WeightedMinibatchSource> WeightedMinibatchSourcePtr;
+
     class DistributedCommunicator;
     typedef std::shared_ptr<DistributedCommunicator> DistributedCommunicatorPtr;
 
@@ -203,6 +208,9 @@ namespace CNTK
     class Evaluator;
     typedef std::shared_ptr<Evaluator> EvaluatorPtr;
 
+    class BatchingEvaluator;
+    typedef std::shared_ptr<BatchingEvaluator> BatchingEvaluatorPtr;
+
     class Trainer;
     typedef std::shared_ptr<Trainer> TrainerPtr;
 
@@ -287,6 +295,7 @@ namespace CNTK
         CNTK_API void DisableGradientAccumulationOptimization();
 
         static const uint64_t DefaultProfilerBufferSize = 32 * 1024 * 1024;
+        // In distributed training, StartProfiler() must be called by all workers: it aligns their timelines.
         CNTK_API void StartProfiler(const std::wstring& profilerDir = L"profiler", bool profilerSyncGpu = false, size_t profilerBufferSize = DefaultProfilerBufferSize);
         CNTK_API void EnableProfiler();
         CNTK_API void DisableProfiler();
@@ -300,9 +309,20 @@ namespace CNTK
 
         CNTK_API size_t DefaultPackThresholdSizeInBytes();
 
+        // Values of at least this size are aggregated by the MPICommunicator with a pipelined ring all-reduce
+        // instead of the MPI library's all-reduce. SIZE_MAX (the default) disables the ring all-reduce.
+        CNTK_API void SetRingAllReduceThresholdInBytes(size_t thresholdInBytes);
+        CNTK_API void SetRingAllReduceChunkSizeInBytes(size_t chunkSizeInBytes);
+
         // This is an internal API, needed for testing.
         CNTK_API Dictionary ToDictionary(const MinibatchSourceConfig& dict);
 
+        // Merges the per-dimension means and inverse standard deviations of partitions of the data, with numSamples[k] samples
+        // in partition k, into those of the whole data, like ComputeInputPerDimMeansAndInvStdDevs() does across workers.
+        // This is an internal API, needed for testing.
+        CNTK_API std::pair<NDArrayViewPtr, NDArrayViewPtr> MergeMeansAndInvStdDevs(const std::vector<std::pair<NDArrayViewPtr, NDArrayViewPtr>>& meansAndInvStdDevs,
+                                                                                   const std::vector<size_t>& numSamples);
+
         class VariableResolver;
 
         ///
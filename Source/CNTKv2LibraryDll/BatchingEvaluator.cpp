@@ -0,0 +1,299 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#include "stdafx.h"
+#include "CNTKLibrary.h"
+#include "Utils.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+namespace CNTK
+{
+    class BatchingEvaluator::Impl
+    {
+        typedef std::chrono::steady_clock Clock;
+
+        struct Request
+        {
+            std::unordered_map<Variable, NDArrayViewPtr> m_sample;
+            std::promise<std::unordered_map<Variable, ValuePtr>> m_result;
+            Clock::time_point m_enqueueTime;
+        };
+
+    public:
+        Impl(const FunctionPtr& function, const std::vector<Variable>& outputs, size_t maxBatchSize, size_t maxLatencyInMicroseconds, const DeviceDescriptor& device)
+            : m_function(function),
+              m_outputs(outputs.empty() ? function->Outputs() : outputs),
+              m_arguments(function->Arguments()),
+              m_maxBatchSize(maxBatchSize),
+              m_maxLatency(std::chrono::microseconds(maxLatencyInMicroseconds)),
+              m_device(device),
+              m_stopRequested(false)
+        {
+            if (m_maxBatchSize == 0)
+                InvalidArgument("BatchingEvaluator: maxBatchSize must be > 0.");
+
+            // Requests are stacked along the batch axis and the outputs are split along it again, which requires
+            // the batch axis to be the last dynamic axis of every argument and output.
+            for (const auto& argument : m_arguments)
+                VerifyBatchAxis(argument, "argument");
+
+            for (const auto& output : m_outputs)
+                VerifyBatchAxis(output, "output");
+
+            m_worker = std::thread([this] { Run(); });
+        }
+
+        ~Impl()
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_queueMutex);
+                m_stopRequested = true;
+            }
+            m_queueNotEmpty.notify_all();
+            m_worker.join();
+        }
+
+        std::future<std::unordered_map<Variable, ValuePtr>> Enqueue(const std::unordered_map<Variable, NDArrayViewPtr>& sample)
+        {
+            for (const auto& argument : m_arguments)
+            {
+                auto it = sample.find(argument);
+                if (it == sample.end())
+                    InvalidArgument("BatchingEvaluator: No value specified for argument '%S'.", argument.AsString().c_str());
+
+                if (it->second->Device() != DeviceDescriptor::CPUDevice())
+                    InvalidArgument("BatchingEvaluator: The value of argument '%S' must be located on the CPU.", argument.AsString().c_str());
+
+                auto sampleSize = argument.Shape().TotalSize();
+                auto valueSize = it->second->Shape().TotalSize();
+                if (HasSequenceAxis(argument))
+                {
+                    if ((valueSize == 0) || ((valueSize % sampleSize) != 0))
+                        InvalidArgument("BatchingEvaluator: The value shape '%S' of argument '%S' does not hold a non-empty sequence of samples of shape '%S'.",
+                                        it->second->Shape().AsString().c_str(), argument.AsString().c_str(), argument.Shape().AsString().c_str());
+                }
+                else if (valueSize != sampleSize)
+                    InvalidArgument("BatchingEvaluator: The value shape '%S' of argument '%S' does not hold exactly one sample of shape '%S'.",
+                                    it->second->Shape().AsString().c_str(), argument.AsString().c_str(), argument.Shape().AsString().c_str());
+            }
+
+            std::unique_ptr<Request> request(new Request());
+            request->m_sample = sample;
+            request->m_enqueueTime = Clock::now();
+            auto result = request->m_result.get_future();
+            {
+                std::unique_lock<std::mutex> lock(m_queueMutex);
+                if (m_stopRequested)
+                    LogicError("BatchingEvaluator: Cannot enqueue requests after the evaluator has been stopped.");
+
+                m_queue.push_back(std::move(request));
+            }
+            m_queueNotEmpty.notify_one();
+            return result;
+        }
+
+        BatchingEvaluatorStatistics Statistics() const
+        {
+            std::unique_lock<std::mutex> lock(m_statisticsMutex);
+            return m_statistics;
+        }
+
+        void ResetStatistics()
+        {
+            std::unique_lock<std::mutex> lock(m_statisticsMutex);
+            m_statistics = BatchingEvaluatorStatistics();
+        }
+
+    private:
+        static size_t Microseconds(Clock::duration duration)
+        {
+            return (size_t)std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        }
+
+        static bool HasSequenceAxis(const Variable& variable)
+        {
+            return variable.DynamicAxes().size() > 1;
+        }
+
+        static void VerifyBatchAxis(const Variable& variable, const char* kind)
+        {
+            const auto& dynamicAxes = variable.DynamicAxes();
+            if (dynamicAxes.empty() || (dynamicAxes.back() != Axis::DefaultBatchAxis()) || (dynamicAxes.size() > 2))
+                InvalidArgument("BatchingEvaluator: The %s '%S' must have the batch axis as its last dynamic axis and at most one sequence axis.", kind, variable.AsString().c_str());
+        }
+
+        // Takes the next batch off the queue. The batch is released once it is full or its oldest request
+        // has reached the latency budget. Returns an empty batch only when stopping with an empty queue.
+        std::vector<std::unique_ptr<Request>> NextBatch()
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_queueNotEmpty.wait(lock, [this] { return m_stopRequested || !m_queue.empty(); });
+
+            if (!m_queue.empty())
+            {
+                auto deadline = m_queue.front()->m_enqueueTime + m_maxLatency;
+                m_queueNotEmpty.wait_until(lock, deadline, [this] { return m_stopRequested || (m_queue.size() >= m_maxBatchSize); });
+            }
+
+            std::vector<std::unique_ptr<Request>> batch;
+            while (!m_queue.empty() && (batch.size() < m_maxBatchSize))
+            {
+                batch.push_back(std::move(m_queue.front()));
+                m_queue.pop_front();
+            }
+
+            return batch;
+        }
+
+        void Run()
+        {
+            for (;;)
+            {
+                auto batch = NextBatch();
+                if (batch.empty())
+                    return;
+
+                auto batchStartTime = Clock::now();
+                try
+                {
+                    EvaluateBatch(batch);
+                }
+                catch (...)
+                {
+                    for (auto& request : batch)
+                        request->m_result.set_exception(std::current_exception());
+                }
+
+                auto batchEndTime = Clock::now();
+                std::unique_lock<std::mutex> lock(m_statisticsMutex);
+                m_statistics.m_numRequests += batch.size();
+                m_statistics.m_numBatches++;
+                m_statistics.m_maxBatchSize = std::max(m_statistics.m_maxBatchSize, batch.size());
+                m_statistics.m_batchLatency.Add(Microseconds(batchEndTime - batchStartTime));
+                for (const auto& request : batch)
+                {
+                    m_statistics.m_queueLatency.Add(Microseconds(batchStartTime - request->m_enqueueTime));
+                    m_statistics.m_requestLatency.Add(Microseconds(batchEndTime - request->m_enqueueTime));
+                }
+            }
+        }
+
+        void EvaluateBatch(std::vector<std::unique_ptr<Request>>& batch)
+        {
+            // Each request contributes one sequence to the argument values of the minibatch;
+            // arguments without a sequence axis get a single-sample sequence.
+            std::unordered_map<Variable, ValuePtr> arguments;
+            std::vector<NDArrayViewPtr> samples(batch.size());
+            for (const auto& argument : m_arguments)
+            {
+                for (size_t i = 0; i < batch.size(); ++i)
+                {
+                    const auto& sample = batch[i]->m_sample.at(argument);
+                    auto sequenceLength = sample->Shape().TotalSize() / argument.Shape().TotalSize();
+                    samples[i] = sample->AsShape(argument.Shape().AppendShape({ sequenceLength }));
+                }
+
+                arguments[argument] = Value::Create(argument.Shape(), samples, {}, m_device, /*readOnly =*/ true);
+            }
+
+            std::unordered_map<Variable, ValuePtr> outputs;
+            for (const auto& output : m_outputs)
+                outputs[output] = nullptr;
+
+            m_function->Evaluate(arguments, outputs, m_device);
+
+            // The batch axis is the trailing axis of all output values (verified at construction); split it back into
+            // the individual requests. Outputs with a sequence axis are trimmed to the valid length of each request's sequence.
+            std::vector<std::unordered_map<Variable, ValuePtr>> results(batch.size());
+            for (const auto& output : outputs)
+            {
+                auto data = output.second->Data();
+                auto shape = data->Shape();
+                auto hasSequenceAxis = HasSequenceAxis(output.first);
+                auto batchAxis = shape.Rank() - 1;
+                if ((shape.Rank() != output.first.Shape().Rank() + (hasSequenceAxis ? 2 : 1)) || (shape[batchAxis] != batch.size()))
+                    LogicError("BatchingEvaluator: The value shape '%S' of output '%S' does not hold %zu requests along its batch axis.", shape.AsString().c_str(), output.first.AsString().c_str(), batch.size());
+
+                NDMaskPtr mask = (hasSequenceAxis && output.second->Mask()) ? output.second->Mask()->DeepClone(DeviceDescriptor::CPUDevice()) : nullptr;
+                std::vector<size_t> offset(shape.Rank(), 0);
+                std::vector<size_t> extent = shape.Dimensions();
+                extent[batchAxis] = 1;
+                for (size_t i = 0; i < batch.size(); ++i)
+                {
+                    if (mask)
+                    {
+                        auto sequenceAxis = batchAxis - 1;
+                        auto sequenceLength = shape[sequenceAxis];
+                        const MaskKind* maskData = mask->DataBuffer() + (i * shape[sequenceAxis]);
+                        while ((sequenceLength > 0) && (maskData[sequenceLength - 1] == MaskKind::Invalid))
+                            sequenceLength--;
+
+                        extent[sequenceAxis] = sequenceLength;
+                    }
+
+                    offset[batchAxis] = i;
+                    auto sampleData = data->SliceView(offset, extent, /*readOnly =*/ true)->DeepClone(DeviceDescriptor::CPUDevice(), /*readOnly =*/ true);
+                    results[i][output.first] = MakeSharedObject<Value>(sampleData);
+                }
+            }
+
+            for (size_t i = 0; i < batch.size(); ++i)
+                batch[i]->m_result.set_value(std::move(results[i]));
+        }
+
+        const FunctionPtr m_function;
+        const std::vector<Variable> m_outputs;
+        const std::vector<Variable> m_arguments;
+        const size_t m_maxBatchSize;
+        const Clock::duration m_maxLatency;
+        const DeviceDescriptor m_device;
+
+        std::mutex m_queueMutex;
+        std::condition_variable m_queueNotEmpty;
+        std::deque<std::unique_ptr<Request>> m_queue;
+        bool m_stopRequested;
+
+        mutable std::mutex m_statisticsMutex;
+        BatchingEvaluatorStatistics m_statistics;
+
+        std::thread m_worker;
+    };
+
+    BatchingEvaluatorPtr CreateBatchingEvaluator(const FunctionPtr& function, const std::vector<Variable>& outputs, size_t maxBatchSize, size_t maxLatencyInMicroseconds, const DeviceDescriptor& device)
+    {
+        return MakeSharedObject<BatchingEvaluator>(function, outputs, maxBatchSize, maxLatencyInMicroseconds, device);
+    }
+
+    BatchingEvaluator::BatchingEvaluator(const FunctionPtr& function, const std::vector<Variable>& outputs, size_t maxBatchSize, size_t maxLatencyInMicroseconds, const DeviceDescriptor& device)
+    {
+        if (!function)
+            InvalidArgument("BatchingEvaluator: The function is not allowed to be null.");
+
+        m_impl.reset(new Impl(function, outputs, maxBatchSize, maxLatencyInMicroseconds, device));
+    }
+
+    BatchingEvaluator::~BatchingEvaluator()
+    {
+    }
+
+    std::future<std::unordered_map<Variable, ValuePtr>> BatchingEvaluator::EvaluateAsync(const std::unordered_map<Variable, NDArrayViewPtr>& sample)
+    {
+        return m_impl->Enqueue(sample);
+    }
+
+    BatchingEvaluatorStatistics BatchingEvaluator::Statistics() const
+    {
+        return m_impl->Statistics();
+    }
+
+    void BatchingEvaluator::ResetStatistics()
+    {
+        m_impl->ResetStatistics();
+    }
+}
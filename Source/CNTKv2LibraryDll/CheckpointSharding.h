@@ -0,0 +1,84 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// CheckpointSharding.h -- sharded checkpoints in the streaming model format (see Serialization.h)
+//
+
+#pragma once
+
+#include "CNTKLibrary.h"
+
+namespace CNTK
+{
+    // Sharded checkpoints: in synchronous data-parallel training, all workers hold the same parameters and learner state.
+    // Instead of the main worker writing all of it, the NDArrayViews are split by size over the workers, and every worker
+    // writes its part to a shard file of its own (in the streaming format), in parallel. The model and trainer state files
+    // written by the main worker refer to the NDArrayViews in the shard files by key path, e.g. 'model/primitive_functions/3/value'.
+    // Shard 0 is the main worker's: its NDArrayViews are stored in the model and trainer state files themselves.
+    class CNTK_API CheckpointSharding
+    {
+    public:
+        // 'checkpoint' identifies the checkpoint (e.g., by its sample count), so that a shard file of a different checkpoint
+        // is detected on load rather than silently mixed in.
+        CheckpointSharding(const std::wstring& modelFilePath, size_t numShards, size_t checkpoint);
+
+        // Adds the NDArrayViews of 'dictionary' (or of 'values') to the checkpoint, under the key path 'path'.
+        // The sharding refers to them: they must outlive it.
+        void Add(const std::wstring& path, const Dictionary& dictionary);
+        void Add(const std::wstring& path, const std::vector<DictionaryValue>& values);
+
+        // Assigns the NDArrayViews added so far to the shards, the largest first, each to the shard with the fewest bytes.
+        // All workers add the same NDArrayViews, so all of them arrive at the same assignment.
+        void Partition();
+
+        // The shard of the NDArrayView at 'path'; 0 if the NDArrayView is not part of the sharding.
+        size_t ShardOf(const std::wstring& path) const;
+
+        size_t NumShards() const { return m_numShards; }
+        size_t Checkpoint() const { return m_checkpoint; }
+
+        // The shard files are next to the model file, and referred to by file name only, so that checkpoints can be moved.
+        std::wstring ShardFileName(size_t shard) const;
+        std::wstring ShardFilePath(size_t shard) const;
+
+        const std::vector<std::pair<std::wstring, const NDArrayView*>>& Views() const { return m_views; }
+
+    private:
+        void Add(const std::wstring& path, const DictionaryValue& value);
+
+        std::wstring m_modelFilePath;
+        size_t m_numShards;
+        size_t m_checkpoint;
+        std::vector<std::pair<std::wstring, const NDArrayView*>> m_views;
+        std::unordered_map<std::wstring, size_t> m_shardOf;
+    };
+
+    // Writes the dictionary like SaveInStreamingFormat, except that NDArrayViews of 'sharding' in a shard other than 0
+    // are stored as references to their shard file. 'path' is the key path of the dictionary in the sharding.
+    CNTK_API void SaveInStreamingFormat(const Dictionary& dictionary, std::ostream& stream, const std::wstring& path, const CheckpointSharding& sharding);
+
+    // Writes the shard file 'shard' of 'sharding'.
+    CNTK_API void SaveShard(const CheckpointSharding& sharding, size_t shard, std::ostream& stream);
+
+    // Opens the shard files that a file in the streaming format refers to; they are looked up in the directory of that file.
+    // Every shard file is opened once, and all shard files of a checkpoint are prefetched together.
+    class ShardReader
+    {
+    public:
+        explicit ShardReader(const std::wstring& referringFilePath);
+        ~ShardReader();
+
+    private:
+        friend class Serializer;
+        struct Shard;
+
+        ShardReader(const ShardReader&) = delete;
+        ShardReader& operator=(const ShardReader&) = delete;
+
+        const Shard& Open(const std::string& fileName, size_t checkpoint);
+
+        std::wstring m_directory;
+        std::unordered_map<std::string, std::unique_ptr<Shard>> m_shards;
+    };
+}
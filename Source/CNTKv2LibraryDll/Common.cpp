@@ -15,6 +15,7 @@
 #include "GPUMatrix.h"
 #include "Globals.h"
 #include "PerformanceProfiler.h"
+#include "ProfilerClockSync.h"
 #include "MPIWrapper.h"
 #include "Basics.h"
 #include "ProgressTracing.h"
@@ -182,6 +183,10 @@ namespace CNTK
                 profilerBufferSize,
                 logSuffix,
                 profilerSyncGpu);
+
+            // in distributed training, all workers start the profiler, which aligns their timelines
+            if (mpi && mpi->NumNodesInUse() > 1)
+                Microsoft::MSR::CNTK::SynchronizeProfilerTimelines(mpi);
         }
 
         void EnableProfiler()
@@ -496,6 +501,16 @@ namespace CNTK
         {
             return DEFAULT_PACK_THRESHOLD_SIZE_IN_BYTES;
         }
+
+        void SetRingAllReduceThresholdInBytes(size_t thresholdInBytes)
+        {
+            Microsoft::MSR::CNTK::Globals::SetRingAllReduceThresholdInBytes(thresholdInBytes);
+        }
+
+        void SetRingAllReduceChunkSizeInBytes(size_t chunkSizeInBytes)
+        {
+            Microsoft::MSR::CNTK::Globals::SetRingAllReduceChunkSizeInBytes(chunkSizeInBytes);
+        }
     }
 
     std::atomic<TraceLevel> s_traceLevel(TraceLevel::Warning);
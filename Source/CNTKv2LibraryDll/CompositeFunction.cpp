@@ -1164,6 +1164,150 @@ namespace CNTK
         return true;
     }
 
+    std::shared_ptr<SharedNetworkTemplate> CompositeFunction::GetSharedNetworkTemplate() const
+    {
+        static std::mutex s_mutex;
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (!m_sharedNetworkTemplate)
+            m_sharedNetworkTemplate = std::make_shared<SharedNetworkTemplate>();
+
+        return m_sharedNetworkTemplate;
+    }
+
+    std::vector<Variable> CompositeFunction::VariablesInStructuralOrder() const
+    {
+        std::vector<Variable> variables;
+        std::unordered_set<Variable> visitedVariables;
+        std::unordered_set<Function*> visitedFunctions;
+        auto addVariable = [&](const Variable& var) {
+            if (visitedVariables.insert(var).second)
+                variables.push_back(var);
+        };
+
+        std::function<void(const FunctionPtr&)> visit;
+        visit = [&](const FunctionPtr& function) {
+            if (!visitedFunctions.insert(function.get()).second)
+                return;
+
+            for (const auto& input : function->Inputs())
+            {
+                if (input.IsOutput())
+                    visit(input.Owner());
+                addVariable(input);
+            }
+
+            auto blockFunction = dynamic_cast<const BlockFunction*>(function.get());
+            if (blockFunction)
+            {
+                for (const auto& argument : blockFunction->Composite()->Arguments())
+                    addVariable(argument);
+                visit(blockFunction->BlockRoot());
+            }
+
+            for (const auto& output : function->RawOutputs())
+                addVariable(output);
+        };
+        visit(RootFunction());
+
+        return variables;
+    }
+
+    // Called by a Function that has just built and compiled its inference network from its graph: makes a template of
+    // the network, unless another Function with the same template was first.
+    void CompositeFunction::RegisterSharedNetworkTemplate(const std::unordered_set<Variable>& outputs)
+    {
+        if (!m_sharedNetworkTemplate || !m_fullyDefinedArgumentsMap.empty())
+            return;
+
+        std::lock_guard<std::mutex> lock(m_sharedNetworkTemplate->m_mutex);
+        if (m_sharedNetworkTemplate->m_network)
+            return;
+
+        auto variables = VariablesInStructuralOrder();
+        std::unordered_map<Variable, size_t> variableIndices;
+        std::vector<std::pair<VariableKind, NDShape>> variableSignatures;
+        std::vector<std::wstring> nodeNames(variables.size());
+        for (size_t i = 0; i < variables.size(); ++i)
+        {
+            variableIndices[variables[i]] = i;
+            variableSignatures.push_back({ variables[i].Kind(), variables[i].Shape() });
+        }
+
+        // The template is of no use if the structural order misses any of the mapped Variables
+        for (const auto& varNodePair : m_variableToNodeMap)
+        {
+            auto index = variableIndices.find(varNodePair.first);
+            if (index == variableIndices.end())
+                return;
+            nodeNames[index->second] = varNodePair.second->NodeName();
+        }
+
+        std::vector<size_t> outputIndices;
+        for (const auto& output : outputs)
+        {
+            auto index = variableIndices.find(output);
+            if (index == variableIndices.end())
+                return;
+            outputIndices.push_back(index->second);
+        }
+        std::sort(outputIndices.begin(), outputIndices.end());
+
+        m_sharedNetworkTemplate->m_variableSignatures = std::move(variableSignatures);
+        m_sharedNetworkTemplate->m_nodeNames = std::move(nodeNames);
+        m_sharedNetworkTemplate->m_outputs = std::move(outputIndices);
+        m_sharedNetworkTemplate->m_network = m_computationNetwork->CloneWithSharedParameters();
+    }
+
+    // Creates the inference network of 'this' Function from the shared template, if there is one for the same device and outputs.
+    bool CompositeFunction::CreateComputationNetworkFromSharedTemplate(const DeviceDescriptor& device, const std::unordered_set<Variable>& outputs)
+    {
+        if (!m_sharedNetworkTemplate)
+            return false;
+
+        ComputationNetworkPtr templateNetwork;
+        {
+            std::lock_guard<std::mutex> lock(m_sharedNetworkTemplate->m_mutex);
+            templateNetwork = m_sharedNetworkTemplate->m_network;
+        }
+
+        if (!templateNetwork || (AsDeviceDescriptor(templateNetwork->GetDeviceId()) != device))
+            return false;
+
+        const auto& sharedTemplate = *m_sharedNetworkTemplate;
+        auto variables = VariablesInStructuralOrder();
+        if (variables.size() != sharedTemplate.m_variableSignatures.size())
+            return false;
+
+        std::unordered_map<Variable, size_t> variableIndices;
+        for (size_t i = 0; i < variables.size(); ++i)
+        {
+            if ((variables[i].Kind() != sharedTemplate.m_variableSignatures[i].first) || (variables[i].Shape() != sharedTemplate.m_variableSignatures[i].second))
+                return false;
+            variableIndices[variables[i]] = i;
+        }
+
+        std::vector<size_t> outputIndices;
+        for (const auto& output : outputs)
+        {
+            auto index = variableIndices.find(output);
+            if (index == variableIndices.end())
+                return false;
+            outputIndices.push_back(index->second);
+        }
+        std::sort(outputIndices.begin(), outputIndices.end());
+        if (outputIndices != sharedTemplate.m_outputs)
+            return false;
+
+        m_computationNetwork = templateNetwork->CloneWithSharedParameters();
+        for (size_t i = 0; i < variables.size(); ++i)
+        {
+            if (!sharedTemplate.m_nodeNames[i].empty())
+                m_variableToNodeMap[variables[i]] = m_computationNetwork->GetNodeFromName(sharedTemplate.m_nodeNames[i]);
+        }
+
+        return true;
+    }
+
     template <typename ElementType>
     ComputationNetworkPtr CompositeFunction::GetComputationNetwork(const DeviceDescriptor& device,
                                                                    const std::unordered_set<Variable>& backpropRoots,
@@ -1198,6 +1342,15 @@ namespace CNTK
                     argumentComputationNode->SetDims(AsTensorShape(newShape), argumentComputationNode->HasMBLayout());
             }
         }
+        else if (backpropRoots.empty() && CreateComputationNetworkFromSharedTemplate(device, outputs))
+        {
+            m_inputsExcludedFromGradientComputation = NonOwnerPreservingCopy(inputsToExcludeGradientsFor);
+
+            assert(m_lastRecordedParameterValueTimeStamps.empty());
+            auto functionParameters = Parameters();
+            for (auto parameter : functionParameters)
+                m_lastRecordedParameterValueTimeStamps.insert({ parameter, parameter.CurrentValueTimeStamp() });
+        }
         else
         {
             m_computationNetwork = std::make_shared<ComputationNetwork>(AsCNTKImplDeviceId(device));
@@ -1348,6 +1501,9 @@ namespace CNTK
             auto functionParameters = Parameters();
             for (auto parameter : functionParameters)
                 m_lastRecordedParameterValueTimeStamps.insert({ parameter, parameter.CurrentValueTimeStamp() });
+
+            if (backpropRoots.empty())
+                RegisterSharedNetworkTemplate(outputs);
         }
 
         if (!m_networkMatricesAllocated && allocateNetworkMatrices)
@@ -1395,15 +1551,19 @@ namespace CNTK
         if (!computationNode->Is<InputValueBase<ElementType>>())
             CNTK::LogicError("CompositeFunction::Forward: Illegal to populate value of a non-input Variable '%S'.", variableValue.first.AsString().c_str());
 
+        // Sequences that need to be interleaved are packed straight into the node's matrix if it lives on the same device
+        auto& nodeDataPtr = computationNode->As<ComputationNode<ElementType>>()->ValuePtrRef();
+        bool packInPlace = (variableValue.second->Device() == AsDeviceDescriptor(nodeDataPtr->GetDeviceId())) && (variableValue.second->IsSparse() == (nodeDataPtr->GetMatrixType() == MatrixType::SPARSE));
         NDShape inferredVariableShape;
-        std::pair<std::shared_ptr<const Matrix<ElementType>>, MBLayoutPtr> CNTKMatrixAndMBLayout = Utils::GetCNTKImplMatrixAndMBLayoutFromValueObject<ElementType>(variableValue.first, variableValue.second, &inferredVariableShape);
+        std::pair<std::shared_ptr<const Matrix<ElementType>>, MBLayoutPtr> CNTKMatrixAndMBLayout = Utils::GetCNTKImplMatrixAndMBLayoutFromValueObject<ElementType>(variableValue.first, variableValue.second, &inferredVariableShape,
+                                                                                                                                                                  packInPlace ? nodeDataPtr : nullptr, nullptr);
         if (!VariableShapeMatchesNodeShape(inferredVariableShape, computationNode->GetSampleLayout()))
             CNTK::LogicError("CompositeFunction::Forward: Inferred shape '%S' of Variable '%S' does not match the corresponding computation node shape '%s'.", 
                              inferredVariableShape.AsString().c_str(), variableValue.first.AsString().c_str(), ((std::string)computationNode->GetSampleLayout()).c_str());
 
         // Switch the node matrix to the right matrix type
-        auto& nodeData = computationNode->As<ComputationNode<ElementType>>()->Value();
-        nodeData.AssignValuesOf(*CNTKMatrixAndMBLayout.first);
+        if (CNTKMatrixAndMBLayout.first != nodeDataPtr)
+            nodeDataPtr->AssignValuesOf(*CNTKMatrixAndMBLayout.first);
 
         auto layout = CNTKMatrixAndMBLayout.second;
         auto& nodeLayout = computationNode->GetMBLayout();
@@ -1548,8 +1708,14 @@ namespace CNTK
                                   varValue->Shape().AsString().c_str(), var.AsString().c_str(), getGradient ? "gradient" : "output", valueShape.AsString().c_str());
         }
 
-        ValuePtr nodeValue;
+        // A dense, writable Value object specified by the caller is filled in place, instead of through a temporary Value object
         auto layout = computationNode->GetMBLayout();
+        auto canFillInPlace = [&varValue](const MatrixBase& matrix) {
+            return !std::dynamic_pointer_cast<PackedValue>(varValue) && !varValue->IsSparse() && !varValue->IsReadOnly() &&
+                   (matrix.GetMatrixType() == MatrixType::DENSE) && (varValue->Device() == AsDeviceDescriptor(matrix.GetDeviceId()));
+        };
+
+        ValuePtr nodeValue;
         switch (var.GetDataType())
         {
         case DataType::Float:
@@ -1557,6 +1723,8 @@ namespace CNTK
             auto& matrix = getGradient ? computationNode->As<ComputationNode<float>>()->Gradient() : computationNode->As<ComputationNode<float>>()->Value();
             if (varValue == nullptr)
                 nodeValue = MakeSharedObject<PackedValue>(varShape, var.DynamicAxes(), std::make_shared<Matrix<float>>(matrix.AsReference()), layout, /*readOnly =*/ false);
+            else if (canFillInPlace(matrix))
+                Utils::CopyCNTKImplMatrixAndMBLayoutToValueObject<float>(varShape, var.DynamicAxes(), matrix, layout, varValue);
             else
                 nodeValue = Utils::GetValueObjectFromCNTKImplMatrixAndMBLayout<float>(var, computationNode, matrix, layout);
             break;
@@ -1566,6 +1734,8 @@ namespace CNTK
             auto& matrix = getGradient ? computationNode->As<ComputationNode<double>>()->Gradient() : computationNode->As<ComputationNode<double>>()->Value();
             if (varValue == nullptr)
                 nodeValue = MakeSharedObject<PackedValue>(varShape, var.DynamicAxes(), std::make_shared<Matrix<double>>(matrix.AsReference()), layout, /*readOnly =*/ false);
+            else if (canFillInPlace(matrix))
+                Utils::CopyCNTKImplMatrixAndMBLayoutToValueObject<double>(varShape, var.DynamicAxes(), matrix, layout, varValue);
             else
                 nodeValue = Utils::GetValueObjectFromCNTKImplMatrixAndMBLayout<double>(var, computationNode, matrix, layout);
             break;
@@ -1577,7 +1747,7 @@ namespace CNTK
 
         if (varValue == nullptr)
             varValue = nodeValue;
-        else
+        else if (nodeValue != nullptr)
             varValue->CopyFrom(*nodeValue);
     }
 
@@ -11,6 +11,7 @@
 #include "ComputationNetwork.h"
 #include "BackCompat.h"
 #include "Value.h"
+#include <mutex>
 
 namespace CNTK
 {
@@ -34,6 +35,19 @@ namespace CNTK
     class CompositeFunction;
     typedef std::shared_ptr<CompositeFunction> CompositeFunctionPtr;
 
+    // A compiled inference network that is never evaluated itself, from which equivalent CompositeFunctions create
+    // their networks with ComputationNetwork::CloneWithSharedParameters(). The i-th Variable of a CompositeFunction
+    // in VariablesInStructuralOrder() corresponds to the node m_nodeNames[i] (empty if it has no node).
+    // Immutable once m_network is set.
+    struct SharedNetworkTemplate
+    {
+        std::mutex m_mutex;
+        Microsoft::MSR::CNTK::ComputationNetworkPtr m_network;
+        std::vector<std::pair<VariableKind, NDShape>> m_variableSignatures;
+        std::vector<std::wstring> m_nodeNames;
+        std::vector<size_t> m_outputs;
+    };
+
     ///
     /// Represents a symbolic computation with zero or more input arguments and one or more outputs.
     /// Opposed to primitive functions, a composite function is composed of other Function instances whose inputs and outputs are wired together.
@@ -55,6 +69,8 @@ namespace CNTK
 
         friend void ComputeInputPerDimMeansAndInvStdDevs(const MinibatchSourcePtr& minibatchSource,
                                                          std::unordered_map<StreamInformation, std::pair<NDArrayViewPtr, NDArrayViewPtr>>& computedMeanAndInvStdDevs,
+                                                         size_t maxNumSamples,
+                                                         const DistributedCommunicatorPtr& communicator,
                                                          const DeviceDescriptor& device /*= DeviceDescriptor::CPUDevice()*/);
 
         static std::atomic<unsigned int> s_nextAutoGeneratedDynamicAxis;
@@ -264,6 +280,15 @@ namespace CNTK
 
         std::unordered_map<Variable, NDShape> InferFreeDimensionsOfArguments(const std::unordered_map<Variable, ValuePtr>& arguments);
 
+        // The network template shared by 'this' Function and all Functions cloned from it with shared parameters (see below)
+        std::shared_ptr<SharedNetworkTemplate> GetSharedNetworkTemplate() const;
+
+        // All Variables of the graph, including those inside of Block Functions, in an order that only depends on the structure of the graph.
+        std::vector<Variable> VariablesInStructuralOrder() const;
+
+        bool CreateComputationNetworkFromSharedTemplate(const DeviceDescriptor& device, const std::unordered_set<Variable>& outputs);
+        void RegisterSharedNetworkTemplate(const std::unordered_set<Variable>& outputs);
+
         template <typename ElementType>
         Microsoft::MSR::CNTK::ComputationNetworkPtr GetComputationNetwork(const DeviceDescriptor& device,
                                                                           const std::unordered_set<Variable>& backpropRoots,
@@ -364,6 +389,11 @@ namespace CNTK
 
         std::unordered_set<Variable> m_inputsExcludedFromGradientComputation;
 
+        // Clones with shared parameters (ParameterCloningMethod::Share), e.g. one per thread for concurrent evaluation,
+        // derive their inference network from the first one compiled by any of them instead of each building and compiling
+        // one from the Function graph; only the activations are allocated per clone. See GetComputationNetwork.
+        mutable std::shared_ptr<SharedNetworkTemplate> m_sharedNetworkTemplate;
+
         // Version history:
         // 1 -- initial version.
         // 2 -- add support for stateful functions (with corresponding nodes inheriting from RngUser).
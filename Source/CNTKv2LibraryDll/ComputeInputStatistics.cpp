@@ -8,19 +8,187 @@
 #include "Utils.h"
 #include "CompositeFunction.h"
 #include <tuple>
+#include <algorithm>
+#include <functional>
 #include "ComputationNetworkBuilder.h"
 
 using namespace Microsoft::MSR::CNTK;
 
 namespace CNTK
 {
+    // The parallel formula of Chan et al. merges the means and variances of partitions of the data into those of the whole data:
+    //   mean = sum_k n_k mean_k / n,   var = sum_k n_k (var_k + (mean_k - mean)^2) / n
+    // Each sum over the partitions is taken in double precision, of the terms that every partition computes below.
+    // The variance is recovered from the inverse standard deviation; a partition without samples contributes nothing.
+
+    // The terms of the first sum: n_k mean_k for every dimension, followed by n_k.
+    static std::vector<double> MeanSumTerms(const NDArrayView& mean, size_t numSamples)
+    {
+        size_t dim = mean.Shape().TotalSize();
+        double n = (double)numSamples;
+        const float* meanBuffer = mean.DataBuffer<float>();
+        std::vector<double> terms(dim + 1);
+        for (size_t j = 0; j < dim; j++)
+            terms[j] = (n > 0) ? n * meanBuffer[j] : 0;
+        terms[dim] = n;
+        return terms;
+    }
+
+    // The terms of the second sum: n_k (var_k + (mean_k - mean)^2), given the first sum over all partitions.
+    static std::vector<double> SquareSumTerms(const NDArrayView& mean, const NDArrayView& invStdDev, size_t numSamples, const std::vector<double>& meanSums)
+    {
+        size_t dim = mean.Shape().TotalSize();
+        double n = (double)numSamples;
+        double totalNumSamples = meanSums[dim];
+        const float* meanBuffer = mean.DataBuffer<float>();
+        const float* invStdDevBuffer = invStdDev.DataBuffer<float>();
+        std::vector<double> terms(dim);
+        for (size_t j = 0; j < dim; j++)
+        {
+            double variance = 1.0 / ((double)invStdDevBuffer[j] * invStdDevBuffer[j]);
+            double delta = meanBuffer[j] - meanSums[j] / totalNumSamples;
+            terms[j] = (n > 0) ? n * (variance + delta * delta) : 0;
+        }
+        return terms;
+    }
+
+    // The mean and inverse standard deviation of the whole data, from both sums.
+    static void MergedMeanAndInvStdDev(const std::vector<double>& meanSums, const std::vector<double>& squareSums, NDArrayView& mean, NDArrayView& invStdDev)
+    {
+        size_t dim = mean.Shape().TotalSize();
+        double totalNumSamples = meanSums[dim];
+        float* meanBuffer = mean.WritableDataBuffer<float>();
+        float* invStdDevBuffer = invStdDev.WritableDataBuffer<float>();
+        for (size_t j = 0; j < dim; j++)
+        {
+            meanBuffer[j] = (float)(meanSums[j] / totalNumSamples);
+            invStdDevBuffer[j] = (float)(1.0 / sqrt(std::max(squareSums[j] / totalNumSamples, 1e-10))); // same floor as InvStdDevNode
+        }
+    }
+
+    static NDArrayViewPtr ToNDArrayView(const std::vector<double>& values)
+    {
+        auto view = MakeSharedObject<NDArrayView>(DataType::Double, NDShape({ values.size() }), DeviceDescriptor::CPUDevice());
+        std::copy(values.begin(), values.end(), view->WritableDataBuffer<double>());
+        return view;
+    }
+
+    static std::vector<double> ToVector(const NDArrayViewPtr& view)
+    {
+        const double* buffer = view->DataBuffer<double>();
+        return std::vector<double>(buffer, buffer + view->Shape().TotalSize());
+    }
+
+    // Merges the means and inverse standard deviations computed by every worker on its partition of the data into those of
+    // the whole data. Each sum of the parallel formula is one aggregation over all workers.
+    static void AggregateMeansAndInvStdDevs(const DistributedCommunicatorPtr& communicator,
+                                            std::unordered_map<StreamInformation, std::pair<NDArrayViewPtr, NDArrayViewPtr>>& computedMeanAndInvStdDevs,
+                                            std::unordered_map<StreamInformation, size_t>& numSamples)
+    {
+        // the same order of the streams on all workers
+        std::vector<StreamInformation> streams;
+        for (auto& currentStreamKV : computedMeanAndInvStdDevs)
+            streams.push_back(currentStreamKV.first);
+        std::sort(streams.begin(), streams.end(), [](const StreamInformation& a, const StreamInformation& b) { return a.m_id < b.m_id; });
+
+        const auto cpuDevice = DeviceDescriptor::CPUDevice();
+        std::vector<NDArrayViewPtr> means, invStdDevs, sums;
+        for (const auto& stream : streams)
+        {
+            const auto& meanAndInvStdDev = computedMeanAndInvStdDevs[stream];
+            auto mean = MakeSharedObject<NDArrayView>(DataType::Float, meanAndInvStdDev.first->Shape(), cpuDevice);
+            auto invStdDev = MakeSharedObject<NDArrayView>(DataType::Float, meanAndInvStdDev.second->Shape(), cpuDevice);
+            mean->CopyFrom(*meanAndInvStdDev.first);
+            invStdDev->CopyFrom(*meanAndInvStdDev.second);
+
+            means.push_back(mean);
+            invStdDevs.push_back(invStdDev);
+            sums.push_back(ToNDArrayView(MeanSumTerms(*mean, numSamples[stream])));
+        }
+
+        communicator->AggregateInPlace(sums, communicator->Workers());
+
+        std::vector<NDArrayViewPtr> squareSums;
+        for (size_t i = 0; i < streams.size(); i++)
+        {
+            if (ToVector(sums[i]).back() == 0)
+                RuntimeError("ComputeInputPerDimMeansAndInvStdDevs: No worker has read data for stream '%S'.", streams[i].AsString().c_str());
+
+            squareSums.push_back(ToNDArrayView(SquareSumTerms(*means[i], *invStdDevs[i], numSamples[streams[i]], ToVector(sums[i]))));
+        }
+
+        communicator->AggregateInPlace(squareSums, communicator->Workers());
+
+        for (size_t i = 0; i < streams.size(); i++)
+        {
+            MergedMeanAndInvStdDev(ToVector(sums[i]), ToVector(squareSums[i]), *means[i], *invStdDevs[i]);
+
+            auto& meanAndInvStdDev = computedMeanAndInvStdDevs[streams[i]];
+            meanAndInvStdDev.first->CopyFrom(*means[i]);
+            meanAndInvStdDev.second->CopyFrom(*invStdDevs[i]);
+        }
+    }
+
+    namespace Internal
+    {
+        std::pair<NDArrayViewPtr, NDArrayViewPtr> MergeMeansAndInvStdDevs(const std::vector<std::pair<NDArrayViewPtr, NDArrayViewPtr>>& meansAndInvStdDevs,
+                                                                          const std::vector<size_t>& numSamples)
+        {
+            if (meansAndInvStdDevs.empty() || (meansAndInvStdDevs.size() != numSamples.size()))
+                InvalidArgument("MergeMeansAndInvStdDevs: The number of partitions (%d) does not match the number of sample counts (%d).", (int)meansAndInvStdDevs.size(), (int)numSamples.size());
+
+            const auto cpuDevice = DeviceDescriptor::CPUDevice();
+            std::vector<NDArrayViewPtr> means, invStdDevs;
+            for (const auto& meanAndInvStdDev : meansAndInvStdDevs)
+            {
+                means.push_back(meanAndInvStdDev.first->DeepClone(cpuDevice));
+                invStdDevs.push_back(meanAndInvStdDev.second->DeepClone(cpuDevice));
+            }
+
+            std::vector<double> sums(means[0]->Shape().TotalSize() + 1);
+            for (size_t k = 0; k < means.size(); k++)
+            {
+                auto terms = MeanSumTerms(*means[k], numSamples[k]);
+                std::transform(sums.begin(), sums.end(), terms.begin(), sums.begin(), std::plus<double>());
+            }
+
+            if (sums.back() == 0)
+                InvalidArgument("MergeMeansAndInvStdDevs: No partition has samples.");
+
+            std::vector<double> squareSums(means[0]->Shape().TotalSize());
+            for (size_t k = 0; k < means.size(); k++)
+            {
+                auto terms = SquareSumTerms(*means[k], *invStdDevs[k], numSamples[k], sums);
+                std::transform(squareSums.begin(), squareSums.end(), terms.begin(), squareSums.begin(), std::plus<double>());
+            }
+
+            MergedMeanAndInvStdDev(sums, squareSums, *means[0], *invStdDevs[0]);
+            return std::make_pair(means[0], invStdDevs[0]);
+        }
+    }
+
     void ComputeInputPerDimMeansAndInvStdDevs(const MinibatchSourcePtr& minibatchSource,
                                               std::unordered_map<StreamInformation, std::pair<NDArrayViewPtr, NDArrayViewPtr>>& computedMeanAndInvStdDevs,
                                               const DeviceDescriptor& device /*= DeviceDescriptor::CPUDevice()*/)
+    {
+        ComputeInputPerDimMeansAndInvStdDevs(minibatchSource, computedMeanAndInvStdDevs, MinibatchSource::InfinitelyRepeat, nullptr, device);
+    }
+
+    void ComputeInputPerDimMeansAndInvStdDevs(const MinibatchSourcePtr& minibatchSource,
+                                              std::unordered_map<StreamInformation, std::pair<NDArrayViewPtr, NDArrayViewPtr>>& computedMeanAndInvStdDevs,
+                                              size_t maxNumSamples,
+                                              const DistributedCommunicatorPtr& communicator /*= nullptr*/,
+                                              const DeviceDescriptor& device /*= DeviceDescriptor::CPUDevice()*/)
     {
         typedef std::shared_ptr<ComputationNode<float>> ComputationNodePtr;
         const auto& minibatchSourceStreams = minibatchSource->StreamInfos();
 
+        size_t numberOfWorkers = (communicator != nullptr) ? communicator->Workers().size() : 1;
+        size_t workerRank = (communicator != nullptr) ? communicator->CurrentWorker().m_globalRank : 0;
+        bool distributed = (numberOfWorkers > 1);
+        if (maxNumSamples != MinibatchSource::InfinitelyRepeat)
+            maxNumSamples = (maxNumSamples + numberOfWorkers - 1) / numberOfWorkers;
+
         auto computationNetwork = std::make_shared<ComputationNetwork>(AsCNTKImplDeviceId(device));
         ComputationNetworkBuilder<float> builder(*computationNetwork);
 
@@ -78,16 +246,24 @@ namespace CNTK
             dynamic_pointer_cast<IPreComputeNode>(preComputeNode)->MarkComputed(false /*begin accumulating*/);
 
         std::unordered_map<MBLayoutPtr, Variable> layoutsPopulated;
+        std::unordered_map<StreamInformation, size_t> numSamples;
+        size_t maxNumSamplesRead = 0;
         const size_t maxMinibatchDataSize = (1 << 27); // 128 MB
         const size_t minibatchSize = maxMinibatchDataSize / totalSizePerSample;
-        for (;;)
+        while (maxNumSamplesRead < maxNumSamples)
         {
-            auto minibatchData = minibatchSource->GetNextMinibatch(minibatchSize, device);
+            auto minibatchData = minibatchSource->GetNextMinibatch(/*minibatchSizeInSequences =*/ 0, std::min(minibatchSize, maxNumSamples - maxNumSamplesRead),
+                                                                   numberOfWorkers, workerRank, device);
             if (minibatchData.empty())
                 break;
 
             for (auto& currentStreamKV : computedMeanAndInvStdDevs)
-                CompositeFunction::PopulateComputationNodeValue<float>({ streamToDummyInputVariableMap[currentStreamKV.first], minibatchData[currentStreamKV.first].data }, streamToInputNodeMap[currentStreamKV.first], layoutsPopulated);
+            {
+                const auto& streamData = minibatchData[currentStreamKV.first];
+                CompositeFunction::PopulateComputationNodeValue<float>({ streamToDummyInputVariableMap[currentStreamKV.first], streamData.data }, streamToInputNodeMap[currentStreamKV.first], layoutsPopulated);
+                numSamples[currentStreamKV.first] += streamData.numberOfSamples;
+                maxNumSamplesRead = std::max(maxNumSamplesRead, numSamples[currentStreamKV.first]);
+            }
 
             ComputationNetwork::BumpEvalTimeStamp(allInputNodes);
 
@@ -95,8 +271,15 @@ namespace CNTK
         }
 
         // finalize
-        for (auto & preComputeNode : preComputeNodes)
-            dynamic_pointer_cast<IPreComputeNode>(preComputeNode)->MarkComputed(true /*done accumulating*/);
+        // The partition of a worker may hold no data for a stream; its statistics are left out of the aggregation then.
+        for (auto& currentStreamKV : computedMeanAndInvStdDevs)
+        {
+            if (distributed && (numSamples[currentStreamKV.first] == 0))
+                continue;
+
+            dynamic_pointer_cast<IPreComputeNode>(streamToMeanNodeMap[currentStreamKV.first])->MarkComputed(true /*done accumulating*/);
+            dynamic_pointer_cast<IPreComputeNode>(streamToInvStdDevNodeMap[currentStreamKV.first])->MarkComputed(true /*done accumulating*/);
+        }
 
         // Copy out the results
         for (auto& currentStreamKV : computedMeanAndInvStdDevs)
@@ -117,5 +300,8 @@ namespace CNTK
             if (computedMeanAndInvStdDevs[currentStreamKV.first].second == nullptr)
                 computedMeanAndInvStdDevs[currentStreamKV.first].second = invStdDev->Data();
         }
+
+        if (distributed)
+            AggregateMeansAndInvStdDevs(communicator, computedMeanAndInvStdDevs, numSamples);
     }
 }
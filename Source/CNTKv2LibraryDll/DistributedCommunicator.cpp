@@ -12,6 +12,7 @@
 #include "CUDAPageLockedMemAllocator.h"
 #include "MatrixQuantizerImpl.h"
 #include "GPUDataTransferer.h"
+#include "PerformanceProfiler.h"
 #include <numeric>
 #include "Utils.h"
 
@@ -84,6 +85,7 @@ namespace CNTK
                 m_workers.insert({ i,  L"" });
         }
         m_packThresholdSizeInBytes = packThresholdSizeInBytes;
+        m_ringAllReduce.reset(new RingAllReduce(m_mpi));
     }
 
     void MPICommunicatorImpl::Initialize(const std::vector<NDArrayViewPtr>& values)
@@ -363,6 +365,7 @@ namespace CNTK
         CopyDataFromGPUToCPU(valuesToAggregate);
 
         std::vector<MPI_Request> allReduceRequests;
+        std::vector<std::pair<long long, size_t>> allReduceProfilerStates; // profiler state and size in bytes of every request
         for (auto i = 0; i < numValues; ++i)
         {
             auto inputValue = valuesToAggregate[i];
@@ -385,18 +388,25 @@ namespace CNTK
             void* inputData = (ShouldCopyDataToCPU(inputValue)) ? m_intermediateCPUBuffers[i].data.get() : GetDataBuffer(inputValue);
             void* outputData = (ShouldCopyDataToCPU(inputValue)) ? m_intermediateCPUBuffers[i].data.get() : GetDataBuffer(outputValue);
 
+            auto profAllReduce = ProfilerTimeBegin();
+            bool reduced = false;
             if (dataType == DataType::Float)
             {
-                AllReduceGradients(static_cast<float*>(inputData), static_cast<float*>(outputData), numElements,
+                reduced = AllReduceGradients(static_cast<float*>(inputData), static_cast<float*>(outputData), numElements,
                     allReduceRequests, (inputValue->Device() == DeviceDescriptor::CPUDevice()));
             }
             else if (dataType == DataType::Double)
             {
-                AllReduceGradients(static_cast<double*>(inputData), static_cast<double*>(outputData), numElements,
+                reduced = AllReduceGradients(static_cast<double*>(inputData), static_cast<double*>(outputData), numElements,
                     allReduceRequests, (inputValue->Device() == DeviceDescriptor::CPUDevice()));
             }
             else
                 LogicError("MPICommunicator: Unknown DataType.");
+            allReduceProfilerStates.resize(allReduceRequests.size(), std::make_pair(profAllReduce, GetBufferSize(outputValue)));
+
+            // The wait loop below never sees a request for this value, so start the transfer back to the GPU right away
+            if (reduced && ShouldCopyDataToCPU(inputValue))
+                m_gpuDataTransferers[i]->CopyCPUToGPUAsync(m_intermediateCPUBuffers[i].data.get(), GetBufferSize(outputValue), GetDataBuffer(outputValue));
         }
 
         if (m_nccl->IsSupported())
@@ -417,6 +427,7 @@ namespace CNTK
             }
 
             numAllReduceRequestsCompleted++;
+            ProfilerTimeEnd(allReduceProfilerStates[idx].first, "All-Reduce Gradient", (long long)allReduceProfilerStates[idx].second, -1);
 
             assert(idx < valuesToAggregate.size());
             auto value = valuesToAggregate[idx];
@@ -543,13 +554,13 @@ namespace CNTK
     }
 
     template <typename ElemType>
-    void MPICommunicatorImpl::AllReduceGradients(ElemType* inputData, ElemType* outputData, size_t numElements, std::vector<MPI_Request> &allReduceRequests, bool dataOnCPU)
+    bool MPICommunicatorImpl::AllReduceGradients(ElemType* inputData, ElemType* outputData, size_t numElements, std::vector<MPI_Request> &allReduceRequests, bool dataOnCPU)
     {
         if (m_nccl->IsSupported() && !dataOnCPU)
         {
             m_nccl->AllReduce(inputData, outputData, numElements);
 
-            return;
+            return false;
         }
 
         if (m_mpi->UseGpuGdr())
@@ -559,13 +570,23 @@ namespace CNTK
             else
                 m_mpi->AllReduce(inputData, outputData, numElements);
 
-            return;
+            return false;
         }
 
+        // Keep one request per value, the wait loop maps request indices to values
         allReduceRequests.push_back(MPI_Request());
+        if (RingAllReduce::IsPreferred(numElements * sizeof(ElemType)))
+        {
+            allReduceRequests.back() = MPI_REQUEST_NULL;
+            m_ringAllReduce->AllReduce(inputData, outputData, numElements, GetTraceLevel() >= TraceLevel::Info);
+            return true;
+        }
+
         if (inputData == outputData)
             m_mpi->AllReduceAsync(outputData, numElements, &allReduceRequests.back());
         else
             m_mpi->AllReduceAsync(inputData, outputData, numElements, &allReduceRequests.back());
+
+        return false;
     }
 }
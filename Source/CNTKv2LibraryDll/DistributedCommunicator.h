@@ -9,6 +9,7 @@
 #include "Constants.h"
 #include "NcclComm.h"
 #include "MPIWrapper.h"
+#include "RingAllReduce.h"
 #include <MatrixQuantizerImpl.h>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
@@ -93,6 +94,9 @@ namespace CNTK
         // NcclComm
         std::unique_ptr<Microsoft::MSR::CNTK::NcclComm> m_nccl;
 
+        // Used instead of MPI_Iallreduce for large values, see Globals::RingAllReduceThresholdInBytes()
+        std::unique_ptr<Microsoft::MSR::CNTK::RingAllReduce> m_ringAllReduce;
+
     protected:
         DeviceDescriptor GetNonCPUDevice(const std::vector<NDArrayViewPtr>& values)
         {
@@ -136,7 +140,8 @@ namespace CNTK
         template <typename ElemType>
         void UnpackFromContinuousBuffer(Microsoft::MSR::CNTK::Matrix<ElemType>* aggregationBuffer, const std::vector<NDArrayViewPtr>& outputValues, std::vector<size_t>& packedGradientsIndex);
 
+        // Returns true if the values have been reduced by the time it returns (ring all-reduce); otherwise the reduction is pending on a request or NCCL.
         template <typename ElemType>
-        void AllReduceGradients(ElemType* inputData, ElemType* outputData, size_t numElements, std::vector<MPI_Request> &allReduceRequests, bool dataOnCPU);
+        bool AllReduceGradients(ElemType* inputData, ElemType* outputData, size_t numElements, std::vector<MPI_Request> &allReduceRequests, bool dataOnCPU);
     };
 }
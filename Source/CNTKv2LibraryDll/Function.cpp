@@ -9,6 +9,7 @@
 #include "CompositeFunction.h"
 #include "BlockFunction.h"
 #include "Utils.h"
+#include "Serialization.h"
 #include "UserFunctionFactory.h"
 
 using namespace Microsoft::MSR::CNTK;
@@ -430,18 +431,30 @@ namespace CNTK
         Forward(arguments, outputs, computeDevice, {});
     }
 
-    void Function::Save(const std::wstring& filepath)
+    void Function::Save(const std::wstring& filepath, ModelFormat format /*= ModelFormat::CNTKv2*/)
     {
         Dictionary model = Serialize();
         auto stream = GetFstream(filepath, false);
-        *stream << model;
+        if ((format == ModelFormat::CNTKv2Streaming) || (format == ModelFormat::CNTKv2StreamingFloat16))
+            SaveInStreamingFormat(model, *stream, /*float16Payloads =*/ (format == ModelFormat::CNTKv2StreamingFloat16));
+        else
+            *stream << model;
         stream->flush();
     }
 
     /*static*/ FunctionPtr Function::Load(const std::wstring& filepath, const DeviceDescriptor& computeDevice, const Internal::UDFDeserializerPtr& deserializer)
     {
         auto stream = GetFstream(filepath, true);
-        if (!Internal::IsLegacyModel(*stream))
+        if (IsStreamingFormat(*stream))
+        {
+            stream.reset();
+            // The parameter values of the loaded Dictionary are views of the mapped file;
+            // Deserialize copies them to the compute device.
+            MemoryMappedFile file(filepath);
+            ShardReader shards(filepath);
+            return Function::Deserialize(LoadFromStreamingFormat(file.Data(), file.Size(), /*copyPayloads =*/ false, &shards), computeDevice, deserializer);
+        }
+        else if (!Internal::IsLegacyModel(*stream))
         {
             Dictionary model;
             *stream >> model;
@@ -467,7 +480,9 @@ namespace CNTK
             }
         };
 
-        if (Internal::IsLegacyModel(buffer, length))
+        if (IsStreamingFormat(buffer, length))
+            return Function::Deserialize(LoadFromStreamingFormat(buffer, length, /*copyPayloads =*/ false), computeDevice, deserializer);
+        else if (Internal::IsLegacyModel(buffer, length))
             InvalidArgument("Loading a legacy model from byte array is not supported.");
         else
         {
@@ -480,6 +495,12 @@ namespace CNTK
 
     /*static*/ FunctionPtr Function::Load(std::istream& inputStream, const DeviceDescriptor& computeDevice, const Internal::UDFDeserializerPtr& deserializer)
     {
+        if (IsStreamingFormat(inputStream))
+        {
+            std::vector<char> buffer((std::istreambuf_iterator<char>(inputStream)), std::istreambuf_iterator<char>());
+            return Function::Deserialize(LoadFromStreamingFormat(buffer.data(), buffer.size(), /*copyPayloads =*/ false), computeDevice, deserializer);
+        }
+
         Dictionary model;
         inputStream >> model;
         return Function::Deserialize(model, computeDevice, deserializer);
@@ -488,7 +509,15 @@ namespace CNTK
     void Function::Restore(const std::wstring& filepath)
     {
         auto stream = GetFstream(filepath, true);
-        if (!Internal::IsLegacyModel(*stream))
+        if (IsStreamingFormat(*stream))
+        {
+            stream.reset();
+            MemoryMappedFile file(filepath);
+            ShardReader shards(filepath);
+            RestoreFromCheckpoint(LoadFromStreamingFormat(file.Data(), file.Size(), /*copyPayloads =*/ false, &shards));
+            return;
+        }
+        else if (!Internal::IsLegacyModel(*stream))
         {
             Dictionary model;
             *stream >> model;
@@ -871,6 +900,12 @@ namespace CNTK
 
         auto clonedComposite = AsComposite(clonedRootFunction, compositeFunction->Name());
         clonedComposite->ReplacePlaceholders(placeholderReplacements);
+
+        // A clone that shares the parameters (and the graph structure) of this Function can share its compiled inference network too
+        auto clonedCompositeFunction = dynamic_cast<CompositeFunction*>(clonedComposite.get());
+        if ((parameterCloneMethod == ParameterCloningMethod::Share) && replacements.empty() && (clonedCompositeFunction != nullptr))
+            clonedCompositeFunction->m_sharedNetworkTemplate = compositeFunction->GetSharedNetworkTemplate();
+
         return clonedComposite;
     }
 
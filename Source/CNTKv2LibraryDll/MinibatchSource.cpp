@@ -12,6 +12,7 @@
 #include "ReaderShim.h"
 #include "ReaderConstants.h"
 #include <tuple>
+#include <chrono>
 #include "Value.h"
 #include "MPIWrapper.h"
 #include "PerformanceProfiler.h"
@@ -289,6 +290,156 @@ namespace CNTK
         m_prevMinibatchSize = 0;
     }
 
+    WeightedMinibatchSourcePtr CreateWeightedMinibatchSource(const std::vector<MinibatchSourcePtr>& sources, const std::vector<double>& weights)
+    {
+        return MakeSharedObject<WeightedMinibatchSourceImpl>(sources, weights);
+    }
+
+    /*static*/ const std::wstring WeightedMinibatchSourceImpl::SourcesAttributeName = L"sources";
+    /*static*/ const std::wstring WeightedMinibatchSourceImpl::NumSamplesRequestedAttributeName = L"numSamplesRequested";
+    /*static*/ const std::wstring WeightedMinibatchSourceImpl::ExhaustedAttributeName = L"exhausted";
+
+    WeightedMinibatchSourceImpl::WeightedMinibatchSourceImpl(const std::vector<MinibatchSourcePtr>& sources, const std::vector<double>& weights)
+        : m_sources(sources),
+          m_sourceStreamInfos(sources.size()),
+          m_exhausted(sources.size(), false),
+          m_numSamplesRead(sources.size(), 0),
+          m_secondsReading(sources.size(), 0)
+    {
+        if (sources.empty())
+            InvalidArgument("CreateWeightedMinibatchSource: At least one source must be specified.");
+
+        m_streamInfos = sources[0]->StreamInfos();
+        for (size_t i = 0; i < sources.size(); i++)
+        {
+            const auto& sourceStreamInfos = sources[i]->StreamInfos();
+            if (sourceStreamInfos.size() != m_streamInfos.size())
+                InvalidArgument("CreateWeightedMinibatchSource: Source %d has %d streams, source 0 has %d.", (int)i, (int)sourceStreamInfos.size(), (int)m_streamInfos.size());
+
+            for (const auto& streamInfo : m_streamInfos)
+            {
+                auto match = std::find_if(sourceStreamInfos.begin(), sourceStreamInfos.end(), [&streamInfo](const StreamInformation& s) {
+                    return s.m_name == streamInfo.m_name && s.m_sampleLayout == streamInfo.m_sampleLayout &&
+                           s.m_elementType == streamInfo.m_elementType && s.m_storageFormat == streamInfo.m_storageFormat;
+                });
+                if (match == sourceStreamInfos.end())
+                    InvalidArgument("CreateWeightedMinibatchSource: Source %d has no stream matching '%S' of source 0.", (int)i, streamInfo.AsString().c_str());
+
+                m_sourceStreamInfos[i][streamInfo] = *match;
+            }
+        }
+
+        SetWeights(weights);
+    }
+
+    /*virtual*/ double WeightedMinibatchSourceImpl::ReaderWaitSeconds() const /*override*/
+    {
+        double seconds = 0;
+        for (const auto& source : m_sources)
+            seconds += source->ReaderWaitSeconds();
+        return seconds;
+    }
+
+    /*virtual*/ void WeightedMinibatchSourceImpl::SetWeights(const std::vector<double>& weights) /*override*/
+    {
+        if (weights.size() != m_sources.size())
+            InvalidArgument("WeightedMinibatchSource: %d weights were specified for %d sources.", (int)weights.size(), (int)m_sources.size());
+
+        if (std::any_of(weights.begin(), weights.end(), [](double w) { return !(w >= 0); }) ||
+            std::all_of(weights.begin(), weights.end(), [](double w) { return w == 0; }))
+        {
+            InvalidArgument("WeightedMinibatchSource: The weights must not be negative, and at least one must be positive.");
+        }
+
+        m_weights = weights;
+        m_numSamplesRequested.assign(m_sources.size(), 0);
+    }
+
+    size_t WeightedMinibatchSourceImpl::NextSource() const
+    {
+        size_t next = SIZE_MAX;
+        for (size_t i = 0; i < m_sources.size(); i++)
+        {
+            if (m_exhausted[i] || m_weights[i] == 0)
+                continue;
+
+            if (next == SIZE_MAX || m_numSamplesRequested[i] / m_weights[i] < m_numSamplesRequested[next] / m_weights[next])
+                next = i;
+        }
+        return next;
+    }
+
+    const std::unordered_map<StreamInformation, MinibatchData>&
+    WeightedMinibatchSourceImpl::GetNextMinibatch(size_t minibatchSizeInSequences,
+                                                  size_t minibatchSizeInSamples,
+                                                  size_t numberOfWorkers,
+                                                  size_t workerRank,
+                                                  const DeviceDescriptor& device /*= DeviceDescriptor::UseDefaultDevice()*/) /*override*/
+    {
+        m_minibatchData.clear();
+
+        // An exhausted source drops out, and the next one in line serves the minibatch.
+        for (size_t i = NextSource(); i != SIZE_MAX; i = NextSource())
+        {
+            auto start = std::chrono::steady_clock::now();
+            const auto& sourceMinibatchData = m_sources[i]->GetNextMinibatch(minibatchSizeInSequences, minibatchSizeInSamples, numberOfWorkers, workerRank, device);
+            m_secondsReading[i] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            if (sourceMinibatchData.empty())
+            {
+                m_exhausted[i] = true;
+                continue;
+            }
+
+            m_numSamplesRequested[i] += (minibatchSizeInSamples != 0) ? minibatchSizeInSamples : minibatchSizeInSequences;
+
+            size_t numSamples = 0;
+            for (const auto& streamInfo : m_streamInfos)
+            {
+                const auto& data = sourceMinibatchData.at(m_sourceStreamInfos[i].at(streamInfo));
+                m_minibatchData[streamInfo] = data;
+                numSamples = std::max(numSamples, data.numberOfSamples);
+            }
+            m_numSamplesRead[i] += numSamples;
+            break;
+        }
+
+        return m_minibatchData;
+    }
+
+    /*virtual*/ Dictionary WeightedMinibatchSourceImpl::GetCheckpointState() const /*override*/
+    {
+        std::vector<DictionaryValue> sources, numSamplesRequested, exhausted;
+        for (size_t i = 0; i < m_sources.size(); i++)
+        {
+            sources.push_back(m_sources[i]->GetCheckpointState());
+            numSamplesRequested.push_back(m_numSamplesRequested[i]);
+            exhausted.push_back((bool)m_exhausted[i]);
+        }
+
+        Dictionary checkpointState;
+        checkpointState[SourcesAttributeName] = sources;
+        checkpointState[NumSamplesRequestedAttributeName] = numSamplesRequested;
+        checkpointState[ExhaustedAttributeName] = exhausted;
+        return checkpointState;
+    }
+
+    /*virtual*/ void WeightedMinibatchSourceImpl::RestoreFromCheckpoint(const Dictionary& checkpoint) /*override*/
+    {
+        const auto& sources = checkpoint[SourcesAttributeName].Value<std::vector<DictionaryValue>>();
+        const auto& numSamplesRequested = checkpoint[NumSamplesRequestedAttributeName].Value<std::vector<DictionaryValue>>();
+        const auto& exhausted = checkpoint[ExhaustedAttributeName].Value<std::vector<DictionaryValue>>();
+        if (sources.size() != m_sources.size())
+            RuntimeError("WeightedMinibatchSource: The checkpoint is of %d sources, not %d.", (int)sources.size(), (int)m_sources.size());
+
+        for (size_t i = 0; i < m_sources.size(); i++)
+        {
+            m_sources[i]->RestoreFromCheckpoint(sources[i].Value<Dictionary>());
+            m_numSamplesRequested[i] = numSamplesRequested[i].Value<size_t>();
+            m_exhausted[i] = exhausted[i].Value<bool>();
+        }
+    }
+
     /* static */ ImageTransform ReaderCrop(const wchar_t* cropType,
             int cropSize, float sideRatio, float areaRatio,
             float aspectRatio, const wchar_t* jitterType)
@@ -455,6 +606,9 @@ namespace CNTK
             augmentedConfiguration[L"multiThreadedDeserialization"] = configuration.isMultithreaded;
             augmentedConfiguration[L"traceLevel"] = static_cast<size_t>(configuration.traceLevel);
 
+            if (configuration.prefetchDepth != 1)
+                augmentedConfiguration[L"prefetchDepth"] = configuration.prefetchDepth;
+
             // The CNTK reader implementation requires for each deserializer both the module and deserializer type be specified
             // This is redundant and the V2 API users will just specify type from which the module is automatically inferred
             // TODO: This should be done in the same manner for CNTK exe as well.
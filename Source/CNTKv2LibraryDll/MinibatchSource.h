@@ -34,6 +34,8 @@ namespace CNTK
         virtual Dictionary GetCheckpointState() const override;
         virtual void RestoreFromCheckpoint(const Dictionary& checkpoint) override;
 
+        virtual double ReaderWaitSeconds() const override { return m_shim->GetReaderWaitSeconds(); }
+
     private:
         static Microsoft::MSR::CNTK::InputStreamDescription GetInputStreamDescription(const StreamInformation& s, const DeviceDescriptor& device)
         {
@@ -67,4 +69,56 @@ namespace CNTK
         std::shared_ptr<Microsoft::MSR::CNTK::ReaderShim<float>> m_shim;
         Microsoft::MSR::CNTK::StreamMinibatchInputs m_matrices;
     };
+
+    class WeightedMinibatchSourceImpl final : public WeightedMinibatchSource
+    {
+        static const std::wstring SourcesAttributeName;
+        static const std::wstring NumSamplesRequestedAttributeName;
+        static const std::wstring ExhaustedAttributeName;
+
+    public:
+        WeightedMinibatchSourceImpl(const std::vector<MinibatchSourcePtr>& sources, const std::vector<double>& weights);
+
+        virtual const std::unordered_set<StreamInformation>& StreamInfos() override { return m_streamInfos; }
+
+        const std::unordered_map<StreamInformation, MinibatchData>& GetNextMinibatch(
+            size_t minibatchSizeInSequences,
+            size_t minibatchSizeInSamples,
+            size_t numberOfWorkers,
+            size_t workerRank,
+            const DeviceDescriptor& device = DeviceDescriptor::UseDefaultDevice()) override;
+
+        virtual Dictionary GetCheckpointState() const override;
+        virtual void RestoreFromCheckpoint(const Dictionary& checkpoint) override;
+
+        virtual void SetWeights(const std::vector<double>& weights) override;
+        virtual const std::vector<double>& Weights() const override { return m_weights; }
+        virtual const std::vector<size_t>& NumSamplesRead() const override { return m_numSamplesRead; }
+        virtual const std::vector<double>& SecondsReading() const override { return m_secondsReading; }
+
+        // The sum over the sources.
+        virtual double ReaderWaitSeconds() const override;
+
+    private:
+        // The source that is furthest behind its share of the requested samples, or SIZE_MAX if none is left.
+        size_t NextSource() const;
+
+    private:
+        std::vector<MinibatchSourcePtr> m_sources;
+        std::vector<double> m_weights;
+        std::unordered_set<StreamInformation> m_streamInfos;
+
+        // Per source: the StreamInformation of each of our streams in that source
+        std::vector<std::unordered_map<StreamInformation, StreamInformation>> m_sourceStreamInfos;
+
+        // Per source: the requested minibatch sizes summed over the minibatches it has served since the weights were set.
+        // Unlike the samples actually read, this is the same on all workers, so that all of them choose the same source.
+        std::vector<size_t> m_numSamplesRequested;
+        std::vector<bool> m_exhausted;
+
+        std::vector<size_t> m_numSamplesRead;
+        std::vector<double> m_secondsReading;
+
+        std::unordered_map<StreamInformation, MinibatchData> m_minibatchData;
+    };
 }
@@ -6,11 +6,16 @@
 #include "stdafx.h"
 #include "CNTKLibrary.h"
 #include "Utils.h"
+#include "Serialization.h"
 #include <istream>
 #include <ostream>
 #include <string>
 #include <vector>
 #include <limits>
+#include <map>
+#include <numeric>
+#include <algorithm>
+#include "HalfPrecision.h"
 
 #ifdef _MSC_VER
 #include <io.h>
@@ -28,32 +33,177 @@ namespace CNTK
 
     using namespace ::google::protobuf;
 
+    // The streaming model format (ModelFormat::CNTKv2Streaming):
+    //
+    //   header   magic (8 bytes), format version (uint64)
+    //   payloads the raw data of all NDArrayViews, each aligned to s_payloadAlignment bytes
+    //   message  the proto::Dictionary, in which the NDArrayViews refer to their payloads by offset (ExternalValues)
+    //   trailer  offset and size of the message (2 x uint64), magic (8 bytes)
+    //
+    // The payloads are written one after another while the message is built, so the writer never holds a serialized
+    // copy of the model. Only the message, which is small, is parsed on load; the payloads are used in place.
+    // In ModelFormat::CNTKv2StreamingFloat16, the payloads of dense Float NDArrayViews hold half precision values instead
+    // (ExternalValues::Float16); they are converted back to single precision on load.
+    static const char s_streamingFormatMagic[8] = { 'C', 'N', 'T', 'K', 'v', '2', 'S', '\0' };
+    static const uint64 s_streamingFormatVersion = 1;
+    static const uint64 s_streamingFormatHeaderSize = sizeof(s_streamingFormatMagic) + sizeof(uint64);
+    static const uint64 s_streamingFormatTrailerSize = 2 * sizeof(uint64) + sizeof(s_streamingFormatMagic);
+    static const uint64 s_payloadAlignment = 64;
+
+    // A shard file of a sharded checkpoint (see CheckpointSharding) is a file in the streaming format, whose Dictionary maps
+    // the key paths of its NDArrayViews to the NDArrayViews, and s_shardCheckpointKey to the checkpoint it belongs to.
+    static const std::string s_shardCheckpointKey = "checkpoint";
+
+    // NDArrayViews smaller than this stay in the files of the main worker: a reference to a shard is about as large.
+    static const size_t s_minShardedViewSize = 4096;
+
+    // Conversion between single and IEEE half precision, for the payloads of ModelFormat::CNTKv2StreamingFloat16
+    using Microsoft::MSR::CNTK::FloatToHalf;
+    using Microsoft::MSR::CNTK::HalfToFloat;
+
     class Serializer
     {
         friend std::ostream& operator<<(std::ostream&, const Dictionary&);
         friend std::istream& operator>>(std::istream&, Dictionary&);
         friend std::ostream& operator<<(std::ostream&, const DictionaryValue&);
         friend std::istream& operator>>(std::istream&, DictionaryValue&);
+        friend void SaveInStreamingFormat(const Dictionary&, std::ostream&, bool);
+        friend void SaveInStreamingFormat(const Dictionary&, std::ostream&, const std::wstring&, const CheckpointSharding&);
+        friend void SaveShard(const CheckpointSharding&, size_t, std::ostream&);
+        friend Dictionary LoadFromStreamingFormat(const char*, size_t, bool, ShardReader*);
 
         friend class Dictionary;
         friend class DictionaryValue;
 
     private:
-        static proto::DictionaryValue* CreateProto(const DictionaryValue& src, Arena* arena = nullptr);
-        static proto::Dictionary* CreateProto(const Dictionary& src, Arena* arena = nullptr);
-        static proto::Vector* CreateProto(const std::vector<DictionaryValue>& src, Arena* arena = nullptr);
-        static proto::NDArrayView* CreateProto(const NDArrayView& src, Arena* arena = nullptr);
+        // Appends the payloads of the streaming model format to the output stream.
+        // For a sharded checkpoint, it also keeps track of the key path of the value being written.
+        class PayloadWriter
+        {
+        public:
+            PayloadWriter(std::ostream& stream, uint64 position, const CheckpointSharding* sharding = nullptr, const std::wstring& path = L"", bool float16 = false)
+                : m_stream(stream), m_position(position), m_sharding(sharding), m_path(path), m_float16(float16)
+            {}
+
+            // Returns the offset of the payload in the file
+            uint64 Append(const void* data, size_t size)
+            {
+                Align();
+                uint64 offset = m_position;
+                m_stream.write((const char*)data, size);
+                m_position += size;
+                return offset;
+            }
+
+            // Appends the values in half precision, converting a block at a time. Returns the offset of the payload in the file.
+            uint64 AppendFloat16(const float* data, size_t count)
+            {
+                Align();
+                uint64 offset = m_position;
+                const size_t blockSize = 64 * 1024;
+                m_halfBuffer.resize(std::min(count, blockSize));
+                for (size_t i = 0; i < count; i += blockSize)
+                {
+                    size_t n = std::min(count - i, blockSize);
+                    FloatToHalf(data + i, m_halfBuffer.data(), n);
+                    m_stream.write((const char*)m_halfBuffer.data(), n * sizeof(uint16_t));
+                }
+                m_position += count * sizeof(uint16_t);
+                return offset;
+            }
+
+            void Align()
+            {
+                static const char padding[s_payloadAlignment] = {};
+                size_t paddingSize = (size_t)((s_payloadAlignment - m_position % s_payloadAlignment) % s_payloadAlignment);
+                m_stream.write(padding, paddingSize);
+                m_position += paddingSize;
+            }
+
+            uint64 Position() const { return m_position; }
+
+            // Whether dense Float payloads are stored in half precision
+            bool Float16() const { return m_float16; }
+
+            const CheckpointSharding* Sharding() const { return m_sharding; }
+            const std::wstring& Path() const { return m_path; }
+
+            void PushKey(const std::wstring& key)
+            {
+                if (m_sharding == nullptr)
+                    return;
+                m_pathLengths.push_back(m_path.size());
+                m_path += L'/';
+                m_path += key;
+            }
+
+            void PushIndex(size_t index)
+            {
+                if (m_sharding != nullptr)
+                    PushKey(std::to_wstring(index));
+            }
+
+            void Pop()
+            {
+                if (m_sharding == nullptr)
+                    return;
+                m_path.resize(m_pathLengths.back());
+                m_pathLengths.pop_back();
+            }
+
+        private:
+            std::ostream& m_stream;
+            uint64 m_position;
+            const CheckpointSharding* m_sharding;
+            std::wstring m_path;
+            std::vector<size_t> m_pathLengths;
+            bool m_float16;
+            std::vector<uint16_t> m_halfBuffer;
+        };
+
+        // The content of a file in the streaming model format. Unless m_copy is set, the NDArrayViews created
+        // from it refer to this memory rather than own a copy of their data.
+        struct PayloadSection
+        {
+            const char* m_data;
+            size_t m_size;
+            bool m_copy;
+            ShardReader* m_shards;
+        };
+
+        static proto::DictionaryValue* CreateProto(const DictionaryValue& src, Arena* arena = nullptr, PayloadWriter* payloads = nullptr);
+        static proto::Dictionary* CreateProto(const Dictionary& src, Arena* arena = nullptr, PayloadWriter* payloads = nullptr);
+        static proto::Vector* CreateProto(const std::vector<DictionaryValue>& src, Arena* arena = nullptr, PayloadWriter* payloads = nullptr);
+        static proto::NDArrayView* CreateProto(const NDArrayView& src, Arena* arena = nullptr, PayloadWriter* payloads = nullptr);
         static proto::Axis* CreateProto(const Axis& src, Arena* arena = nullptr);
         static proto::NDShape* CreateProto(const NDShape& src, Arena* arena = nullptr);
 
-        static Dictionary* CreateFromProto(const proto::Dictionary& src);
-        static std::vector<DictionaryValue>* CreateFromProto(const proto::Vector& src);
-        static NDArrayView* CreateFromProto(const proto::NDArrayView& src);
+        static Dictionary* CreateFromProto(const proto::Dictionary& src, const PayloadSection* payloads = nullptr);
+        static std::vector<DictionaryValue>* CreateFromProto(const proto::Vector& src, const PayloadSection* payloads = nullptr);
+        static NDArrayView* CreateFromProto(const proto::NDArrayView& src, const PayloadSection* payloads = nullptr);
         static Axis* CreateFromProto(const proto::Axis& src);
         static NDShape* CreateFromProto(const proto::NDShape& src);
 
-        static void Copy(const DictionaryValue& src, proto::DictionaryValue& dst, Arena* arena = nullptr);
-        static void Copy(const proto::DictionaryValue& src, DictionaryValue& dst);
+        static void Copy(const DictionaryValue& src, proto::DictionaryValue& dst, Arena* arena = nullptr, PayloadWriter* payloads = nullptr);
+        static void Copy(const proto::DictionaryValue& src, DictionaryValue& dst, const PayloadSection* payloads = nullptr);
+
+        static proto::Dictionary* CreateShardProto(const CheckpointSharding& sharding, size_t shard, Arena* arena, PayloadWriter* payloads);
+        static NDArrayView* CreateFromShard(const proto::NDArrayView& src, const NDShape& shape, const PayloadSection* payloads);
+        static void OpenShards(const proto::Dictionary& src, ShardReader& shards);
+
+        static void WriteStreamingFormatHeader(std::ostream& stream);
+        static void WriteStreamingFormatMessage(const proto::Dictionary& message, PayloadWriter& payloads, std::ostream& stream);
+
+        static Dictionary LoadFromStreamingFormat(const proto::Dictionary& src, const PayloadSection& payloads)
+        {
+            Dictionary dictionary;
+            dictionary.m_dictionaryData->reserve(src.data_size());
+            for (const auto& kv : src.data())
+            {
+                Copy(kv.second, dictionary[ToWString(kv.first)], &payloads);
+            }
+            return dictionary;
+        }
 
         static proto::NDArrayView::DataType ToProtoType(DataType type)
         {
@@ -178,14 +328,39 @@ namespace CNTK
         }
     }
 
-    /*static*/ proto::NDArrayView* Serializer::CreateProto(const NDArrayView& src, Arena* arena)
+    /*static*/ proto::NDArrayView* Serializer::CreateProto(const NDArrayView& src, Arena* arena, PayloadWriter* payloads)
     {
         proto::NDArrayView* dst = (arena != nullptr) ? 
             Arena::CreateMessage<proto::NDArrayView>(arena) : new proto::NDArrayView();
         dst->set_data_type(ToProtoType(src.GetDataType()));
         dst->set_allocated_shape(CreateProto(src.Shape(), arena));
         dst->set_storage_format(ToProtoType(src.GetStorageFormat()));
-        if (src.GetDataType() == DataType::Float)
+        const CheckpointSharding* sharding = (payloads != nullptr) ? payloads->Sharding() : nullptr;
+        size_t shard = (sharding != nullptr) ? sharding->ShardOf(payloads->Path()) : 0;
+        if (shard != 0)
+        {
+            auto shardedValues = dst->mutable_sharded_values();
+            shardedValues->set_file(ToString(sharding->ShardFileName(shard)));
+            shardedValues->set_key(ToString(payloads->Path()));
+            shardedValues->set_checkpoint(sharding->Checkpoint());
+        }
+        else if (payloads != nullptr && payloads->Float16() && src.GetDataType() == DataType::Float && src.GetStorageFormat() == StorageFormat::Dense)
+        {
+            size_t count = src.Shape().TotalSize();
+            auto externalValues = dst->mutable_external_values();
+            externalValues->set_offset(payloads->AppendFloat16(src.DataBuffer<float>(), count));
+            externalValues->set_size(count * sizeof(uint16_t));
+            externalValues->set_encoding(proto::NDArrayView::ExternalValues::Float16);
+        }
+        else if (payloads != nullptr)
+        {
+            const void* data = (src.GetDataType() == DataType::Float) ? (const void*)src.DataBuffer<float>() : (const void*)src.DataBuffer<double>();
+            size_t size = src.Shape().TotalSize() * DataTypeSize(src.GetDataType());
+            auto externalValues = dst->mutable_external_values();
+            externalValues->set_offset(payloads->Append(data, size));
+            externalValues->set_size(size);
+        }
+        else if (src.GetDataType() == DataType::Float)
         {
             CopyData<float>(src, dst->mutable_float_values()->mutable_value());
         }
@@ -196,7 +371,7 @@ namespace CNTK
         return dst;
     }
 
-    /*static*/ NDArrayView* Serializer::CreateFromProto(const proto::NDArrayView& src)
+    /*static*/ NDArrayView* Serializer::CreateFromProto(const proto::NDArrayView& src, const PayloadSection* payloads)
     {
         if (!proto::NDArrayView::DataType_IsValid(src.data_type()) ||
             !proto::NDArrayView::StorageFormat_IsValid(src.storage_format()))
@@ -207,6 +382,46 @@ namespace CNTK
         std::unique_ptr<NDShape> shape(CreateFromProto(src.shape()));
         auto dataType = FromProtoType(src.data_type());
         auto storageFormat = FromProtoType(src.storage_format());
+
+        if (src.values_case() == proto::NDArrayView::kShardedValues)
+            return CreateFromShard(src, *shape, payloads);
+
+        if (src.values_case() == proto::NDArrayView::kExternalValues)
+        {
+            if (payloads == nullptr)
+                RuntimeError("The NDArrayView data is stored outside of the protobuf message, in a file in the streaming model format; "
+                             "load the file with Function::Load or Dictionary::Load instead.");
+
+            auto offset = src.external_values().offset();
+            auto size = src.external_values().size();
+            bool float16 = (src.external_values().encoding() == proto::NDArrayView::ExternalValues::Float16);
+            if (!float16 && src.external_values().encoding() != proto::NDArrayView::ExternalValues::Raw)
+                RuntimeError("The NDArrayView (shape = '%S') is stored in an unknown encoding.", shape->AsString().c_str());
+
+            size_t elementSize = float16 ? sizeof(uint16_t) : DataTypeSize(dataType);
+            if ((dataType != DataType::Float && dataType != DataType::Double) || (float16 && dataType != DataType::Float) ||
+                (size != shape->TotalSize() * elementSize) || (offset > payloads->m_size) || (size > payloads->m_size - offset))
+            {
+                RuntimeError("The NDArrayView (shape = '%S') refers to data outside of the streaming model file.", shape->AsString().c_str());
+            }
+
+            const char* data = payloads->m_data + offset;
+            if (float16)
+            {
+                NDArrayView* dst = new NDArrayView(dataType, storageFormat, *shape, DeviceDescriptor::CPUDevice());
+                HalfToFloat(data, dst->WritableDataBuffer<float>(), shape->TotalSize());
+                return dst;
+            }
+
+            if (!payloads->m_copy && (size > 0) && ((uintptr_t)data % DataTypeSize(dataType) == 0))
+                return new NDArrayView(dataType, *shape, const_cast<char*>(data), size, DeviceDescriptor::CPUDevice(), /*readOnly =*/ true);
+
+            NDArrayView* dst = new NDArrayView(dataType, storageFormat, *shape, DeviceDescriptor::CPUDevice());
+            void* buffer = (dataType == DataType::Float) ? (void*)dst->WritableDataBuffer<float>() : (void*)dst->WritableDataBuffer<double>();
+            memcpy(buffer, data, size);
+            return dst;
+        }
+
         NDArrayView* dst = new NDArrayView(dataType, storageFormat, *shape, DeviceDescriptor::CPUDevice());
 
         if (dataType == DataType::Float)
@@ -220,60 +435,68 @@ namespace CNTK
         return dst;
     }
 
-    /*static*/ proto::Vector* Serializer::CreateProto(const std::vector<DictionaryValue>& src, Arena* arena)
+    /*static*/ proto::Vector* Serializer::CreateProto(const std::vector<DictionaryValue>& src, Arena* arena, PayloadWriter* payloads)
     {
         proto::Vector* dst = (arena != nullptr) ? 
             Arena::CreateMessage<proto::Vector>(arena) : new proto::Vector();
         dst->mutable_value()->Reserve((int)src.size());
-        for (const auto& value : src)
+        for (size_t i = 0; i < src.size(); ++i)
         {
-            dst->mutable_value()->AddAllocated(CreateProto(value, arena));
+            if (payloads != nullptr)
+                payloads->PushIndex(i);
+            dst->mutable_value()->AddAllocated(CreateProto(src[i], arena, payloads));
+            if (payloads != nullptr)
+                payloads->Pop();
         }
         return dst;
     }
 
-    /*static*/ std::vector<DictionaryValue>* Serializer::CreateFromProto(const proto::Vector& src)
+    /*static*/ std::vector<DictionaryValue>* Serializer::CreateFromProto(const proto::Vector& src, const PayloadSection* payloads)
     {
         std::vector<DictionaryValue>* dst = new std::vector<DictionaryValue>(src.value_size());
         for (auto i = 0; i < src.value_size(); ++i)
         {
-            Copy(src.value()[i], dst->at(i));
+            Copy(src.value()[i], dst->at(i), payloads);
         }
         return dst;
     }
 
-    /*static*/ proto::Dictionary* Serializer::CreateProto(const Dictionary& src, Arena* arena)
+    /*static*/ proto::Dictionary* Serializer::CreateProto(const Dictionary& src, Arena* arena, PayloadWriter* payloads)
     {
         proto::Dictionary* dst = (arena != nullptr) ? 
             Arena::CreateMessage<proto::Dictionary>(arena) : new proto::Dictionary();
         dst->set_version(src.s_version);
         for (const auto& kv : src)
         {
-            Copy(kv.second, dst->mutable_data()->operator[](ToString(kv.first)), arena);
+            if (payloads != nullptr)
+                payloads->PushKey(kv.first);
+            Copy(kv.second, dst->mutable_data()->operator[](ToString(kv.first)), arena, payloads);
+            if (payloads != nullptr)
+                payloads->Pop();
         }
         return dst;
     }
 
-    /*static*/ Dictionary* Serializer::CreateFromProto(const proto::Dictionary& src)
+    /*static*/ Dictionary* Serializer::CreateFromProto(const proto::Dictionary& src, const PayloadSection* payloads)
     {
         Dictionary* dst = new Dictionary();
         for (const auto& kv : src.data())
         {
-            Copy(kv.second, dst->operator[](ToWString(kv.first)));
+            Copy(kv.second, dst->operator[](ToWString(kv.first)), payloads);
         }
         return dst;
     }
 
-    /*static*/ proto::DictionaryValue* Serializer::CreateProto(const DictionaryValue& src, Arena* arena)
+    /*static*/ proto::DictionaryValue* Serializer::CreateProto(const DictionaryValue& src, Arena* arena, PayloadWriter* payloads)
     {
         proto::DictionaryValue* dst = (arena != nullptr) ? 
             Arena::CreateMessage<proto::DictionaryValue>(arena) : new proto::DictionaryValue();
         dst->set_version(src.s_version);
-        Copy(src, *dst, arena);
+        Copy(src, *dst, arena, payloads);
         return dst;
     }
 
-    /*static*/ void Serializer::Copy(const DictionaryValue& src, proto::DictionaryValue& dst, Arena* arena)
+    /*static*/ void Serializer::Copy(const DictionaryValue& src, proto::DictionaryValue& dst, Arena* arena, PayloadWriter* payloads)
     {
         auto valueType = src.ValueType();
         dst.set_value_type(ToProtoType(valueType));
@@ -307,20 +530,20 @@ namespace CNTK
             dst.set_allocated_axis_value(CreateProto(src.Value<Axis>(), arena));
             break;
         case DictionaryValue::Type::Vector:
-            dst.set_allocated_vector_value(CreateProto(src.Value<std::vector<DictionaryValue>>(), arena));
+            dst.set_allocated_vector_value(CreateProto(src.Value<std::vector<DictionaryValue>>(), arena, payloads));
             break;
         case DictionaryValue::Type::Dictionary:
-            dst.set_allocated_dictionary_value(CreateProto(src.Value<Dictionary>(), arena));
+            dst.set_allocated_dictionary_value(CreateProto(src.Value<Dictionary>(), arena, payloads));
             break;
         case DictionaryValue::Type::NDArrayView:
-            dst.set_allocated_nd_array_view_value(CreateProto(src.Value<NDArrayView>(), arena));
+            dst.set_allocated_nd_array_view_value(CreateProto(src.Value<NDArrayView>(), arena, payloads));
             break;
         default:
             NOT_IMPLEMENTED
         }
     }
 
-    /*static*/ void Serializer::Copy(const proto::DictionaryValue& src, DictionaryValue& dst)
+    /*static*/ void Serializer::Copy(const proto::DictionaryValue& src, DictionaryValue& dst, const PayloadSection* payloads)
     {
         auto valueType = src.value_type();
 
@@ -359,17 +582,112 @@ namespace CNTK
             dst.m_data.m_ptr = CreateFromProto(src.axis_value());
             break;
         case proto::DictionaryValue::Vector:
-            dst.m_data.m_ptr = CreateFromProto(src.vector_value());
+            dst.m_data.m_ptr = CreateFromProto(src.vector_value(), payloads);
+            break;
+        case proto::DictionaryValue::Dictionary:
+            dst.m_data.m_ptr = CreateFromProto(src.dictionary_value(), payloads);
+            break;
+        case proto::DictionaryValue::NDArrayView:
+            dst.m_data.m_ptr = CreateFromProto(src.nd_array_view_value(), payloads);
+            break;
+        }
+    }
+
+    struct ShardReader::Shard
+    {
+        explicit Shard(const std::wstring& filePath) : m_file(filePath), m_message(nullptr), m_checkpoint(0) {}
+
+        MemoryMappedFile m_file;
+        Arena m_arena;
+        const proto::Dictionary* m_message;
+        size_t m_checkpoint;
+    };
+
+    /*static*/ proto::Dictionary* Serializer::CreateShardProto(const CheckpointSharding& sharding, size_t shard, Arena* arena, PayloadWriter* payloads)
+    {
+        proto::Dictionary* dst = (arena != nullptr) ?
+            Arena::CreateMessage<proto::Dictionary>(arena) : new proto::Dictionary();
+        dst->set_version(Dictionary::s_version);
+
+        auto& checkpoint = dst->mutable_data()->operator[](s_shardCheckpointKey);
+        checkpoint.set_version(DictionaryValue::s_version);
+        checkpoint.set_value_type(proto::DictionaryValue::SizeT);
+        checkpoint.set_size_t_value(sharding.Checkpoint());
+
+        for (const auto& view : sharding.Views())
+        {
+            if (sharding.ShardOf(view.first) != shard)
+                continue;
+
+            auto& value = dst->mutable_data()->operator[](ToString(view.first));
+            value.set_version(DictionaryValue::s_version);
+            value.set_value_type(proto::DictionaryValue::NDArrayView);
+            value.set_allocated_nd_array_view_value(CreateProto(*view.second, arena, payloads));
+        }
+        return dst;
+    }
+
+    /*static*/ NDArrayView* Serializer::CreateFromShard(const proto::NDArrayView& src, const NDShape& shape, const PayloadSection* payloads)
+    {
+        if (payloads == nullptr || payloads->m_shards == nullptr)
+            RuntimeError("The NDArrayView data is stored in a shard file of a sharded checkpoint; "
+                         "load the checkpoint from its file with Function::Load, Function::Restore or Dictionary::Load instead.");
+
+        const auto& sharded = src.sharded_values();
+        const auto& shard = payloads->m_shards->Open(sharded.file(), sharded.checkpoint());
+        auto value = shard.m_message->data().find(sharded.key());
+        if (value == shard.m_message->data().end() || value->second.value_type() != proto::DictionaryValue::NDArrayView ||
+            value->second.nd_array_view_value().data_type() != src.data_type() ||
+            value->second.nd_array_view_value().values_case() != proto::NDArrayView::kExternalValues)
+        {
+            RuntimeError("The shard file '%s' does not contain the NDArrayView '%s'.", sharded.file().c_str(), sharded.key().c_str());
+        }
+
+        PayloadSection shardPayloads = { shard.m_file.Data(), shard.m_file.Size(), payloads->m_copy, nullptr };
+        std::unique_ptr<NDArrayView> dst(CreateFromProto(value->second.nd_array_view_value(), &shardPayloads));
+        if (!dst || dst->Shape() != shape)
+            RuntimeError("The NDArrayView '%s' in the shard file '%s' does not have the expected shape '%S'.", sharded.key().c_str(), sharded.file().c_str(), shape.AsString().c_str());
+
+        return dst.release();
+    }
+
+    static void CollectShardFiles(const proto::Dictionary& src, std::map<std::string, uint64>& shardFiles);
+
+    static void CollectShardFiles(const proto::DictionaryValue& src, std::map<std::string, uint64>& shardFiles)
+    {
+        switch (src.value_type())
+        {
+        case proto::DictionaryValue::Vector:
+            for (const auto& value : src.vector_value().value())
+                CollectShardFiles(value, shardFiles);
             break;
         case proto::DictionaryValue::Dictionary:
-            dst.m_data.m_ptr = CreateFromProto(src.dictionary_value());
+            CollectShardFiles(src.dictionary_value(), shardFiles);
             break;
         case proto::DictionaryValue::NDArrayView:
-            dst.m_data.m_ptr = CreateFromProto(src.nd_array_view_value());
+            if (src.nd_array_view_value().values_case() == proto::NDArrayView::kShardedValues)
+                shardFiles.emplace(src.nd_array_view_value().sharded_values().file(), src.nd_array_view_value().sharded_values().checkpoint());
+            break;
+        default:
             break;
         }
     }
 
+    static void CollectShardFiles(const proto::Dictionary& src, std::map<std::string, uint64>& shardFiles)
+    {
+        for (const auto& kv : src.data())
+            CollectShardFiles(kv.second, shardFiles);
+    }
+
+    // Opens all shard files that 'src' refers to before any NDArrayView is read from them, so that they are prefetched in parallel.
+    /*static*/ void Serializer::OpenShards(const proto::Dictionary& src, ShardReader& shards)
+    {
+        std::map<std::string, uint64> shardFiles;
+        CollectShardFiles(src, shardFiles);
+        for (const auto& shardFile : shardFiles)
+            shards.Open(shardFile.first, shardFile.second);
+    }
+
     static void SetUTF8Locale()
     {   
 #ifndef _MSC_VER
@@ -471,6 +789,240 @@ namespace CNTK
         return stream;
     }
 
+    static void WriteUInt64(std::ostream& stream, uint64 value)
+    {
+        stream.write((const char*)&value, sizeof(value));
+    }
+
+    static uint64 ReadUInt64(const char* buffer)
+    {
+        uint64 value;
+        memcpy(&value, buffer, sizeof(value));
+        return value;
+    }
+
+    bool IsStreamingFormat(const char* buffer, size_t bufferSize)
+    {
+        return (bufferSize >= sizeof(s_streamingFormatMagic)) && (memcmp(buffer, s_streamingFormatMagic, sizeof(s_streamingFormatMagic)) == 0);
+    }
+
+    bool IsStreamingFormat(std::istream& stream)
+    {
+        char buffer[sizeof(s_streamingFormatMagic)];
+        const auto position = stream.tellg();
+        if (position == std::streampos(-1))
+            return false;
+        stream.read(buffer, sizeof(buffer));
+        const auto numBytesRead = (size_t)stream.gcount();
+        stream.clear();
+        stream.seekg(position);
+        return IsStreamingFormat(buffer, numBytesRead);
+    }
+
+    /*static*/ void Serializer::WriteStreamingFormatHeader(std::ostream& stream)
+    {
+        stream.write(s_streamingFormatMagic, sizeof(s_streamingFormatMagic));
+        WriteUInt64(stream, s_streamingFormatVersion);
+    }
+
+    /*static*/ void Serializer::WriteStreamingFormatMessage(const proto::Dictionary& message, PayloadWriter& payloads, std::ostream& stream)
+    {
+        payloads.Align();
+
+        uint64 messageOffset = payloads.Position();
+        uint64 messageSize = message.ByteSizeLong();
+        if (!message.SerializeToOstream(&stream))
+            RuntimeError("Failed to serialize protobuf %s to the output stream.", message.GetTypeName().c_str());
+
+        WriteUInt64(stream, messageOffset);
+        WriteUInt64(stream, messageSize);
+        stream.write(s_streamingFormatMagic, sizeof(s_streamingFormatMagic));
+        if (!stream)
+            RuntimeError("Failed to write the model to the output stream.");
+    }
+
+    void SaveInStreamingFormat(const Dictionary& dictionary, std::ostream& stream, bool float16Payloads)
+    {
+        UsingUTF8 locale;
+        Serializer::WriteStreamingFormatHeader(stream);
+        Serializer::PayloadWriter payloads(stream, s_streamingFormatHeaderSize, nullptr, L"", float16Payloads);
+        Arena arena;
+        Serializer::WriteStreamingFormatMessage(*Serializer::CreateProto(dictionary, &arena, &payloads), payloads, stream);
+    }
+
+    void SaveInStreamingFormat(const Dictionary& dictionary, std::ostream& stream, const std::wstring& path, const CheckpointSharding& sharding)
+    {
+        UsingUTF8 locale;
+        Serializer::WriteStreamingFormatHeader(stream);
+        Serializer::PayloadWriter payloads(stream, s_streamingFormatHeaderSize, &sharding, path);
+        Arena arena;
+        Serializer::WriteStreamingFormatMessage(*Serializer::CreateProto(dictionary, &arena, &payloads), payloads, stream);
+    }
+
+    void SaveShard(const CheckpointSharding& sharding, size_t shard, std::ostream& stream)
+    {
+        UsingUTF8 locale;
+        Serializer::WriteStreamingFormatHeader(stream);
+        Serializer::PayloadWriter payloads(stream, s_streamingFormatHeaderSize);
+        Arena arena;
+        Serializer::WriteStreamingFormatMessage(*Serializer::CreateShardProto(sharding, shard, &arena, &payloads), payloads, stream);
+    }
+
+    static proto::Dictionary* ParseStreamingFormat(const char* buffer, size_t bufferSize, Arena& arena)
+    {
+        if (!IsStreamingFormat(buffer, bufferSize) || (bufferSize < s_streamingFormatHeaderSize + s_streamingFormatTrailerSize) ||
+            (memcmp(buffer + bufferSize - sizeof(s_streamingFormatMagic), s_streamingFormatMagic, sizeof(s_streamingFormatMagic)) != 0))
+        {
+            RuntimeError("The model is not in the streaming format, or it is truncated.");
+        }
+
+        uint64 version = ReadUInt64(buffer + sizeof(s_streamingFormatMagic));
+        if (version > s_streamingFormatVersion)
+            RuntimeError("The streaming model format version %d is not supported by this version of CNTK (up to version %d).", (int)version, (int)s_streamingFormatVersion);
+
+        const char* trailer = buffer + bufferSize - s_streamingFormatTrailerSize;
+        uint64 messageOffset = ReadUInt64(trailer);
+        uint64 messageSize = ReadUInt64(trailer + sizeof(uint64));
+        uint64 messageEnd = bufferSize - s_streamingFormatTrailerSize;
+        if ((messageOffset < s_streamingFormatHeaderSize) || (messageOffset > messageEnd) || (messageSize != messageEnd - messageOffset) || (messageSize > INT_MAX))
+            RuntimeError("The streaming model file is corrupt.");
+
+        proto::Dictionary* proto = Arena::CreateMessage<proto::Dictionary>(&arena);
+        io::ArrayInputStream rawInput(buffer + messageOffset, (int)messageSize);
+        io::CodedInputStream input(&rawInput);
+        if (!ParseMessage(input, *proto))
+            RuntimeError("Failed to parse protobuf %s from the streaming model file.", proto->GetTypeName().c_str());
+
+        return proto;
+    }
+
+    Dictionary LoadFromStreamingFormat(const char* buffer, size_t bufferSize, bool copyPayloads, ShardReader* shards)
+    {
+        UsingUTF8 locale;
+        Arena arena;
+        proto::Dictionary* proto = ParseStreamingFormat(buffer, bufferSize, arena);
+        if (shards != nullptr)
+            Serializer::OpenShards(*proto, *shards);
+
+        Serializer::PayloadSection payloads = { buffer, bufferSize, copyPayloads, shards };
+        return Serializer::LoadFromStreamingFormat(*proto, payloads);
+    }
+
+    CheckpointSharding::CheckpointSharding(const std::wstring& modelFilePath, size_t numShards, size_t checkpoint)
+        : m_modelFilePath(modelFilePath), m_numShards(std::max<size_t>(numShards, 1)), m_checkpoint(checkpoint)
+    {
+    }
+
+    void CheckpointSharding::Add(const std::wstring& path, const Dictionary& dictionary)
+    {
+        for (const auto& kv : dictionary)
+            Add(path + L'/' + kv.first, kv.second);
+    }
+
+    void CheckpointSharding::Add(const std::wstring& path, const std::vector<DictionaryValue>& values)
+    {
+        for (size_t i = 0; i < values.size(); ++i)
+            Add(path + L'/' + std::to_wstring(i), values[i]);
+    }
+
+    void CheckpointSharding::Add(const std::wstring& path, const DictionaryValue& value)
+    {
+        switch (value.ValueType())
+        {
+        case DictionaryValue::Type::Vector:
+            Add(path, value.Value<std::vector<DictionaryValue>>());
+            break;
+        case DictionaryValue::Type::Dictionary:
+            Add(path, value.Value<Dictionary>());
+            break;
+        case DictionaryValue::Type::NDArrayView:
+            m_views.push_back({ path, &value.Value<NDArrayView>() });
+            break;
+        default:
+            break;
+        }
+    }
+
+    void CheckpointSharding::Partition()
+    {
+        auto sizeOf = [this](size_t i) { return m_views[i].second->Shape().TotalSize() * DataTypeSize(m_views[i].second->GetDataType()); };
+
+        // The order only depends on the NDArrayViews, not on the order in which they were added (the order of a Dictionary is undefined).
+        std::vector<size_t> order(m_views.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+        {
+            return (sizeOf(a) != sizeOf(b)) ? (sizeOf(a) > sizeOf(b)) : (m_views[a].first < m_views[b].first);
+        });
+
+        std::vector<size_t> shardSizes(m_numShards, 0);
+        m_shardOf.clear();
+        for (auto i : order)
+        {
+            auto size = sizeOf(i);
+            size_t shard = (size < s_minShardedViewSize) ? 0 : (size_t)(std::min_element(shardSizes.begin(), shardSizes.end()) - shardSizes.begin());
+            shardSizes[shard] += size;
+            m_shardOf[m_views[i].first] = shard;
+        }
+    }
+
+    size_t CheckpointSharding::ShardOf(const std::wstring& path) const
+    {
+        auto shard = m_shardOf.find(path);
+        return (shard != m_shardOf.end()) ? shard->second : 0;
+    }
+
+    std::wstring CheckpointSharding::ShardFileName(size_t shard) const
+    {
+        auto separator = m_modelFilePath.find_last_of(L"/\\");
+        auto modelFileName = (separator != std::wstring::npos) ? m_modelFilePath.substr(separator + 1) : m_modelFilePath;
+        return modelFileName + L".shard" + std::to_wstring(shard);
+    }
+
+    std::wstring CheckpointSharding::ShardFilePath(size_t shard) const
+    {
+        return m_modelFilePath + L".shard" + std::to_wstring(shard);
+    }
+
+    ShardReader::ShardReader(const std::wstring& referringFilePath)
+    {
+        auto separator = referringFilePath.find_last_of(L"/\\");
+        if (separator != std::wstring::npos)
+            m_directory = referringFilePath.substr(0, separator + 1);
+    }
+
+    ShardReader::~ShardReader()
+    {
+    }
+
+    const ShardReader::Shard& ShardReader::Open(const std::string& fileName, size_t checkpoint)
+    {
+        auto shard = m_shards.find(fileName);
+        if (shard == m_shards.end())
+        {
+            if (fileName.empty() || fileName.find_first_of("/\\") != std::string::npos)
+                RuntimeError("The sharded checkpoint refers to an invalid shard file '%s'.", fileName.c_str());
+
+            std::unique_ptr<Shard> newShard(new Shard(m_directory + ToWString(fileName)));
+            newShard->m_file.Prefetch();
+            newShard->m_message = ParseStreamingFormat(newShard->m_file.Data(), newShard->m_file.Size(), newShard->m_arena);
+
+            auto shardCheckpoint = newShard->m_message->data().find(s_shardCheckpointKey);
+            if (shardCheckpoint == newShard->m_message->data().end() || shardCheckpoint->second.value_type() != proto::DictionaryValue::SizeT)
+                RuntimeError("The file '%s' is not a shard file of a sharded checkpoint.", fileName.c_str());
+            newShard->m_checkpoint = (size_t)shardCheckpoint->second.size_t_value();
+
+            shard = m_shards.emplace(fileName, std::move(newShard)).first;
+        }
+
+        // Every worker writes its shard file on its own, so a failure of one of them can leave a shard file of an earlier checkpoint.
+        if (shard->second->m_checkpoint != checkpoint)
+            RuntimeError("The shard file '%s' belongs to checkpoint %llu, but the file that refers to it to checkpoint %llu; the checkpoint is incomplete.",
+                         fileName.c_str(), (unsigned long long)shard->second->m_checkpoint, (unsigned long long)checkpoint);
+
+        return *shard->second;
+    }
+
     void Dictionary::Save(const std::wstring& filename)
     {
         UsingUTF8 locale;
@@ -487,6 +1039,13 @@ namespace CNTK
 
     /*static*/ Dictionary Dictionary::Load(const std::wstring& filename)
     {
+        if (IsStreamingFormat(*GetFstream(filename, true)))
+        {
+            MemoryMappedFile file(filename);
+            ShardReader shards(filename);
+            return LoadFromStreamingFormat(file.Data(), file.Size(), /*copyPayloads =*/ true, &shards);
+        }
+
         UsingUTF8 locale;
         Arena arena;
         proto::Dictionary* proto = Arena::CreateMessage<proto::Dictionary>(&arena);
@@ -8,6 +8,7 @@
 #include "stdafx.h"
 #include "CNTKLibrary.h"
 #include "Utils.h"
+#include "CheckpointSharding.h"
 
 namespace CNTK
 {
@@ -46,6 +47,19 @@ namespace CNTK
     const std::wstring externalWorkerStateKey = L"external_worker_state";
     const std::wstring userDefinedStateKey = L"user_defined_state";
 
+    // The streaming model format (ModelFormat::CNTKv2Streaming), which stores the NDArrayView data of a Dictionary
+    // as raw, aligned payloads next to the protobuf message instead of inside of it. See Serialization.cpp.
+    bool IsStreamingFormat(const char* buffer, size_t bufferSize);
+    bool IsStreamingFormat(std::istream& stream);
+    // With 'float16Payloads' set, dense Float NDArrayViews are stored in half precision (ModelFormat::CNTKv2StreamingFloat16).
+    void SaveInStreamingFormat(const Dictionary& dictionary, std::ostream& stream, bool float16Payloads = false);
+
+    // Unless 'copyPayloads' is set, the NDArrayViews of the returned Dictionary are read-only views of 'buffer'
+    // (e.g., a MemoryMappedFile), so the Dictionary must not be used after the buffer is released.
+    // NDArrayViews that are stored in the shard files of a sharded checkpoint are read through 'shards'
+    // (and are views of the shard files, which the ShardReader keeps open).
+    Dictionary LoadFromStreamingFormat(const char* buffer, size_t bufferSize, bool copyPayloads, ShardReader* shards = nullptr);
+
     template <typename T> 
     inline std::string GetVersionsString(size_t currentVersion, size_t dictVersion)
     {
@@ -9,7 +9,9 @@
 #include "Learner.h"
 #include "PerformanceProfiler.h"
 #include "CompositeFunction.h"
+#include "DataParallelDistributedLearner.h"
 #include "Serialization.h"
+#include "AsyncCheckpointWriter.h"
 
 namespace
 {
@@ -23,6 +25,18 @@ namespace
     // 1 -- initial version: added a key-value pair for the checkpoint version info, added
     //      distributed state key to save all local state collected from distributed workers.
     static const size_t trainerCheckpointVersion = 1;
+
+    // Sharded checkpoints rely on all workers holding the same parameters and learner state, as in synchronous
+    // data-parallel training. With block momentum or model averaging, they differ between synchronizations.
+    bool AreDataParallel(const std::vector<CNTK::LearnerPtr>& learners)
+    {
+        for (const auto& learner : learners)
+        {
+            if (std::dynamic_pointer_cast<CNTK::DataParallelDistributedLearner>(learner) == nullptr)
+                return false;
+        }
+        return true;
+    }
 }
 
 namespace CNTK
@@ -287,7 +301,9 @@ namespace CNTK
 
         outputs.insert(outputsToFetch.begin(), outputsToFetch.end());
 
+        auto profForward = Microsoft::MSR::CNTK::ProfilerTimeBegin();
         auto backPropSate = m_combinedTrainingFunction->Forward(arguments, outputs, computeDevice, { m_aggregatedLossFunction }, m_modelParametersNotCoveredByLearners);
+        Microsoft::MSR::CNTK::ProfilerTimeEnd(profForward, Microsoft::MSR::CNTK::profilerEvtMainForward);
         m_prevMinibatchAggregateTrainingLossValue = outputs[m_aggregatedLossFunction];
         if (m_aggregatedEvaluationFunction)
             m_prevMinibatchAggregateEvalCriterionValue = outputs[m_aggregatedEvaluationFunction];
@@ -316,7 +332,9 @@ namespace CNTK
             parameterGradients[parameter] = nullptr;
 
         // TODO: Why Backward signature does not take Parameter instead of Variable for gradients?
+        auto profBackward = Microsoft::MSR::CNTK::ProfilerTimeBegin();
         m_combinedTrainingFunction->Backward(backPropSate, { { m_aggregatedLossFunction, m_rootGradientValue } }, parameterGradients);
+        Microsoft::MSR::CNTK::ProfilerTimeEnd(profBackward, Microsoft::MSR::CNTK::profilerEvtMainBackward);
         m_prevMinibatchNumSamples = GetSampleCount(m_trainingSampleCountVar, outputs[m_trainingSampleCountVar]);
     }
 
@@ -327,11 +345,25 @@ namespace CNTK
     }
 
     void Trainer::SaveCheckpoint(const std::wstring& modelFilePath, Dictionary externalState)
+    {
+        SaveCheckpoint(modelFilePath, externalState, /*writeInBackground =*/ false);
+    }
+
+    void Trainer::SaveCheckpoint(const std::wstring& modelFilePath, Dictionary externalState, bool writeInBackground, bool sharded)
     {
         auto learnersState = m_parameterLearners->CreateCheckpoint();
 
         if (!m_distributed)
-            return Save(modelFilePath, learnersState, externalState);
+            return Save(modelFilePath, learnersState, externalState, {}, writeInBackground);
+
+        if (sharded && !AreDataParallel(m_parameterLearners->ParameterLearners()))
+        {
+            static bool warned = false;
+            if (!warned)
+                fprintf(stderr, "WARNING: Sharded checkpointing is only supported with data-parallel distributed learners; the main worker saves the whole checkpoint.\n");
+            warned = true;
+            sharded = false;
+        }
 
         auto compositeFunction = dynamic_cast<CompositeFunction*>(m_combinedTrainingFunction.get());
 
@@ -352,39 +384,112 @@ namespace CNTK
             aggregatedState[std::to_wstring(w.m_globalRank)] = *remoteState[w.m_globalRank];
         }
 
-        if (communicator->CurrentWorker().IsMain())
-            Save(modelFilePath, learnersState, externalState, aggregatedState);
+        // A sharded checkpoint is written by all workers, each of them its part.
+        if (communicator->CurrentWorker().IsMain() || sharded)
+            Save(modelFilePath, learnersState, externalState, aggregatedState, writeInBackground, sharded);
 
         // all workers need to sync up after saving model to avoid read-after-write hazard
         // i.e. one worker is in the middle of write while another tries to read
         communicator->Barrier();
     }
 
-    void Trainer::Save(const std::wstring& modelFilePath, const std::vector<DictionaryValue>& learnerState, const Dictionary& externalState, const Dictionary& distributedState)
+    void Trainer::Save(const std::wstring& modelFilePath, const std::vector<DictionaryValue>& learnerState, const Dictionary& externalState, const Dictionary& distributedState, bool writeInBackground, bool sharded)
     {
-        std::wstring tempModelFile = modelFilePath + L".tmp";
-        Dictionary state;
-        state[versionPropertyName] = trainerCheckpointVersion;
-        state[learnersPropertyName] = learnerState;
-        state[externalStatePropertyName] = externalState;
-        state[distributedStatePropertyName] = distributedState;
-
-        m_combinedTrainingFunction->Save(tempModelFile);
-        std::wstring trainerStateCheckpointFilePath = GetTrainerStateCheckpointFilePath(modelFilePath);
-        std::wstring tempCheckpointFile = trainerStateCheckpointFilePath + L".tmp";
+        // The previous checkpoint must be on disk before the next one is taken.
+        WaitForCheckpoint();
+
+        // The snapshot: serialized dictionaries hold copies of all parameter values and learner state.
+        auto model = std::make_shared<Dictionary>(m_combinedTrainingFunction->Serialize());
+        auto state = std::make_shared<Dictionary>();
+        (*state)[versionPropertyName] = trainerCheckpointVersion;
+        (*state)[learnersPropertyName] = learnerState;
+        (*state)[externalStatePropertyName] = externalState;
+        (*state)[distributedStatePropertyName] = distributedState;
+
+        // Checkpoints are written in the streaming format: the model and the learner state (e.g., the moments of
+        // Adam) can each exceed the 2 GB limit of a protobuf message, and restoring reads the format back faster.
+        std::function<void()> write;
+        if (sharded && m_distributed)
+        {
+            // All workers take the same snapshot and compute the same sharding of it. Shard 0 goes into the model and
+            // trainer state files of the main worker (rank 0), every other worker writes its shard file.
+            // The total number of samples seen, which is the same on all workers, identifies the checkpoint.
+            DistributedCommunicatorPtr communicator = MPICommunicator();
+            auto sharding = std::make_shared<CheckpointSharding>(modelFilePath, communicator->Workers().size(), TotalNumberOfSamplesSeen());
+            sharding->Add(L"model", *model);
+            sharding->Add(L"state/" + learnersPropertyName, (*state)[learnersPropertyName].Value<std::vector<DictionaryValue>>());
+            sharding->Partition();
+
+            size_t shard = communicator->CurrentWorker().m_globalRank;
+            write = [model, state, sharding, shard, modelFilePath]()
+            {
+                if (shard != 0)
+                {
+                    Microsoft::MSR::CNTK::AsyncCheckpointWriter::WriteFileAtomically(sharding->ShardFilePath(shard), [&](const std::wstring& tempShardFile)
+                    {
+                        auto stream = GetFstream(tempShardFile, false);
+                        SaveShard(*sharding, shard, *stream);
+                        stream->flush();
+                    });
+                    return;
+                }
+
+                // the trainer state goes first, so that a model file is never newer than its trainer state
+                Microsoft::MSR::CNTK::AsyncCheckpointWriter::WriteFileAtomically(GetTrainerStateCheckpointFilePath(modelFilePath), [&](const std::wstring& tempCheckpointFile)
+                {
+                    auto stream = GetFstream(tempCheckpointFile, false);
+                    SaveInStreamingFormat(*state, *stream, L"state", *sharding);
+                    stream->flush();
+                });
+                Microsoft::MSR::CNTK::AsyncCheckpointWriter::WriteFileAtomically(modelFilePath, [&](const std::wstring& tempModelFile)
+                {
+                    auto stream = GetFstream(tempModelFile, false);
+                    SaveInStreamingFormat(*model, *stream, L"model", *sharding);
+                    stream->flush();
+                });
+            };
+        }
+        else
+        {
+            write = [model, state, modelFilePath]()
+            {
+                // the trainer state goes first, so that a model file is never newer than its trainer state
+                Microsoft::MSR::CNTK::AsyncCheckpointWriter::WriteFileAtomically(GetTrainerStateCheckpointFilePath(modelFilePath), [&state](const std::wstring& tempCheckpointFile)
+                {
+                    auto stream = GetFstream(tempCheckpointFile, false);
+                    SaveInStreamingFormat(*state, *stream);
+                    stream->flush();
+                });
+                Microsoft::MSR::CNTK::AsyncCheckpointWriter::WriteFileAtomically(modelFilePath, [&model](const std::wstring& tempModelFile)
+                {
+                    auto stream = GetFstream(tempModelFile, false);
+                    SaveInStreamingFormat(*model, *stream);
+                    stream->flush();
+                });
+            };
+        }
 
-        state.Save(tempCheckpointFile);
+        if (!writeInBackground)
+            return write();
 
-        // The return value is ignored here.
-        _wunlink(modelFilePath.c_str());
-        _wunlink(trainerStateCheckpointFilePath.c_str());
+        if (!m_checkpointWriter)
+            m_checkpointWriter = std::make_shared<Microsoft::MSR::CNTK::AsyncCheckpointWriter>();
+        m_checkpointWriter->Start(std::move(write));
+    }
 
-        renameOrDie(tempModelFile, modelFilePath);
-        renameOrDie(tempCheckpointFile, trainerStateCheckpointFilePath);
+    void Trainer::WaitForCheckpoint()
+    {
+        if (m_checkpointWriter)
+            m_checkpointWriter->Wait();
     }
 
     Dictionary Trainer::RestoreFromCheckpoint(const std::wstring& modelFilePath)
     {
+        // The checkpoint may still be being written in the background, by the main worker in distributed training.
+        WaitForCheckpoint();
+        if (m_distributed)
+            MPICommunicator()->Barrier();
+
         // Restore the model's parameters
         m_combinedTrainingFunction->Restore(modelFilePath);
 
@@ -423,6 +528,13 @@ namespace CNTK
 
         Dictionary distributedState = checkpoint[distributedStatePropertyName].Value<Dictionary>();
 
+        // The learner state and the sample position of the minibatch source are the same on all workers, so a checkpoint
+        // can be restored on a different number of workers: then all of them continue from the external state of the main worker.
+        size_t numberOfCheckpointedWorkers = std::max<size_t>(distributedState.Size(), 1);
+        bool sameNumberOfWorkers = (numberOfCheckpointedWorkers == communicator->Workers().size());
+        if (!sameNumberOfWorkers && communicator->CurrentWorker().IsMain())
+            fprintf(stderr, "Restoring a checkpoint of %d workers on %d workers.\n", (int)numberOfCheckpointedWorkers, (int)communicator->Workers().size());
+
         if (communicator->CurrentWorker().IsMain() || !distributedState.Contains(localWorkerId))
         {
             return externalState;
@@ -440,7 +552,7 @@ namespace CNTK
         // the internal worker state both have identical UIDs.
         compositeFunction->SetInternalState(internalState);
         
-        return localState[externalWorkerStateKey].Value<Dictionary>();
+        return sameNumberOfWorkers ? localState[externalWorkerStateKey].Value<Dictionary>() : externalState;
     }
 
     double Trainer::PreviousMinibatchLossAverage() const
@@ -5,10 +5,12 @@
 
 #include "stdafx.h"
 #include <boost/algorithm/string/predicate.hpp>
+#include <csignal>
 
 #include "CNTKLibrary.h"
 #include "fileutil.h"
 #include "PerformanceProfiler.h"
+#include "Utils.h"
 
 namespace CNTK
 {
@@ -22,15 +24,55 @@ namespace CNTK
             find_if(s.begin(), s.end(), [](wchar_t c) { return !isdigit(c); }) == s.end();
     }
 
+    // Set by the handler of the termination signal, polled after every minibatch.
+    static volatile std::sig_atomic_t s_terminationRequested = 0;
+
+    static void OnTerminationSignal(int)
+    {
+        s_terminationRequested = 1;
+    }
+
+    // Handles the termination signal for the lifetime of the object, if enabled.
+    class TerminationSignalScope
+    {
+    public:
+        TerminationSignalScope(bool enabled) : m_enabled(enabled), m_previousHandler(SIG_DFL)
+        {
+            s_terminationRequested = 0;
+            if (!m_enabled)
+                return;
+
+            m_previousHandler = std::signal(SIGTERM, OnTerminationSignal);
+            if (m_previousHandler == SIG_ERR)
+                m_previousHandler = SIG_DFL;
+        }
+
+        ~TerminationSignalScope()
+        {
+            if (m_enabled)
+                std::signal(SIGTERM, m_previousHandler);
+        }
+
+    private:
+        bool m_enabled;
+        void (*m_previousHandler)(int);
+    };
+
     CheckpointConfig::CheckpointConfig(
         const std::wstring& checkPointFileName,
         size_t checkpointFrequencyInSamples,
         bool restoreFromCheckpointIfExists,
-        bool preserveAllCheckpoints) :
+        bool preserveAllCheckpoints,
+        bool checkpointOnTermination,
+        bool asyncCheckpointing,
+        bool shardedCheckpointing) :
         m_preserveAll(preserveAllCheckpoints),
         m_restore(restoreFromCheckpointIfExists),
         m_fileName(checkPointFileName),
-        m_frequency(checkpointFrequencyInSamples)
+        m_frequency(checkpointFrequencyInSamples),
+        m_checkpointOnTermination(checkpointOnTermination),
+        m_async(asyncCheckpointing),
+        m_sharded(shardedCheckpointing)
     {
         if (m_fileName.empty())
         {
@@ -40,6 +82,9 @@ namespace CNTK
             if (preserveAllCheckpoints)
                 InvalidArgument("Checkpoint file name must not be empty if 'preserve all checkpoints' option is specified.");
 
+            if (checkpointOnTermination)
+                InvalidArgument("Checkpoint file name must not be empty if 'checkpoint on termination' option is specified.");
+
             checkpointFrequencyInSamples = 0;
         }
     }
@@ -127,8 +172,9 @@ namespace CNTK
             if (distributed)
             {
                 m_parallelAfterSamples = std::max(m_parallelAfterSamples, distributed->ParallelizationAfter());
-                m_workerRank = distributed->GetCommunicator()->CurrentWorker().m_globalRank;
-                m_numberOfWorkers = distributed->GetCommunicator()->Workers().size();
+                m_communicator = distributed->GetCommunicator();
+                m_workerRank = m_communicator->CurrentWorker().m_globalRank;
+                m_numberOfWorkers = m_communicator->Workers().size();
             }
         }
 
@@ -137,7 +183,7 @@ namespace CNTK
             m_actions.push_back({ m_checkpoint.m_frequency, 0, 0,
                 [this](size_t currentIndex, const DeviceDescriptor&)
                 {
-                    SaveCheckpoint(currentIndex);
+                    SaveCheckpoint(currentIndex, m_checkpoint.m_async);
                     // enable profiler after the first checkpoint
                     // This has effect only if the profiler is globally enabled by StartProfiler()
                     Microsoft::MSR::CNTK::ProfilerEnable(true);
@@ -169,6 +215,8 @@ namespace CNTK
             restoredNumberOfSamples = m_trainer->TotalNumberOfSamplesSeen();
         }
 
+        TerminationSignalScope terminationSignal(m_checkpoint.m_checkpointOnTermination);
+
         // Main train loop.
         bool earlyExit = false;
         while (shouldTrain)
@@ -187,6 +235,15 @@ namespace CNTK
             shouldTrain = Trainer()->TrainMinibatch(minibatch, computeDevice);
             earlyExit |= !OnMinibatchEnd(); // If the callback wants to have early exit - we stop training.
 
+            // Save a checkpoint and stop, so that the job can be restarted quickly, possibly on a different number of workers.
+            if (m_checkpoint.m_checkpointOnTermination && IsTerminationRequested(computeDevice))
+            {
+                size_t totalNumberOfSamples = Trainer()->TotalNumberOfSamplesSeen();
+                fprintf(stderr, "Termination requested, saving a checkpoint after %d samples and stopping the training session.\n", (int)totalNumberOfSamples);
+                SaveCheckpoint(m_checkpoint.m_frequency != 0 ? totalNumberOfSamples / m_checkpoint.m_frequency : 0);
+                return;
+            }
+
             auto profMisc = Microsoft::MSR::CNTK::ScopeProfile(Microsoft::MSR::CNTK::profilerEvtMainPost);
 
             // Peform actions if required.
@@ -216,6 +273,9 @@ namespace CNTK
             }
         }
 
+        // All checkpoints written in the background must be on disk before the session ends.
+        Trainer()->WaitForCheckpoint();
+
         // In case of incremental - save final checkpoint.
         // This is required only when we keep all existing checkpoints, otherwise 
         // The checkpoint was already saved with the proper name.
@@ -234,7 +294,6 @@ namespace CNTK
         if (m_cv.m_source) // Running cross validation
         {
             std::unordered_map<Variable, ValuePtr> minibatch;
-            double accumulatedError = 0;
             size_t totalNumberOfSamples = 0;
             size_t numberOfMinibatches = 0;
 
@@ -245,20 +304,21 @@ namespace CNTK
             {
                 GetCrossValidationMinibatch(minibatch, m_cv.m_mbSize[totalNumberOfSamples], computeDevice);
 
-                // TODO: it may be slow to rely on TestMinibatch to return error each time, since it may require transfer
-                // of error from the GPU each time, accumulatedError can be allocated on GPU
+                // The trainer sums up the error on the compute device, it is only transferred once all minibatches are done
                 shouldCV = m_trainer->TestMinibatch(minibatch, errorAndCount, computeDevice, m_numberOfWorkers != 1);
                 if (shouldCV)
                 {
-                    accumulatedError += errorAndCount.first->AsScalar<double>();
                     totalNumberOfSamples += errorAndCount.second;
                     numberOfMinibatches++;
                 }
             }
 
             m_cv.m_source->RestoreFromCheckpoint(checkpoint);
+
+            // The summary resets the sum of the error.
+            double totalError = (numberOfMinibatches > 0) ? m_trainer->m_aggregatedTestEvalCriterionValue->AsScalar<double>() : 0;
             Trainer()->SummarizeTestProgress();
-            return OnCrossValidationEnd(currentIndex, accumulatedError / totalNumberOfSamples, totalNumberOfSamples, numberOfMinibatches);
+            return OnCrossValidationEnd(currentIndex, totalError / totalNumberOfSamples, totalNumberOfSamples, numberOfMinibatches);
         }
         else // Only invoking the callback.
         {
@@ -333,7 +393,7 @@ namespace CNTK
         m_source->RestoreFromCheckpoint(externalState[s_trainingMinibatchSource].Value<Dictionary>());
     }
 
-    void TrainingSession::SaveCheckpoint(size_t currentIndex)
+    void TrainingSession::SaveCheckpoint(size_t currentIndex, bool writeInBackground)
     {
         OnCheckpointStart(currentIndex);
         Dictionary externalState;
@@ -342,15 +402,27 @@ namespace CNTK
         wstring checkpointFile = m_checkpoint.m_fileName;
         if (m_checkpoint.m_preserveAll)
             checkpointFile += std::to_wstring(currentIndex);
-        Trainer()->SaveCheckpoint(checkpointFile, externalState);
+        Trainer()->SaveCheckpoint(checkpointFile, externalState, writeInBackground, m_checkpoint.m_sharded);
         OnCheckpointEnd(currentIndex);
     }
 
+    // All workers have to stop after the same minibatch, so they agree on whether any of them has been asked to terminate.
+    bool TrainingSession::IsTerminationRequested(const DeviceDescriptor& computeDevice)
+    {
+        if (!m_communicator || m_numberOfWorkers == 1)
+            return s_terminationRequested != 0;
+
+        // The flag lives on the compute device, like the gradients the communicator aggregates.
+        auto terminationRequested = MakeSharedObject<NDArrayView>(s_terminationRequested ? 1.0 : 0.0, NDShape{}, computeDevice);
+        m_communicator->AggregateInPlace({ terminationRequested }, m_communicator->Workers());
+        return terminationRequested->AsScalar<double>() > 0;
+    }
+
     void TrainingSession::SaveFinalCheckpoint()
     {
         Dictionary externalState;
         externalState[s_trainingMinibatchSource] = m_source->GetCheckpointState();
-        Trainer()->SaveCheckpoint(m_checkpoint.m_fileName, externalState);
+        Trainer()->SaveCheckpoint(m_checkpoint.m_fileName, externalState, /*writeInBackground =*/ false, m_checkpoint.m_sharded);
     }
 
     // Restores from a m_checkPointFileName file.
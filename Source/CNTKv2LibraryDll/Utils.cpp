@@ -14,6 +14,13 @@
 #include "Utils.h"
 #include "Serialization.h"
 #include <fcntl.h>
+#ifdef _MSC_VER
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include "PrimitiveFunction.h"
 #include "RecurrentNodes.h"
 #include "Value.h"
@@ -422,6 +429,71 @@ namespace CNTK
         return fd;
     }
 
+    MemoryMappedFile::MemoryMappedFile(const std::wstring& filePath)
+        : m_data(nullptr), m_size(0)
+    {
+#ifdef _MSC_VER
+        m_file = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (m_file == INVALID_HANDLE_VALUE)
+            RuntimeError("Cannot open file '%S' for reading.", filePath.c_str());
+
+        LARGE_INTEGER size;
+        GetFileSizeEx(m_file, &size);
+        m_size = (size_t)size.QuadPart;
+        m_mapping = (m_size > 0) ? CreateFileMapping(m_file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+        if (m_mapping != NULL)
+            m_data = (const char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+        if (m_data == nullptr)
+        {
+            if (m_mapping != NULL)
+                CloseHandle(m_mapping);
+            CloseHandle(m_file);
+            RuntimeError("Cannot memory-map file '%S'.", filePath.c_str());
+        }
+#else
+        m_file = open(ToString(filePath).c_str(), O_RDONLY);
+        if (m_file < 0)
+            RuntimeError("Cannot open file '%S' for reading.", filePath.c_str());
+
+        struct stat fileStat;
+        if (fstat(m_file, &fileStat) == 0)
+            m_size = (size_t)fileStat.st_size;
+        void* data = (m_size > 0) ? mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_file, 0) : MAP_FAILED;
+        if (data == MAP_FAILED)
+        {
+            close(m_file);
+            RuntimeError("Cannot memory-map file '%S'.", filePath.c_str());
+        }
+        m_data = (const char*)data;
+#endif
+    }
+
+    MemoryMappedFile::~MemoryMappedFile()
+    {
+#ifdef _MSC_VER
+        if (m_data != nullptr)
+            UnmapViewOfFile(m_data);
+        if (m_mapping != NULL)
+            CloseHandle(m_mapping);
+        CloseHandle(m_file);
+#else
+        munmap(const_cast<char*>(m_data), m_size);
+        close(m_file);
+#endif
+    }
+
+    void MemoryMappedFile::Prefetch() const
+    {
+#ifdef _MSC_VER
+#if _WIN32_WINNT >= 0x0602 // PrefetchVirtualMemory is available as of Windows 8
+        WIN32_MEMORY_RANGE_ENTRY range = { const_cast<char*>(m_data), m_size };
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+#else
+        madvise(const_cast<char*>(m_data), m_size, MADV_WILLNEED);
+#endif
+    }
+
     std::string ToString(const std::wstring& wstring)
     {
 #ifdef _MSC_VER
@@ -779,67 +851,78 @@ namespace CNTK
         }
     }
 
-    template <typename ElementType>
-    ValuePtr Utils::GetValueObjectFromCNTKImplMatrixAndMBLayout(const NDShape& sampleShape, const std::vector<Axis>& sampleDynamicAxes, const Matrix<ElementType>& matrix, const MBLayoutPtr& layout, bool readOnly /*= true*/)
+    // Creates the mask of the unpacked form of data with the given layout; nullptr if all sequences are complete and of the same length.
+    // The mask is written into 'maskStorage' instead of a new NDMask if it has the right shape.
+    static NDMaskPtr CreateMaskFromMBLayout(const MBLayoutPtr& layout, const NDMaskPtr& maskStorage)
     {
-        auto CreateMask = [](const MBLayoutPtr& layout, const DeviceDescriptor& device) {
-            std::vector<bool> sequenceBeginFlags;
-            std::vector<size_t> sequenceLengths;
-            std::vector<size_t> sequencesShorterThanLongestSequence;
-
-            size_t maxNumTimeSteps = layout->GetNumTimeSteps();
-            size_t numSequences = layout->GetNumSequences();
-            auto& layoutSequences = layout->GetAllSequences();
-
-            size_t sequenceIdx = 0;
-            bool allSequencesStartInThisMB = true;
-            bool allSequencesSameLength = true;
-            for (auto sequenceInfo : layoutSequences)
+        std::vector<bool> sequenceBeginFlags;
+        std::vector<size_t> sequenceLengths;
+        std::vector<size_t> sequencesShorterThanLongestSequence;
+
+        size_t maxNumTimeSteps = layout->GetNumTimeSteps();
+        size_t numSequences = layout->GetNumSequences();
+        auto& layoutSequences = layout->GetAllSequences();
+
+        size_t sequenceIdx = 0;
+        bool allSequencesStartInThisMB = true;
+        bool allSequencesSameLength = true;
+        for (auto sequenceInfo : layoutSequences)
+        {
+            if (sequenceInfo.seqId != GAP_SEQUENCE_ID)
             {
-                if (sequenceInfo.seqId != GAP_SEQUENCE_ID)
-                {
-                    auto currentSequenceBeginIdx = std::max<ptrdiff_t>(0, sequenceInfo.tBegin);
-                    auto currentSequenceEndIdx = std::min(maxNumTimeSteps, sequenceInfo.tEnd);
-                    auto currentSequenceLength = (currentSequenceEndIdx - currentSequenceBeginIdx);
-                    auto isCurrentSequenceBeginningInsideThisMB = sequenceInfo.tBegin >= 0;
+                auto currentSequenceBeginIdx = std::max<ptrdiff_t>(0, sequenceInfo.tBegin);
+                auto currentSequenceEndIdx = std::min(maxNumTimeSteps, sequenceInfo.tEnd);
+                auto currentSequenceLength = (currentSequenceEndIdx - currentSequenceBeginIdx);
+                auto isCurrentSequenceBeginningInsideThisMB = sequenceInfo.tBegin >= 0;
 
-                    allSequencesStartInThisMB = allSequencesStartInThisMB && isCurrentSequenceBeginningInsideThisMB;
-                    allSequencesSameLength = allSequencesSameLength && (currentSequenceLength == maxNumTimeSteps);
+                allSequencesStartInThisMB = allSequencesStartInThisMB && isCurrentSequenceBeginningInsideThisMB;
+                allSequencesSameLength = allSequencesSameLength && (currentSequenceLength == maxNumTimeSteps);
 
-                    sequenceBeginFlags.push_back(isCurrentSequenceBeginningInsideThisMB);
-                    sequenceLengths.push_back(currentSequenceLength);
+                sequenceBeginFlags.push_back(isCurrentSequenceBeginningInsideThisMB);
+                sequenceLengths.push_back(currentSequenceLength);
 
-                    if (currentSequenceLength != maxNumTimeSteps)
-                        sequencesShorterThanLongestSequence.push_back(sequenceIdx);
+                if (currentSequenceLength != maxNumTimeSteps)
+                    sequencesShorterThanLongestSequence.push_back(sequenceIdx);
 
-                    sequenceIdx++;
-                }
+                sequenceIdx++;
             }
+        }
 
-            if (!allSequencesStartInThisMB && (numSequences != layout->GetNumParallelSequences()))
-                LogicError("Cannot create an unpacked Value object from packed data where one or more sequences are truncated");
+        if (!allSequencesStartInThisMB && (numSequences != layout->GetNumParallelSequences()))
+            LogicError("Cannot create an unpacked Value object from packed data where one or more sequences are truncated");
 
-            bool maskNeeded = !allSequencesSameLength || !allSequencesStartInThisMB;
+        bool maskNeeded = !allSequencesSameLength || !allSequencesStartInThisMB;
 
-            NDMaskPtr mask;
-            if (maskNeeded)
+        NDMaskPtr mask;
+        if (maskNeeded)
+        {
+            NDShape maskShape({ maxNumTimeSteps, numSequences });
+            if (maskStorage && (maskStorage->Shape() == maskShape))
             {
-                mask = MakeSharedObject<NDMask>(NDShape({ maxNumTimeSteps, numSequences }), DeviceDescriptor::CPUDevice());
-                for (size_t i = 0; i < numSequences; ++i)
-                    if (sequenceBeginFlags[i])
-                        mask->MarkSequenceBegin({ 0, i });
-
-                for (auto shortSequenceIdx : sequencesShorterThanLongestSequence)
-                    mask->InvalidateSection({ sequenceLengths[shortSequenceIdx], shortSequenceIdx }, { NDShape::InferredDimension, 1 });
+                mask = maskStorage;
+                mask->Clear();
             }
+            else
+                mask = MakeSharedObject<NDMask>(maskShape, DeviceDescriptor::CPUDevice());
+
+            for (size_t i = 0; i < numSequences; ++i)
+                if (sequenceBeginFlags[i])
+                    mask->MarkSequenceBegin({ 0, i });
+
+            for (auto shortSequenceIdx : sequencesShorterThanLongestSequence)
+                mask->InvalidateSection({ sequenceLengths[shortSequenceIdx], shortSequenceIdx }, { NDShape::InferredDimension, 1 });
+        }
 
-            return mask;
-        };
+        return mask;
+    }
 
+    template <typename ElementType>
+    ValuePtr Utils::GetValueObjectFromCNTKImplMatrixAndMBLayout(const NDShape& sampleShape, const std::vector<Axis>& sampleDynamicAxes, const Matrix<ElementType>& matrix, const MBLayoutPtr& layout, bool readOnly /*= true*/)
+    {
         // No data shuffling needed if no layout or the layout has just one time-step or just one sequence
         NDMaskPtr mask;
         if (layout != nullptr)
-            mask = CreateMask(layout, AsDeviceDescriptor(matrix.GetDeviceId()));
+            mask = CreateMaskFromMBLayout(layout, /*maskStorage =*/ nullptr);
 
         // Reshuffle to data to unpack and uninterleave the CNTK form packed data
         auto unpackedTensorView = ComputationNode<ElementType>::Unpack(AsTensorShape(sampleShape), matrix, layout, /*batchMajor=*/ false, /*gapPadValue=*/ nullptr);
@@ -848,6 +931,42 @@ namespace CNTK
         return MakeSharedObject<Value>(data, mask);
     }
 
+    template <typename ElementType>
+    void Utils::CopyCNTKImplMatrixAndMBLayoutToValueObject(const NDShape& sampleShape, const std::vector<Axis>& sampleDynamicAxes, const Matrix<ElementType>& matrix, const MBLayoutPtr& layout, const ValuePtr& value)
+    {
+        auto dataShape = PackedValue::GetUnpackedShape(sampleShape, sampleDynamicAxes, layout);
+        auto data = value->Data();
+        if (data->Shape() != dataShape)
+            data = data->AsShape(dataShape);
+
+        // Unpack scatters straight into the target buffer; if no reshuffling is needed, it returns a view of the packed data instead, which we copy
+        auto targetMatrix = data->GetWritableMatrix<ElementType>(sampleShape.Rank());
+        auto unpackedTensorView = ComputationNode<ElementType>::Unpack(AsTensorShape(sampleShape), matrix, layout, targetMatrix, /*tempIndicesStorage =*/ nullptr, /*tempMaskStorage =*/ nullptr, /*batchMajor=*/ false, /*gapPadValue=*/ nullptr);
+        if (unpackedTensorView.GetSOBPtr() != targetMatrix)
+        {
+            NDArrayView unpackedData(AsDataType<ElementType>(), AsDeviceDescriptor(matrix.GetDeviceId()), AsStorageFormat(matrix.GetFormat()), dataShape, /*readOnly =*/ true, new TensorView<ElementType>(unpackedTensorView, AsTensorViewShape(dataShape)));
+            data->CopyFrom(unpackedData);
+        }
+
+        auto targetMask = value->Mask();
+        NDMaskPtr mask;
+        if (layout != nullptr)
+            mask = CreateMaskFromMBLayout(layout, targetMask);
+
+        if (mask == nullptr)
+        {
+            if (targetMask != nullptr)
+                targetMask->Clear();
+        }
+        else if (mask != targetMask)
+        {
+            if (targetMask == nullptr)
+                InvalidArgument("Value::CopyFrom: Invalid source object; Cannot copy a Value with a mask into 'this' Value which does not have a mask.");
+
+            targetMask->CopyFrom(*mask);
+        }
+    }
+
     template <typename ElementType>
     ValuePtr Utils::GetValueObjectFromCNTKImplMatrixAndMBLayout(const Variable& var, const ComputationNodeBasePtr& computationNode, const Matrix<ElementType>& matrix, const MBLayoutPtr& layout, bool readOnly /*= true*/)
     {
@@ -1029,6 +1148,9 @@ namespace CNTK
     template ValuePtr Utils::GetValueObjectFromCNTKImplMatrixAndMBLayout<float>(const Variable& var, const ComputationNodeBasePtr& computationNode, const Matrix<float>& matrix, const MBLayoutPtr& layout, bool readOnly /*= true*/);
     template ValuePtr Utils::GetValueObjectFromCNTKImplMatrixAndMBLayout<double>(const Variable& var, const ComputationNodeBasePtr& computationNode, const Matrix<double>& matrix, const MBLayoutPtr& layout, bool readOnly /*= true*/);
 
+    template void Utils::CopyCNTKImplMatrixAndMBLayoutToValueObject<float>(const NDShape& sampleShape, const std::vector<Axis>& sampleDynamicAxes, const Matrix<float>& matrix, const MBLayoutPtr& layout, const ValuePtr& value);
+    template void Utils::CopyCNTKImplMatrixAndMBLayoutToValueObject<double>(const NDShape& sampleShape, const std::vector<Axis>& sampleDynamicAxes, const Matrix<double>& matrix, const MBLayoutPtr& layout, const ValuePtr& value);
+
     void Accumulator::Update(const ValuePtr& delta, const DeviceDescriptor& device)
     {
         if (!delta)
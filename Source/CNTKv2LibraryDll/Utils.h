@@ -586,6 +586,34 @@ namespace CNTK
     std::shared_ptr<std::fstream> GetFstream(const std::wstring& filePath, bool readOnly);
     int GetFileDescriptor(const std::wstring& filePath, bool readOnly);
 
+    // A file mapped read-only into memory, for the lifetime of the object.
+    // Pages are read from disk on first access, and can be dropped again by the OS under memory pressure.
+    class MemoryMappedFile
+    {
+    public:
+        explicit MemoryMappedFile(const std::wstring& filePath);
+        ~MemoryMappedFile();
+
+        const char* Data() const { return m_data; }
+        size_t Size() const { return m_size; }
+
+        // Asks the OS to start reading the whole file in the background, so that several files can be read in parallel.
+        void Prefetch() const;
+
+    private:
+        MemoryMappedFile(const MemoryMappedFile&) = delete;
+        MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+#ifdef _MSC_VER
+        void* m_file;
+        void* m_mapping;
+#else
+        int m_file;
+#endif
+        const char* m_data;
+        size_t m_size;
+    };
+
     std::string ToString(const std::wstring& wstring);
     std::wstring ToWString(const std::string& string);
 
@@ -713,6 +741,10 @@ namespace CNTK
 
         template <typename ElementType>
         static ValuePtr GetValueObjectFromCNTKImplMatrixAndMBLayout(const Variable& var, const Microsoft::MSR::CNTK::ComputationNodeBasePtr& computationNode, const Microsoft::MSR::CNTK::Matrix<ElementType>& matrix, const Microsoft::MSR::CNTK::MBLayoutPtr& layout, bool readOnly = true);
+
+        // Unpacks the CNTK form packed data directly into the existing (dense, writable) Data and Mask of 'value', without allocating an intermediate Value
+        template <typename ElementType>
+        static void CopyCNTKImplMatrixAndMBLayoutToValueObject(const NDShape& sampleShape, const std::vector<Axis>& sampleDynamicAxes, const Microsoft::MSR::CNTK::Matrix<ElementType>& matrix, const Microsoft::MSR::CNTK::MBLayoutPtr& layout, const ValuePtr& value);
     };
 
     template <typename Container>
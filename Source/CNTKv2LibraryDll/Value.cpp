@@ -16,6 +16,7 @@
 #include "Matrix.h"
 #include "CPUSparseMatrix.h"
 #include "RecurrentNodes.h"
+#include <mutex>
 
 namespace CNTK
 {
@@ -58,6 +59,58 @@ namespace CNTK
         return CreateMask(sequenceLengths, sequenceStartFlags, device);
     }
 
+    //
+    // Recycles the CPU buffers that Value::Create packs sequences into before copying them to a different device,
+    // so that feeding batches of the same shape again and again does not allocate host memory on every call.
+    //
+    class StagingBufferPool
+    {
+    public:
+        NDArrayViewPtr Acquire(DataType dataType, const NDShape& shape)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto iter = std::find_if(m_buffers.begin(), m_buffers.end(), [dataType, &shape](const NDArrayViewPtr& buffer) {
+                    return (buffer->GetDataType() == dataType) && (buffer->Shape() == shape);
+                });
+
+                if (iter != m_buffers.end())
+                {
+                    auto buffer = *iter;
+                    m_buffers.erase(iter);
+                    return buffer;
+                }
+            }
+
+            return MakeSharedObject<NDArrayView>(dataType, shape, DeviceDescriptor::CPUDevice());
+        }
+
+        // Buffers that are still referenced elsewhere are not recycled. The least recently released buffer is dropped when the pool is full.
+        void Release(NDArrayViewPtr&& buffer)
+        {
+            if (buffer.use_count() != 1)
+                return;
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_buffers.size() == s_maxNumBuffers)
+                m_buffers.erase(m_buffers.begin());
+
+            m_buffers.push_back(std::move(buffer));
+        }
+
+        static StagingBufferPool& Instance()
+        {
+            static StagingBufferPool pool;
+            return pool;
+        }
+
+    private:
+        static const size_t s_maxNumBuffers = 8;
+
+        std::mutex m_mutex;
+        std::vector<NDArrayViewPtr> m_buffers;
+    };
+
     template <typename ElementType>
     /*static*/ ValuePtr Value::Create(const NDShape& sampleShape, const std::vector<std::vector<size_t>>& oneHotSequences, const std::vector<bool>& sequenceStartFlags, const DeviceDescriptor& device, bool readOnly/* = false*/)
     {
@@ -188,10 +241,12 @@ namespace CNTK
         NDMaskPtr deviceValueMask = CreateMask(sequenceLengths, sequenceStartFlags, DeviceDescriptor::CPUDevice());
 
         NDArrayViewPtr valueData;
+        bool staged = false;
         NDShape valueDataShape = fullyDefinedSampleShape.AppendShape({ maxSequenceLength, numSequences });
         if (numSequences == 1)
         {
-            if (createNewCopy)
+            // A copy to a different device below is a new copy already
+            if (createNewCopy && (sequences[0]->Device() == device))
                 valueData = sequences[0]->DeepClone();
             else
                 valueData = sequences[0];
@@ -243,7 +298,13 @@ namespace CNTK
             }
             else
             {
-                valueData = MakeSharedObject<NDArrayView>(dataType, valueDataShape, DeviceDescriptor::CPUDevice());
+                // The packed data is only needed until it is copied to 'device' if that is not the CPU
+                staged = (device != DeviceDescriptor::CPUDevice());
+                if (staged)
+                    valueData = StagingBufferPool::Instance().Acquire(dataType, valueDataShape);
+                else
+                    valueData = MakeSharedObject<NDArrayView>(dataType, valueDataShape, DeviceDescriptor::CPUDevice());
+
                 auto maxSequenceSizeInElements = fullyDefinedSampleShape.TotalSize() * maxSequenceLength;
                 switch (dataType)
                 {
@@ -255,6 +316,7 @@ namespace CNTK
                         const float* currentSequenceBuffer = sequences[i]->DataBuffer<float>();
                         auto currentSequenceSizeInElements = sequences[i]->Shape().TotalSize();
                         std::copy(currentSequenceBuffer, currentSequenceBuffer + currentSequenceSizeInElements, dataBuffer + (maxSequenceSizeInElements * i));
+                        std::fill(dataBuffer + (maxSequenceSizeInElements * i) + currentSequenceSizeInElements, dataBuffer + (maxSequenceSizeInElements * (i + 1)), (float)0);
                     }
                     break;
                 }
@@ -266,6 +328,7 @@ namespace CNTK
                         const double* currentSequenceBuffer = sequences[i]->DataBuffer<double>();
                         auto currentSequenceSizeInElements = sequences[i]->Shape().TotalSize();
                         std::copy(currentSequenceBuffer, currentSequenceBuffer + currentSequenceSizeInElements, dataBuffer + (maxSequenceSizeInElements * i));
+                        std::fill(dataBuffer + (maxSequenceSizeInElements * i) + currentSequenceSizeInElements, dataBuffer + (maxSequenceSizeInElements * (i + 1)), (double)0);
                     }
                     break;
                 }
@@ -286,6 +349,9 @@ namespace CNTK
         else
             deviceValueData = valueData->DeepClone(device, readOnly);
 
+        if (staged)
+            StagingBufferPool::Instance().Release(std::move(valueData));
+
         return MakeSharedObject<Value>(deviceValueData, deviceValueMask);
     }
 
@@ -653,7 +653,7 @@ int File::EndOfLineOrEOF(bool skip)
         return false;
 }
 
-// Buffer write stream
+// Use a large stdio buffer for the stream, for many small writes or reads
 int File::Setvbuf()
 {
     return setvbuf(this->m_file, NULL, _IOFBF, WRITE_BUFFER_SIZE);
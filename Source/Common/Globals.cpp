@@ -4,6 +4,7 @@
 //
 
 #include "Globals.h"
+#include "Constants.h"
 #include <unordered_map>
 
 using namespace std;
@@ -17,6 +18,9 @@ namespace Microsoft { namespace MSR { namespace CNTK {
     std::atomic<bool> Globals::m_enableShareNodeValueMatrices(true);
     std::atomic<bool> Globals::m_optimizeGradientAccumulation(true);
 
+    std::atomic<size_t> Globals::m_ringAllReduceThresholdInBytes(SIZE_MAX);
+    std::atomic<size_t> Globals::m_ringAllReduceChunkSizeInBytes(DEFAULT_RING_ALLREDUCE_CHUNK_SIZE_IN_BYTES);
+
     // Note: this is a map that transfers the old reader and writer names to
     //       the new naming scheme
     std::unordered_map<std::wstring, std::wstring> g_deprecatedReaderWriterNameMap =
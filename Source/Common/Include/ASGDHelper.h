@@ -6,6 +6,7 @@
 
 #include <list>
 #include "ComputationNetwork.h"
+#include "MPIWrapper.h"
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -62,6 +63,9 @@ ASGDHelper<ElemType>* NewASGDHelper(
     double adjustCoef = 0.2,                                                 // see in DecayCoefficient()
     size_t adjustPerMinibatches = 600,                                       //
     int traceLevel = 0,                                                      // log level
-    int syncPerfStats = 0);                                                  // shown perf data every syncPerfStats
+    int syncPerfStats = 0,                                                   // shown perf data every syncPerfStats
+    bool useDelayCompensation = false,                                       // DC-ASGD, compensate the pushed updates for the staleness of the model
+    double delayCompensationLambda = 0.04,                                   // variance control parameter of DC-ASGD
+    const MPIWrapperPtr& pMPI = nullptr);                                    // nullptr: MPIWrapper::GetInstance()
 
 }}}
@@ -0,0 +1,73 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// AsyncCheckpointWriter.h -- writes checkpoints on a background thread, so that training does not wait for the file system
+//
+
+#pragma once
+
+#include "Basics.h"
+#include "fileutil.h"
+#include <functional>
+#include <future>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// Snapshot-then-write: the training thread takes a snapshot of everything a checkpoint contains (cheap: memory copies),
+// and a background thread writes the snapshot to disk (expensive: tens of seconds for multi-GB models on network file systems).
+// At most one checkpoint is in flight: starting the next one waits for the previous one (back-pressure).
+class AsyncCheckpointWriter
+{
+public:
+    AsyncCheckpointWriter() {}
+
+    ~AsyncCheckpointWriter()
+    {
+        try
+        {
+            Wait();
+        }
+        catch (const std::exception& e)
+        {
+            fprintf(stderr, "AsyncCheckpointWriter: writing the last checkpoint failed: %s\n", e.what());
+        }
+    }
+
+    // Runs 'write' on a background thread. 'write' must only access the snapshot it owns.
+    // Waits for the checkpoint in flight first, and rethrows the error if writing it failed.
+    void Start(std::function<void()>&& write)
+    {
+        Wait();
+        m_inFlight = std::async(std::launch::async, std::move(write));
+    }
+
+    // Waits until the checkpoint in flight, if any, is on disk. Rethrows the error if writing it failed.
+    void Wait()
+    {
+        if (m_inFlight.valid())
+            m_inFlight.get();
+    }
+
+    // Writes 'fileName' atomically: 'write' writes the given temporary file, which is then synced to disk and renamed over 'fileName'.
+    // 'fileName' is never missing: a crash at any point leaves either its previous or its new version.
+    static void WriteFileAtomically(const std::wstring& fileName, const std::function<void(const std::wstring&)>& write)
+    {
+        std::wstring tempFileName = fileName + L".tmp";
+        write(tempFileName);
+
+        FILE* f = fopenOrDie(tempFileName, L"ab");
+        fsyncOrDie(f);
+        fcloseOrDie(f);
+
+        replaceFileOrDie(tempFileName, fileName);
+    }
+
+private:
+    AsyncCheckpointWriter(const AsyncCheckpointWriter&) = delete;
+    AsyncCheckpointWriter& operator=(const AsyncCheckpointWriter&) = delete;
+
+    std::future<void> m_inFlight;
+};
+
+}}}
@@ -10,5 +10,11 @@
 // The default threshold size to pack a gradient into a continuous buffer during aggregation for less MPI ops.
 const size_t DEFAULT_PACK_THRESHOLD_SIZE_IN_KB = 32;
 const size_t DEFAULT_PACK_THRESHOLD_SIZE_IN_BYTES = DEFAULT_PACK_THRESHOLD_SIZE_IN_KB * 1024;
+// The default size of the fusion buckets in which gradients are all-reduced while backprop is still running.
+const size_t DEFAULT_GRADIENT_BUCKET_SIZE_IN_KB = 4096;
+const size_t DEFAULT_GRADIENT_BUCKET_SIZE_IN_BYTES = DEFAULT_GRADIENT_BUCKET_SIZE_IN_KB * 1024;
+// The default size of the pieces in which the ring all-reduce pipelines its transfers.
+const size_t DEFAULT_RING_ALLREDUCE_CHUNK_SIZE_IN_KB = 1024;
+const size_t DEFAULT_RING_ALLREDUCE_CHUNK_SIZE_IN_BYTES = DEFAULT_RING_ALLREDUCE_CHUNK_SIZE_IN_KB * 1024;
 
 #endif
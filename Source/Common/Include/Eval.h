@@ -333,6 +333,8 @@ public:
     // Output must be preallocated and sized to avoid memory allocation / deallocation across DLL
     // boundaries.
     // This method is not reentrant, as the forward pass keeps internal state.
+    // On the CPU, input buffers are used in place (not copied) for the duration of the call, and outputs
+    // whose size is known from the inputs are computed directly into the output buffers.
     // inputs - vector of input buffers, one for every input as given by GetInputLayouts()
     // outputs - vector of output buffers. Must be sized to fit output schema.
     //
@@ -355,6 +357,14 @@ public:
     // resetRNN - flags whether to reset memory cells of RNN. 
     //
     virtual void ForwardPass(const ValueRefs<ElemType>& inputs, ValueRefs<ElemType>& output, bool resetRNN) = 0;
+
+    //
+    // CreateSession - create a new evaluator for the same model that can be used concurrently with this one,
+    // e.g. one per thread of a serving process. The model parameters are loaded only once and shared read-only
+    // by all sessions; a session only holds its own activation buffers. Call StartForwardEvaluation() on the session
+    // before using it, and release it with Destroy(). Sessions may outlive the evaluator they were created from.
+    //
+    virtual IEvaluateModelExtended<ElemType>* CreateSession() = 0;
 };
 
 template <typename ElemType>
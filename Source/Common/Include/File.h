@@ -195,6 +195,30 @@ public:
         return *this;
     }
 
+    // get/put an array of basic types; in binary files with a single read/write instead of one per element
+    template <typename T>
+    void ReadArray(T* data, size_t count)
+    {
+        if (IsTextBased())
+        {
+            for (size_t i = 0; i < count; i++)
+                fgetText(m_file, data[i]);
+        }
+        else if (count > 0)
+            freadOrDie(data, sizeof(T), count, m_file);
+    }
+    template <typename T>
+    void WriteArray(const T* data, size_t count)
+    {
+        if (IsTextBased())
+        {
+            for (size_t i = 0; i < count; i++)
+                fputText(m_file, data[i]);
+        }
+        else if (count > 0)
+            fwriteOrDie(data, sizeof(T), count, m_file);
+    }
+
     void WriteString(const char* str, int size = 0);                   // zero terminated strings use size=0
     void ReadString(char* str, int size);                              // read up to size bytes, or a zero terminator (or space in text mode)
     void WriteString(const wchar_t* str, int size = 0);                // zero terminated strings use size=0
@@ -6,6 +6,8 @@
 #pragma once
 
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -28,11 +30,20 @@ namespace Microsoft { namespace MSR { namespace CNTK {
         static void SetShareNodeValueMatrices(bool enable) { m_enableShareNodeValueMatrices = enable; }
         static bool ShouldEnableShareNodeValueMatrices() { return m_enableShareNodeValueMatrices; }
 
+        // Gradients of at least this size are all-reduced with CNTK's own ring all-reduce instead of the MPI library's.
+        // SIZE_MAX (the default) disables the ring all-reduce.
+        static void SetRingAllReduceThresholdInBytes(size_t threshold) { m_ringAllReduceThresholdInBytes = threshold; }
+        static size_t RingAllReduceThresholdInBytes() { return m_ringAllReduceThresholdInBytes; }
+        static void SetRingAllReduceChunkSizeInBytes(size_t chunkSize) { m_ringAllReduceChunkSizeInBytes = chunkSize; }
+        static size_t RingAllReduceChunkSizeInBytes() { return m_ringAllReduceChunkSizeInBytes; }
+
     private:
         static std::atomic<bool> m_forceDeterministicAlgorithms;
         // The global flag to enable matrices values in forward and backward prop
         static std::atomic<bool> m_enableShareNodeValueMatrices;
         static std::atomic<bool> m_forceConstantRandomSeed;
         static std::atomic<bool> m_optimizeGradientAccumulation;
+        static std::atomic<size_t> m_ringAllReduceThresholdInBytes;
+        static std::atomic<size_t> m_ringAllReduceChunkSizeInBytes;
     };
 }}}
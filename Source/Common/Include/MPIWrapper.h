@@ -28,14 +28,17 @@ typedef enum _MPI_Datatype { MPI_CHAR, MPI_INT, MPI_FLOAT, MPI_DOUBLE, MPI_UNSIG
 
 #define MPI_IN_PLACE          ((void*)(int)-1)
 #define MPI_SUM               ((MPI_Op)0x58000003)
+#define MPI_REPLACE           ((MPI_Op)0x5800000d)
 
 #define MPI_STATUSES_IGNORE  (MPI_Status*)1
 #define MPI_STATUS_IGNORE    (MPI_Status*)1
 #define MPI_UNDEFINED        (-32766)
+#define MPI_REQUEST_NULL     ((MPI_Request)0)
 
 typedef int MPI_Op;
 typedef int MPI_Request;
 typedef void *MPI_Status;
+typedef int MPI_Win;
 #endif
 
 #include <errno.h> 
@@ -114,6 +117,17 @@ public:
     virtual int Abort(int errorcode) = 0;
     virtual int Error_string(int errorcode, char* string, int* resultlen) = 0;
 
+    // one-sided communication over the current communicator, with a shared (passive target) access epoch to all ranks.
+    // Win_allocate is collective; the element-wise atomicity of Accumulate/Get_accumulate is the one defined by MPI.
+    virtual int Win_allocate(size_t sizeInBytes, int displacementUnit, void* baseptr, MPI_Win* win) = 0;
+    virtual int Win_free(MPI_Win* win) = 0;
+    virtual int Win_lock_all(MPI_Win win) = 0;
+    virtual int Win_unlock_all(MPI_Win win) = 0;
+    virtual int Win_flush_all(MPI_Win win) = 0;
+    virtual int Get(void* resultAddr, int count, MPI_Datatype datatype, int targetRank, size_t targetDisplacement, MPI_Win win) = 0;
+    virtual int Accumulate(const void* originAddr, int count, MPI_Datatype datatype, int targetRank, size_t targetDisplacement, MPI_Op op, MPI_Win win) = 0;
+    virtual int Get_accumulate(const void* originAddr, void* resultAddr, int count, MPI_Datatype datatype, int targetRank, size_t targetDisplacement, MPI_Op op, MPI_Win win) = 0;
+
     // helpers to determine the MPI_Datatype of a pointer
     static MPI_Datatype GetDataType(char *);
     static MPI_Datatype GetDataType(int *);
@@ -175,6 +189,10 @@ public:
     virtual void Gatherv(const float *sendData, size_t numSendElements, float *receiveData, int recvCounts[], int offsets[], size_t rootRank) const = 0;
     virtual void Gatherv(const double *sendData, size_t numSendElements, double *receiveData, int recvCounts[], int offsets[], size_t rootRank) const = 0;
 
+    virtual void AllGatherv(const int *sendData, size_t numSendElements, int *receiveData, int recvCounts[], int offsets[]) const = 0;
+    virtual void AllGatherv(const float *sendData, size_t numSendElements, float *receiveData, int recvCounts[], int offsets[]) const = 0;
+    virtual void AllGatherv(const double *sendData, size_t numSendElements, double *receiveData, int recvCounts[], int offsets[]) const = 0;
+
     // wait for all ranks to reach here
     virtual int WaitAll() = 0;
     virtual void WaitAny(MPI_Request* requests, int numRequests, int* index) = 0;
@@ -0,0 +1,89 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// ProfilerClockSync.h -- aligns the profiler timelines of the ranks of a distributed job
+//
+
+#pragma once
+
+#include "MPIWrapper.h"
+#include "PerformanceProfiler.h"
+#include "TimerUtility.h"
+#include <limits>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// Makes time zero of the profiler timeline the same instant on all ranks, and the rank the process id of the timeline.
+// After a barrier, every rank estimates the offset of its clock to the clock of the main node from the fastest of a few
+// time stamp round trips (the error is at most half of that round trip, typically a few microseconds).
+// Collective: must be called by all ranks, after ProfilerInit().
+inline void SynchronizeProfilerTimelines(const MPIWrapperPtr& mpi)
+{
+    if (!mpi)
+        return;
+
+    const int rank = (int)mpi->CurrentNodeRank();
+    const int mainRank = (int)mpi->MainNodeRank();
+    if (mpi->NumNodesInUse() == 1)
+    {
+        ProfilerSetTimelineOrigin(rank, Clock::GetTimeStamp());
+        return;
+    }
+
+    const int numRoundTrips = 8;
+    const int tag = 15000; // below the tags of RingAllReduce
+
+    mpi->WaitAll();
+
+    long long mainClockMinusLocalClock = 0;
+    if (rank == mainRank)
+    {
+        // answer every request with the current time stamp, one rank after another
+        for (int peer = 0; peer < (int)mpi->NumNodesInUse(); peer++)
+        {
+            if (peer == mainRank)
+                continue;
+
+            for (int i = 0; i < numRoundTrips; i++)
+            {
+                long long timeStamp;
+                mpi->Recv(&timeStamp, 1, MPI_LONG_LONG_INT, peer, tag, MPI_STATUS_IGNORE) || MpiFail("SynchronizeProfilerTimelines: MPI_Recv");
+                timeStamp = Clock::GetTimeStamp();
+                MPI_Request request;
+                mpi->Isend(&timeStamp, 1, MPI_LONG_LONG_INT, peer, tag, &request) || MpiFail("SynchronizeProfilerTimelines: MPI_Isend");
+                mpi->Wait(&request);
+            }
+        }
+    }
+    else
+    {
+        long long fastestRoundTrip = std::numeric_limits<long long>::max();
+        for (int i = 0; i < numRoundTrips; i++)
+        {
+            long long sendTimeStamp = Clock::GetTimeStamp();
+            MPI_Request request;
+            mpi->Isend(&sendTimeStamp, 1, MPI_LONG_LONG_INT, mainRank, tag, &request) || MpiFail("SynchronizeProfilerTimelines: MPI_Isend");
+            mpi->Wait(&request);
+            long long mainTimeStamp;
+            mpi->Recv(&mainTimeStamp, 1, MPI_LONG_LONG_INT, mainRank, tag, MPI_STATUS_IGNORE) || MpiFail("SynchronizeProfilerTimelines: MPI_Recv");
+            long long receiveTimeStamp = Clock::GetTimeStamp();
+
+            // the main node took its time stamp about half way through the round trip
+            if (receiveTimeStamp - sendTimeStamp < fastestRoundTrip)
+            {
+                fastestRoundTrip = receiveTimeStamp - sendTimeStamp;
+                mainClockMinusLocalClock = mainTimeStamp - (sendTimeStamp + fastestRoundTrip / 2);
+            }
+        }
+    }
+
+    // time zero is the main node's time stamp after everybody is done
+    mpi->WaitAll();
+    long long origin = Clock::GetTimeStamp();
+    mpi->Bcast(&origin, 1, MPI_LONG_LONG_INT, mainRank);
+
+    ProfilerSetTimelineOrigin(rank, origin - mainClockMinusLocalClock);
+}
+
+}}}
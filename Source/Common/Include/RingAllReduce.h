@@ -0,0 +1,182 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// RingAllReduce.h -- bandwidth-optimal all-reduce of CPU buffers, built on MPI point-to-point messages
+//
+
+#pragma once
+
+#include "Basics.h"
+#include "Constants.h"
+#include "Globals.h"
+#include "MPIWrapper.h"
+#include "PerformanceProfiler.h"
+#include "TimerUtility.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// Sums a buffer over all ranks with a ring reduce-scatter followed by a ring all-gather.
+// Every rank sends and receives 2 * (N-1) / N times the buffer size, independent of the number of ranks N.
+// The buffer is cut into N segments, and every segment into chunks. The chunks travel around the ring independently:
+// a chunk is forwarded as soon as it has arrived (and, in the reduce-scatter, been added), so the transfers of
+// consecutive ring steps overlap.
+//
+// The ring all-reduce is used instead of MPI_Allreduce for buffers of at least Globals::RingAllReduceThresholdInBytes().
+class RingAllReduce
+{
+public:
+    RingAllReduce(const MPIWrapperPtr& mpi, size_t chunkSizeInBytes = Globals::RingAllReduceChunkSizeInBytes())
+        : m_mpi(mpi), m_chunkSizeInBytes(std::max<size_t>(chunkSizeInBytes, 1)), m_numCalls(0), m_numBytes(0), m_seconds(0)
+    {
+    }
+
+    // Whether a buffer of the given size should be reduced with the ring rather than MPI_Allreduce.
+    // The size of a reduction is the same on all ranks, so all of them take the same decision.
+    static bool IsPreferred(size_t sizeInBytes)
+    {
+        return sizeInBytes >= Globals::RingAllReduceThresholdInBytes();
+    }
+
+    // In-place if inputData == outputData. Blocks until the reduction is done.
+    template <class ElemType>
+    void AllReduce(const ElemType* inputData, ElemType* outputData, size_t numElements, bool showPerfStats = false)
+    {
+        Timer timer;
+        timer.Start();
+        auto profAllReduce = ProfilerTimeBegin();
+
+        if (inputData != outputData)
+            memcpy(outputData, inputData, numElements * sizeof(ElemType));
+
+        const int numRanks = (int)m_mpi->NumNodesInUse();
+        if (numRanks > 1 && numElements > 0)
+            RingAllReduceInPlace(outputData, numElements, numRanks, (int)m_mpi->CurrentNodeRank());
+
+        timer.Stop();
+        double seconds = timer.ElapsedSeconds();
+        size_t numBytes = numElements * sizeof(ElemType);
+        if (numRanks > 1)
+            ProfilerTimeEnd(profAllReduce, "Ring All-Reduce", (long long)(2.0 * (numRanks - 1) / numRanks * numBytes), (int)((m_mpi->CurrentNodeRank() + 1) % numRanks));
+        m_numCalls++;
+        m_numBytes += numBytes;
+        m_seconds += seconds;
+        if (showPerfStats)
+        {
+            // 'bus bandwidth': the bytes every rank actually sends, per second
+            double busBandwidth = (seconds > 0) ? (2.0 * (numRanks - 1) / numRanks * numBytes / seconds) : 0;
+            fprintf(stderr, "Ring all-reduce of %.3g MB: %.6g seconds, bus bandwidth %.3g GB/s\n", numBytes / 1e6, seconds, busBandwidth / 1e9);
+        }
+    }
+
+    // Cumulative statistics over all reductions so far
+    size_t NumCalls() const { return m_numCalls; }
+    size_t NumBytes() const { return m_numBytes; }
+    double Seconds() const { return m_seconds; }
+
+private:
+    // Tags of the chunk messages; the chunk count is capped so that they stay below the MPI minimum of MPI_TAG_UB (32767).
+    static const int s_firstTag = 16384;
+    static const size_t s_maxNumChunks = 1024;
+
+    static size_t Mod(int a, int n)
+    {
+        return (size_t)(((a % n) + n) % n);
+    }
+
+    template <class ElemType>
+    void RingAllReduceInPlace(ElemType* data, size_t numElements, int numRanks, int rank)
+    {
+        // Segment k is [segmentBegin[k], segmentBegin[k+1]); all ranks compute the same partitioning.
+        std::vector<size_t> segmentBegin(numRanks + 1);
+        for (int k = 0; k <= numRanks; k++)
+            segmentBegin[k] = numElements * k / numRanks;
+
+        size_t maxSegmentSize = (numElements + numRanks - 1) / numRanks;
+        size_t chunkSize = std::max<size_t>(m_chunkSizeInBytes / sizeof(ElemType), 1);
+        chunkSize = std::max(chunkSize, (maxSegmentSize + s_maxNumChunks - 1) / s_maxNumChunks);
+        size_t numChunks = (maxSegmentSize + chunkSize - 1) / chunkSize;
+
+        auto chunkBegin = [&](size_t segment, size_t chunk) { return std::min(segmentBegin[segment] + chunk * chunkSize, segmentBegin[segment + 1]); };
+        auto chunkEnd = [&](size_t segment, size_t chunk) { return std::min(segmentBegin[segment] + (chunk + 1) * chunkSize, segmentBegin[segment + 1]); };
+
+        // Step s < N-1 is the reduce-scatter, the remaining N-1 steps are the all-gather.
+        // Whatever a rank receives in step s, it sends on in step s+1.
+        const int numSteps = 2 * (numRanks - 1);
+        auto sendSegment = [&](int step) { return (step < numRanks - 1) ? Mod(rank - step, numRanks) : Mod(rank + 1 - (step - numRanks + 1), numRanks); };
+        auto recvSegment = [&](int step) { return (step < numRanks - 1) ? Mod(rank - step - 1, numRanks) : Mod(rank - (step - numRanks + 1), numRanks); };
+
+        const int next = (rank + 1) % numRanks;
+        const int previous = (rank + numRanks - 1) % numRanks;
+        MPI_Datatype dataType = MPIWrapper::GetDataType(data);
+
+        m_receiveBuffer.resize(numChunks * chunkSize * sizeof(ElemType));
+        ElemType* receiveBuffer = reinterpret_cast<ElemType*>(m_receiveBuffer.data());
+
+        // requests[chunk] is the receive of a chunk, requests[numChunks + chunk] its send.
+        // A chunk starts its next step only once both its receive and its send are done: then no send
+        // still reads a part of 'data' that the all-gather overwrites, and no rank ever blocks on a single request.
+        std::vector<int> step(numChunks, 0);
+        std::vector<MPI_Request> requests(2 * numChunks, MPI_REQUEST_NULL);
+        std::vector<bool> received(numChunks, false);
+
+        auto startStep = [&](size_t chunk)
+        {
+            int s = step[chunk];
+            int tag = s_firstTag + (int)chunk;
+            size_t recvBegin = chunkBegin(recvSegment(s), chunk);
+            int recvCount = (int)(chunkEnd(recvSegment(s), chunk) - recvBegin);
+            ElemType* recvTarget = (s < numRanks - 1) ? (receiveBuffer + chunk * chunkSize) : (data + recvBegin);
+            m_mpi->Irecv(recvTarget, recvCount, dataType, previous, tag, &requests[chunk]) || MpiFail("RingAllReduce: MPI_Irecv");
+
+            size_t sendBegin = chunkBegin(sendSegment(s), chunk);
+            int sendCount = (int)(chunkEnd(sendSegment(s), chunk) - sendBegin);
+            m_mpi->Isend(data + sendBegin, sendCount, dataType, next, tag, &requests[numChunks + chunk]) || MpiFail("RingAllReduce: MPI_Isend");
+            received[chunk] = false;
+        };
+
+        for (size_t chunk = 0; chunk < numChunks; chunk++)
+            startStep(chunk);
+
+        for (;;)
+        {
+            int idx = MPI_UNDEFINED;
+            m_mpi->Waitany((int)requests.size(), requests.data(), &idx, MPI_STATUS_IGNORE) || MpiFail("RingAllReduce: MPI_Waitany");
+            if (idx == MPI_UNDEFINED)
+                break;
+
+            size_t chunk = (size_t)idx % numChunks;
+            if ((size_t)idx < numChunks)
+            {
+                // the reduce-scatter adds what arrived, the all-gather received in place
+                int s = step[chunk];
+                if (s < numRanks - 1)
+                {
+                    size_t begin = chunkBegin(recvSegment(s), chunk);
+                    size_t end = chunkEnd(recvSegment(s), chunk);
+                    const ElemType* receivedData = receiveBuffer + chunk * chunkSize;
+                    for (size_t i = begin; i < end; i++)
+                        data[i] += receivedData[i - begin];
+                }
+
+                received[chunk] = true;
+            }
+
+            if (received[chunk] && requests[numChunks + chunk] == MPI_REQUEST_NULL && ++step[chunk] < numSteps)
+                startStep(chunk);
+        }
+    }
+
+    MPIWrapperPtr m_mpi;
+    const size_t m_chunkSizeInBytes;
+    std::vector<char> m_receiveBuffer;
+
+    size_t m_numCalls;
+    size_t m_numBytes;
+    double m_seconds;
+};
+
+}}}
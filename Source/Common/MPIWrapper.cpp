@@ -4,6 +4,12 @@
 //
 #include "Include/Basics.h"
 #include "Include/MPIWrapper.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 #if HAS_MPI
 #pragma comment(lib, "msmpi.lib")
@@ -33,6 +39,49 @@ class MPIWrapperMpi : public MPIWrapper
     // MPI communicator that reflects the current subset selection
     MPI_Comm m_currentComm;
 
+    // Hierarchical all-reduce: the ranks of a host reduce through a shared-memory window,
+    // and only one leader per host takes part in the all-reduce across hosts.
+    static const size_t s_sharedSlotSizeInBytes = 16 * 1024 * 1024;        // per rank; larger reductions are done in pieces
+    static const size_t s_minHierarchicalAllReduceSizeInBytes = 64 * 1024; // below this, latency dominates and plain MPI_Allreduce is used
+    bool m_useHierarchicalAllReduce;
+    MPI_Comm m_localComm;  // the ranks on this host
+    MPI_Comm m_leaderComm; // the first rank of each host; MPI_COMM_NULL on the other ranks
+    int m_localRank;
+    int m_localSize;
+    MPI_Win m_sharedWindow;
+    std::vector<char*> m_sharedSlots; // one slot per local rank
+    char* m_sharedResult;             // reduced piece, owned by the host leader
+
+    // Returns the name used to determine the host topology. CNTK_MPI_HOSTNAME overrides the processor name,
+    // which allows to simulate several hosts on a single machine.
+    static std::string GetProcessorName();
+    void SetupHierarchicalAllReduce(const std::vector<char>& allNames, size_t nameMax);
+    void FreeHierarchicalAllReduce();
+    bool UseHierarchicalAllReduce(size_t numElements, size_t elementSize, MPI_Op op) const;
+    void LocalBarrier() const;
+    template <class ElemType>
+    void HierarchicalAllReduce(const ElemType* sendData, ElemType* receiveData, size_t numElements) const;
+
+    // Nonblocking hierarchical all-reduce: AllReduceAsync() and Iallreduce() queue the reductions for a helper thread,
+    // which runs them in order and then completes the generalized request that was returned for each.
+    // MPI runs with MPI_THREAD_SERIALIZED, so the helper thread holds m_mpiMutex while it calls MPI, the calls that only
+    // start a nonblocking operation take the same lock, and all other calls first wait until the queue is empty
+    // (a blocking collective could otherwise wait for a rank whose helper thread waits for the lock).
+    // The requests must therefore be waited for through this class.
+    mutable std::mutex m_mpiMutex;
+    mutable std::mutex m_asyncAllReduceMutex; // guards the queue below
+    mutable std::condition_variable m_asyncAllReduceCondition;
+    mutable std::deque<std::function<void()>> m_asyncAllReduces; // the front one is running
+    mutable std::exception_ptr m_asyncAllReduceError;
+    bool m_stopAsyncAllReduceThread;
+    std::thread m_asyncAllReduceThread;
+
+    template <class ElemType>
+    void HierarchicalAllReduceAsync(const ElemType* sendData, ElemType* receiveData, size_t numElements, MPI_Request* request) const;
+    void RunAsyncAllReduces();
+    void WaitForAsyncAllReduces() const;
+    void StopAsyncAllReduceThread();
+
     // MPI_Init() is loading the msmpi.dll. Failing to load the dll will terminate the
     // application.
     int MPI_Init_DL();
@@ -89,6 +138,15 @@ public:
     virtual int Abort(int errorcode);
     virtual int Error_string(int errorcode, char* string, int* resultlen);
 
+    virtual int Win_allocate(size_t sizeInBytes, int displacementUnit, void* baseptr, MPI_Win* win);
+    virtual int Win_free(MPI_Win* win);
+    virtual int Win_lock_all(MPI_Win win);
+    virtual int Win_unlock_all(MPI_Win win);
+    virtual int Win_flush_all(MPI_Win win);
+    virtual int Get(void* resultAddr, int count, MPI_Datatype datatype, int targetRank, size_t targetDisplacement, MPI_Win win);
+    virtual int Accumulate(const void* originAddr, int count, MPI_Datatype datatype, int targetRank, size_t targetDisplacement, MPI_Op op, MPI_Win win);
+    virtual int Get_accumulate(const void* originAddr, void* resultAddr, int count, MPI_Datatype datatype, int targetRank, size_t targetDisplacement, MPI_Op op, MPI_Win win);
+
     // allreduce of a vector
     virtual void AllReduce(std::vector<size_t>& accumulator) const;
     virtual void AllReduce(std::vector<int>& accumulator) const;
@@ -143,6 +201,10 @@ public:
     virtual void Gatherv(const float *sendData, size_t numSendElements, float *receiveData, int recvCounts[], int offsets[], size_t rootRank) const;
     virtual void Gatherv(const double *sendData, size_t numSendElements, double *receiveData, int recvCounts[], int offsets[], size_t rootRank) const;
 
+    virtual void AllGatherv(const int *sendData, size_t numSendElements, int *receiveData, int recvCounts[], int offsets[]) const;
+    virtual void AllGatherv(const float *sendData, size_t numSendElements, float *receiveData, int recvCounts[], int offsets[]) const;
+    virtual void AllGatherv(const double *sendData, size_t numSendElements, double *receiveData, int recvCounts[], int offsets[]) const;
+
     // wait for all ranks to reach here
     virtual int WaitAll();
     virtual void WaitAny(MPI_Request* requests, int numRequests, int* index);
@@ -186,6 +248,15 @@ public:
     virtual int Abort(int errorcode);
     virtual int Error_string(int errorcode, char* string, int* resultlen);
 
+    virtual int Win_allocate(size_t sizeInBytes, int displacementUnit, void* baseptr, MPI_Win* win);
+    virtual int Win_free(MPI_Win* win);
+    virtual int Win_lock_all(MPI_Win win);
+    virtual int Win_unlock_all(MPI_Win win);
+    virtual int Win_flush_all(MPI_Win win);
+    virtual int Get(void* resultAddr, int count, MPI_Datatype datatype, int targetRank, size_t targetDisplacement, MPI_Win win);
+    virtual int Accumulate(const void* originAddr, int count, MPI_Datatype datatype, int targetRank, size_t targetDisplacement, MPI_Op op, MPI_Win win);
+    virtual int Get_accumulate(const void* originAddr, void* resultAddr, int count, MPI_Datatype datatype, int targetRank, size_t targetDisplacement, MPI_Op op, MPI_Win win);
+
     // allreduce of a vector
     virtual void AllReduce(std::vector<size_t>& accumulator) const;
     virtual void AllReduce(std::vector<int>& accumulator) const;
@@ -240,6 +311,10 @@ public:
     virtual void Gatherv(const float *sendData, size_t numSendElements, float *receiveData, int recvCounts[], int offsets[], size_t rootRank) const;
     virtual void Gatherv(const double *sendData, size_t numSendElements, double *receiveData, int recvCounts[], int offsets[], size_t rootRank) const;
 
+    virtual void AllGatherv(const int *sendData, size_t numSendElements, int *receiveData, int recvCounts[], int offsets[]) const;
+    virtual void AllGatherv(const float *sendData, size_t numSendElements, float *receiveData, int recvCounts[], int offsets[]) const;
+    virtual void AllGatherv(const double *sendData, size_t numSendElements, double *receiveData, int recvCounts[], int offsets[]) const;
+
     // wait for all ranks to reach here
     virtual int WaitAll();
     virtual void WaitAny(MPI_Request* requests, int numRequests, int* index);
@@ -394,7 +469,8 @@ int MPIWrapper::GetTotalNumberOfMPINodes()
 int MPIWrapperMpi::s_myRank = -1;
 
 MPIWrapperMpi::MPIWrapperMpi()
-    : m_currentComm(MPI_COMM_WORLD)
+    : m_currentComm(MPI_COMM_WORLD), m_useHierarchicalAllReduce(false), m_localComm(MPI_COMM_NULL), m_leaderComm(MPI_COMM_NULL),
+      m_localRank(0), m_localSize(1), m_sharedWindow(MPI_WIN_NULL), m_sharedResult(nullptr), m_stopAsyncAllReduceThread(false)
 {
     static bool initialized = false;
     if (initialized)
@@ -422,10 +498,8 @@ MPIWrapperMpi::MPIWrapperMpi()
     assert((GetTotalNumberOfMPINodes() == 0 && m_numNodesInUse == 1) ||
         (GetTotalNumberOfMPINodes() == m_numNodesInUse));
 
-    char name[BUFSIZ];
-    int length;
-    MPI_Get_processor_name(name, &length);
-    m_myName = std::wstring(name, name + length);
+    std::string name = GetProcessorName();
+    m_myName = std::wstring(name.begin(), name.end());
 
     // Applying MPI workaround
     s_myRank = m_myRank;
@@ -475,6 +549,8 @@ MPIWrapperMpi::~MPIWrapperMpi()
 
         Finalize();
     }
+    else if (m_asyncAllReduceThread.joinable())
+        m_asyncAllReduceThread.detach(); // it may wait for a rank that is gone
 }
 
 // MPI_Init() is loading the msmpi.dll. Failing to load the dll will terminate the
@@ -513,6 +589,7 @@ void MPIWrapperMpi::MPIWorkaroundAtExit()
 
 void MPIWrapperMpi::Ping(const char *msg) const
 {
+    WaitForAsyncAllReduces();
 #undef USE2NDCOMM
 #ifndef USE2NDCOMM
     if (NumNodesInUse() != m_numMPINodes)
@@ -542,6 +619,7 @@ void MPIWrapperMpi::Ping(const char *msg) const
 
 void MPIWrapperMpi::RequestNodes(const char *msg, size_t requestednodes /*default: all*/)
 {
+    WaitForAsyncAllReduces();
     Ping("requestnodes (before change)");
 
     // undo current split
@@ -589,9 +667,8 @@ void MPIWrapperMpi::RequestNodes(const char *msg, size_t requestednodes /*defaul
     // check that MPI_Get_processor_name matches for all ranks.
     const int nameMax = MPI_MAX_PROCESSOR_NAME + 1;
     char myName[nameMax] = { 0 };
-    int  myNameLen = 0;
-    MPI_Get_processor_name(myName, &myNameLen) || MpiFail("requestnodes: MPI_Get_processor_name");
-    myName[myNameLen] = '\0';
+    std::string processorName = GetProcessorName();
+    strncpy(myName, processorName.c_str(), nameMax - 1);
 
     std::vector<char> nameBuffer(m_numNodesInUse * nameMax);
     char* allNames = nameBuffer.data();
@@ -612,6 +689,254 @@ void MPIWrapperMpi::RequestNodes(const char *msg, size_t requestednodes /*defaul
         msg, (int)m_numNodesInUse, (int)m_numMPINodes, m_multiHost ? "multiple hosts" : "a single host",
         (int)requestednodes, (int)CurrentNodeRank(), IsIdle() ? "out (idle)" : "in (participating)");
     fflush(stderr);
+
+    SetupHierarchicalAllReduce(nameBuffer, nameMax);
+}
+
+std::string MPIWrapperMpi::GetProcessorName()
+{
+    const char* overrideName = std::getenv("CNTK_MPI_HOSTNAME");
+    if (overrideName != nullptr && *overrideName != '\0')
+        return std::string(overrideName).substr(0, MPI_MAX_PROCESSOR_NAME);
+
+    char name[MPI_MAX_PROCESSOR_NAME + 1] = { 0 };
+    int length = 0;
+    MPI_Get_processor_name(name, &length) || MpiFail("GetProcessorName: MPI_Get_processor_name");
+    return std::string(name, name + length);
+}
+
+// Sets up the communicators and the shared-memory window for HierarchicalAllReduce(), based on the processor names of all ranks.
+// This is only worth it if there are several hosts and at least one of them runs more than one rank.
+// Set CNTK_HIERARCHICAL_ALLREDUCE=0 to always use plain MPI_Allreduce.
+void MPIWrapperMpi::SetupHierarchicalAllReduce(const std::vector<char>& allNames, size_t nameMax)
+{
+    FreeHierarchicalAllReduce();
+
+    const char* setting = std::getenv("CNTK_HIERARCHICAL_ALLREDUCE");
+    if ((setting != nullptr && atoi(setting) == 0) || !m_multiHost || IsIdle())
+        return;
+
+    // hosts are numbered by their first rank; all ranks compute the same numbering
+    std::vector<int> hostOfRank(m_numNodesInUse);
+    std::vector<int> ranksOnHost(m_numNodesInUse, 0);
+    for (size_t i = 0; i < m_numNodesInUse; i++)
+    {
+        size_t first = 0;
+        while (strcmp(allNames.data() + first * nameMax, allNames.data() + i * nameMax) != 0)
+            first++;
+
+        hostOfRank[i] = (int)first;
+        ranksOnHost[first]++;
+    }
+
+    if (*std::max_element(ranksOnHost.begin(), ranksOnHost.end()) < 2)
+        return;
+
+    MPI_Comm_split(m_currentComm, hostOfRank[m_myRank], m_myRank, &m_localComm) || MpiFail("SetupHierarchicalAllReduce: MPI_Comm_split");
+    MPI_Comm_rank(m_localComm, &m_localRank) || MpiFail("SetupHierarchicalAllReduce: MPI_Comm_rank");
+    MPI_Comm_size(m_localComm, &m_localSize) || MpiFail("SetupHierarchicalAllReduce: MPI_Comm_size");
+    MPI_Comm_split(m_currentComm, (m_localRank == 0) ? 0 : MPI_UNDEFINED, m_myRank, &m_leaderComm) || MpiFail("SetupHierarchicalAllReduce: MPI_Comm_split");
+
+    // every rank contributes one slot, the leader additionally holds the reduced result
+    MPI_Aint windowSize = s_sharedSlotSizeInBytes + ((m_localRank == 0) ? s_sharedSlotSizeInBytes : 0);
+    void* windowBase = nullptr;
+    MPI_Win_allocate_shared(windowSize, 1, MPI_INFO_NULL, m_localComm, &windowBase, &m_sharedWindow) || MpiFail("SetupHierarchicalAllReduce: MPI_Win_allocate_shared");
+
+    m_sharedSlots.resize(m_localSize);
+    for (int r = 0; r < m_localSize; r++)
+    {
+        MPI_Aint size;
+        int displacementUnit;
+        void* base;
+        MPI_Win_shared_query(m_sharedWindow, r, &size, &displacementUnit, &base) || MpiFail("SetupHierarchicalAllReduce: MPI_Win_shared_query");
+        m_sharedSlots[r] = static_cast<char*>(base);
+    }
+
+    m_sharedResult = m_sharedSlots[0] + s_sharedSlotSizeInBytes;
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, m_sharedWindow) || MpiFail("SetupHierarchicalAllReduce: MPI_Win_lock_all");
+    m_useHierarchicalAllReduce = true;
+    m_stopAsyncAllReduceThread = false;
+    m_asyncAllReduceThread = std::thread([this]() { RunAsyncAllReduces(); });
+
+    size_t numHosts = std::count_if(ranksOnHost.begin(), ranksOnHost.end(), [](int n) { return n > 0; });
+    fprintf(stderr, "requestnodes: using hierarchical all-reduce across %d hosts, %d ranks on this host\n", (int)numHosts, m_localSize);
+    fflush(stderr);
+}
+
+void MPIWrapperMpi::FreeHierarchicalAllReduce()
+{
+    StopAsyncAllReduceThread();
+    m_useHierarchicalAllReduce = false;
+    if (m_sharedWindow != MPI_WIN_NULL)
+    {
+        MPI_Win_unlock_all(m_sharedWindow) || MpiFail("FreeHierarchicalAllReduce: MPI_Win_unlock_all");
+        MPI_Win_free(&m_sharedWindow) || MpiFail("FreeHierarchicalAllReduce: MPI_Win_free");
+    }
+
+    if (m_leaderComm != MPI_COMM_NULL)
+        MPI_Comm_free(&m_leaderComm) || MpiFail("FreeHierarchicalAllReduce: MPI_Comm_free");
+
+    if (m_localComm != MPI_COMM_NULL)
+        MPI_Comm_free(&m_localComm) || MpiFail("FreeHierarchicalAllReduce: MPI_Comm_free");
+
+    m_sharedSlots.clear();
+    m_sharedResult = nullptr;
+}
+
+bool MPIWrapperMpi::UseHierarchicalAllReduce(size_t numElements, size_t elementSize, MPI_Op op) const
+{
+    // numElements is the same on all ranks, so all of them take the same path
+    return m_useHierarchicalAllReduce && (op == MPI_SUM) && (numElements * elementSize >= s_minHierarchicalAllReduceSizeInBytes);
+}
+
+// Barrier across the ranks of this host that also makes the stores to the shared window visible to them
+void MPIWrapperMpi::LocalBarrier() const
+{
+    MPI_Win_sync(m_sharedWindow) || MpiFail("LocalBarrier: MPI_Win_sync");
+    MPI_Barrier(m_localComm) || MpiFail("LocalBarrier: MPI_Barrier");
+    MPI_Win_sync(m_sharedWindow) || MpiFail("LocalBarrier: MPI_Win_sync");
+}
+
+// Sum over all ranks in three steps, one piece of at most one slot at a time:
+//  - reduce-scatter within the host: every rank copies its piece into its slot, and then sums
+//    its share of the piece over all slots into the leader's result buffer
+//  - the host leaders all-reduce the result across hosts
+//  - broadcast within the host: every rank copies the result out of the shared window
+// Across hosts, only one copy of the data per host is sent instead of one per rank.
+template <class ElemType>
+void MPIWrapperMpi::HierarchicalAllReduce(const ElemType* sendData, ElemType* receiveData, size_t numElements) const
+{
+    const ElemType* source = ((const void*)sendData == MPI_IN_PLACE) ? receiveData : sendData;
+    ElemType* mySlot = reinterpret_cast<ElemType*>(m_sharedSlots[m_localRank]);
+    ElemType* result = reinterpret_cast<ElemType*>(m_sharedResult);
+    const size_t pieceSize = s_sharedSlotSizeInBytes / sizeof(ElemType);
+
+    for (size_t offset = 0; offset < numElements; offset += pieceSize)
+    {
+        size_t numPieceElements = std::min(pieceSize, numElements - offset);
+        memcpy(mySlot, source + offset, numPieceElements * sizeof(ElemType));
+        LocalBarrier();
+
+        size_t shareSize = (numPieceElements + m_localSize - 1) / m_localSize;
+        size_t begin = std::min(numPieceElements, m_localRank * shareSize);
+        size_t end = std::min(numPieceElements, begin + shareSize);
+        memcpy(result + begin, reinterpret_cast<const ElemType*>(m_sharedSlots[0]) + begin, (end - begin) * sizeof(ElemType));
+        for (int r = 1; r < m_localSize; r++)
+        {
+            const ElemType* slot = reinterpret_cast<const ElemType*>(m_sharedSlots[r]);
+            for (size_t i = begin; i < end; i++)
+                result[i] += slot[i];
+        }
+        LocalBarrier();
+
+        if (m_leaderComm != MPI_COMM_NULL)
+            MPI_Allreduce(MPI_IN_PLACE, result, (int)numPieceElements, GetDataType(result), MPI_SUM, m_leaderComm) || MpiFail("HierarchicalAllReduce: MPI_Allreduce");
+        LocalBarrier();
+
+        // The next piece writes to the slots and the result only after the barrier following its first copy,
+        // i.e. once every rank is done reading this piece.
+        memcpy(receiveData + offset, result, numPieceElements * sizeof(ElemType));
+    }
+}
+
+// Callbacks of the generalized requests that stand for a queued hierarchical all-reduce
+static int QueryAsyncAllReduce(void* /*extraState*/, MPI_Status* status)
+{
+    MPI_Status_set_elements(status, MPI_BYTE, 0);
+    MPI_Status_set_cancelled(status, 0);
+    status->MPI_SOURCE = MPI_UNDEFINED;
+    status->MPI_TAG = MPI_UNDEFINED;
+    return MPI_SUCCESS;
+}
+
+static int FreeAsyncAllReduce(void* /*extraState*/)
+{
+    return MPI_SUCCESS;
+}
+
+static int CancelAsyncAllReduce(void* /*extraState*/, int /*complete*/)
+{
+    return MPI_SUCCESS; // a queued all-reduce cannot be cancelled, since the other ranks take part in it
+}
+
+template <class ElemType>
+void MPIWrapperMpi::HierarchicalAllReduceAsync(const ElemType* sendData, ElemType* receiveData, size_t numElements, MPI_Request* request) const
+{
+    {
+        std::lock_guard<std::mutex> mpiLock(m_mpiMutex);
+        MPI_Grequest_start(QueryAsyncAllReduce, FreeAsyncAllReduce, CancelAsyncAllReduce, nullptr, request) || MpiFail("AllReduceAsync: MPI_Grequest_start");
+    }
+
+    MPI_Request completion = *request;
+    {
+        std::lock_guard<std::mutex> lock(m_asyncAllReduceMutex);
+        m_asyncAllReduces.push_back([this, sendData, receiveData, numElements, completion]()
+        {
+            HierarchicalAllReduce(sendData, receiveData, numElements);
+            MPI_Grequest_complete(completion) || MpiFail("AllReduceAsync: MPI_Grequest_complete");
+        });
+    }
+    m_asyncAllReduceCondition.notify_all();
+}
+
+// Body of the helper thread. All ranks queue the same all-reduces in the same order, and all of them run them in that order.
+void MPIWrapperMpi::RunAsyncAllReduces()
+{
+    for (;;)
+    {
+        std::function<void()> allReduce;
+        {
+            std::unique_lock<std::mutex> lock(m_asyncAllReduceMutex);
+            m_asyncAllReduceCondition.wait(lock, [this]() { return m_stopAsyncAllReduceThread || !m_asyncAllReduces.empty(); });
+            if (m_asyncAllReduces.empty())
+                return;
+            allReduce = m_asyncAllReduces.front();
+        }
+
+        try
+        {
+            std::lock_guard<std::mutex> mpiLock(m_mpiMutex);
+            allReduce();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(m_asyncAllReduceMutex);
+            if (!m_asyncAllReduceError)
+                m_asyncAllReduceError = std::current_exception(); // rethrown by the next call on the main thread
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_asyncAllReduceMutex);
+            m_asyncAllReduces.pop_front();
+        }
+        m_asyncAllReduceCondition.notify_all();
+    }
+}
+
+void MPIWrapperMpi::WaitForAsyncAllReduces() const
+{
+    std::unique_lock<std::mutex> lock(m_asyncAllReduceMutex);
+    m_asyncAllReduceCondition.wait(lock, [this]() { return m_asyncAllReduces.empty(); });
+    if (m_asyncAllReduceError)
+    {
+        std::exception_ptr error = m_asyncAllReduceError;
+        m_asyncAllReduceError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void MPIWrapperMpi::StopAsyncAllReduceThread()
+{
+    if (!m_asyncAllReduceThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_asyncAllReduceMutex);
+        m_stopAsyncAllReduceThread = true;
+    }
+    m_asyncAllReduceCondition.notify_all();
+    m_asyncAllReduceThread.join(); // after it has run the queued all-reduces
+    WaitForAsyncAllReduces();      // rethrows a failure of one of them
 }
 
 bool MPIWrapperMpi::IsMultiHost() const
@@ -626,53 +951,71 @@ MPI_Comm MPIWrapperMpi::Communicator() const
 
 int MPIWrapperMpi::Finalize(void)
 {
+    FreeHierarchicalAllReduce();
     return MPI_Finalize();
 }
 
 // wait for all ranks to reach here
 int MPIWrapperMpi::WaitAll()
 {
+    WaitForAsyncAllReduces();
     return MPI_Barrier(m_currentComm) || MpiFail("waitall: MPI_Barrier");
 }
 
 int MPIWrapperMpi::Wait(MPI_Request* request, MPI_Status* status)
 {
+    WaitForAsyncAllReduces();
     return MPI_Wait(request, status);
 }
 
 int MPIWrapperMpi::WaitAll(std::vector<MPI_Request>& requests)
 {
+    WaitForAsyncAllReduces();
     return MPI_Waitall((int)requests.size(), &requests[0], MPI_STATUSES_IGNORE) || MpiFail("waitall: MPI_Waitall");
 }
 
 int MPIWrapperMpi::Waitany(int count, MPI_Request array_of_requests[], int* index, MPI_Status* status)
 {
+    WaitForAsyncAllReduces();
     return MPI_Waitany(count, array_of_requests, index, status);
 }
 
 int MPIWrapperMpi::Waitall(int count, MPI_Request array_of_requests[], MPI_Status array_of_statuses[])
 {
+    WaitForAsyncAllReduces();
     return MPI_Waitall(count, array_of_requests, array_of_statuses);
 }
 
 int MPIWrapperMpi::Isend(const void* buf, int count, MPI_Datatype datatype, int dest, int tag, MPI_Request* request)
 {
+    std::lock_guard<std::mutex> mpiLock(m_mpiMutex);
     return MPI_Isend(buf, count, datatype, dest, tag, m_currentComm, request);
 }
 
 int MPIWrapperMpi::Recv(void* buf, int count, MPI_Datatype datatype, int source, int tag, MPI_Status* status)
 {
+    WaitForAsyncAllReduces();
     return MPI_Recv(buf, count, datatype, source, tag, m_currentComm, status);
 }
 
 int MPIWrapperMpi::Irecv(void* buf, int count, MPI_Datatype datatype, int source, int tag, MPI_Request* request)
 {
+    std::lock_guard<std::mutex> mpiLock(m_mpiMutex);
     return MPI_Irecv(buf, count, datatype, source, tag, m_currentComm, request);
 }
 
 int MPIWrapperMpi::Iallreduce(const void* sendbuf, void* recvbuf, int count, MPI_Datatype datatype, MPI_Op op, MPI_Request* request)
 {
-    return MPI_Iallreduce(sendbuf, recvbuf, count, datatype, op, m_currentComm, request);
+    if (datatype == MPI_FLOAT && UseHierarchicalAllReduce(count, sizeof(float), op))
+        HierarchicalAllReduceAsync(static_cast<const float*>(sendbuf), static_cast<float*>(recvbuf), count, request);
+    else if (datatype == MPI_DOUBLE && UseHierarchicalAllReduce(count, sizeof(double), op))
+        HierarchicalAllReduceAsync(static_cast<const double*>(sendbuf), static_cast<double*>(recvbuf), count, request);
+    else
+    {
+        std::lock_guard<std::mutex> mpiLock(m_mpiMutex);
+        return MPI_Iallreduce(sendbuf, recvbuf, count, datatype, op, m_currentComm, request);
+    }
+    return MPI_SUCCESS;
 }
 
 int MPIWrapperMpi::Abort(int errorcode)
@@ -686,6 +1029,54 @@ int MPIWrapperMpi::Error_string(int errorcode, char* str, int* resultlen)
     return MPI_Error_string(errorcode, str, resultlen);
 }
 
+int MPIWrapperMpi::Win_allocate(size_t sizeInBytes, int displacementUnit, void* baseptr, MPI_Win* win)
+{
+    WaitForAsyncAllReduces();
+    return MPI_Win_allocate((MPI_Aint)sizeInBytes, displacementUnit, MPI_INFO_NULL, m_currentComm, baseptr, win);
+}
+
+int MPIWrapperMpi::Win_free(MPI_Win* win)
+{
+    WaitForAsyncAllReduces();
+    return MPI_Win_free(win);
+}
+
+int MPIWrapperMpi::Win_lock_all(MPI_Win win)
+{
+    WaitForAsyncAllReduces();
+    return MPI_Win_lock_all(0, win);
+}
+
+int MPIWrapperMpi::Win_unlock_all(MPI_Win win)
+{
+    WaitForAsyncAllReduces();
+    return MPI_Win_unlock_all(win);
+}
+
+int MPIWrapperMpi::Win_flush_all(MPI_Win win)
+{
+    WaitForAsyncAllReduces();
+    return MPI_Win_flush_all(win);
+}
+
+int MPIWrapperMpi::Get(void* resultAddr, int count, MPI_Datatype datatype, int targetRank, size_t targetDisplacement, MPI_Win win)
+{
+    std::lock_guard<std::mutex> mpiLock(m_mpiMutex);
+    return MPI_Get(resultAddr, count, datatype, targetRank, (MPI_Aint)targetDisplacement, count, datatype, win);
+}
+
+int MPIWrapperMpi::Accumulate(const void* originAddr, int count, MPI_Datatype datatype, int targetRank, size_t targetDisplacement, MPI_Op op, MPI_Win win)
+{
+    std::lock_guard<std::mutex> mpiLock(m_mpiMutex);
+    return MPI_Accumulate(originAddr, count, datatype, targetRank, (MPI_Aint)targetDisplacement, count, datatype, op, win);
+}
+
+int MPIWrapperMpi::Get_accumulate(const void* originAddr, void* resultAddr, int count, MPI_Datatype datatype, int targetRank, size_t targetDisplacement, MPI_Op op, MPI_Win win)
+{
+    std::lock_guard<std::mutex> mpiLock(m_mpiMutex);
+    return MPI_Get_accumulate(originAddr, count, datatype, resultAddr, count, datatype, targetRank, (MPI_Aint)targetDisplacement, count, datatype, op, win);
+}
+
 bool MPIWrapperMpi::UseGpuGdr()
 {
     // Only support GPUDirect RDMA on Unix and built with GDR
@@ -791,26 +1182,37 @@ void MPIWrapperMpi::AllReduce(float* sendData, size_t numElements, MPI_Op op) co
 
 void MPIWrapperMpi::AllReduce(size_t* sendData, size_t* receiveData, size_t numElements, MPI_Op op) const
 {
+    WaitForAsyncAllReduces();
     MPI_Allreduce(sendData, receiveData, (int)numElements, GetDataType(sendData), op, Communicator()) || MpiFail("Allreduce: MPI_Allreduce");
 }
 
 void MPIWrapperMpi::AllReduce(int* sendData, int* receiveData, size_t numElements, MPI_Op op) const
 {
+    WaitForAsyncAllReduces();
     MPI_Allreduce(sendData, receiveData, (int)numElements, GetDataType(sendData), op, Communicator()) || MpiFail("Allreduce: MPI_Allreduce");
 }
 
 void MPIWrapperMpi::AllReduce(double* sendData, double* receiveData, size_t numElements, MPI_Op op) const
 {
-    MPI_Allreduce(sendData, receiveData, (int)numElements, GetDataType(sendData), op, Communicator()) || MpiFail("Allreduce: MPI_Allreduce");
+    WaitForAsyncAllReduces();
+    if (UseHierarchicalAllReduce(numElements, sizeof(double), op))
+        HierarchicalAllReduce(sendData, receiveData, numElements);
+    else
+        MPI_Allreduce(sendData, receiveData, (int)numElements, GetDataType(sendData), op, Communicator()) || MpiFail("Allreduce: MPI_Allreduce");
 }
 
 void MPIWrapperMpi::AllReduce(float* sendData, float* receiveData, size_t numElements, MPI_Op op) const
 {
-    MPI_Allreduce(sendData, receiveData, (int)numElements, GetDataType(sendData), op, Communicator()) || MpiFail("Allreduce: MPI_Allreduce");
+    WaitForAsyncAllReduces();
+    if (UseHierarchicalAllReduce(numElements, sizeof(float), op))
+        HierarchicalAllReduce(sendData, receiveData, numElements);
+    else
+        MPI_Allreduce(sendData, receiveData, (int)numElements, GetDataType(sendData), op, Communicator()) || MpiFail("Allreduce: MPI_Allreduce");
 }
 
 void MPIWrapperMpi::Bcast(size_t* sendData, size_t numElements, size_t srcRank)
 {
+    WaitForAsyncAllReduces();
     MPI_Bcast(sendData, (int)numElements, GetDataType(sendData), (int)srcRank, Communicator()) || MpiFail("Bcast: MPI_Bcast");
 }
 
@@ -836,136 +1238,191 @@ void MPIWrapperMpi::AllReduceAsync(float* sendData, size_t numElements, MPI_Requ
 
 void MPIWrapperMpi::AllReduceAsync(size_t *sendData, size_t *receiveData, size_t numElements, MPI_Request* request, MPI_Op op) const
 {
+    std::lock_guard<std::mutex> mpiLock(m_mpiMutex);
     MPI_Iallreduce(sendData, receiveData, (int)numElements, GetDataType(sendData), op, Communicator(), request) || MpiFail("AllReduceAsync: MPI_Iallreduce");
 }
 
 void MPIWrapperMpi::AllReduceAsync(int *sendData, int *receiveData, size_t numElements, MPI_Request* request, MPI_Op op) const
 {
+    std::lock_guard<std::mutex> mpiLock(m_mpiMutex);
     MPI_Iallreduce(sendData, receiveData, (int)numElements, GetDataType(sendData), op, Communicator(), request) || MpiFail("AllReduceAsync: MPI_Iallreduce");
 }
 void MPIWrapperMpi::AllReduceAsync(double *sendData, double *receiveData, size_t numElements, MPI_Request* request, MPI_Op op) const
 {
-    MPI_Iallreduce(sendData, receiveData, (int)numElements, GetDataType(sendData), op, Communicator(), request) || MpiFail("AllReduceAsync: MPI_Iallreduce");
+    if (UseHierarchicalAllReduce(numElements, sizeof(double), op))
+        HierarchicalAllReduceAsync(sendData, receiveData, numElements, request);
+    else
+    {
+        std::lock_guard<std::mutex> mpiLock(m_mpiMutex);
+        MPI_Iallreduce(sendData, receiveData, (int)numElements, GetDataType(sendData), op, Communicator(), request) || MpiFail("AllReduceAsync: MPI_Iallreduce");
+    }
 }
 void MPIWrapperMpi::AllReduceAsync(float *sendData, float *receiveData, size_t numElements, MPI_Request* request, MPI_Op op) const
 {
-    MPI_Iallreduce(sendData, receiveData, (int)numElements, GetDataType(sendData), op, Communicator(), request) || MpiFail("AllReduceAsync: MPI_Iallreduce");
+    if (UseHierarchicalAllReduce(numElements, sizeof(float), op))
+        HierarchicalAllReduceAsync(sendData, receiveData, numElements, request);
+    else
+    {
+        std::lock_guard<std::mutex> mpiLock(m_mpiMutex);
+        MPI_Iallreduce(sendData, receiveData, (int)numElements, GetDataType(sendData), op, Communicator(), request) || MpiFail("AllReduceAsync: MPI_Iallreduce");
+    }
 }
 
 
 void MPIWrapperMpi::Bcast(double* sendData, size_t numElements, size_t srcRank)
 {
+    WaitForAsyncAllReduces();
     MPI_Bcast(sendData, (int)numElements, GetDataType(sendData), (int)srcRank, Communicator()) || MpiFail("Bcast: MPI_Bcast");
 }
 
 void MPIWrapperMpi::Bcast(float* sendData, size_t numElements, size_t srcRank)
 {
+    WaitForAsyncAllReduces();
     MPI_Bcast(sendData, (int)numElements, GetDataType(sendData), (int)srcRank, Communicator()) || MpiFail("Bcast: MPI_Bcast");
 }
 
 void MPIWrapperMpi::Bcast(void* buffer, int count, MPI_Datatype datatype, int root)
 {
+    WaitForAsyncAllReduces();
     MPI_Bcast(buffer, count, datatype, root, Communicator()) || MpiFail("Bcast: MPI_Bcast");
 }
 
 void MPIWrapperMpi::AllGatherAsync(const size_t *sendData, size_t numSendElements, size_t *receiveData, size_t numRecvElements, MPI_Request* request) const
 {
+    std::lock_guard<std::mutex> mpiLock(m_mpiMutex);
     MPI_Iallgather(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, (int)numRecvElements, GetDataType(receiveData), Communicator(), request) || MpiFail("AllReduceAsync: MPI_Iallgather");
 }
 
 void MPIWrapperMpi::AllGatherAsync(const int *sendData, size_t numSendElements, int *receiveData, size_t numRecvElements, MPI_Request* request) const
 {
+    std::lock_guard<std::mutex> mpiLock(m_mpiMutex);
     MPI_Iallgather(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, (int)numRecvElements, GetDataType(receiveData), Communicator(), request) || MpiFail("AllReduceAsync: MPI_Iallgather");
 }
 
 void MPIWrapperMpi::AllGatherAsync(const float *sendData, size_t numSendElements, float *receiveData, size_t numRecvElements, MPI_Request* request) const
 {
+    std::lock_guard<std::mutex> mpiLock(m_mpiMutex);
     MPI_Iallgather(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, (int)numRecvElements, GetDataType(receiveData), Communicator(), request) || MpiFail("AllReduceAsync: MPI_Iallgather");
 }
 
 void MPIWrapperMpi::AllGatherAsync(const double *sendData, size_t numSendElements, double *receiveData, size_t numRecvElements, MPI_Request* request) const
 {
+    std::lock_guard<std::mutex> mpiLock(m_mpiMutex);
     MPI_Iallgather(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, (int)numRecvElements, GetDataType(receiveData), Communicator(), request) || MpiFail("AllReduceAsync: MPI_Iallgather");
 }
 
 void MPIWrapperMpi::AllGather(const size_t *sendData, size_t numSendElements, size_t *receiveData, size_t numRecvElements) const
 {
+    WaitForAsyncAllReduces();
     MPI_Allgather(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, (int)numRecvElements, GetDataType(receiveData), Communicator()) || MpiFail("AllReduceAsync: MPI_Allgather");
 }
 
 void MPIWrapperMpi::AllGather(const int *sendData, size_t numSendElements, int *receiveData, size_t numRecvElements) const
 {
+    WaitForAsyncAllReduces();
     MPI_Allgather(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, (int)numRecvElements, GetDataType(receiveData), Communicator()) || MpiFail("AllReduceAsync: MPI_Allgather");
 }
 
 void MPIWrapperMpi::AllGather(const float *sendData, size_t numSendElements, float *receiveData, size_t numRecvElements) const
 {
+    WaitForAsyncAllReduces();
     MPI_Allgather(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, (int)numRecvElements, GetDataType(receiveData), Communicator()) || MpiFail("AllReduceAsync: MPI_Allgather");
 }
 
 void MPIWrapperMpi::AllGather(const double *sendData, size_t numSendElements, double*receiveData, size_t numRecvElements) const
 {
+    WaitForAsyncAllReduces();
     MPI_Allgather(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, (int)numRecvElements, GetDataType(receiveData), Communicator()) || MpiFail("AllReduceAsync: MPI_Allgather");
 }
 
 void MPIWrapperMpi::Allgather(const void* sendbuf, int sendcount, MPI_Datatype sendtype, void* recvbuf, int recvcount, MPI_Datatype recvtype) const
 {
+    WaitForAsyncAllReduces();
     MPI_Allgather(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, Communicator()) || MpiFail("AllReduceAsync: MPI_Allgather");
 }
 
 void MPIWrapperMpi::Gather(const size_t *sendData, size_t numSendElements, size_t *receiveData, size_t numRecvElements, size_t rootRank) const
 {
+    WaitForAsyncAllReduces();
     MPI_Gather(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, (int)numRecvElements, GetDataType(receiveData), (int)rootRank, Communicator()) || MpiFail("AllReduceAsync: MPI_Gather");
 }
 
 void MPIWrapperMpi::Gather(const int *sendData, size_t numSendElements, int *receiveData, size_t numRecvElements, size_t rootRank) const
 {
+    WaitForAsyncAllReduces();
     MPI_Gather(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, (int)numRecvElements, GetDataType(receiveData), (int)rootRank, Communicator()) || MpiFail("AllReduceAsync: MPI_Gather");
 }
 
 void MPIWrapperMpi::Gather(const float *sendData, size_t numSendElements, float *receiveData, size_t numRecvElements, size_t rootRank) const
 {
+    WaitForAsyncAllReduces();
     MPI_Gather(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, (int)numRecvElements, GetDataType(receiveData), (int)rootRank, Communicator()) || MpiFail("AllReduceAsync: MPI_Gather");
 }
 
 void MPIWrapperMpi::Gather(const double *sendData, size_t numSendElements, double *receiveData, size_t numRecvElements, size_t rootRank) const
 {
+    WaitForAsyncAllReduces();
     MPI_Gather(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, (int)numRecvElements, GetDataType(receiveData), (int)rootRank, Communicator()) || MpiFail("AllReduceAsync: MPI_Gather");
 }
 
 void MPIWrapperMpi::Gatherv(const size_t *sendData, size_t numSendElements, size_t *receiveData, int recvCounts[], int offsets[], size_t rootRank) const
 {
+    WaitForAsyncAllReduces();
     MPI_Gatherv(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, recvCounts, offsets, GetDataType(receiveData), (int)rootRank, Communicator()) || MpiFail("AllReduceAsync: MPI_Gatherv");
 }
 
 void MPIWrapperMpi::Gatherv(const char *sendData, size_t numSendElements, char *receiveData, int recvCounts[], int offsets[], size_t rootRank) const
 {
+    WaitForAsyncAllReduces();
     MPI_Gatherv(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, recvCounts, offsets, GetDataType(receiveData), (int)rootRank, Communicator()) || MpiFail("AllReduceAsync: MPI_Gatherv");
 }
 
 void MPIWrapperMpi::Gatherv(const int *sendData, size_t numSendElements, int *receiveData, int recvCounts[], int offsets[], size_t rootRank) const
 {
+    WaitForAsyncAllReduces();
     MPI_Gatherv(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, recvCounts, offsets, GetDataType(receiveData), (int)rootRank, Communicator()) || MpiFail("AllReduceAsync: MPI_Gatherv");
 }
 
 void MPIWrapperMpi::Gatherv(const float *sendData, size_t numSendElements, float *receiveData, int recvCounts[], int offsets[], size_t rootRank) const
 {
+    WaitForAsyncAllReduces();
     MPI_Gatherv(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, recvCounts, offsets, GetDataType(receiveData), (int)rootRank, Communicator()) || MpiFail("AllReduceAsync: MPI_Gatherv");
 }
 
 void MPIWrapperMpi::Gatherv(const double *sendData, size_t numSendElements, double *receiveData, int recvCounts[], int offsets[], size_t rootRank) const
 {
+    WaitForAsyncAllReduces();
     MPI_Gatherv(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, recvCounts, offsets, GetDataType(receiveData), (int)rootRank, Communicator()) || MpiFail("AllReduceAsync: MPI_Gatherv");
 }
 
+void MPIWrapperMpi::AllGatherv(const int *sendData, size_t numSendElements, int *receiveData, int recvCounts[], int offsets[]) const
+{
+    WaitForAsyncAllReduces();
+    MPI_Allgatherv(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, recvCounts, offsets, GetDataType(receiveData), Communicator()) || MpiFail("AllGatherv: MPI_Allgatherv");
+}
+
+void MPIWrapperMpi::AllGatherv(const float *sendData, size_t numSendElements, float *receiveData, int recvCounts[], int offsets[]) const
+{
+    WaitForAsyncAllReduces();
+    MPI_Allgatherv(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, recvCounts, offsets, GetDataType(receiveData), Communicator()) || MpiFail("AllGatherv: MPI_Allgatherv");
+}
+
+void MPIWrapperMpi::AllGatherv(const double *sendData, size_t numSendElements, double *receiveData, int recvCounts[], int offsets[]) const
+{
+    WaitForAsyncAllReduces();
+    MPI_Allgatherv(sendData, (int)numSendElements, GetDataType(receiveData), receiveData, recvCounts, offsets, GetDataType(receiveData), Communicator()) || MpiFail("AllGatherv: MPI_Allgatherv");
+}
+
 // wait for an async request to finish
 void MPIWrapperMpi::Wait(MPI_Request* request)
 {
+    WaitForAsyncAllReduces();
     MPI_Wait(request, MPI_STATUSES_IGNORE) || MpiFail("Wait: MPI_Wait");
 }
 
 void MPIWrapperMpi::WaitAny(MPI_Request* requests, int numRequests, int* index)
 {
+    WaitForAsyncAllReduces();
     MPI_Waitany(numRequests, requests, index, MPI_STATUSES_IGNORE) || MpiFail("WaitAny: MPI_Waitany");
 }
 
@@ -1063,6 +1520,46 @@ int MPIWrapperEmpty::Abort(int errorcode)
     return MPI_UNDEFINED;
 }
 
+int MPIWrapperEmpty::Win_allocate(size_t sizeInBytes, int displacementUnit, void* baseptr, MPI_Win* win)
+{
+    return MPI_UNDEFINED;
+}
+
+int MPIWrapperEmpty::Win_free(MPI_Win* win)
+{
+    return MPI_UNDEFINED;
+}
+
+int MPIWrapperEmpty::Win_lock_all(MPI_Win win)
+{
+    return MPI_UNDEFINED;
+}
+
+int MPIWrapperEmpty::Win_unlock_all(MPI_Win win)
+{
+    return MPI_UNDEFINED;
+}
+
+int MPIWrapperEmpty::Win_flush_all(MPI_Win win)
+{
+    return MPI_UNDEFINED;
+}
+
+int MPIWrapperEmpty::Get(void* resultAddr, int count, MPI_Datatype datatype, int targetRank, size_t targetDisplacement, MPI_Win win)
+{
+    return MPI_UNDEFINED;
+}
+
+int MPIWrapperEmpty::Accumulate(const void* originAddr, int count, MPI_Datatype datatype, int targetRank, size_t targetDisplacement, MPI_Op op, MPI_Win win)
+{
+    return MPI_UNDEFINED;
+}
+
+int MPIWrapperEmpty::Get_accumulate(const void* originAddr, void* resultAddr, int count, MPI_Datatype datatype, int targetRank, size_t targetDisplacement, MPI_Op op, MPI_Win win)
+{
+    return MPI_UNDEFINED;
+}
+
 int MPIWrapperEmpty::Error_string(int errorcode, char* str, int* resultlen)
 {
     if (!str || !resultlen)
@@ -1277,6 +1774,18 @@ void MPIWrapperEmpty::Gatherv(const double *sendData, size_t numSendElements, do
 {
 }
 
+void MPIWrapperEmpty::AllGatherv(const int *sendData, size_t numSendElements, int *receiveData, int recvCounts[], int offsets[]) const
+{
+}
+
+void MPIWrapperEmpty::AllGatherv(const float *sendData, size_t numSendElements, float *receiveData, int recvCounts[], int offsets[]) const
+{
+}
+
+void MPIWrapperEmpty::AllGatherv(const double *sendData, size_t numSendElements, double *receiveData, int recvCounts[], int offsets[]) const
+{
+}
+
 
 void MPIWrapperEmpty::Wait(MPI_Request* request)
 {
@@ -681,6 +681,25 @@ void renameOrDie(const std::wstring& from, const std::wstring& to)
 #endif
 }
 
+// ----------------------------------------------------------------------------
+// replaceFileOrDie(): rename 'from' over an existing 'to' in one step
+// ----------------------------------------------------------------------------
+
+void replaceFileOrDie(const std::wstring& from, const std::wstring& to)
+{
+#ifdef _WIN32
+    if (!MoveFileExW(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+        RuntimeError("error replacing file '%ls' by '%ls': %d", to.c_str(), from.c_str(), GetLastError());
+#else
+    // rename() replaces the target atomically
+    if (rename(wtocharpath(from.c_str()).c_str(), wtocharpath(to.c_str()).c_str()) == 0)
+        return;
+    // fall back to renameOrDie() on file systems that cannot rename over a file (see the HDFS FUSE workaround there)
+    fprintf(stderr, "Warning: replacing file '%ls' failed (%s), deleting it first.\n", to.c_str(), strerror(errno));
+    renameOrDie(from, to);
+#endif
+}
+
 // ----------------------------------------------------------------------------
 // copyOrDie(): copy file with error handling.
 // ----------------------------------------------------------------------------
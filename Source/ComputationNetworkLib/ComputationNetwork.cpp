@@ -102,12 +102,52 @@ void ComputationNetwork::Save(const wstring& fileName, const FileOptions fileFor
     renameOrDie(tmpFileName, fileName);
 }
 
-// TODO: how does the file distinguish float vs double nodes?
+template <class ElemType>
+static MatrixBasePtr CPUCopyOfValue(const ComputationNodeBasePtr& node)
+{
+    auto copy = make_shared<Matrix<ElemType>>(CPUDEVICE);
+    copy->AssignValuesOf(node->As<ComputationNode<ElemType>>()->Value());
+    return copy;
+}
+
+shared_ptr<ComputationNodeBase::ValueSnapshot> ComputationNetwork::TakeValueSnapshot() const
+{
+    VerifyIsCompiled("TakeValueSnapshot");
+    auto snapshot = make_shared<ComputationNodeBase::ValueSnapshot>();
+    for (const auto& iter : m_nameToNodeMap)
+    {
+        // only the nodes whose Save() writes their value
+        const auto& node = iter.second;
+        if (node->OperationName() != OperationNameOf(LearnableParameter) && !node->Is<IPreComputeNode>())
+            continue;
+
+        if (node->Is<ComputationNode<float>>())
+            (*snapshot)[iter.first] = CPUCopyOfValue<float>(node);
+        else
+            (*snapshot)[iter.first] = CPUCopyOfValue<double>(node);
+    }
+    return snapshot;
+}
+
+void ComputationNetwork::Save(File& fstream, const ComputationNodeBase::ValueSnapshot& snapshot) const
+{
+    VerifyIsCompiled("Save");
+    ComputationNodeBase::SetValueSnapshotForSave(&snapshot);
+    auto resetSnapshot = MakeScopeExit([]() { ComputationNodeBase::SetValueSnapshotForSave(nullptr); });
+    SaveToFileImpl(fstream);
+}
+
 void ComputationNetwork::SaveToFileImpl(const wstring& fileName, const FileOptions fileFormat) const
 {
     File fstream(fileName, fileFormat | FileOptions::fileOptionsWrite);
     // Buffer writes in memory then flush to filesystem, which reduces number of small writes
     fstream.Setvbuf();
+    SaveToFileImpl(fstream);
+}
+
+// TODO: how does the file distinguish float vs double nodes?
+void ComputationNetwork::SaveToFileImpl(File& fstream) const
+{
     fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BCN");
 
     // model version
@@ -275,6 +315,7 @@ void ComputationNetwork::Read(const wstring& fileName)
     ClearNetwork();
 
     File fstream(fileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsRead);
+    fstream.Setvbuf(); // the model header and node list are many small reads
 
     auto modelVersion = GetModelVersion(fstream);
 
@@ -29,6 +29,7 @@
 #include <chrono>
 #include <unordered_map>
 #include <set>
+#include <functional>
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -73,6 +74,11 @@ public:
     void ClearNetwork();
     void InvalidateCompiledNetwork();
 
+    // create a compiled copy of this network whose parameters share their value matrices with this network
+    // Each copy owns its own activations, so copies can be evaluated concurrently, e.g. one per thread.
+    // Parameters must not be modified while copies exist.
+    shared_ptr<ComputationNetwork> CloneWithSharedParameters() const;
+
     void SetDeviceId(DEVICEID_TYPE deviceId)
     {
         m_deviceId = deviceId;
@@ -95,6 +101,7 @@ public:
     void RereadPersistableParameters(const std::wstring& fileName)
     {
         File fstream(fileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsRead);
+        fstream.Setvbuf();
         auto modelVersion = GetModelVersion(fstream);
         ReadPersistableParameters<ElemType>(modelVersion, fstream, false);
     }
@@ -118,11 +125,16 @@ public:
     }
 
     void Save(const std::wstring& fileName, const FileOptions fileFormat = FileOptions::fileOptionsBinary) const;
+    // Checkpoints written in the background: the training thread takes CPU copies of all values that Save() writes
+    // (parameters and precomputed statistics), and the writer thread saves the model with them, while training goes on.
+    std::shared_ptr<ComputationNodeBase::ValueSnapshot> TakeValueSnapshot() const;
+    void Save(File& fstream, const ComputationNodeBase::ValueSnapshot& snapshot) const;
     void SaveEdited(const std::wstring& fileName, const FileOptions fileFormat = FileOptions::fileOptionsBinary);
 
 private:
 
     void SaveToFileImpl(const std::wstring& fileName, const FileOptions fileFormat) const;
+    void SaveToFileImpl(File& fstream) const;
     
     static size_t GetModelVersion(File& fstream);
 
@@ -141,6 +153,10 @@ public:
     // main entry point for backprop
     void Backprop(const ComputationNodeBasePtr rootNode);
 
+    // same, but calls 'onGradientComplete' for each node as soon as its gradient is final, i.e. right after
+    // the backward traversal has passed all of the node's consumers (used to overlap gradient aggregation with backprop)
+    void Backprop(const ComputationNodeBasePtr rootNode, const std::function<void(const ComputationNodeBasePtr&)>& onGradientComplete);
+
     template <class NODESET> // version that takes multiple nodes
     void TravserseInSortedGlobalEvalOrder(const NODESET& nodes, const std::function<void(const ComputationNodeBasePtr&)>& action)
     {
@@ -179,6 +195,26 @@ public:
         });
     }
 
+    // determine the sequence of nodes that ForwardProp(nodes) would visit, with recurrent loops represented by their FlowControlNode
+    // Callers that repeatedly evaluate the same set of nodes (e.g. the eval API) can determine this once and
+    // then call ForwardPropInOrder() for each minibatch, saving the graph traversal.
+    template <class NODESET>
+    std::vector<ComputationNodeBasePtr> GetForwardPropOrder(const NODESET& nodes)
+    {
+        std::vector<ComputationNodeBasePtr> order;
+        TravserseInSortedGlobalEvalOrder(nodes, [&](const ComputationNodeBasePtr& node) {
+            order.push_back(node);
+        });
+        return order;
+    }
+
+    // forward prop over a sequence of nodes previously determined by GetForwardPropOrder()
+    void ForwardPropInOrder(const std::vector<ComputationNodeBasePtr>& order)
+    {
+        for (const auto& node : order)
+            PARTraversalFlowControlNode::ForwardProp(node, FrameRange(nullptr));
+    }
+
     template <class NODESET> // version that takes multiple nodes
     void PostForwardAndBackProp(const NODESET& nodes)
     {
@@ -471,6 +507,8 @@ public:
     void AddFeatureNode(ComputationNodeBasePtr featureNode);
     //ComputationNodeBasePtr RemoveFeatureNode(ComputationNodeBasePtr featureNode);
     void SetLearnableNodesBelowLearningRateMultiplier(const float learningRateMultiplier, const ComputationNodeBasePtr& rootNode = nullptr);
+    template <class ElemType>
+    size_t StoreConstantsInHalfPrecision();
 
     // -----------------------------------------------------------------------
     // node access
@@ -1107,6 +1145,12 @@ protected:
     // them inside a loop over all time steps of the recurrence.
     // For every time step, the entire chain of nodes is called, with the time index
     // passed as a FrameRange object.
+    //
+    // Time steps at which only some parallel sequences carry data are compacted:
+    // the set of active sequences per step is determined once per minibatch from
+    // the MBLayout's sequence table; steps without any active sequence are skipped,
+    // and steps with a single active sequence are run on that sequence's column only,
+    // provided all nodes of the loop support per-sequence FrameRanges.
     // -----------------------------------------------------------------------
 
     class SEQTraversalFlowControlNode : public FlowControlNode
@@ -1137,6 +1181,14 @@ protected:
         virtual void ReleaseMatricesAfterBackprop(MatrixPool& matrixPool);
         virtual bool IsOutOfDateWrtInputs() const override;
 
+    private:
+        void DetermineActiveSequences();
+        bool GetCompactedFrameRange(const FrameRange& fr, FrameRange& frCompacted) const;
+
+        std::vector<size_t> m_numActiveSequences;  // [t] number of parallel sequences that carry data at time step t
+        std::vector<size_t> m_lastActiveSequence;  // [t] index of a parallel sequence active at time step t (meaningful if m_numActiveSequences[t] == 1)
+        bool m_allNodesSupportPerSequenceFrameRange = false; // true if all nested nodes can be run on a single parallel sequence
+
     public:
         ComputationNodeBasePtr m_sourceNode; // one of the nodes of the loop   --TODO: What is the special meaning of this node? It seems to always be a delay node.
         int m_loopId;                        // unique loop id, index in m_allSEQNodes array
@@ -1200,6 +1252,9 @@ protected:
         // There is currently no other constructor for inner nested PAR-traversed sub-networks, but there will be.
         PARTraversalFlowControlNode(const std::vector<shared_ptr<SEQTraversalFlowControlNode>>& recurrentInfo, const std::list<ComputationNodeBasePtr>& allNodes);
         // Base::m_nestedNodes contains all top-level nodes, in evaluation order
+
+        // if set, called during Backprop() for every top-level node after its own backprop step
+        std::function<void(const ComputationNodeBasePtr&)> m_onGradientComplete;
     };
 
 public:
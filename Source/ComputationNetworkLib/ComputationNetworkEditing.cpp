@@ -10,9 +10,12 @@
 #include "ComputationNetwork.h"
 #include "InputAndParamNodes.h"
 #include "TrainingNodes.h"
+#include "LinearAlgebraNodes.h"
 #include <string>
 #include <vector>
 #include <list>
+#include <map>
+#include <algorithm>
 
 using namespace std;
 
@@ -63,6 +66,50 @@ ComputationNodeBasePtr ComputationNetwork::CopyNode(const ComputationNetwork& fr
     return pToNode;
 }
 
+// create a copy of the network for concurrent evaluation
+// All nodes are duplicated and linked up the same way, but parameters (LearnableParameters and precomputed nodes)
+// refer to the same value matrices as in this network. All other values are allocated by the copy itself
+// when AllocateAllMatrices() is called on it, so the copy costs about as much memory as the activations.
+shared_ptr<ComputationNetwork> ComputationNetwork::CloneWithSharedParameters() const
+{
+    VerifyIsCompiled("CloneWithSharedParameters");
+
+    auto net = make_shared<ComputationNetwork>(m_deviceId);
+    net->SetTraceLevel(TraceLevel());
+    net->SetTrackGapNans(GetTrackGapNaNs());
+    net->SetIsV2Library(GetIsV2Library());
+    net->SetRandomSeedOffset(GetRandomSeedOffset());
+
+    // duplicate all nodes (this also copies the group tags)
+    const auto flags = (CopyNodeFlags)(CopyNodeFlags::copyNodeValue | CopyNodeFlags::shareParameterValues | CopyNodeFlags::copyNodeAll);
+    for (const auto& iter : m_nameToNodeMap)
+        net->AddNodeToNet(iter.second->Duplicate(iter.first, flags));
+
+    // connect them the same way as in this network
+    for (const auto& iter : m_nameToNodeMap)
+    {
+        vector<ComputationNodeBasePtr> inputs;
+        for (const auto& input : iter.second->GetInputs())
+            inputs.push_back(net->GetNodeFromName(input->NodeName()));
+        net->GetNodeFromName(iter.first)->AttachInputs(inputs);
+    }
+
+    // node groups
+    auto copyGroup = [&](const vector<ComputationNodeBasePtr>& from, vector<ComputationNodeBasePtr>& to)
+    {
+        for (const auto& node : from)
+            to.push_back(net->GetNodeFromName(node->NodeName()));
+    };
+    copyGroup(m_featureNodes,    net->m_featureNodes);
+    copyGroup(m_labelNodes,      net->m_labelNodes);
+    copyGroup(m_criterionNodes,  net->m_criterionNodes);
+    copyGroup(m_evaluationNodes, net->m_evaluationNodes);
+    copyGroup(m_outputNodes,     net->m_outputNodes);
+
+    net->CompileNetwork();
+    return net;
+}
+
 // only copy a complete independent tree
 // when node name exists
 void ComputationNetwork::CopySubTree(const ComputationNetwork& fromNet,
@@ -367,4 +414,51 @@ void ComputationNetwork::SetLearnableNodesBelowLearningRateMultiplier(const floa
     }
 }
 
+// stores the constant LearnableParameters that are only used as the left operand of Times in half precision
+// Times converts them on the fly, so this halves the memory of their values, e.g. of embeddings. This is meant for
+// inference on the CPU: a network with values in half precision cannot be trained. Returns the number of parameters.
+template <class ElemType>
+size_t ComputationNetwork::StoreConstantsInHalfPrecision()
+{
+    if (GetDeviceId() != CPUDEVICE)
+        InvalidArgument("StoreConstantsInHalfPrecision: Values in half precision are only supported on the CPU.");
+
+    map<ComputationNodeBasePtr, vector<pair<ComputationNodeBasePtr, size_t>>> consumers; // node -> (consumer, input index)
+    for (const auto& node : GetAllNodes())
+        for (size_t i = 0; i < node->GetNumInputs(); i++)
+            consumers[node->Input(i)].push_back(make_pair(node, i));
+
+    auto isNetworkOutput = [this](const ComputationNodeBasePtr& node)
+    {
+        for (const auto* group : { &OutputNodes(), &EvaluationNodes(), &FinalCriterionNodes() })
+            if (find(group->begin(), group->end(), node) != group->end())
+                return true;
+        return false;
+    };
+
+    size_t numStored = 0;
+    for (const auto& node : GetAllNodes())
+    {
+        auto parameter = dynamic_pointer_cast<LearnableParameter<ElemType>>(node);
+        if (!parameter || parameter->HalfPrecisionValue() || parameter->GetLearningRateMultiplier() != 0 ||
+            parameter->Value().GetMatrixType() != DENSE || isNetworkOutput(node))
+            continue;
+
+        const auto& nodeConsumers = consumers[node];
+        bool onlyTimes = !nodeConsumers.empty() && all_of(nodeConsumers.begin(), nodeConsumers.end(), [](const pair<ComputationNodeBasePtr, size_t>& consumer)
+        {
+            return consumer.second == 0 && dynamic_pointer_cast<TimesNode<ElemType>>(consumer.first);
+        });
+        if (!onlyTimes)
+            continue;
+
+        parameter->StoreValueInHalfPrecision();
+        numStored++;
+    }
+    return numStored;
+}
+
+template size_t ComputationNetwork::StoreConstantsInHalfPrecision<float>();
+template size_t ComputationNetwork::StoreConstantsInHalfPrecision<double>();
+
 }}}
@@ -88,6 +88,15 @@ void ComputationNetwork::Backprop(const ComputationNodeBasePtr rootNode) // trai
     GetNestedNetwork(rootNode)->Backprop(FrameRange(nullptr), true, true);
 }
 
+void ComputationNetwork::Backprop(const ComputationNodeBasePtr rootNode, const std::function<void(const ComputationNodeBasePtr&)>& onGradientComplete)
+{
+    auto network = dynamic_pointer_cast<PARTraversalFlowControlNode>(GetNestedNetwork(rootNode));
+    network->m_onGradientComplete = onGradientComplete;
+    auto resetCallback = MakeScopeExit([&network]() { network->m_onGradientComplete = nullptr; });
+
+    Backprop(rootNode);
+}
+
 void ComputationNetwork::FormNestedNetwork(const ComputationNodeBasePtr& rootNode)
 {
     if (m_nestedNetworks.find(rootNode) != m_nestedNetworks.end())
@@ -186,6 +195,10 @@ ComputationNetwork::PARTraversalFlowControlNode::PARTraversalFlowControlNode(con
         node->Backprop(fr.WithLayout(node->GetMBLayout()), true /*childrenInThisLoop*/, true /*childrenInOuterLoop*/);
         node->EndBackprop();
 
+        // all consumers of 'node' come later in evaluation order, so its gradient is complete now
+        if (m_onGradientComplete)
+            m_onGradientComplete(node);
+
         // Extreme Tracing, part 2/4
         if (node->HasEnvironmentPtr() && node->Environment().ShouldDumpNode() && node->NeedsGradient())
             DumpNode<float>(node, /*dumpGradient=*/true) || DumpNode<double>(node, true);
@@ -247,11 +260,58 @@ static bool DumpNode(ComputationNodeBasePtr nodep, bool dumpGradient)
                        m_nestedNodes[0]->NodeName().c_str(), m_nestedNodes[0]->GetMBLayoutAxisString().c_str());
     }
 
+    // determine which parallel sequences carry data at which time step, for skipping gaps
+    DetermineActiveSequences();
+
     // tell all that loop is about to commence
     for (auto& node : m_nestedNodes)
         node->BeginForwardProp();
 }
 
+// determine the number of active parallel sequences for each time step from the MBLayout's sequence table
+// This is used to skip computation over gaps. E.g. if sequences in a minibatch end at different lengths,
+// the tail of the longest sequence is computed on its own column only.
+void ComputationNetwork::SEQTraversalFlowControlNode::DetermineActiveSequences()
+{
+    const auto& pMBLayout = GetMBLayout();
+    size_t T = pMBLayout->GetNumTimeSteps();
+    m_numActiveSequences.assign(T, 0);
+    m_lastActiveSequence.assign(T, SIZE_MAX);
+    for (const auto& seq : pMBLayout->GetAllSequences())
+    {
+        if (seq.seqId == GAP_SEQUENCE_ID)
+            continue;
+        size_t tBegin = (size_t)max(seq.tBegin, (ptrdiff_t)0); // (sequence may have started in a previous minibatch)
+        size_t tEnd   = min(seq.tEnd, T);                       // (or extend beyond the end of this one)
+        for (size_t t = tBegin; t < tEnd; t++)
+        {
+            m_numActiveSequences[t]++;
+            m_lastActiveSequence[t] = seq.s;
+        }
+    }
+
+    m_allNodesSupportPerSequenceFrameRange = pMBLayout->GetNumParallelSequences() > 1;
+    for (auto& node : m_nestedNodes)
+        m_allNodesSupportPerSequenceFrameRange &= node->SupportsPerSequenceFrameRange();
+}
+
+// determine the FrameRange to actually compute for time step 'fr'
+// Returns false if no sequence is active at this time step, i.e. there is nothing to compute.
+// If only a single sequence is active and all nodes support it, the FrameRange is narrowed to that sequence.
+bool ComputationNetwork::SEQTraversalFlowControlNode::GetCompactedFrameRange(const FrameRange& fr, FrameRange& frCompacted) const
+{
+    size_t t = fr.t();
+    if (t >= m_numActiveSequences.size()) // (layout changed since BeginForwardProp(); don't compact)
+        frCompacted = fr;
+    else if (m_numActiveSequences[t] == 0)
+        return false;
+    else if (m_numActiveSequences[t] == 1 && m_allNodesSupportPerSequenceFrameRange)
+        frCompacted = fr.Sequence(m_lastActiveSequence[t]);
+    else
+        frCompacted = fr;
+    return true;
+}
+
 // evaluation of a SEQTraversalFlowControlNode FlowControlNode
 // This evaluates all nodes in this FlowControlNode in SEQ mode: process the loop frame by frame in a nested loop.
 // This is where the time axis changes.
@@ -265,12 +325,16 @@ static bool DumpNode(ComputationNodeBasePtr nodep, bool dumpGradient)
     // for every time step run through all nodes in this particular loop (treat the loop like a little ComputationNetwork)
     // Note: Currently, this is limited to linear-time loops. But nothing stops the iteration below to, e.g., be a 2D iteration over an image
     // if we implement an according FrameRangeIteration.
+    // Time steps at which only a single sequence is active are computed for that sequence only; see GetCompactedFrameRange().
     FrameRangeIteration range(GetMBLayout(), m_steppingDirection);
     for (auto t = range.begin(); t != range.end(); t++)
     {
+        FrameRange frStep;
+        if (!GetCompactedFrameRange(t, frStep))
+            continue; // all gaps: nothing to compute
         for (auto& node : m_nestedNodes)
         {
-            node->ForwardProp(t);
+            node->ForwardProp(frStep);
             node->BumpEvalTimeStamp();
         }
     }
@@ -307,10 +371,13 @@ static bool DumpNode(ComputationNodeBasePtr nodep, bool dumpGradient)
     FrameRangeIteration range(pMBLayout, m_steppingDirection);
     for (auto t = range.rbegin(); t != range.rend(); t++) // note: reverse iteration
     {
+        FrameRange frStep;
+        if (!GetCompactedFrameRange(t, frStep))
+            continue; // all gaps: nothing to back-propagate
         for (auto nodeIter2 = recurrentNodes.rbegin(); nodeIter2 != recurrentNodes.rend(); ++nodeIter2)
         {
             auto& node2 = *nodeIter2;
-            node2->Backprop(t, true /*childrenInThisLoop*/, false /*childrenInOuterLoop*/);
+            node2->Backprop(frStep, true /*childrenInThisLoop*/, false /*childrenInOuterLoop*/);
             // The above flags tell Backprop() to skip back-propagation from inside a node into
             // a node that is outside the loop, which is done later in EndBackprop() in PAR mode.
         }
@@ -1096,6 +1096,22 @@ template WriteFormattingOptions::WriteFormattingOptions(const ScriptableObjects:
 
 atomic_ullong TimeStamp::s_timeStampCounter = ATOMIC_VAR_INIT(0);
 
+// the snapshot saved on this thread, if any (see ComputationNetwork::Save(File&, const ValueSnapshot&))
+static THREAD_LOCAL const ComputationNodeBase::ValueSnapshot* t_valueSnapshotForSave = nullptr;
+
+/*static*/ void ComputationNodeBase::SetValueSnapshotForSave(const ValueSnapshot* snapshot)
+{
+    t_valueSnapshotForSave = snapshot;
+}
+
+/*static*/ const MatrixBase* ComputationNodeBase::GetValueSnapshotForSave(const wstring& nodeName)
+{
+    if (!t_valueSnapshotForSave)
+        return nullptr;
+    auto iter = t_valueSnapshotForSave->find(nodeName);
+    return (iter != t_valueSnapshotForSave->end()) ? iter->second.get() : nullptr;
+}
+
 template <> map<size_t, map<size_t, shared_ptr<SingleMatrix>>> ComputationNode<float>::s_constOnes{};
 template <> map<size_t, map<size_t, shared_ptr<DoubleMatrix>>> ComputationNode<double>::s_constOnes{};
 
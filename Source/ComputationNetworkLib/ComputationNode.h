@@ -70,7 +70,8 @@ enum CopyNodeFlags // flags to be passed to the CopyTo() function
     copyNodeValue          = 1, // copy everything except for the input links
     copyNodeInputLinks     = 2, // copy over input links
     copyNodeAll            = 3, // copy everything
-    copyNodeAcrossNetworks = 4  // allow a cross network child copy
+    copyNodeAcrossNetworks = 4, // allow a cross network child copy
+    shareParameterValues   = 8  // with copyNodeValue: parameters share their value matrix with the original, other nodes get no value copied
 };
 
 #pragma region base computation class
@@ -794,6 +795,11 @@ public:
     virtual void InvalidateMissingValueColumns(const FrameRange&) = 0;
     virtual void InvalidateMissingGradientColumns(const FrameRange&) = 0;
 
+    // Can ForwardProp() and Backprop() be called with a FrameRange that refers to a single parallel sequence
+    // (FrameRange::Sequence()) at a single time step? Used by SEQTraversalFlowControlNode to skip computation
+    // over gaps when only one sequence is still active. Base-class version makes the conservative assumption that it cannot.
+    virtual bool SupportsPerSequenceFrameRange() const { return false; }
+
     // -----------------------------------------------------------------------
     // memory sharing
     // -----------------------------------------------------------------------
@@ -913,6 +919,12 @@ public:
 
     bool IsValueSparse() const { return m_isValueSparse; }
 
+    // CPU copies of node values by node name (see ComputationNetwork::TakeValueSnapshot()). While a snapshot is set
+    // for saving on a thread, Save() on that thread writes the copies instead of the live values.
+    typedef std::map<std::wstring, MatrixBasePtr> ValueSnapshot;
+    static void SetValueSnapshotForSave(const ValueSnapshot* snapshot);
+    static const MatrixBase* GetValueSnapshotForSave(const std::wstring& nodeName);
+
     // debugging helper
     size_t m_uniqueNumericId; // (a unique handle for debugging)
 protected:
@@ -1260,7 +1272,12 @@ public:
     virtual void CopyTo(ComputationNodeBasePtr nodeP, const std::wstring& newName, const CopyNodeFlags flags) const override
     {
         Base::CopyTo(nodeP, newName, flags);
-        if (flags & CopyNodeFlags::copyNodeValue)
+        if ((flags & CopyNodeFlags::copyNodeValue) && (flags & CopyNodeFlags::shareParameterValues))
+        {
+            // values of non-parameters are recomputed anyway; they will be allocated by the target network
+            // (parameter nodes override CopyTo() to share their value)
+        }
+        else if (flags & CopyNodeFlags::copyNodeValue)
         {
             auto node = DownCast(nodeP);
             if (m_value)
@@ -1510,6 +1527,13 @@ public:
     const Matrix<ElemType>& Value() const { return *m_value; }
     Matrix<ElemType>&       Value()       { return *m_value; }
 
+    // the value to Save(), which is a CPU copy while a snapshot is saved on this thread
+    const Matrix<ElemType>& ValueToSave() const
+    {
+        auto snapshot = dynamic_cast<const Matrix<ElemType>*>(GetValueSnapshotForSave(NodeName()));
+        return snapshot ? *snapshot : Value();
+    }
+
     MatrixBasePtr ValuePtr() const override final { return m_value; }    // readers want this as a shared_ptr straight
     std::shared_ptr<Matrix<ElemType>>& ValuePtrRef() { return m_value; }
 
@@ -2463,6 +2487,7 @@ public:
     virtual bool OutputUsedInComputingInputNodesGradients() const override { return false; }
 #endif
     virtual bool InputUsedInComputingInputNodesGradients(size_t /*childIndex*/) const override { return false; }
+    virtual bool SupportsPerSequenceFrameRange() const override { return true; }
 
     virtual void /*IComputationNode::*/ BeginForwardProp() override // called before first iteration step of ForwardProp()
     {
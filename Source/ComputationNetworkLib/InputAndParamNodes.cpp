@@ -415,7 +415,14 @@ void LearnableParameter<ElemType>::Save(File& fstream) const /*override*/
     Base::Save(fstream);
     fstream << m_learningRateMultiplier;
     m_sampleLayout.Save(fstream);
-    fstream << Value();
+    if (m_halfPrecisionValue) // saved in full precision
+    {
+        Matrix<ElemType> value(m_halfPrecisionValue->GetNumRows(), m_halfPrecisionValue->GetNumCols(), CPUDEVICE);
+        m_halfPrecisionValue->ConvertColumns(0, m_halfPrecisionValue->GetNumCols(), value.Data());
+        fstream << value;
+    }
+    else
+        fstream << ValueToSave();
 }
 
 template <class ElemType>
@@ -469,6 +476,12 @@ template <class ElemType>
         node->m_initOutputRank = m_initOutputRank;
         node->m_initOnCPUOnly  = m_initOnCPUOnly;
         node->m_initValue      = m_initValue;
+        node->m_halfPrecisionValue = m_halfPrecisionValue; // (constant; m_value is empty then, so it must come along in any case)
+        if (flags & CopyNodeFlags::shareParameterValues)
+        {
+            node->m_value = m_value;  // the same parameter storage is used by both nodes
+            node->m_initString.clear(); // (a shared value must never be re-initialized through the copy)
+        }
     }
 }
 
@@ -637,6 +650,20 @@ template <class ElemType>
     SetLearningRateMultiplier(0);
 }
 
+template <class ElemType>
+void LearnableParameter<ElemType>::StoreValueInHalfPrecision()
+{
+    if (m_halfPrecisionValue)
+        return;
+    if (!m_initString.empty())
+        LogicError("%ls: Cannot store the value in half precision before deferred initialization has completed.", NodeDescription().c_str());
+    if (m_learningRateMultiplier != 0 || m_deviceId != CPUDEVICE || Value().GetMatrixType() != DENSE)
+        LogicError("%ls: Only constant, dense values on the CPU can be stored in half precision.", NodeDescription().c_str());
+
+    m_halfPrecisionValue = make_shared<HalfPrecisionMatrix>(Value().GetNumRows(), Value().GetNumCols(), Value().Data());
+    m_value = make_shared<Matrix<ElemType>>(m_deviceId); // releases the full precision value, unless shared with another node
+}
+
 template class LearnableParameter<float>;
 template class LearnableParameter<double>;
 
@@ -145,6 +145,20 @@ public:
     // called from CloneFunction(..., parameters="constant")
     virtual void FreezeParameters() override; // from IFreezable
 
+    // Stores the value in half precision and releases the full precision matrix, which halves the memory of a constant
+    // used for inference. Only Times can use such a value, as its left operand; see ComputationNetwork::StoreConstantsInHalfPrecision().
+    void StoreValueInHalfPrecision();
+    const HalfPrecisionMatrix* HalfPrecisionValue() const { return m_halfPrecisionValue.get(); }
+
+    // a value in half precision has no matrix to verify
+    virtual void /*IComputationNode::*/ BeginForwardProp() override
+    {
+        if (m_halfPrecisionValue)
+            ComputationNodeBase::BeginForwardProp();
+        else
+            Base::BeginForwardProp();
+    }
+
     // Setting the reg multiplier for a learnable node, effecting L1Reg and L2Reg both.
     void SetRegMultiplier(float regMultiplier)
     {
@@ -176,6 +190,9 @@ private:
 
     // flags related to gradient update
     float m_regMultiplier; // The multiplier to adjust the L1Reg and L2Reg for Learnable node
+
+    // the value, if stored in half precision (then Value() is empty)
+    std::shared_ptr<HalfPrecisionMatrix> m_halfPrecisionValue;
 };
 
 // -----------------------------------------------------------------------
@@ -358,6 +375,16 @@ public:
             LogicError("UpdateFunctionMBSize: m_value not matching m_sampleLayout");
     }
 
+    virtual void CopyTo(ComputationNodeBasePtr nodeP, const std::wstring& newName, const CopyNodeFlags flags) const override
+    {
+        Base::CopyTo(nodeP, newName, flags);
+        if (flags & CopyNodeFlags::copyNodeValue)
+        {
+            auto node = dynamic_pointer_cast<InputValueBase<ElemType>>(nodeP);
+            node->Init(m_sampleLayout, m_isSparse, m_dynamicAxisNodeName, m_learningRateMultiplier);
+        }
+    }
+
     virtual void /*ComputationNode::*/ ForwardProp(const FrameRange&) override
     {
         // we have been filled by the Reader
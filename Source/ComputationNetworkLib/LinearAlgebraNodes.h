@@ -563,6 +563,35 @@ private:
         }
     }
 
+    // The left operand, if it is a constant stored in half precision (see ComputationNetwork::StoreConstantsInHalfPrecision()).
+    const HalfPrecisionMatrix* HalfPrecisionInput0() const
+    {
+        auto parameter = dynamic_cast<const LearnableParameter<ElemType>*>(Input(0).get());
+        return parameter ? parameter->HalfPrecisionValue() : nullptr;
+    }
+
+    // Same as the matrix product in ForwardProp(), with the left operand converted to ElemType on the fly.
+    void ForwardProp_HalfPrecision(const HalfPrecisionMatrix& halfPrecisionValue, const FrameRange& fr)
+    {
+        if (m_transpose)
+            LogicError("%ls %ls operation does not support a left operand in half precision.", NodeName().c_str(), OperationName().c_str());
+
+        // flatten into 2D like TensorView::DoMatrixProductOf(): the first m_outputRank dimensions of A are the rows
+        const auto& shape0 = InputRef(0).GetSampleLayout();
+        size_t m = 1;
+        for (size_t i = 0; i < m_outputRank; i++)
+            m *= shape0[i];
+        size_t k = shape0.GetNumElements() / m;
+
+        Matrix<ElemType> input1 = InputRef(1).ValueFor(fr);
+        Matrix<ElemType> output = ValueFor(fr);
+        if (input1.GetNumRows() != k)
+            input1 = input1.Reshaped(k, input1.GetNumElements() / k);
+        if (output.GetNumRows() != m)
+            output = output.Reshaped(m, output.GetNumElements() / m);
+        Matrix<ElemType>::MultiplyAndWeightedAdd(1, halfPrecisionValue.Reshaped(m, k), input1, 0, output);
+    }
+
 public:
     virtual void /*ComputationNode::*/ ForwardProp(const FrameRange& fr) override
     {
@@ -623,6 +652,12 @@ public:
             return;
         }
 
+        if (auto halfPrecisionValue = HalfPrecisionInput0())
+        {
+            ForwardProp_HalfPrecision(*halfPrecisionValue, fr);
+            return;
+        }
+
         // TensorView::DoMatrixProductOf() will reduce each tensor object into a 2D tensor (or fail if it cannot)
         // and recreate actual Matrix objects (in case of sparse, they must be identical to the original tensor storage object).
         // Transposition is applied after flattening into 2D, but only allowed if the input sample is 2D anyway.
@@ -634,6 +669,9 @@ public:
 
     virtual void /*ComputationNode::*/ BackpropTo(const size_t inputIndex, const FrameRange& fr) override
     {
+        if (HalfPrecisionInput0())
+            LogicError("%ls %ls operation: A left operand in half precision is only supported for inference.", NodeName().c_str(), OperationName().c_str());
+
         // special treatment if A is minibatch data; see Forward() for comment
         if (!fr.IsOneColumnWrt(InputRef(0).GetMBLayout()))
         {
@@ -765,6 +803,7 @@ public:
     // but both *inputs* are used, so we don't overload the InputUsed-() function which defaults to 'true'
 
     virtual bool ImplementsGradientOverwriteOptimization() const override { return true; }
+    virtual bool SupportsPerSequenceFrameRange() const override { return !ReduceSequenceAxis(); } // (we unroll into single sequences ourselves)
 
     virtual void /*ComputationNodeBase::*/ Validate(bool isFinalValidationPass) override
     {
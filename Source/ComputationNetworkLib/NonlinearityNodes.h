@@ -100,6 +100,7 @@ public:
     }
 
     virtual bool ImplementsGradientOverwriteOptimization() const override { return (opType != noGradient); }
+    virtual bool SupportsPerSequenceFrameRange() const override { return true; }
 };
 
 #define UnaryElementWiseWithOpCodeNodeBaseMembers UsingComputationNodeMembersBoilerplate;
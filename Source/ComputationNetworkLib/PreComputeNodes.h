@@ -58,7 +58,7 @@ public:
     {
         Base::Save(fstream);
         fstream << m_hasComputed;
-        fstream << Value();
+        fstream << ValueToSave();
     }
 
     virtual void Load(File& fstream, size_t modelVersion) override
@@ -102,6 +102,8 @@ public:
         {
             auto node = dynamic_pointer_cast<PreComputedNodeBase<ElemType>>(nodeP);
             node->m_hasComputed = m_hasComputed;
+            if (flags & CopyNodeFlags::shareParameterValues)
+                node->m_value = m_value; // precomputed values are parameters as well
         }
     }
 
@@ -341,7 +341,10 @@ template<class ElemType, int direction>
             // truncated BPTT carry-over
             size_t T_delayedActivation = m_delayedActivationMBLayout ? m_delayedActivationMBLayout->GetNumTimeSteps() : 0; // (note: should never happen in full-sequence mode)
             auto tensorShape = GetTensorShape(rank);
-            auto slice = TensorSliceWithMBLayoutFor(tensorShape.GetDims(), FrameRange(m_delayedActivationMBLayout, t_delayed/*<0*/ + T_delayedActivation), m_delayedActivationMBLayout);
+            auto frCarryOver = FrameRange(m_delayedActivationMBLayout, t_delayed/*<0*/ + T_delayedActivation);
+            if (fr.seqIndex != SIZE_MAX) // compacted loop step: 'tgt' is a single parallel sequence, so 'src' must be as well
+                frCarryOver = frCarryOver.Sequence(fr.seqIndex);
+            auto slice = TensorSliceWithMBLayoutFor(tensorShape.GetDims(), frCarryOver, m_delayedActivationMBLayout);
             tensorShape.NarrowTo(slice);
             src = TensorView<ElemType>(m_delayedValue, tensorShape);
         }
@@ -69,6 +69,7 @@ public:
     virtual void /*ComputationNode::*/ BackpropTo(const size_t inputIndex, const FrameRange& fr) override;
     virtual bool OutputUsedInComputingInputNodesGradients() const override { return false; }
     virtual bool InputUsedInComputingInputNodesGradients(size_t /*childIndex*/) const override { return false; }
+    virtual bool SupportsPerSequenceFrameRange() const override { return GetNumInputs() == 1 || !InputRef(1).HasMBLayout(); } // (per-sequence initial state is gathered for the whole time step)
     virtual void /*ComputationNodeBase::*/ Validate(bool isFinalValidationPass) override;
     virtual int /*IRecurrentNode::*/ GetRecurrenceSteppingDirection() const override { return -direction; }
     virtual NodeStatePtr /*IStatefulNode::*/ ExportState() override;
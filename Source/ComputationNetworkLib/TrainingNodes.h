@@ -2315,11 +2315,12 @@ public:
         fstream << m_normTimeConst;
         fstream << m_blendTimeConst;
         fstream << (int32_t)m_imageLayoutKind;
-        RunCount();                   // cache m_runCountUntied, so that someone who inspects the file sees something meaningful (as an FYI)
+        // like RunCount(), but from the value that is saved, so that someone who inspects the file sees something meaningful (as an FYI)
+        size_t runCount = HasTiedRunCount() ? (size_t)Input(RUN_COUNT)->ValueToSave().Get00Element() : m_runCountUntied;
 #if CURRENT_CNTK_MODEL_VERSION == CNTK_MODEL_VERSION_19
-        fstream << (bool)(m_runCountUntied == 0);  // a temp version that saved a flag instead (beta11)
+        fstream << (bool)(runCount == 0);  // a temp version that saved a flag instead (beta11)
 #else
-        fstream << m_runCountUntied;  // this is really saved as a FYI and for optimizing 0-checks; the primary storage for this value is in the shared Parameter
+        fstream << runCount;  // this is really saved as a FYI and for optimizing 0-checks; the primary storage for this value is in the shared Parameter
 #endif
         fstream << m_epsilon;
         fstream << m_useCntkEngine;
@@ -59,6 +59,15 @@ void CNTKEvalBase<ElemType>::CreateNetwork(const std::string& networkDescription
     {
         LogicError("Unable to construct network from description");
     }
+
+    // Optionally, keep the weights that only Times uses in half precision, to halve their memory (CPU only).
+    // The network is only evaluated, so all of its parameters are constants.
+    if (config(L"halfPrecisionWeights", false))
+    {
+        this->m_net->SetLearnableNodesBelowLearningRateMultiplier(0);
+        size_t numStored = this->m_net->template StoreConstantsInHalfPrecision<ElemType>();
+        fprintf(stderr, "CreateNetwork: %d parameters are stored in half precision.\n", (int)numStored);
+    }
 }
 
 
@@ -256,21 +265,37 @@ VariableLayout CNTKEvalExtended<ElemType>::ToVariableLayout(const ComputationNod
 template<typename ElemType>
 void CNTKEvalExtended<ElemType>::StartForwardEvaluation(const std::vector<wstring>& outputNodeNames)
 {
-    m_scopedNetworkOperationMode = make_shared<ScopedNetworkOperationMode>(this->m_net, NetworkOperationMode::inferring);
-    m_outputNodes  = this->m_net->OutputNodesByName(outputNodeNames);
-    m_inputNodes = this->m_net->InputNodesForOutputs(outputNodeNames);
-    // allocate memory for forward computation
-    this->m_net->AllocateAllMatrices({}, m_outputNodes, nullptr);
-    this->m_net->StartEvaluateMinibatchLoop(m_outputNodes);
-    m_inputMatrices = DataReaderHelpers::RetrieveInputMatrices(m_inputNodes);
+    if (!m_scopedNetworkOperationMode)
+        m_scopedNetworkOperationMode = make_shared<ScopedNetworkOperationMode>(this->m_net, NetworkOperationMode::inferring);
 
-    for (const auto& node : m_outputNodes)
+    auto planIter = m_forwardPlans.find(outputNodeNames);
+    if (planIter == m_forwardPlans.end())
     {
-        shared_ptr<Matrix<ElemType>> outputMatrix = dynamic_pointer_cast<Matrix<ElemType>>(node->ValuePtr());
-        if (outputMatrix->GetMatrixType() != MatrixType::DENSE)
-            RuntimeError("Sparse outputs are not supported by this API.");
+        ForwardPlan plan;
+        plan.m_outputNodes = this->m_net->OutputNodesByName(outputNodeNames);
+        plan.m_inputNodes = this->m_net->InputNodesForOutputs(outputNodeNames);
+        // allocate memory for forward computation
+        this->m_net->AllocateAllMatrices({}, plan.m_outputNodes, nullptr);
+        plan.m_inputMatrices = DataReaderHelpers::RetrieveInputMatrices(plan.m_inputNodes);
+        plan.m_forwardPropOrder = this->m_net->GetForwardPropOrder(plan.m_outputNodes);
+
+        for (const auto& node : plan.m_outputNodes)
+        {
+            shared_ptr<Matrix<ElemType>> outputMatrix = dynamic_pointer_cast<Matrix<ElemType>>(node->ValuePtr());
+            if (outputMatrix->GetMatrixType() != MatrixType::DENSE)
+                RuntimeError("Sparse outputs are not supported by this API.");
+        }
+
+        planIter = m_forwardPlans.insert(make_pair(outputNodeNames, move(plan))).first;
     }
 
+    const auto& plan = planIter->second;
+    m_outputNodes = plan.m_outputNodes;
+    m_inputNodes = plan.m_inputNodes;
+    m_inputMatrices = plan.m_inputMatrices;
+    m_forwardPropOrder = plan.m_forwardPropOrder;
+    this->m_net->StartEvaluateMinibatchLoop(m_outputNodes);
+
     m_started = true;
 }
 
@@ -317,6 +342,15 @@ void CNTKEvalExtended<ElemType>::ForwardPassT(const std::vector<ValueBuffer<Elem
     if (outputs.size() != m_outputNodes.size())
         RuntimeError("Expected %d outputs, but got %d.", (int)m_outputNodes.size(), (int)outputs.size());
 
+    // On the CPU the caller's buffers are bound to the input and output matrices for the duration of the call
+    // instead of being copied; the bindings are dropped again before returning.
+    std::vector<shared_ptr<Matrix<ElemType>>> boundMatrices;
+    auto releaseBoundMatrices = MakeScopeExit([&boundMatrices]()
+    {
+        for (auto& matrix : boundMatrices)
+            matrix->ReleaseExternalBuffer();
+    });
+
     size_t i = 0;
     for (auto& inputNode : m_inputNodes)
     {
@@ -361,21 +395,55 @@ void CNTKEvalExtended<ElemType>::ForwardPassT(const std::vector<ValueBuffer<Elem
         // SentinelValueIndicatingUnspecifedSequenceBeginIdx is used to specify the lower bound of look-back step of recurrent nodes
         inputNode->GetMBLayout()->AddSequence(0, 0, resetRNN ? 0 : SentinelValueIndicatingUnspecifedSequenceBeginIdx, numCols);
 
+        bool bindBuffer = matrix->GetDeviceId() == CPUDEVICE;
         if (type == MatrixType::DENSE)
-            matrix->SetValue(numRows, numCols, matrix->GetDeviceId(), buffer.m_buffer.data(), matrixFlagNormal);
+            matrix->SetValue(numRows, numCols, matrix->GetDeviceId(), buffer.m_buffer.data(), bindBuffer ? matrixFlagDontOwnBuffer : matrixFlagNormal);
         else if (type == MatrixType::SPARSE)
         {
             // In the sparse case the m_data layout is identical to CUDA's CSC layout
             // (see http://docs.nvidia.com/cuda/cusparse/#compressed-sparse-column-format-csc).
-            matrix->SetMatrixFromCSCFormat(buffer.m_colIndices.data(), buffer.m_indices.data(), buffer.m_buffer.data(),
-                                           buffer.m_buffer.size(), numRows, numCols);
+            if (bindBuffer)
+                matrix->SetMatrixFromExternalCSCFormat(buffer.m_colIndices.data(), buffer.m_indices.data(), buffer.m_buffer.data(),
+                                                       buffer.m_buffer.size(), numRows, numCols);
+            else
+                matrix->SetMatrixFromCSCFormat(buffer.m_colIndices.data(), buffer.m_indices.data(), buffer.m_buffer.data(),
+                                               buffer.m_buffer.size(), numRows, numCols);
         }
 
+        if (bindBuffer)
+            boundMatrices.push_back(matrix);
+
         ++i;
     }
 
+    // Outputs that share an MBLayout with an input have a known size at this point and can be computed in place.
+    std::vector<ElemType*> boundOutputs(m_outputNodes.size(), nullptr);
+    for (size_t i2 = 0; i2 < m_outputNodes.size(); ++i2)
+    {
+        auto node = m_outputNodes[i2];
+        auto matrix = dynamic_pointer_cast<Matrix<ElemType>>(node->ValuePtr());
+        if (matrix->GetDeviceId() != CPUDEVICE || matrix->GetMatrixType() != MatrixType::DENSE || !node->HasMBLayout())
+            continue;
+
+        bool hasInputLayout = std::any_of(m_inputNodes.begin(), m_inputNodes.end(), [&node](const ComputationNodeBasePtr& inputNode) { return inputNode->GetMBLayout() == node->GetMBLayout(); });
+        bool isBound = std::find(boundMatrices.begin(), boundMatrices.end(), matrix) != boundMatrices.end();
+        if (!hasInputLayout || isBound)
+            continue;
+
+        size_t numRows = node->GetSampleMatrixNumRows();
+        size_t numCols = node->GetMBLayout()->GetNumCols();
+        ValueContainer<ElemType>& vec = outputs[i2].m_buffer;
+        if (vec.capacity() < numRows * numCols)
+            continue;
+
+        vec.resize(numRows * numCols);
+        boundOutputs[i2] = const_cast<ElemType*>(vec.data());
+        matrix->SetValue(numRows, numCols, CPUDEVICE, boundOutputs[i2], matrixFlagDontOwnBuffer);
+        boundMatrices.push_back(matrix);
+    }
+
     ComputationNetwork::BumpEvalTimeStamp(m_inputNodes);
-    this->m_net->ForwardProp(m_outputNodes);
+    this->m_net->ForwardPropInOrder(m_forwardPropOrder);
 
     for (size_t i2 = 0; i2 < m_outputNodes.size(); ++i2)
     {
@@ -397,6 +465,10 @@ void CNTKEvalExtended<ElemType>::ForwardPassT(const std::vector<ValueBuffer<Elem
 
         size_t numElements = outputMatrix->GetNumElements();
 
+        // Nothing to copy if the node computed its value directly into the output buffer.
+        if (boundOutputs[i2] != nullptr && outputMatrix->Data() == boundOutputs[i2] && vec.size() == numElements)
+            continue;
+
         if (vec.capacity() < numElements)
         {
             // Bad luck - we can't reallocate memory of an external object at this point.
@@ -438,10 +510,23 @@ void CNTKEvalExtended<ElemType>::Destroy()
 {
     // Since m_scopeNetworkOperationMode has a reference to m_net, it has to be released first.
     m_scopedNetworkOperationMode.reset();
+    m_forwardPlans.clear();
     CNTKEvalBase<ElemType>::Destroy();
     delete this;
 }
 
+template <typename ElemType>
+IEvaluateModelExtended<ElemType>* CNTKEvalExtended<ElemType>::CreateSession()
+{
+    if (!this->m_net)
+        RuntimeError("CreateSession() called before CreateNetwork()");
+
+    auto session = new CNTKEvalExtended<ElemType>();
+    session->m_config = this->m_config;
+    session->m_net = this->m_net->CloneWithSharedParameters();
+    return session;
+}
+
 template <typename ElemType>
 void EVAL_API GetEvalExtended(IEvaluateModelExtended<ElemType>** peval)
 {
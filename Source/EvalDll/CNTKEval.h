@@ -109,6 +109,8 @@ public:
 
     virtual void Destroy() override;
 
+    virtual IEvaluateModelExtended<ElemType>* CreateSession() override;
+
     virtual void CreateNetwork(const std::string& networkDescription) override
     {
         CNTKEvalBase<ElemType>::CreateNetwork(networkDescription);
@@ -125,8 +127,21 @@ private:
     std::shared_ptr<ScopedNetworkOperationMode> m_scopedNetworkOperationMode;
     std::vector<ComputationNodeBasePtr> m_inputNodes;
     StreamMinibatchInputs m_inputMatrices;
+    std::vector<ComputationNodeBasePtr> m_forwardPropOrder; // nodes to run in ForwardPass(), see ComputationNetwork::GetForwardPropOrder()
     bool m_started;
 
+    // Everything StartForwardEvaluation() derives from a set of outputs, cached so that ForwardPass() does
+    // not walk the graph, and switching back to a previously used set of outputs does not redo the analysis.
+    // Input sample shapes are fixed by the network, and matrices only grow, so the output set is a sufficient key.
+    struct ForwardPlan
+    {
+        std::vector<ComputationNodeBasePtr> m_outputNodes;
+        std::vector<ComputationNodeBasePtr> m_inputNodes;
+        StreamMinibatchInputs m_inputMatrices;
+        std::vector<ComputationNodeBasePtr> m_forwardPropOrder;
+    };
+    std::map<std::vector<std::wstring>, ForwardPlan> m_forwardPlans;
+
     template<template<typename> class ValueContainer> 
     void ForwardPassT(const std::vector < ValueBuffer<ElemType, ValueContainer> >& inputs,
                       std::vector < ValueBuffer<ElemType, ValueContainer> >& outputs, bool resetRNN);
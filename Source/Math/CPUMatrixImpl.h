@@ -879,8 +879,10 @@ void CPUMatrix<ElemType>::SetValue(const size_t numRows, const size_t numCols, E
     if (matrixFlags & matrixFlagDontOwnBuffer)
     {
         // free previous array allocation if any before overwriting
-        delete[] Buffer();
+        if (OwnBuffer())
+            delete[] Buffer();
 
+        m_sliceViewOffset = 0;
         m_numRows = numRows;
         m_numCols = numCols;
         SetBuffer(pArray, GetNumElements() * sizeof(ElemType), true);
@@ -888,6 +890,8 @@ void CPUMatrix<ElemType>::SetValue(const size_t numRows, const size_t numCols, E
     }
     else
     {
+        // a previously bound external buffer is not ours to fill; go back to owned storage
+        ReleaseExternalBuffer();
         RequireSize(numRows, numCols);
 
         if (!IsEmpty())
@@ -4807,6 +4811,61 @@ void CPUMatrix<ElemType>::MultiplyAndWeightedAdd(ElemType alpha, const CPUMatrix
     }
 }
 
+/// <summary>Matrix-matrix multiply with weights stored in half precision: c = alpha * a * b + beta * c</summary>
+/// <param name="alpha">Scalar</param>
+/// <param name="a">Input matrix in half precision</param>
+/// <param name="b">Input matrix</param>
+/// <param name="beta">Scalar</param>
+/// <param name="c">Resulting matrix, user is responsible for allocating this</param>
+/// The columns of a are converted a block at a time into a buffer that is multiplied by the matching rows of b,
+/// so a is never held in full precision, and the buffer stays in cache.
+template <class ElemType>
+void CPUMatrix<ElemType>::MultiplyAndWeightedAdd(ElemType alpha, const HalfPrecisionMatrix& a, const CPUMatrix<ElemType>& b, ElemType beta, CPUMatrix<ElemType>& c)
+{
+    int m = (int) a.GetNumRows();
+    int k = (int) a.GetNumCols();
+    int n = (int) b.GetNumCols();
+
+    if (k != (int) b.GetNumRows())
+        InvalidArgument("CPUMatrix<ElemType>::MultiplyAndWeightedAdd : The inner dimensions of a and b must match.");
+
+    if (beta == 0)
+        c.RequireSize(m, n);
+    else
+        c.VerifySize(m, n); // Can't resize if beta != 0
+
+    if (c.IsEmpty())
+        return;
+    if (k == 0)
+    {
+        if (beta == 0)
+            c.SetValue(0);
+        else
+            Scale(beta, c);
+        return;
+    }
+
+    const int blockSize = max(1, (int) (64 * 1024 / m)); // columns of a per block
+    vector<ElemType> block((size_t) m * min(blockSize, k));
+    int ldb = (int) b.GetNumRows();
+    int ldc = (int) c.GetNumRows();
+    for (int k0 = 0; k0 < k; k0 += blockSize)
+    {
+        int kb = min(blockSize, k - k0);
+        a.ConvertColumns(k0, kb, block.data());
+        ElemType blockBeta = (k0 == 0) ? beta : 1; // the first block applies beta, the others accumulate
+        if (sizeof(ElemType) == sizeof(double))
+        {
+            cblas_dgemm((CBLAS_ORDER) (int)MatrixOrder::ColMajor, CBLAS_TRANSPOSE::CblasNoTrans, CBLAS_TRANSPOSE::CblasNoTrans, m, n, kb, alpha, reinterpret_cast<double*>(block.data()), m, reinterpret_cast<double*>(b.Data() + k0), ldb, blockBeta, reinterpret_cast<double*>(c.Data()), ldc);
+        }
+        else
+        {
+#pragma warning(suppress : 4244)
+            cblas_sgemm((CBLAS_ORDER) (int)MatrixOrder::ColMajor, CBLAS_TRANSPOSE::CblasNoTrans, CBLAS_TRANSPOSE::CblasNoTrans, m, n, kb, alpha, reinterpret_cast<float*>(block.data()), m, reinterpret_cast<float*>(b.Data() + k0), ldb, blockBeta, reinterpret_cast<float*>(c.Data()), ldc);
+        }
+    }
+}
+
 template <class ElemType>
 void CPUMatrix<ElemType>::Multiply1x1AndWeightedAdd(ElemType alpha, const CPUMatrix<ElemType>& a, const CPUMatrix<ElemType>& b,
                                                     ElemType beta, CPUMatrix<ElemType>& c)
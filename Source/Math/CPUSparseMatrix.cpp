@@ -703,6 +703,28 @@ void CPUSparseMatrix<ElemType>::SetMatrixFromCSCFormat(const CPUSPARSE_INDEX_TYP
     memcpy(NzValues(), h_Val, sizeof(ElemType)*nz);
 }
 
+// Binds the matrix to externally managed CSC arrays without copying them (see matrixFlagDontOwnBuffer).
+template <class ElemType>
+void CPUSparseMatrix<ElemType>::SetMatrixFromExternalCSCFormat(CPUSPARSE_INDEX_TYPE* h_CSCCol, CPUSPARSE_INDEX_TYPE* h_Row, ElemType* h_Val,
+                                                               const size_t nz, const size_t numRows, const size_t numCols)
+{
+    if (h_CSCCol == nullptr || (nz > 0 && (h_Row == nullptr || h_Val == nullptr)))
+        InvalidArgument("SetMatrixFromExternalCSCFormat: Invalid CSC arrays.");
+
+    // Start from fresh storage, so that neither our own buffers nor any views sharing them are affected.
+    ZeroInit(matrixFormatSparseCSC, CPUDEVICE);
+
+    m_numRows = numRows;
+    m_numCols = numCols;
+    SetNumStorageRows(numRows);
+    SetNumStorageCols(numCols);
+    SetBuffer(h_Val, nz * sizeof(ElemType), true);
+    SetUnCompIndex(h_Row);
+    SetCompIndex(h_CSCCol);
+    SetSizeAllocated(nz);
+    SetCompIndexSize(numCols + 1);
+}
+
 template <class ElemType>
 void CPUSparseMatrix<ElemType>::SetMatrixFromSBCFormat(const size_t* blockIds, const ElemType* val, const size_t numBlocks, const size_t numRows, const size_t numCols)
 {
@@ -993,6 +1015,55 @@ void CPUSparseMatrix<ElemType>::MultiplyAndWeightedAdd(ElemType alpha, const CPU
         MultiplyDenseAndSparse<ElemType, true /* dense times sparse */, false /* transposeA */, false  /*transposeB*/>::MultiplyAndWeightedAdd(alpha, b /*sparse*/, a /* dense */, beta, c /* matrix beeing updated */);
 }
 
+// c = alpha * lhs * rhs + beta * c
+// dense (in half precision) * sparse -> dense
+// Only the columns of lhs that rhs selects are converted, e.g. the embeddings of the words in the minibatch.
+template <class ElemType>
+void CPUSparseMatrix<ElemType>::MultiplyAndWeightedAdd(ElemType alpha, const HalfPrecisionMatrix& a, const CPUSparseMatrix<ElemType>& b, ElemType beta, CPUMatrix<ElemType>& c)
+{
+    size_t m = a.GetNumRows();
+    size_t n = b.GetNumCols();
+    if (a.GetNumCols() != b.GetNumRows())
+        InvalidArgument("CPUSparseMatrix::MultiplyAndWeightedAdd: The inner dimensions of a (= %lu) and b (= %lu) don't match.", (unsigned long)a.GetNumCols(), (unsigned long)b.GetNumRows());
+
+    if (beta == 0)
+        c.RequireSize(m, n);
+    else
+        c.VerifySize(m, n); // Can't resize if beta != 0
+
+    if (beta == 0)
+        memset(c.Data(), 0, sizeof(ElemType) * c.GetNumElements());
+    else if (beta != 1)
+        CPUMatrix<ElemType>::Scale(beta, c);
+
+    if (b.IsEmpty() || c.IsEmpty())
+        return;
+
+    if (b.GetFormat() != matrixFormatSparseCSC)
+        NOT_IMPLEMENTED;
+
+    const ElemType* valueBuffer = b.Buffer() + *b.SecondaryIndexLocation(); // values of the current view
+    const CPUSPARSE_INDEX_TYPE* rowIndexBuffer = b.MajorIndexLocation();  // row indices of the current view
+    const CPUSPARSE_INDEX_TYPE* columnStart = b.SecondaryIndexLocation();
+
+#pragma omp parallel
+    {
+        vector<ElemType> column(m);
+#pragma omp for
+        for (long j = 0; j < (long)n; j++)
+        {
+            ElemType* cColumn = c.Data() + j * m;
+            for (CPUSPARSE_INDEX_TYPE p = columnStart[j] - columnStart[0]; p < columnStart[j + 1] - columnStart[0]; p++)
+            {
+                a.ConvertColumns(rowIndexBuffer[p], 1, column.data());
+                ElemType value = alpha * valueBuffer[p];
+                for (size_t i = 0; i < m; i++)
+                    cColumn[i] += value * column[i];
+            }
+        }
+    }
+}
+
 // c = alpha * lhs * rhs + beta * c
 // sparse * dense -> dense
 template <class ElemType>
@@ -1711,18 +1782,9 @@ MATH_API File& operator>>(File& stream, CPUSparseMatrix<ElemType>& us)
         CPUSPARSE_INDEX_TYPE* compressedIndex = us.SecondaryIndexLocation();
 
         // read in the sparse matrix info
-        for (size_t i = 0; i < nz; ++i)
-        {
-            stream >> dataBuffer[i];
-        }
-        for (size_t i = 0; i < nz; ++i)
-        {
-            stream >> unCompressedIndex[i];
-        }
-        for (size_t i = 0; i < compressedSize; ++i)
-        {
-            stream >> compressedIndex[i];
-        }
+        stream.ReadArray(dataBuffer, nz);
+        stream.ReadArray(unCompressedIndex, nz);
+        stream.ReadArray(compressedIndex, compressedSize);
     }
     stream.GetMarker(fileMarkerEndSection, std::wstring(L"EMAT"));
 
@@ -1754,18 +1816,9 @@ MATH_API File& operator<<(File& stream, const CPUSparseMatrix<ElemType>& us)
         CPUSPARSE_INDEX_TYPE* unCompressedIndex = us.MajorIndexLocation();
         CPUSPARSE_INDEX_TYPE* compressedIndex = us.SecondaryIndexLocation();
 
-        for (size_t i = 0; i < nz; ++i)
-        {
-            stream << dataBuffer[i];
-        }
-        for (size_t i = 0; i < nz; ++i)
-        {
-            stream << unCompressedIndex[i];
-        }
-        for (size_t i = 0; i < compressedSize; ++i)
-        {
-            stream << compressedIndex[i];
-        }
+        stream.WriteArray(dataBuffer, nz);
+        stream.WriteArray(unCompressedIndex, nz);
+        stream.WriteArray(compressedIndex, compressedSize);
     }
     stream.PutMarker(fileMarkerEndSection, std::wstring(L"EMAT"));
 
@@ -119,6 +119,8 @@ public:
 
     void SetMatrixFromCSCFormat(const CPUSPARSE_INDEX_TYPE* h_CSCCol, const CPUSPARSE_INDEX_TYPE* h_Row, const ElemType* h_Val,
                                 const size_t nz, const size_t numRows, const size_t numCols);
+    void SetMatrixFromExternalCSCFormat(CPUSPARSE_INDEX_TYPE* h_CSCCol, CPUSPARSE_INDEX_TYPE* h_Row, ElemType* h_Val,
+                                        const size_t nz, const size_t numRows, const size_t numCols);
 
     void SetMatrixFromSBCFormat(const size_t* blockIds, const ElemType* val, const size_t numBlocks, const size_t numRows, const size_t numCols);
 
@@ -130,6 +132,9 @@ public:
     static void MultiplyAndWeightedAdd(ElemType alpha, const CPUSparseMatrix<ElemType>& lhs, const bool transposeA,
                                        const CPUMatrix<ElemType>& rhs, const bool transposeB, ElemType beta, CPUMatrix<ElemType>& c);
 
+    // Dense (in half precision) * Sparse -> Dense
+    static void MultiplyAndWeightedAdd(ElemType alpha, const HalfPrecisionMatrix& lhs, const CPUSparseMatrix<ElemType>& rhs, ElemType beta, CPUMatrix<ElemType>& c);
+
     // Dense * Sparse -> Sparse
     static void MultiplyAndAdd(ElemType alpha, const CPUMatrix<ElemType>& lhs, const bool transposeA,
                                const CPUSparseMatrix<ElemType>& rhs, const bool transposeB, CPUSparseMatrix<ElemType>& c);
@@ -487,6 +487,14 @@ public:
 
     bool OwnBuffer() const { return !HasExternalBuffer(); }
 
+    // Drops the reference to an externally managed buffer, leaving an empty matrix that owns its storage again.
+    // The external buffer itself is not touched.
+    void ReleaseExternalBuffer()
+    {
+        if (HasExternalBuffer())
+            ZeroInit();
+    }
+
     bool IsEmpty() const { return m_numRows == 0 || m_numCols == 0; }
 
     size_t GetSizeAllocated() const { return m_sob->GetSizeAllocated(); }
@@ -3149,10 +3149,7 @@ MATH_API File& operator>>(File& stream, GPUSparseMatrix<ElemType>& us)
         CPUSPARSE_INDEX_TYPE* compressedIndex = new CPUSPARSE_INDEX_TYPE[compressedSize];
 
         // read in the sparse matrix info
-        for (size_t i = 0; i < nz; ++i)
-        {
-            stream >> dataBuffer[i];
-        }
+        stream.ReadArray(dataBuffer, nz);
         for (size_t i = 0; i < nz; ++i)
         {
             size_t val;
@@ -3214,10 +3211,7 @@ MATH_API File& operator<<(File& stream, const GPUSparseMatrix<ElemType>& us)
         else
             NOT_IMPLEMENTED;
 
-        for (size_t i = 0; i < nz; ++i)
-        {
-            stream << dataBuffer[i];
-        }
+        stream.WriteArray(dataBuffer, nz);
         for (size_t i = 0; i < nz; ++i)
         {
             size_t val = unCompressedIndex[i];
@@ -0,0 +1,175 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+// HalfPrecision.h -- IEEE half precision storage on the CPU, for constant weights in inference and for model files.
+//
+#pragma once
+
+#include "Basics.h"
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <memory>
+#include <vector>
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#include <immintrin.h>
+#define CNTK_F16C_AVAILABLE
+#endif
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// Conversion between single and IEEE half precision.
+// Rounds to nearest even; values beyond the half precision range become infinite, tiny values become subnormal or zero.
+inline uint16_t FloatToHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+    bits &= 0x7FFFFFFF;
+
+    if (bits >= 0x7F800000) // inf or NaN
+        return sign | 0x7C00 | ((bits > 0x7F800000) ? 0x0200 : 0);
+    if (bits >= 0x477FF000) // rounds to beyond the largest half (65504)
+        return sign | 0x7C00;
+
+    int exponent = (int)(bits >> 23);
+    uint32_t mantissa = (bits & 0x007FFFFF) | 0x00800000;
+    if (exponent < 113) // subnormal half, or zero
+    {
+        int shift = 126 - exponent;
+        if (shift > 24)
+            return sign;
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1)))
+            half++;
+        return sign | (uint16_t)half;
+    }
+
+    uint32_t half = ((uint32_t)(exponent - 112) << 10) | ((mantissa >> 13) & 0x03FF);
+    uint32_t remainder = mantissa & 0x1FFF;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+        half++; // a carry into the exponent is the correct result
+    return sign | (uint16_t)half;
+}
+
+inline float HalfToFloat(uint16_t half)
+{
+    uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x03FF;
+    uint32_t bits;
+    if (exponent == 0x1F) // inf or NaN
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    else if (exponent != 0)
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    else if (mantissa == 0)
+        bits = sign;
+    else // subnormal half: normalize
+    {
+        exponent = 113;
+        while ((mantissa & 0x0400) == 0)
+        {
+            mantissa <<= 1;
+            exponent--;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x03FF) << 13);
+    }
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Array conversions; they use F16C when the build enables it, which gives the same bits as the scalar conversions.
+inline void FloatToHalf(const float* src, uint16_t* dst, size_t count)
+{
+    size_t i = 0;
+#ifdef CNTK_F16C_AVAILABLE
+    for (; i + 8 <= count; i += 8)
+        _mm_storeu_si128((__m128i*)(dst + i), _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+#endif
+    for (; i < count; i++)
+        dst[i] = FloatToHalf(src[i]);
+}
+
+inline void FloatToHalf(const double* src, uint16_t* dst, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        dst[i] = FloatToHalf((float)src[i]);
+}
+
+// 'src' need not be aligned.
+inline void HalfToFloat(const void* src, float* dst, size_t count)
+{
+    const char* bytes = (const char*)src;
+    size_t i = 0;
+#ifdef CNTK_F16C_AVAILABLE
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(bytes + i * sizeof(uint16_t)))));
+#endif
+    for (; i < count; i++)
+    {
+        uint16_t half;
+        memcpy(&half, bytes + i * sizeof(uint16_t), sizeof(half));
+        dst[i] = HalfToFloat(half);
+    }
+}
+
+inline void HalfToFloat(const void* src, double* dst, size_t count)
+{
+    const char* bytes = (const char*)src;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint16_t half;
+        memcpy(&half, bytes + i * sizeof(uint16_t), sizeof(half));
+        dst[i] = HalfToFloat(half);
+    }
+}
+
+// A dense column-major matrix of constant values stored in half precision in CPU memory, which halves the memory
+// and bandwidth of weights used for inference. It is not used in computations directly; products with it
+// (CPUMatrix/CPUSparseMatrix::MultiplyAndWeightedAdd()) convert a block of columns at a time as they go.
+// Copies and reshaped matrices share the values.
+class HalfPrecisionMatrix
+{
+public:
+    template <class ElemType>
+    HalfPrecisionMatrix(size_t numRows, size_t numCols, const ElemType* data)
+        : m_numRows(numRows), m_numCols(numCols)
+    {
+        auto values = std::make_shared<std::vector<uint16_t>>(numRows * numCols);
+        FloatToHalf(data, values->data(), values->size());
+        m_values = values;
+    }
+
+    HalfPrecisionMatrix Reshaped(size_t numRows, size_t numCols) const
+    {
+        if (numRows * numCols != GetNumElements())
+            InvalidArgument("HalfPrecisionMatrix::Reshaped: The number of elements (%d) does not match the new shape [%d x %d].", (int)GetNumElements(), (int)numRows, (int)numCols);
+        HalfPrecisionMatrix reshaped(*this);
+        reshaped.m_numRows = numRows;
+        reshaped.m_numCols = numCols;
+        return reshaped;
+    }
+
+    size_t GetNumRows() const { return m_numRows; }
+    size_t GetNumCols() const { return m_numCols; }
+    size_t GetNumElements() const { return m_numRows * m_numCols; }
+
+    // Converts the columns [firstColumn, firstColumn + numColumns) into 'dst', which holds GetNumRows() x numColumns values.
+    template <class ElemType>
+    void ConvertColumns(size_t firstColumn, size_t numColumns, ElemType* dst) const
+    {
+        assert(firstColumn + numColumns <= m_numCols);
+        HalfToFloat(m_values->data() + firstColumn * m_numRows, dst, numColumns * m_numRows);
+    }
+
+private:
+    size_t m_numRows;
+    size_t m_numCols;
+    std::shared_ptr<const std::vector<uint16_t>> m_values;
+};
+
+}}}
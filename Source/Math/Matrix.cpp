@@ -1421,6 +1421,19 @@ void Matrix<ElemType>::SetMatrixFromCSCFormat(const CPUSPARSE_INDEX_TYPE* h_CSCC
         { m_GPUSparseMatrix->SetMatrixFromCSCFormat(h_CSCCol, h_Row, h_Val, nz, numRows, numCols, false, -1, transferer); });
 }
 
+template <class ElemType>
+void Matrix<ElemType>::SetMatrixFromExternalCSCFormat(CPUSPARSE_INDEX_TYPE* h_CSCCol, CPUSPARSE_INDEX_TYPE* h_Row, ElemType* h_Val,
+    const size_t nz, const size_t numRows, const size_t numCols)
+{
+    if (GetMatrixType() == MatrixType::SPARSE && GetDeviceId() == CPUDEVICE)
+    {
+        m_CPUSparseMatrix->SetMatrixFromExternalCSCFormat(h_CSCCol, h_Row, h_Val, nz, numRows, numCols);
+        SetDataLocation(CPU, SPARSE);
+    }
+    else
+        SetMatrixFromCSCFormat(h_CSCCol, h_Row, h_Val, nz, numRows, numCols);
+}
+
 template <class ElemType>
 void Matrix<ElemType>::SetDiagonalValue(const ElemType v)
 {
@@ -4878,6 +4891,26 @@ void Matrix<ElemType>::MultiplyAndWeightedAdd(ElemType alpha, const Matrix<ElemT
     }
 }
 
+/// <summary>Matrix-matrix multiply with weights stored in half precision (see HalfPrecision.h): c = alpha * a * b + beta * c</summary>
+/// <param name="alpha">Scalar</param>
+/// <param name="a">Input matrix in half precision, in CPU memory</param>
+/// <param name="b">Input matrix, dense or sparse (CSC), on the CPU</param>
+/// <param name="beta">Scalar</param>
+/// <param name="c">Resulting matrix, on the CPU</param>
+template <class ElemType>
+void Matrix<ElemType>::MultiplyAndWeightedAdd(ElemType alpha, const HalfPrecisionMatrix& a, const Matrix<ElemType>& b, ElemType beta, Matrix<ElemType>& c)
+{
+    if (b.GetDeviceId() != CPUDEVICE || c.GetDeviceId() != CPUDEVICE)
+        InvalidArgument("MultiplyAndWeightedAdd: Products with matrices in half precision are only supported on the CPU.");
+
+    c.SwitchToMatrixType(MatrixType::DENSE, matrixFormatDense, false);
+    if (b.GetMatrixType() == MatrixType::SPARSE)
+        CPUSparseMatrix<ElemType>::MultiplyAndWeightedAdd(alpha, a, *b.m_CPUSparseMatrix, beta, *c.m_CPUMatrix);
+    else
+        CPUMatrix<ElemType>::MultiplyAndWeightedAdd(alpha, a, *b.m_CPUMatrix, beta, *c.m_CPUMatrix);
+    c.SetDataLocation(CPU, DENSE);
+}
+
 template <class ElemType>
 /*static*/ void Matrix<ElemType>::Multiply1x1AndWeightedAdd(ElemType alpha, const Matrix<ElemType>& a, const Matrix<ElemType>& b, ElemType beta, Matrix<ElemType>& c)
 {
@@ -20,6 +20,7 @@
 #include <array>
 #include <initializer_list>
 #include "QuantizedOperations.h"
+#include "HalfPrecision.h"
 
 // Forward declarations
 namespace CNTK
@@ -162,6 +163,8 @@ public:
     MatrixType GetMatrixType() const override;
     MatrixFormat GetFormat() const override;
     bool OwnBuffer() const { return m_baseMatrix->OwnBuffer(); }
+    // Drops the reference to a buffer bound with matrixFlagDontOwnBuffer or SetMatrixFromExternalCSCFormat(), leaving an empty matrix.
+    void ReleaseExternalBuffer() { m_baseMatrix->ReleaseExternalBuffer(); }
     int GetDeviceId() const; // -1 if CPU, otherwise GPU CUDA device id
     DEVICEID_TYPE GetPreferredDeviceId() const { return m_preferredDeviceId; }; // -1 if CPU, otherwise GPU CUDA device id
     void SetPreferredDeviceId(DEVICEID_TYPE preferredDeviceId) { m_preferredDeviceId = preferredDeviceId; }
@@ -282,6 +285,10 @@ public:
     }
     void SetMatrixFromCSCFormat(const CPUSPARSE_INDEX_TYPE* h_CSCCol, const CPUSPARSE_INDEX_TYPE* h_Row, const ElemType* h_Val,
         const size_t nz, const size_t numRows, const size_t numCols, DataTransferer* transferer = nullptr);
+    // Same as SetMatrixFromCSCFormat(), but a CPU sparse matrix refers to the given arrays instead of copying them.
+    // The arrays must stay valid until ReleaseExternalBuffer() is called. Other matrix types copy the data.
+    void SetMatrixFromExternalCSCFormat(CPUSPARSE_INDEX_TYPE* h_CSCCol, CPUSPARSE_INDEX_TYPE* h_Row, ElemType* h_Val,
+        const size_t nz, const size_t numRows, const size_t numCols);
 
     void MaskColumnsValue(const Matrix<char>& columnsMask, ElemType val, size_t numColsPerMaskEntry);
 
@@ -562,6 +569,7 @@ public:
     static void SVD(const Matrix<ElemType>& A, Matrix<ElemType>& SIGMA, Matrix<ElemType>& U, Matrix<ElemType>& VT, Matrix<ElemType>& W);
 
     static void MultiplyAndWeightedAdd(ElemType alpha, const Matrix<ElemType>& a, const bool transposeA, const Matrix<ElemType>& b, const bool transposeB, ElemType beta, Matrix<ElemType>& c, shared_ptr<QuantizedMultiplier<ElemType>> pQuantizedMultiplier=nullptr); // SGEMM
+    static void MultiplyAndWeightedAdd(ElemType alpha, const HalfPrecisionMatrix& a, const Matrix<ElemType>& b, ElemType beta, Matrix<ElemType>& c); // CPU only
     static void MultiplyAndAdd(const Matrix<ElemType>& a, const bool transposeA, const Matrix<ElemType>& b, const bool transposeB, Matrix<ElemType>& c);
     static void Multiply(const Matrix<ElemType>& a, const bool transposeA, const Matrix<ElemType>& b, const bool transposeB, Matrix<ElemType>& c);
     static void Multiply(const Matrix<ElemType>& a, const Matrix<ElemType>& b, Matrix<ElemType>& c);
@@ -3,12 +3,18 @@
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
+// Matrices smaller than this are quantized on the calling thread only
+static const size_t s_minElementsForParallelQuantization = 32768;
+
 template <class ElemType>
 MatrixQuantizerCPU<ElemType>::MatrixQuantizerCPU()
     : MatrixQuantizerImpl<ElemType>(CPUDEVICE)
 {
 }
 
+// The work is distributed over OpenMP threads: the range of each column is computed independently (summing its
+// values sequentially, as in the single-threaded version), then every QWord of every column is quantized independently.
+// The result therefore does not depend on the number of threads. The layout is the same as in MatrixQuantizer_kernel.cu.
 template <class ElemType>
 void MatrixQuantizerCPU<ElemType>::QuantizeAsync(const Matrix<ElemType>& inMatrix, const Matrix<ElemType>& inResidual, QuantizedMatrix<ElemType>& outQMatrix, Matrix<ElemType>& outResidual, bool zeroThresholdFor1Bit)
 {
@@ -26,40 +32,42 @@ void MatrixQuantizerCPU<ElemType>::QuantizeAsync(const Matrix<ElemType>& inMatri
     assert((inResidual.GetNumRows() == nRow) && (inResidual.GetNumCols() == nCol));
     assert((outResidual.GetNumRows() == nRow) && (outResidual.GetNumCols() == nCol));
 
-    const size_t ldNbits = ValueQuantizer<ElemType>::ld(nBits);
-#ifdef QUANTUSEPPL
-    Concurrency::parallel_for((size_t) 0, us.cols(), [&](size_t j)
-#else
-    for (size_t j = 0; j < nCol; j++)
-#endif
+    const ElemType* inData = inMatrix.Data();
+    const ElemType* inResidualData = inResidual.Data();
+    ElemType* outResidualData = outResidual.Data();
+    const bool parallelize = (nRow * nCol) >= s_minElementsForParallelQuantization;
+
+    // determine the quantization range of each column
+#pragma omp parallel for if (parallelize)
+    for (long j = 0; j < (long) nCol; j++)
     {
         auto& qcol = *(outQMatrix.GetQuantizedColumn(j));
+        // Explicit use of 'template' keyword is needed to compile with GCC
         if (zeroThresholdFor1Bit)
-        {
-            // Explicit use of 'template' keyword is needed to compile with GCC
-            ColumnQuantizer<ElemType>::template ComputeRangeStatColj<true>(inMatrix.Data(), inResidual.Data(), (long) nRow, j, nBits, qcol.lower, qcol.upper);
-        }
+            ColumnQuantizer<ElemType>::template ComputeRangeStatColj<true>(inData, inResidualData, (long) nRow, j, nBits, qcol.lower, qcol.upper);
         else
-        {
-            // Explicit use of 'template' keyword is needed to compile with GCC
-            ColumnQuantizer<ElemType>::template ComputeRangeStatColj<false>(inMatrix.Data(), inResidual.Data(), (long) nRow, j, nBits, qcol.lower, qcol.upper);
-        }
+            ColumnQuantizer<ElemType>::template ComputeRangeStatColj<false>(inData, inResidualData, (long) nRow, j, nBits, qcol.lower, qcol.upper);
+    }
 
-        ColumnQuantizer<ElemType> q(ldNbits, qcol.lower, qcol.upper);
+    // quantize (also computing the residual at once)
+    const size_t ldNbits = ValueQuantizer<ElemType>::ld(nBits);
+    const size_t numQWordsPerCol = ColumnQuantizer<ElemType>::QWordsPerCol(nRow, nBits);
+    const size_t totalQWords = nCol * numQWordsPerCol;
+#pragma omp parallel for if (parallelize)
+    for (long linindex = 0; linindex < (long) totalQWords; linindex++)
+    {
+        const size_t j = linindex / numQWordsPerCol;
+        const size_t iQWord = linindex % numQWordsPerCol;
+
+        auto& qcol = *(outQMatrix.GetQuantizedColumn(j));
+        const ColumnQuantizer<ElemType> q(ldNbits, qcol.lower, qcol.upper);
+
+        // Explicit use of 'template' keyword is needed to compile with GCC
         if (zeroThresholdFor1Bit)
-        {
-            // Explicit use of 'template' keyword is needed to compile with GCC
-            q.template Quantize<true>(inMatrix.Data(), inResidual.Data(), (long) nRow, j, qcol.bits, outResidual.Data());
-        }
+            qcol.bits[iQWord] = q.template QuantizeOneQWord<true>(inData, inResidualData, (long) nRow, iQWord, nRow, numQWordsPerCol, j, outResidualData);
         else
-        {
-            // Explicit use of 'template' keyword is needed to compile with GCC
-            q.template Quantize<false>(inMatrix.Data(), inResidual.Data(), (long) nRow, j, qcol.bits, outResidual.Data());
-        }
+            qcol.bits[iQWord] = q.template QuantizeOneQWord<false>(inData, inResidualData, (long) nRow, iQWord, nRow, numQWordsPerCol, j, outResidualData);
     }
-#ifdef QUANTUSEPPL
-    );
-#endif
 }
 
 template <class ElemType>
@@ -68,7 +76,7 @@ void MatrixQuantizerCPU<ElemType>::WaitQuantizeAsyncDone()
     // TODO: Currently this is a no-op since the actual quantization is synchronous
 }
 
-// unquantize an entire matrix, calling unquantize() for each column
+// unquantize an entire matrix, one QWord of a column at a time (the same layout as in QuantizeAsync())
 template <class ElemType>
 void MatrixQuantizerCPU<ElemType>::UnquantizeAsync(QuantizedMatrix<ElemType>& inQMatrix, Matrix<ElemType>& outMatrix, bool add /*= false*/)
 {
@@ -83,20 +91,22 @@ void MatrixQuantizerCPU<ElemType>::UnquantizeAsync(QuantizedMatrix<ElemType>& in
     // Verify that the different matrix parameters have matching dimensions
     assert((outMatrix.GetNumRows() == nRow) && (outMatrix.GetNumCols() == nCol));
 
+    ElemType* outData = outMatrix.Data();
+    const bool parallelize = (nRow * nCol) >= s_minElementsForParallelQuantization;
+
     const size_t ldNbits = ValueQuantizer<ElemType>::ld(nBits);
-#ifdef QUANTUSEPPL
-    Concurrency::parallel_for((size_t) 0, us.cols(), [&](size_t j)
-#else
-    for (size_t j = 0; j < nCol; j++)
-#endif
+    const size_t numQWordsPerCol = ColumnQuantizer<ElemType>::QWordsPerCol(nRow, nBits);
+    const size_t totalQWords = nCol * numQWordsPerCol;
+#pragma omp parallel for if (parallelize)
+    for (long linindex = 0; linindex < (long) totalQWords; linindex++)
     {
+        const size_t j = linindex / numQWordsPerCol;
+        const size_t iQWord = linindex % numQWordsPerCol;
+
         const auto& qcol = *(inQMatrix.GetQuantizedColumn(j));
-        ColumnQuantizer<ElemType> q(ldNbits, qcol.lower, qcol.upper);
-        q.Unquantize(outMatrix.Data(), (long) nRow, j, qcol.bits, add);
+        const ColumnQuantizer<ElemType> q(ldNbits, qcol.lower, qcol.upper);
+        q.UnquantizeOneQWord(outData, (long) nRow, iQWord, nRow, numQWordsPerCol, j, qcol.bits[iQWord], add);
     }
-#ifdef QUANTUSEPPL
-    );
-#endif
 }
 
 template <class ElemType>
@@ -58,6 +58,8 @@ static const FixedEventDesc c_fixedEvtDesc[profilerEvtMax] = {
     { "_Minibatch Iteration", profilerEvtTime, false },             // profilerEvtMainMinibatch
     { "__Get Minibatch", profilerEvtTime, true },                   // profilerEvtMainGetMinibatch
     { "__Forward + Backward", profilerEvtTime, true },              // profilerEvtMainFB
+    { "___Forward", profilerEvtTime, true },                        // profilerEvtMainForward
+    { "___Backward", profilerEvtTime, true },                       // profilerEvtMainBackward
     { "__Gradient Aggregation", profilerEvtTime, true },            // profilerEvtMainGradient
     { "__Weight Update", profilerEvtTime, true },                   // profilerEvtMainWeights
     { "__Post Processing", profilerEvtTime, true },                 // profilerEvtMainPost
@@ -67,6 +69,7 @@ static const FixedEventDesc c_fixedEvtDesc[profilerEvtMax] = {
     { "", profilerEvtSeparator, false },                            // profilerSepSpace2
 
     { "Prefetch Minibatch", profilerEvtTime, false },               // profilerEvtPrefetchMinibatch
+    { "Wait For Prefetch", profilerEvtTime, false },                // profilerEvtReaderWait
 };
 
 
@@ -88,6 +91,8 @@ struct CustomEventRecord
 {
     long long       beginClock;
     long long       endClock;
+    long long       bytes;        // communication events only, otherwise 0
+    int             peer;         // communication events only, -1 for collectives and other events
     unsigned int    threadId;
 };
 
@@ -107,6 +112,8 @@ struct ProfilerState
     unsigned long long      customEventBufferBytes;      // Number of bytes allocated for the custom event buffer
     unsigned long long      customEventOffset;           // Offset to current place in buffer
     unique_ptr<char[]>      customEventBuffer;           // Pointer to custom event buffer
+    int                     timelineRank;                // Process id in the timeline
+    long long               timelineOrigin;              // Local time stamp of time zero in the timeline
 };
 
 
@@ -124,6 +131,7 @@ void FormatTimeStr(char* str, size_t strLen, double value);
 void FormatThroughputStr(char* str, size_t strLen, double value);
 void FormatBytesStr(char* str, size_t strLen, long long bytes);
 void ProfilerGenerateDetailFile(const std::wstring& fileName);
+void ProfilerGenerateTimelineFile(const std::wstring& fileName);
 
 
 double TicksToSeconds(long long ticks)
@@ -166,6 +174,9 @@ void PERF_PROFILER_API ProfilerInit(const std::wstring& profilerDir, const unsig
     g_profilerState->syncGpu = syncGpu;
     g_profilerState->enabled = false;
 
+    g_profilerState->timelineRank = 0;
+    g_profilerState->timelineOrigin = Clock::GetTimeStamp();
+
     if (_wmkdir(g_profilerState->profilerDir.c_str()) == -1 && errno != EEXIST)
     {
         RuntimeError("Error: ProfilerInit: Cannot create directory <%ls>.\n", g_profilerState->profilerDir.c_str());
@@ -187,6 +198,21 @@ void PERF_PROFILER_API ProfilerEnable(bool enable)
 }
 
 
+//
+// Set the process of the timeline and its time zero.
+//
+void PERF_PROFILER_API ProfilerSetTimelineOrigin(const int rank, const long long originTimeStamp)
+{
+    // A nullptr state indicates that the profiler is globally disabled, and not initialized
+    if (g_profilerState == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_profilerState->timelineRank = rank;
+    g_profilerState->timelineOrigin = originTimeStamp;
+}
+
+
 //
 // Internal helper functions to record fixed and custom profiling events.
 //
@@ -210,7 +236,7 @@ void ProfilerTimeRecordFixedEvent(const int eventId, const long long beginClock,
     g_profilerState->fixedEvents[eventId].cnt++;
 }
 
-void ProfilerTimeRecordToBuffer(const char* eventDescription, const long long beginClock, const long long endClock)
+void ProfilerTimeRecordToBuffer(const char* eventDescription, const long long beginClock, const long long endClock, const long long bytes = 0, const int peer = -1)
 {
     std::lock_guard<std::mutex> lock(g_mutex);
 
@@ -235,6 +261,8 @@ void ProfilerTimeRecordToBuffer(const char* eventDescription, const long long be
     CustomEventRecord eventRecord;
     eventRecord.beginClock = beginClock;
     eventRecord.endClock = endClock;
+    eventRecord.bytes = bytes;
+    eventRecord.peer = peer;
     eventRecord.threadId = GetThreadId();
 
     memcpy(g_profilerState->customEventBuffer.get() + g_profilerState->customEventOffset, &eventRecord, sizeof(CustomEventRecord));
@@ -278,6 +306,16 @@ void PERF_PROFILER_API ProfilerTimeEnd(const long long stateId, const char* even
 }
 
 
+void PERF_PROFILER_API ProfilerTimeEnd(const long long stateId, const char* eventDescription, const long long bytes, const int peer)
+{
+    // A nullptr state indicates that the profiler is globally disabled, and not initialized
+    if (g_profilerState == nullptr)
+        return;
+
+    ProfilerTimeRecordToBuffer(eventDescription, stateId, Clock::GetTimeStamp(), bytes, peer);
+}
+
+
 //
 // Conditionally sync the GPU if the syncGPU flag is set. This only needs to be excplicitly
 // called for custom events.
@@ -366,6 +404,10 @@ void PERF_PROFILER_API ProfilerClose()
     fileName = g_profilerState->profilerDir + L"/" + std::wstring(timeStr) + L"_detail_" + g_profilerState->logSuffix + L".csv";
     ProfilerGenerateDetailFile(fileName);
 
+    // Generate timeline
+    fileName = g_profilerState->profilerDir + L"/" + std::wstring(timeStr) + L"_trace_" + g_profilerState->logSuffix + L".json";
+    ProfilerGenerateTimelineFile(fileName);
+
     g_profilerState.reset();
 }
 
@@ -534,7 +576,7 @@ void ProfilerGenerateDetailFile(const std::wstring& fileName)
         RuntimeError("Error: ProfilerGenerateDetailFile: Cannot create file <%ls>.\n", fileName.c_str());
     }
 
-    fprintfOrDie(f, "EventDescription,ThreadId,BeginTimeStamp(ms),EndTimeStamp(ms)\n");
+    fprintfOrDie(f, "EventDescription,ThreadId,BeginTimeStamp(ms),EndTimeStamp(ms),Bytes,Peer\n");
 
     char* eventPtr = g_profilerState->customEventBuffer.get();
 
@@ -546,11 +588,55 @@ void ProfilerGenerateDetailFile(const std::wstring& fileName)
         CustomEventRecord* eventRecord = (CustomEventRecord*)eventPtr;
         eventPtr += sizeof(CustomEventRecord);
 
-        fprintfOrDie(f, "\"%s\",%u,%.8f,%.8f\n", descriptionStr, eventRecord->threadId, 
+        fprintfOrDie(f, "\"%s\",%u,%.8f,%.8f,%lld,%d\n", descriptionStr, eventRecord->threadId, 
             1000.0 * TicksToSeconds(eventRecord->beginClock),
-            1000.0 * TicksToSeconds(eventRecord->endClock));
+            1000.0 * TicksToSeconds(eventRecord->endClock),
+            eventRecord->bytes, eventRecord->peer);
+    }
+
+    fclose(f);
+}
+
+
+//
+// Generate the timeline in the Chrome trace event format ("X" events, times in microseconds).
+//
+void ProfilerGenerateTimelineFile(const std::wstring& fileName)
+{
+    FILE* f = _wfopen(fileName.c_str(), L"wt");
+    if (f == NULL)
+    {
+        RuntimeError("Error: ProfilerGenerateTimelineFile: Cannot create file <%ls>.\n", fileName.c_str());
+    }
+
+    int rank = g_profilerState->timelineRank;
+    fprintfOrDie(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    fprintfOrDie(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"rank %d\"}}", rank, rank);
+
+    char* eventPtr = g_profilerState->customEventBuffer.get();
+
+    while (eventPtr < (g_profilerState->customEventBuffer.get() + g_profilerState->customEventOffset))
+    {
+        char* descriptionStr = eventPtr;
+        eventPtr += strlen(descriptionStr) + 1;
+
+        CustomEventRecord* eventRecord = (CustomEventRecord*)eventPtr;
+        eventPtr += sizeof(CustomEventRecord);
+
+        // the descriptions are literals and function names; drop the characters that would need escaping
+        std::string name(descriptionStr);
+        name.erase(std::remove_if(name.begin(), name.end(), [](char c) { return c == '"' || c == '\\' || (unsigned char)c < 0x20; }), name.end());
+
+        fprintfOrDie(f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+            name.c_str(), rank, eventRecord->threadId,
+            1e6 * TicksToSeconds(eventRecord->beginClock - g_profilerState->timelineOrigin),
+            1e6 * TicksToSeconds(eventRecord->endClock - eventRecord->beginClock));
+        if (eventRecord->bytes != 0 || eventRecord->peer != -1)
+            fprintfOrDie(f, ",\"args\":{\"bytes\":%lld,\"peer\":%d}", eventRecord->bytes, eventRecord->peer);
+        fprintfOrDie(f, "}");
     }
 
+    fprintfOrDie(f, "\n]}\n");
     fclose(f);
 }
 
@@ -26,6 +26,14 @@
 // and ProfilerThroughputBegin() calls should be used. The throughput APIs can only be used
 // with fixed events.
 //
+// Timeline
+//
+// At the time the profiler is torn down, the detailed events are also written as a Chrome trace
+// (a JSON file that chrome://tracing and similar viewers display as a timeline), with one process per rank
+// and one row per thread. Communication events can carry the number of bytes and the peer rank.
+// In distributed training, ProfilerSetTimelineOrigin() makes time zero of all ranks the same instant,
+// so that their traces can be viewed together.
+//
 // CNTK specifics
 //
 // The profiler is turned off during the very first epoch to avoid polluting profile data with
@@ -62,6 +70,8 @@ enum ProfilerEvents
     profilerEvtMainMinibatch,               // One minibatch loop time
     profilerEvtMainGetMinibatch,            // GetMinibatch() function time
     profilerEvtMainFB,                      // Forward + Backward pass time
+    profilerEvtMainForward,                 // Forward pass time
+    profilerEvtMainBackward,                // Backward pass time
     profilerEvtMainGradient,                // Gradient aggregation time
     profilerEvtMainWeights,                 // Weight update time
     profilerEvtMainPost,                    // Remainder time in minibatch loop
@@ -73,6 +83,7 @@ enum ProfilerEvents
 
     // Data reader events
     profilerEvtPrefetchMinibatch,           // Prefetching the next minibatch in a background thread
+    profilerEvtReaderWait,                  // Main thread waiting for the prefetched minibatch
 
     profilerEvtMax
 };
@@ -106,6 +117,20 @@ long long PERF_PROFILER_API ProfilerTimeBegin();
 void PERF_PROFILER_API ProfilerTimeEnd(const long long stateId, const int eventId);
 void PERF_PROFILER_API ProfilerTimeEnd(const long long stateId, const char* eventDescription);
 
+//
+// Measure a custom communication event time, with the number of bytes sent by this rank and
+// the rank of the peer (-1 for collective operations). Bytes and peer appear in the timeline.
+//
+void PERF_PROFILER_API ProfilerTimeEnd(const long long stateId, const char* eventDescription, const long long bytes, const int peer);
+
+//
+// Set the process of the timeline and its time zero.
+// rank: Process id of the events in the timeline.
+// originTimeStamp: Local time stamp (as returned by ProfilerTimeBegin()) of time zero.
+// By default, the process id is 0 and time zero is the time of the ProfilerInit() call.
+//
+void PERF_PROFILER_API ProfilerSetTimelineOrigin(const int rank, const long long originTimeStamp);
+
 //
 // Conditionally sync the GPU if the syncGPU flag is set. This only needs to be excplicitly
 // called for custom events.
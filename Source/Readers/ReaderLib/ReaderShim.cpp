@@ -12,6 +12,7 @@
 #endif
 
 #include <sstream>
+#include <chrono>
 #include "Basics.h"
 
 #define DATAREADER_EXPORTS // creating the exports here
@@ -25,8 +26,10 @@ namespace Microsoft { namespace MSR { namespace CNTK {
 template <class ElemType>
 ReaderShim<ElemType>::ReaderShim() :
     m_deviceId(CPUDEVICE),
+    m_prefetchDepth(1),
+    m_readerWaitSeconds(0),
     m_dataTransferers(2, DataTransfererPtr()),
-    m_currentDataTransferIndex(0),
+    m_nextDataTransferIndex(0),
     m_endOfEpoch(false),
     m_endOfSweep(false),
     m_currentSamplePosition(0),
@@ -60,6 +63,11 @@ void ReaderShim<ElemType>::Init(const ConfigParameters& config)
     // otherwise deferring - synchronous execution during .get() call
     m_launchType = prefetch ? launch::async : launch::deferred;
 
+    // Reading several minibatches ahead absorbs the variance of the reading time; without prefetch there is nothing to read ahead.
+    m_prefetchDepth = prefetch ? std::max<size_t>(config(L"prefetchDepth", (size_t)1), 1) : 1;
+    m_prefetchBuffers.resize(m_prefetchDepth);
+    m_dataTransferers.resize(m_prefetchDepth + 1);
+
     m_numParallelSequences = numberOfuttsPerMinibatchForAllEpochs[0];
 
     if (!m_reader)
@@ -98,16 +106,55 @@ void ReaderShim<ElemType>::StartDistributedMinibatchLoop(
 }
 
 template <class ElemType>
-void ReaderShim<ElemType>::SetCurrentSamplePosition(size_t currentSamplePosition)
+void ReaderShim<ElemType>::DiscardPrefetches()
 {
     // Make sure there are no outstanding reads.
-    if (m_prefetchTask.valid())
-        m_prefetchTask.wait();
+    for (auto& task : m_prefetchTasks)
+        task.m_result.wait();
+    m_prefetchTasks.clear();
 
     // Let's check that there is no outstanding copies.
     // Wait on all events if there are any pending copy operations in flight.
-    if (m_dataTransferers[m_currentDataTransferIndex])
-        m_dataTransferers[m_currentDataTransferIndex]->WaitForCopyCPUToGPU();
+    for (auto& transferer : m_dataTransferers)
+    {
+        if (transferer)
+            transferer->WaitForCopyCPUToGPU();
+    }
+}
+
+template <class ElemType>
+void ReaderShim<ElemType>::StartPrefetch(size_t slot)
+{
+    auto dataTransferIndex = m_nextDataTransferIndex;
+    m_nextDataTransferIndex = (m_nextDataTransferIndex + 1) % m_dataTransferers.size();
+
+    // The prefetch reads after the one before it has finished; past the end of the epoch, it does not read at all.
+    auto previous = m_prefetchTasks.empty() ? std::shared_future<PrefetchResult>() : m_prefetchTasks.back().m_result;
+    auto result = std::async(m_launchType, [this, previous, slot, dataTransferIndex]()
+    {
+        if (previous.valid() && previous.get().m_isEndOfEpoch)
+            return PrefetchResult{ false, true, false, previous.get().m_samplePosition, nullptr };
+
+        return PrefetchMinibatch(slot, dataTransferIndex);
+    });
+
+    m_prefetchTasks.push_back(PrefetchTask{ result.share(), slot, dataTransferIndex });
+}
+
+template <class ElemType>
+void ReaderShim<ElemType>::StartPrefetches()
+{
+    // Starting the prefetch tasks. There are always m_prefetchDepth reads queued or in flight.
+    // When the network requests a new minibatch, we wait for the oldest one to finish, swap the buffers
+    // and kick off a new prefetch.
+    for (size_t slot = 0; slot < m_prefetchDepth; slot++)
+        StartPrefetch(slot);
+}
+
+template <class ElemType>
+void ReaderShim<ElemType>::SetCurrentSamplePosition(size_t currentSamplePosition)
+{
+    DiscardPrefetches();
 
     // Set current position.
     m_reader->SetCurrentSamplePosition(currentSamplePosition);
@@ -118,43 +165,20 @@ void ReaderShim<ElemType>::SetCurrentSamplePosition(size_t currentSamplePosition
 template <class ElemType>
 void ReaderShim<ElemType>::SetConfiguration(const ReaderConfiguration& config, const std::map<std::wstring, int>& inputDescriptions)
 {
-    // Make sure there are no outstanding reads.
-    if (m_prefetchTask.valid())
-        m_prefetchTask.wait();
-
-    // Let's check that there is no outstanding copies.
-    // Wait on all events if there are any pending copy operations in flight.
-    if (m_dataTransferers[m_currentDataTransferIndex])
-        m_dataTransferers[m_currentDataTransferIndex]->WaitForCopyCPUToGPU();
+    // The minibatches read ahead are discarded; the reader goes back to the position of the last minibatch returned.
+    DiscardPrefetches();
 
     m_reader->SetConfiguration(config, inputDescriptions);
     m_reader->SetCurrentSamplePosition(m_currentSamplePosition);
 
-    // Start prefetch.
-    auto localCurrentDataTransferIndex = m_currentDataTransferIndex;
-    // Starting the prefetch task. There is always a single async read in flight.
-    // When the network requests a new minibatch, we wait for the current async to finish, swap the buffers
-    // and kick off the new prefetch.
-    m_prefetchTask = std::async(m_launchType,
-        [this, localCurrentDataTransferIndex]()
-    {
-        return PrefetchMinibatch(localCurrentDataTransferIndex);
-    });
+    StartPrefetches();
 }
 
 template <class ElemType>
 void ReaderShim<ElemType>::StartEpoch(const EpochConfiguration& config, const std::unordered_set<InputStreamDescription>& inputs)
 {
     // For adaptive minibatch, make sure there are no outstanding reads.
-    if (m_prefetchTask.valid())
-    {
-        m_prefetchTask.wait();
-    }
-
-    // Let's check that there is no outstanding copies.
-    // Wait on all events if there are any pending copy operations in flight.
-    if (m_dataTransferers[m_currentDataTransferIndex])
-        m_dataTransferers[m_currentDataTransferIndex]->WaitForCopyCPUToGPU();
+    DiscardPrefetches();
 
     // Now we can be sure, no prefetch thread is running and there are no outstanding memcopies.
     // Let's check that requested devices are ok and see whether we need to change our data transferers.
@@ -175,9 +199,10 @@ void ReaderShim<ElemType>::StartEpoch(const EpochConfiguration& config, const st
         // Device changed. Let's change the data transferers.
         m_deviceId = deviceId;
         m_dataTransferers.clear();
-        // We need two in order to support two operations in flight.
-        m_dataTransferers.push_back(m_deviceId == CPUDEVICE ? nullptr : CreatePrefetchDataTransferer(m_deviceId));
-        m_dataTransferers.push_back(m_deviceId == CPUDEVICE ? nullptr : CreatePrefetchDataTransferer(m_deviceId));
+        // We need one more than the prefetch depth in order to support all operations in flight.
+        for (size_t i = 0; i < m_prefetchDepth + 1; i++)
+            m_dataTransferers.push_back(m_deviceId == CPUDEVICE ? nullptr : CreatePrefetchDataTransferer(m_deviceId));
+        m_nextDataTransferIndex = 0;
     }
 
     // Let's create the buffers for the prefetch thread.
@@ -186,26 +211,21 @@ void ReaderShim<ElemType>::StartEpoch(const EpochConfiguration& config, const st
     {
         inputDescriptions[i.GetStreamName()] = i.GetDeviceId();
         // Creating buffers with the same properties the network expects.
-        m_prefetchBuffers[i.GetStreamName()] = StreamPrefetchBuffer
+        for (auto& buffers : m_prefetchBuffers)
         {
-            std::make_shared<Matrix<ElemType>>(0, 0, i.GetDeviceId(), i.GetMatrixType(), i.GetMatrixFormat()),
-            std::make_shared<MBLayout>()
-        };
+            buffers[i.GetStreamName()] = StreamPrefetchBuffer
+            {
+                std::make_shared<Matrix<ElemType>>(0, 0, i.GetDeviceId(), i.GetMatrixType(), i.GetMatrixFormat()),
+                std::make_shared<MBLayout>()
+            };
+        }
     }
 
     m_endOfEpoch = false;
     m_reader->StartEpoch(config, inputDescriptions);
     m_currentSamplePosition = m_reader->GetCurrentSamplePosition();
 
-    auto localCurrentDataTransferIndex = m_currentDataTransferIndex;
-    // Starting the prefetch task. There is always a single async read in flight.
-    // When the network requests a new minibatch, we wait for the current async to finish, swap the buffers
-    // and kick off the new prefetch.
-    m_prefetchTask = std::async(m_launchType,
-    [this, localCurrentDataTransferIndex]()
-    {
-        return PrefetchMinibatch(localCurrentDataTransferIndex);
-    });
+    StartPrefetches();
 }
 
 string EnumerateInputs(const unordered_map<wstring, size_t>& nameToStreamId)
@@ -255,14 +275,23 @@ bool ReaderShim<ElemType>::GetMinibatch(StreamMinibatchInputs& matrices)
         }
     }
 
-    // Make sure the prefetch has finished.
-    assert(m_prefetchTask.valid());
-    auto result = m_prefetchTask.get();
+    // The prefetches were discarded when the sample position was set.
+    if (m_prefetchTasks.empty())
+        StartPrefetches();
+
+    // Make sure the oldest prefetch has finished.
+    auto task = m_prefetchTasks.front();
+    m_prefetchTasks.pop_front();
+    auto profReaderWait = ProfilerTimeBegin();
+    auto waitStart = std::chrono::steady_clock::now();
+    auto result = task.m_result.get();
+    m_readerWaitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - waitStart).count();
+    ProfilerTimeEnd(profReaderWait, profilerEvtReaderWait);
 
     // Ok, prefetch is done.
 
     // Let's update our sample position.
-    m_currentSamplePosition = m_reader->GetCurrentSamplePosition();
+    m_currentSamplePosition = result.m_samplePosition;
 
     m_endOfEpoch = result.m_isEndOfEpoch;
     m_endOfSweep = result.m_isEndOfSweep;
@@ -272,23 +301,19 @@ bool ReaderShim<ElemType>::GetMinibatch(StreamMinibatchInputs& matrices)
         return false;
     }
 
-    // Remember current data transfer, async memcpy for it already started on the prefetch thread.
-    auto currentDataTransferIndex = m_currentDataTransferIndex;
-
-    matrices.m_getKeyById = m_getKeyById;
+    // Async memcpy for the current data transfer already started on the prefetch thread.
+    matrices.m_getKeyById = result.m_getKeyById;
 
-    // Let's update the current data transferer.
-    m_currentDataTransferIndex = (m_currentDataTransferIndex + 1) % 2;
-
-    // Record an event that prefetch can wait on to ensure that prior compute has finished.
-    if (m_dataTransferers[m_currentDataTransferIndex])
-        m_dataTransferers[m_currentDataTransferIndex]->RecordComputeStreamSyncPoint();
+    // Record an event that the next prefetch can wait on to ensure that prior compute has finished.
+    if (m_dataTransferers[m_nextDataTransferIndex])
+        m_dataTransferers[m_nextDataTransferIndex]->RecordComputeStreamSyncPoint();
 
     // We have some data - let's swap the matrices.
     // We cannot simply change pointers because it seems they are remembered deeper in the network.
+    auto& prefetchBuffers = m_prefetchBuffers[task.m_slot];
     for (auto i = matrices.begin(); i != matrices.end(); ++i)
     {
-        std::swap(i->second.GetMatrix<ElemType>(), *m_prefetchBuffers[i->first].m_matrix);
+        std::swap(i->second.GetMatrix<ElemType>(), *prefetchBuffers[i->first].m_matrix);
 
         // Resetting layouts.
         i->second.pMBLayout->Init(1, 0);
@@ -300,7 +325,7 @@ bool ReaderShim<ElemType>::GetMinibatch(StreamMinibatchInputs& matrices)
     // Let's now check the layouts and throw if the same layout is being assigned twice.
     for (auto i = matrices.begin(); i != matrices.end(); ++i)
     {
-        auto streamLayout = m_prefetchBuffers[i->first].m_mbLayout;
+        auto streamLayout = prefetchBuffers[i->first].m_mbLayout;
         auto& layout = i->second.pMBLayout;
         if (layout->GetNumCols() == 0) // just initialized, let's take the layout of the reader.
         {
@@ -321,37 +346,34 @@ bool ReaderShim<ElemType>::GetMinibatch(StreamMinibatchInputs& matrices)
     // So pick up the first one.
     m_numParallelSequences = matrices.begin()->second.pMBLayout->GetNumParallelSequences();
 
-    // It is time to issue the next prefetch.
+    // It is time to issue the next prefetch, into the buffers we have just swapped out.
     if (!m_endOfEpoch)
-    {
-        // Starting the prefetch task. There is always a single async read in flight.
-        // When the network requests a new minibatch, we wait for the current async to finish, swap the buffers
-        // and kick off the new prefetch.
-        auto localCurrentDataTransferIndex = m_currentDataTransferIndex;
-        m_prefetchTask = std::async(m_launchType, [this, localCurrentDataTransferIndex]() { return PrefetchMinibatch(localCurrentDataTransferIndex); });
-    }
+        StartPrefetch(task.m_slot);
 
-    // Let's wait till the previous memcopy has finished.
-    if (m_dataTransferers[currentDataTransferIndex])
-        m_dataTransferers[currentDataTransferIndex]->WaitForCopyCPUToGPU();
+    // Let's wait till the memcopy of this minibatch has finished.
+    if (m_dataTransferers[task.m_dataTransferIndex])
+        m_dataTransferers[task.m_dataTransferIndex]->WaitForCopyCPUToGPU();
 
     return result.m_isDataAvailable;
 }
 
 template <class ElemType>
-typename ReaderShim<ElemType>::PrefetchResult ReaderShim<ElemType>::PrefetchMinibatch(size_t currentDataTransferIndex)
+typename ReaderShim<ElemType>::PrefetchResult ReaderShim<ElemType>::PrefetchMinibatch(size_t slot, size_t currentDataTransferIndex)
 {
     PROFILE_SCOPE(profilerEvtPrefetchMinibatch);
 
+    auto& prefetchBuffers = m_prefetchBuffers[slot];
+
     // Resetting layouts.
-    for (auto& mx : m_prefetchBuffers)
+    for (auto& mx : prefetchBuffers)
         mx.second.m_mbLayout = std::make_shared<MBLayout>();
 
     Minibatch minibatch = m_reader->ReadMinibatch();
+    size_t samplePosition = m_reader->GetCurrentSamplePosition();
 
     // If there is no data we can simply return.
     if (minibatch.m_data.empty())
-        return PrefetchResult{ minibatch.m_endOfSweep, minibatch.m_endOfEpoch, false };
+        return PrefetchResult{ minibatch.m_endOfSweep, minibatch.m_endOfEpoch, false, samplePosition, nullptr };
 
     // Ok we have some data. Let's load it to GPU.
     // But before we need to make sure that corresponding compute has already finished from the last iteration.
@@ -360,9 +382,7 @@ typename ReaderShim<ElemType>::PrefetchResult ReaderShim<ElemType>::PrefetchMini
     if (m_dataTransferers[currentDataTransferIndex])
         m_dataTransferers[currentDataTransferIndex]->WaitForSyncPointOnAssignStreamAsync();
 
-    m_getKeyById = minibatch.m_getKeyById;
-
-    for (auto& mx : m_prefetchBuffers)
+    for (auto& mx : prefetchBuffers)
     {
         size_t streamId = m_nameToStreamId[mx.first];
         const auto& stream = minibatch.m_data[streamId];
@@ -374,9 +394,16 @@ typename ReaderShim<ElemType>::PrefetchResult ReaderShim<ElemType>::PrefetchMini
 
     // Let's record that we started the copy, so that the main thread can wait afterwards.
     if (m_dataTransferers[currentDataTransferIndex])
+    {
         m_dataTransferers[currentDataTransferIndex]->RecordCPUToGPUCopy();
 
-    return PrefetchResult{ minibatch.m_endOfSweep, minibatch.m_endOfEpoch, true };
+        // The packer alternates between two host buffers only. When reading further ahead, the copy has to finish
+        // before the next minibatch is packed into the buffer it copies from.
+        if (m_prefetchDepth > 1)
+            m_dataTransferers[currentDataTransferIndex]->WaitForCopyCPUToGPU();
+    }
+
+    return PrefetchResult{ minibatch.m_endOfSweep, minibatch.m_endOfEpoch, true, samplePosition, minibatch.m_getKeyById };
 }
 
 
@@ -11,6 +11,7 @@
 #include <unordered_map>
 #include <string>
 #include <future>
+#include <deque>
 #include "DataReader.h"
 #include "Reader.h"
 
@@ -47,10 +48,10 @@ public:
         // Make sure there are no outstanding reads.
         // Future destructor does not wait as of 2013 so probably it is not in VS2013:
         // More info can be found here http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2013/n3679.html.
-        if (m_prefetchTask.valid())
+        for (auto& task : m_prefetchTasks)
         {
             // If there are some, give them time to finish.
-            m_prefetchTask.wait_for(std::chrono::seconds(5));
+            task.m_result.wait_for(std::chrono::seconds(5));
             // TODO: if the prefetch is still valid, print a warning here!
         }
 
@@ -106,17 +107,49 @@ public:
         return m_endOfSweep;
     }
 
+    // Total time GetMinibatch() has spent waiting for the prefetch to deliver, i.e. the time the reader has not kept up with the consumer.
+    double GetReaderWaitSeconds() const
+    {
+        return m_readerWaitSeconds;
+    }
+
 private:
     struct PrefetchResult
     {
         bool m_isEndOfSweep;
         bool m_isEndOfEpoch;
         bool m_isDataAvailable;
+
+        // Sample position of the reader after this minibatch, and the key mapping of its sequences.
+        size_t m_samplePosition;
+        std::function<std::string(size_t)> m_getKeyById;
     };
 
-    PrefetchResult PrefetchMinibatch(size_t currentDataTransferIndex);
+    PrefetchResult PrefetchMinibatch(size_t slot, size_t dataTransferIndex);
+
+    // Starts the prefetch of the next minibatch into the buffers of 'slot', behind the prefetches already in flight.
+    void StartPrefetch(size_t slot);
+
+    // Starts the prefetch of m_prefetchDepth minibatches.
+    void StartPrefetches();
+
+    // Waits for the prefetches and copies in flight, and discards their results.
+    void DiscardPrefetches();
 
-    std::future<PrefetchResult> m_prefetchTask;
+    struct PrefetchTask
+    {
+        std::shared_future<PrefetchResult> m_result;
+        size_t m_slot;
+        size_t m_dataTransferIndex;
+    };
+
+    // Prefetches in flight, oldest first. They run one after another, because the reader is not thread-safe.
+    std::deque<PrefetchTask> m_prefetchTasks;
+
+    // Number of minibatches read ahead of the consumer (config parameter 'prefetchDepth', 1 by default).
+    size_t m_prefetchDepth;
+
+    double m_readerWaitSeconds;
     ReaderPtr m_reader;
     ReaderFactory m_factory;
     bool m_endOfEpoch;
@@ -135,22 +168,18 @@ private:
         MBLayoutPtr m_mbLayout;
     };
 
-    // Intermediate buffer where the prefetch thread puts its data to.
-    // When the main thread enters GetMinibatch it swaps the matrices from this buffer,
-    // triggers the next prefetch and waits if memCpy is still in progress.
-    std::unordered_map<std::wstring, StreamPrefetchBuffer> m_prefetchBuffers;
+    // Intermediate buffers where the prefetch thread puts its data to, one set per prefetched minibatch (slot).
+    // When the main thread enters GetMinibatch it swaps the matrices from the buffers of the oldest slot,
+    // triggers the prefetch of the next minibatch into that slot and waits if memCpy is still in progress.
+    std::vector<std::unordered_map<std::wstring, StreamPrefetchBuffer>> m_prefetchBuffers;
 
-    // Alternating data transfer operations. In the current version these are only two - 
-    // currently waiting on the main thread and the one that can be started by the prefetch thread 
-    // in the meantime.
+    // Rotating data transfer operations, m_prefetchDepth + 1 of them: one per prefetch in flight,
+    // and the one of the minibatch the main thread is waiting on.
     std::vector<DataTransfererPtr> m_dataTransferers;
 
-    // Id to key mapping.
-    std::function<std::string(size_t)> m_getKeyById;
-
-    // Current data transfer. Flips 0 and 1.
-    // Can be changed only from the main thread with no ongoing prefetch.
-    size_t m_currentDataTransferIndex; 
+    // Data transfer of the next prefetch.
+    // Can be changed only from the main thread.
+    size_t m_nextDataTransferIndex;
 
     // Device id.
     int m_deviceId;
@@ -2,7 +2,7 @@
 // Copyright (c) Microsoft. All rights reserved.
 // Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
 //
-// ASGDHelper.cpp : Implements ASGDHelper interface. The implementation is based on Multiverso.
+// ASGDHelper.cpp : Implements ASGDHelper interface, either based on Multiverso or on a built-in MPI parameter server.
 //
 
 #define _CRT_SECURE_NO_WARNINGS // "secure" CRT not available on all platforms  --add this at the top of all CPP files that give "function or variable may be unsafe" warnings
@@ -595,8 +595,318 @@ private:
 
 #endif 
 
+// MPIParameterServerHelper is the built-in implementation of ASGDHelper interface, used when CNTK is built without Multiverso.
+// The model is kept as one flat array that is cut into one shard per rank. Every rank hosts its shard in an MPI window,
+// and the workers update and read all shards with one-sided operations inside a shared (passive target) access epoch:
+//  - a push adds the local model change since the last pull to the shards with MPI_Get_accumulate, which also returns the
+//    shards as they were right before the addition, so that push and pull are a single round trip;
+//  - MPI applies the additions element-wise atomically, so pushes of several workers to the same shard need neither
+//    locks nor a server thread on the owning rank;
+//  - MPI places the window in shared memory where it can, so that ranks on the same host access each other's shards directly.
+// With delay compensation (DC-ASGD), a push is corrected for the updates that other workers made to the model since this worker
+// pulled it: delta -= lambda * delta .* delta .* (w - wPulled), where w is the server model right before the push. The correction
+// depends on w, so it is added in a second operation, once the first one has returned w.
+template<class ElemType = float>
+class MPIParameterServerHelper : public ASGDHelper<ElemType>
+{
+public:
+    typedef shared_ptr<ComputationNode<ElemType>> ComputationNodePtr;
+
+    MPIParameterServerHelper(const std::list<ComputationNodeBasePtr> & learnableNodes, // Parameters that needs to be train
+        bool useAsyncBuffer,                                                           // not supported, see below
+        bool isSimulatedModelAveragingSGD,                                             // Using parameter server-based MA rather than ASGD
+        AdjustLearningRateAtBeginning adjusttype,                                      // Adjust learning per minibatches at very begining of training process
+        double adjustCoef,                                                             // see in DecayCoefficient()
+        size_t adjustPerMinibatches,                                                   //
+        int traceLevel,                                                                // log level
+        int syncPerfStats,                                                             // shown perf data every syncPerfStats
+        bool useDelayCompensation,                                                     // DC-ASGD
+        double delayCompensationLambda,                                                // variance control parameter of DC-ASGD
+        const MPIWrapperPtr& pMPI) :
+        m_pMPI(pMPI), m_ModelAveragingSGDSimulating(isSimulatedModelAveragingSGD),
+        m_adjustLearningRateAtBeginningType(adjusttype), m_adjustCoefficient(adjustCoef), m_adjustMBNumber(adjustPerMinibatches),
+        m_traceLevel(traceLevel), m_syncPerfStats(syncPerfStats),
+        m_useDelayCompensation(useDelayCompensation), m_delayCompensationLambda((ElemType)delayCompensationLambda),
+        m_parameterSyncCounter(0), m_window(), m_shard(nullptr), m_numBytesSinceLastReport(0), m_networkSecondsSinceLastReport(0)
+    {
+        if (!m_pMPI)
+            m_pMPI = MPIWrapper::GetInstance();
+
+        // MPI runs with MPI_THREAD_SERIALIZED, so the push and pull cannot be overlapped with the next minibatches
+        // on a background thread while the main thread may call MPI as well.
+        if (useAsyncBuffer && m_traceLevel > 0)
+            fprintf(stderr, "MPIParameterServerHelper: UsePipeline is not supported by the built-in parameter server and is ignored.\n");
+
+        for (auto& learnableNode : learnableNodes)
+        {
+            ComputationNodePtr node = dynamic_pointer_cast<ComputationNode<ElemType>>(learnableNode);
+            m_tableOffsets.push_back(m_totalModelSize);
+            m_tableLength.push_back(node->Value().GetNumElements());
+            m_totalModelSize += m_tableLength.back();
+        }
+
+        // rank r hosts the elements [m_shardBegin[r], m_shardBegin[r+1]) of the model
+        size_t numWorkers = m_pMPI->NumNodesInUse();
+        m_shardBegin.resize(numWorkers + 1);
+        for (size_t r = 0; r <= numWorkers; r++)
+            m_shardBegin[r] = m_totalModelSize * r / numWorkers;
+
+        size_t myRank = m_pMPI->CurrentNodeRank();
+        size_t shardSize = m_shardBegin[myRank + 1] - m_shardBegin[myRank];
+        m_pMPI->Win_allocate(shardSize * sizeof(ElemType), sizeof(ElemType), &m_shard, &m_window) || MpiFail("MPIParameterServerHelper: MPI_Win_allocate");
+        m_pMPI->Win_lock_all(m_window) || MpiFail("MPIParameterServerHelper: MPI_Win_lock_all");
+
+        m_base.resize(m_totalModelSize);
+        m_delta.resize(m_totalModelSize);
+        m_pulled.resize(m_totalModelSize);
+        if (m_useDelayCompensation)
+            m_correction.resize(m_totalModelSize);
+
+        if (m_traceLevel > 0)
+            fprintf(stderr, "MPIParameterServerHelper: %d elements in %d shards, %d on this rank%s.\n",
+                    (int)m_totalModelSize, (int)numWorkers, (int)shardSize, m_useDelayCompensation ? ", delay compensation enabled" : "");
+    }
+
+    ~MPIParameterServerHelper()
+    {
+        m_pMPI->Win_unlock_all(m_window) || MpiFail("~MPIParameterServerHelper: MPI_Win_unlock_all");
+        m_pMPI->Win_free(&m_window) || MpiFail("~MPIParameterServerHelper: MPI_Win_free");
+    }
+
+    void InitModel(const std::list<ComputationNodeBasePtr> & learnableNodes) override
+    {
+        // the main node uploads its model; every node then starts from it
+        if (m_pMPI->IsMainNode())
+        {
+            CopyModelToBuffer(learnableNodes, m_base.data());
+            ForEachPiece([&](int rank, size_t displacement, size_t begin, int count)
+            {
+                m_pMPI->Accumulate(m_base.data() + begin, count, MPIWrapper::GetDataType(m_base.data()), rank, displacement, MPI_REPLACE, m_window) || MpiFail("InitModel: MPI_Accumulate");
+            });
+            m_pMPI->Win_flush_all(m_window) || MpiFail("InitModel: MPI_Win_flush_all");
+        }
+        m_pMPI->WaitAll();
+
+        Pull(m_base.data());
+        // nobody may push before everyone has pulled the initial model
+        m_pMPI->WaitAll();
+
+        CopyBufferToModel(m_base.data(), learnableNodes);
+        m_reportTimer.Start();
+    }
+
+    bool PushAndPullModel(const std::list<ComputationNodeBasePtr> & learnableNodes, size_t sampleSinceLastSynced) override
+    {
+        m_parameterSyncCounter++;
+
+        // delta = the training progress since the model was last set from the server, scaled
+        ElemType factor = m_ModelAveragingSGDSimulating ? (ElemType)(1.0 / m_pMPI->NumNodesInUse()) : (ElemType)DecayCoefficient();
+        CopyModelToBuffer(learnableNodes, m_delta.data());
+        for (size_t i = 0; i < m_totalModelSize; i++)
+            m_delta[i] = (m_delta[i] - m_base[i]) * factor;
+
+        if (m_ModelAveragingSGDSimulating)
+            PushAllThenPull(m_delta.data(), m_pulled.data());
+        else
+            PushAndPull(m_delta.data(), m_base.data(), m_pulled.data());
+
+        m_base.swap(m_pulled);
+        CopyBufferToModel(m_base.data(), learnableNodes);
+
+        if (m_traceLevel > 2 && m_syncPerfStats > 0 && m_parameterSyncCounter % m_syncPerfStats == 0)
+            ReportPerfStats();
+
+        return true;
+    }
+
+    void WaitAll() override
+    {
+        m_pMPI->WaitAll();
+    }
+
+    void WaitAsyncBuffer() override { }
+
+private:
+    // Large shards are transferred in pieces, as MPI counts are ints.
+    static const size_t s_maxElementsPerOperation = 1 << 26;
+
+    // Calls f(rank, displacement in the shard of rank, offset in the model, count) for every piece of the model.
+    template <class F>
+    void ForEachPiece(const F& f) const
+    {
+        for (size_t r = 0; r + 1 < m_shardBegin.size(); r++)
+        {
+            for (size_t begin = m_shardBegin[r]; begin < m_shardBegin[r + 1]; begin += s_maxElementsPerOperation)
+            {
+                size_t count = std::min(s_maxElementsPerOperation, m_shardBegin[r + 1] - begin);
+                f((int)r, begin - m_shardBegin[r], begin, (int)count);
+            }
+        }
+    }
+
+    // Adds delta to the server model and returns the server model after the addition in 'pulled'.
+    // 'base' is the model that delta was computed against.
+    void PushAndPull(const ElemType* delta, const ElemType* base, ElemType* pulled)
+    {
+        Timer timer;
+        timer.Start();
+
+        MPI_Datatype dataType = MPIWrapper::GetDataType(pulled);
+        ForEachPiece([&](int rank, size_t displacement, size_t begin, int count)
+        {
+            m_pMPI->Get_accumulate(delta + begin, pulled + begin, count, dataType, rank, displacement, MPI_SUM, m_window) || MpiFail("PushAndPull: MPI_Get_accumulate");
+        });
+        m_pMPI->Win_flush_all(m_window) || MpiFail("PushAndPull: MPI_Win_flush_all");
+
+        // 'pulled' is the server model right before our addition
+        if (m_useDelayCompensation)
+        {
+            ElemType* correction = m_correction.data();
+            for (size_t i = 0; i < m_totalModelSize; i++)
+            {
+                correction[i] = -m_delayCompensationLambda * delta[i] * delta[i] * (pulled[i] - base[i]);
+                pulled[i] += delta[i] + correction[i];
+            }
+            ForEachPiece([&](int rank, size_t displacement, size_t begin, int count)
+            {
+                m_pMPI->Accumulate(correction + begin, count, dataType, rank, displacement, MPI_SUM, m_window) || MpiFail("PushAndPull: MPI_Accumulate");
+            });
+            m_pMPI->Win_flush_all(m_window) || MpiFail("PushAndPull: MPI_Win_flush_all");
+        }
+        else
+        {
+            for (size_t i = 0; i < m_totalModelSize; i++)
+                pulled[i] += delta[i];
+        }
+
+        timer.Stop();
+        OnTransferCompleted(timer.ElapsedSeconds(), (m_useDelayCompensation ? 3 : 2) * m_totalModelSize * sizeof(ElemType));
+    }
+
+    // Simulated model averaging: all workers add their delta before anyone pulls the sum.
+    void PushAllThenPull(const ElemType* delta, ElemType* pulled)
+    {
+        Timer timer;
+        timer.Start();
+
+        MPI_Datatype dataType = MPIWrapper::GetDataType(pulled);
+        ForEachPiece([&](int rank, size_t displacement, size_t begin, int count)
+        {
+            m_pMPI->Accumulate(delta + begin, count, dataType, rank, displacement, MPI_SUM, m_window) || MpiFail("PushAllThenPull: MPI_Accumulate");
+        });
+        m_pMPI->Win_flush_all(m_window) || MpiFail("PushAllThenPull: MPI_Win_flush_all");
+        m_pMPI->WaitAll();
+        Pull(pulled);
+        m_pMPI->WaitAll();
+
+        timer.Stop();
+        OnTransferCompleted(timer.ElapsedSeconds(), 2 * m_totalModelSize * sizeof(ElemType));
+    }
+
+    void Pull(ElemType* model)
+    {
+        MPI_Datatype dataType = MPIWrapper::GetDataType(model);
+        ForEachPiece([&](int rank, size_t displacement, size_t begin, int count)
+        {
+            m_pMPI->Get(model + begin, count, dataType, rank, displacement, m_window) || MpiFail("Pull: MPI_Get");
+        });
+        m_pMPI->Win_flush_all(m_window) || MpiFail("Pull: MPI_Win_flush_all");
+    }
+
+    void CopyModelToBuffer(const std::list<ComputationNodeBasePtr> & learnableNodes, ElemType* buffer) const
+    {
+        int i = 0; // indicate the index of learnable nodes
+        for (auto nodeIter = learnableNodes.begin(); nodeIter != learnableNodes.end(); nodeIter++, i++)
+        {
+            ComputationNodePtr node = dynamic_pointer_cast<ComputationNode<ElemType>>(*nodeIter);
+            ElemType* px = buffer + m_tableOffsets[i];
+            size_t length = m_tableLength[i]; // large enough, so CopyToArray() does not reallocate
+            node->Value().CopyToArray(px, length);
+        }
+    }
+
+    void CopyBufferToModel(ElemType* buffer, const std::list<ComputationNodeBasePtr> & learnableNodes) const
+    {
+        int i = 0; // indicate the index of learnable nodes
+        for (auto nodeIter = learnableNodes.begin(); nodeIter != learnableNodes.end(); nodeIter++, i++)
+        {
+            ComputationNodePtr node = dynamic_pointer_cast<ComputationNode<ElemType>>(*nodeIter);
+            Matrix<ElemType> &mat = node->Value();
+            mat.SetValue(mat.GetNumRows(), mat.GetNumCols(), mat.GetDeviceId(), buffer + m_tableOffsets[i]);
+        }
+    }
+
+    float DecayCoefficient() const
+    {
+        float f = 1.f;
+        switch (m_adjustLearningRateAtBeginningType)
+        {
+        case AdjustLearningRateAtBeginning::None:
+            break;
+        case AdjustLearningRateAtBeginning::Linearly:
+            f = min(f, max(0.f, (float)(m_adjustCoefficient + (1 - m_adjustCoefficient) / m_adjustMBNumber * m_parameterSyncCounter)));
+            break;
+        case AdjustLearningRateAtBeginning::Staircase:
+            f = min(f, max(0.f, (float)(m_adjustCoefficient * (m_parameterSyncCounter / m_adjustMBNumber + 1))));
+            break;
+        default:
+            break;
+        }
+        return f;
+    }
+
+    void OnTransferCompleted(double seconds, size_t numBytes)
+    {
+        m_networkSecondsSinceLastReport += seconds;
+        m_numBytesSinceLastReport += numBytes;
+        if (m_traceLevel > 3)
+            fprintf(stderr, "\t\t -- pullAndRequest, Worker <--> parameter server time %lf \n", seconds);
+    }
+
+    void ReportPerfStats()
+    {
+        m_reportTimer.Stop();
+        double secondsSinceLastReport = m_reportTimer.ElapsedSeconds();
+        m_reportTimer.Restart();
+
+        fprintf(stderr, "\t\t(parameter server stats) %d-th sync: %8.2f seconds since last report, %8.2f seconds in push and pull (%.2f MB transferred)\n",
+                (int)m_parameterSyncCounter, secondsSinceLastReport, m_networkSecondsSinceLastReport, m_numBytesSinceLastReport / 1e6);
+        m_networkSecondsSinceLastReport = 0;
+        m_numBytesSinceLastReport = 0;
+    }
+
+    MPIWrapperPtr m_pMPI;
+
+    bool m_ModelAveragingSGDSimulating;
+    AdjustLearningRateAtBeginning m_adjustLearningRateAtBeginningType;
+    double m_adjustCoefficient;
+    size_t m_adjustMBNumber;
+    int m_traceLevel;
+    int m_syncPerfStats;
+    bool m_useDelayCompensation;
+    ElemType m_delayCompensationLambda;
+    size_t m_parameterSyncCounter;
+
+    vector<size_t> m_tableLength;
+    vector<size_t> m_tableOffsets;
+    size_t m_totalModelSize = 0;
+    vector<size_t> m_shardBegin;
+
+    MPI_Win m_window;
+    ElemType* m_shard; // this rank's shard, owned by m_window
+
+    vector<ElemType> m_base; // the model as set at the last sync, which the next delta is computed against
+    vector<ElemType> m_delta;
+    vector<ElemType> m_pulled;
+    vector<ElemType> m_correction; // delay compensation
+
+    Timer m_reportTimer;
+    size_t m_numBytesSinceLastReport;
+    double m_networkSecondsSinceLastReport;
+};  // Class MPIParameterServerHelper
+
 // A None implementation of ASGDHelper interface which does nothing
-// This is used when CNTK_ENABLE_ASGD = false
+// This is used when CNTK is built without Multiverso and without MPI
 template<class ElemType = float>
 class NoneASGDHelper : public ASGDHelper<ElemType>
 {
@@ -635,11 +945,20 @@ ASGDHelper<ElemType>* NewASGDHelper(
     double adjustCoef,
     size_t adjustPerMinibatches,
     int traceLevel,
-    int syncPerfStats) 
+    int syncPerfStats,
+    bool useDelayCompensation,
+    double delayCompensationLambda,
+    const MPIWrapperPtr& pMPI)
 {
 #ifdef ASGD_PARALLEL_SUPPORT
+    if (useDelayCompensation)
+        InvalidArgument("Delay compensation (useDCASGD) is only supported by the built-in parameter server, not by Multiverso.");
     return new MultiversoHelper<ElemType>(learnableNodes, nodeNumRanks, useAsyncBuffer, isSimulatedModelAveragingSGD, 
                                       adjusttype, adjustCoef, adjustPerMinibatches, traceLevel, syncPerfStats);
+#elif HAS_MPI
+    return new MPIParameterServerHelper<ElemType>(learnableNodes, useAsyncBuffer, isSimulatedModelAveragingSGD,
+                                                  adjusttype, adjustCoef, adjustPerMinibatches, traceLevel, syncPerfStats,
+                                                  useDelayCompensation, delayCompensationLambda, pMPI);
 #else
     return new NoneASGDHelper<ElemType>(learnableNodes, nodeNumRanks, useAsyncBuffer, isSimulatedModelAveragingSGD, 
                                       adjusttype, adjustCoef, adjustPerMinibatches, traceLevel, syncPerfStats); 
@@ -655,7 +974,10 @@ template ASGDHelper<float>* NewASGDHelper<float>(
     double adjustCoef,
     size_t adjustPerMinibatches,
     int traceLevel,
-    int syncPerfStats); 
+    int syncPerfStats,
+    bool useDelayCompensation,
+    double delayCompensationLambda,
+    const MPIWrapperPtr& pMPI);
 
 template ASGDHelper<double>* NewASGDHelper<double>(
     const std::list<ComputationNodeBasePtr> & learnableNodes,
@@ -666,6 +988,9 @@ template ASGDHelper<double>* NewASGDHelper<double>(
     double adjustCoef,
     size_t adjustPerMinibatches,
     int traceLevel,
-    int syncPerfStats); 
+    int syncPerfStats,
+    bool useDelayCompensation,
+    double delayCompensationLambda,
+    const MPIWrapperPtr& pMPI);
 
 }}} 
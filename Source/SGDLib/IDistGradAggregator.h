@@ -19,6 +19,13 @@ public:
     // Returns a boolean indicating if any samples were processed
     virtual bool AggregateGradients(const std::vector<Matrix<ElemType>*>& gradients, DistGradHeader* headerCPU, bool resetState) = 0;
 
+    // Aggregators that support overlapping aggregation with backprop are told about each gradient as soon as it is final
+    // (before AggregateGradients() is called for the minibatch). The aggregated value of a gradient is then only
+    // guaranteed to be available after WaitForGradient() has been called for it.
+    virtual bool SupportsOverlappedAggregation() const { return false; }
+    virtual void OnGradientComplete(Matrix<ElemType>* /*gradient*/) {}
+    virtual void WaitForGradient(Matrix<ElemType>* /*gradient*/) {}
+
     size_t NumProc()
     {
         return m_mpi->NumNodesInUse();
@@ -35,6 +42,31 @@ public:
     }
 
 protected:
+    // Sums all header fields over the workers with a single all-reduce
+    void AllReduceHeader(DistGradHeader* headerCPU)
+    {
+        std::vector<double> values;
+        values.push_back((double) headerCPU->numSamples);
+        values.push_back((double) headerCPU->numSamplesWithLabel);
+        values.push_back(headerCPU->criterion);
+        for (int i = 0; i < headerCPU->numEvalNode; i++)
+        {
+            values.push_back(headerCPU->evalErrors[i].first);
+            values.push_back((double) headerCPU->evalErrors[i].second);
+        }
+
+        m_mpi->AllReduce(values);
+
+        headerCPU->numSamples = (size_t) values[0];
+        headerCPU->numSamplesWithLabel = (size_t) values[1];
+        headerCPU->criterion = values[2];
+        for (int i = 0; i < headerCPU->numEvalNode; i++)
+        {
+            headerCPU->evalErrors[i].first = values[3 + 2 * i];
+            headerCPU->evalErrors[i].second = (size_t) values[4 + 2 * i];
+        }
+    }
+
     MPIWrapperPtr m_mpi;
 };
 
@@ -43,5 +75,6 @@ protected:
 protected:                                        \
     using IDistGradAggregator<ElemType>::m_mpi;   \
     using IDistGradAggregator<ElemType>::NumProc; \
-    using IDistGradAggregator<ElemType>::MyRank
+    using IDistGradAggregator<ElemType>::MyRank;  \
+    using IDistGradAggregator<ElemType>::AllReduceHeader
 } } }
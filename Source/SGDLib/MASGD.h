@@ -11,6 +11,7 @@
 #include "SGD.h"
 #include "Matrix.h"
 #include "MPIWrapper.h"
+#include "PerformanceProfiler.h"
 #include "TimerUtility.h"
 #include <vector>
 #include <string>
@@ -39,12 +40,18 @@ namespace Microsoft { namespace MSR { namespace CNTK {
         size_t m_localSamplesProcessedSinceLastReport; 
         double m_accumulatedSecondsOnSyncPointInOneEpoch;
         size_t m_syncPointHitCounterInOneEpoch;
+        size_t m_asyncAggregationsInOneEpoch;
+        size_t m_asyncAggregationsAfterDataEndInOneEpoch;
+        double m_accumulatedSecondsInFlightInOneEpoch;
+        double m_accumulatedSecondsWaitedInOneEpoch;
         Timer  m_Timer; 
 
     public:
         MASGDPerfStats(size_t myRank, size_t numWorkers):
             m_numWorkers(numWorkers), m_myRank(myRank), m_numSyncPerformedInCurrentEpoch(0), m_reportFrequency(1), 
-            m_totalSamplesProcessedSinceLastReport(0), m_localSamplesProcessedSinceLastReport(0)
+            m_totalSamplesProcessedSinceLastReport(0), m_localSamplesProcessedSinceLastReport(0),
+            m_accumulatedSecondsOnSyncPointInOneEpoch(0), m_syncPointHitCounterInOneEpoch(0),
+            m_asyncAggregationsInOneEpoch(0), m_asyncAggregationsAfterDataEndInOneEpoch(0), m_accumulatedSecondsInFlightInOneEpoch(0), m_accumulatedSecondsWaitedInOneEpoch(0)
         {
             m_Timer.Start();
         }
@@ -60,10 +67,35 @@ namespace Microsoft { namespace MSR { namespace CNTK {
             m_numSyncPerformedInCurrentEpoch = 0; 
             m_accumulatedSecondsOnSyncPointInOneEpoch = 0;
             m_syncPointHitCounterInOneEpoch = 0;
+            m_asyncAggregationsInOneEpoch = 0;
+            m_asyncAggregationsAfterDataEndInOneEpoch = 0;
+            m_accumulatedSecondsInFlightInOneEpoch = 0;
+            m_accumulatedSecondsWaitedInOneEpoch = 0;
         }
         void OnEpochEnd()
         {
             m_Timer.Stop();
+            if (m_asyncAggregationsInOneEpoch > 0)
+            {
+                fprintf(stderr, "\t\t(model aggregation stats): %d asynchronous aggregations were in flight for %.2f seconds, of which %.2f seconds were waited for (%.1f%% hidden behind training); %d were posted after the end of the local data\n",
+                        (int)m_asyncAggregationsInOneEpoch,
+                        m_accumulatedSecondsInFlightInOneEpoch,
+                        m_accumulatedSecondsWaitedInOneEpoch,
+                        m_accumulatedSecondsInFlightInOneEpoch > 0 ? 100.0 * (1.0 - m_accumulatedSecondsWaitedInOneEpoch / m_accumulatedSecondsInFlightInOneEpoch) : 0.0,
+                        (int)m_asyncAggregationsAfterDataEndInOneEpoch);
+            }
+        }
+        // for asynchronous model aggregation: how long an aggregation took from posting to completion, and how much of that was spent waiting for it
+        void OnAsyncMACompleted(double secondsInFlight, double secondsWaited)
+        {
+            m_asyncAggregationsInOneEpoch++;
+            m_accumulatedSecondsInFlightInOneEpoch += secondsInFlight;
+            m_accumulatedSecondsWaitedInOneEpoch += secondsWaited;
+        }
+        // for asynchronous model aggregation: a worker that has run out of data keeps posting aggregations until all workers have
+        void OnAsyncMAPostedAfterDataEnd()
+        {
+            m_asyncAggregationsAfterDataEndInOneEpoch++;
         }
         void OnMAPerformed(size_t localSamplesProcessedSinceLastSync, size_t totalSamplesProcessedSinceLastSync, float secondsOnCommunication)
         {
@@ -162,7 +194,9 @@ namespace Microsoft { namespace MSR { namespace CNTK {
              if (read2sync)
              {
                  m_numSyncPerformed++;
+                 auto profModelAggregation = ProfilerTimeBegin();
                  ModelAggregationProcessing(samplesSinceLastSync, LearnableNodes, smoothedGradient, totalSamplesProcessed, secondsOnCommunication);
+                 ProfilerTimeEnd(profModelAggregation, "Model Aggregation");
                  m_perfReporter.OnMAPerformed(samplesSinceLastSync, totalSamplesProcessed, secondsOnCommunication);
              }
              
@@ -187,7 +221,9 @@ namespace Microsoft { namespace MSR { namespace CNTK {
              if (read2Sync)
              {
                  m_numSyncPerformed++;
+                 auto profModelAggregation = ProfilerTimeBegin();
                  ModelAggregationProcessing(samplesSinceLastSync, LearnableNodes, smoothedGradient, totalSamplesProcessed, secondsOnCommunication);
+                 ProfilerTimeEnd(profModelAggregation, "Model Aggregation");
                  m_perfReporter.OnMAPerformed(samplesSinceLastSync, totalSamplesProcessed, secondsOnCommunication);
              }
              return read2Sync;
@@ -404,4 +440,218 @@ namespace Microsoft { namespace MSR { namespace CNTK {
         }
     };
 
+
+    // Model averaging with bounded staleness: at a sync point, the (sample-weighted) local model is all-reduced
+    // asynchronously and training continues. The average is merged 'maxStaleness' sync points later, keeping the
+    // progress made locally in the meantime:
+    //     model = model + (average - model as it was sent)
+    // so a slow worker delays the others only if it is more than 'maxStaleness' periods behind.
+    //
+    // The number of all-reductions must agree on all workers, but workers may reach the end of an epoch after a different
+    // number of sync points. Each aggregation therefore also counts the workers that are done: a finished worker keeps
+    // contributing (with weight 0) until an aggregation reports that all of them are done; then the models are averaged once
+    // more synchronously, so that all workers start the next epoch from the same model.
+    template<typename ElemType>
+    class AsyncModelAveragingSGD : public IMASGD<ElemType>
+    {
+        typedef IMASGD<ElemType> Base;
+        using Base::m_pMPI;
+        using Base::m_numWorkers;
+        using Base::m_numSyncPerformed;
+        using Base::m_perfReporter;
+        using Base::DownCast;
+
+        struct PendingAggregation
+        {
+            std::vector<ElemType> buffer;                       // sample-weighted models, followed by the number of samples and of finished workers
+            std::vector<std::unique_ptr<Matrix<ElemType>>> sentModels;
+            MPI_Request request;
+            Timer inFlightTimer;
+        };
+
+    public:
+        AsyncModelAveragingSGD(const MPIWrapperPtr& pMPI, size_t reportFreq, DEVICEID_TYPE devID, size_t maxStaleness)
+            : Base(pMPI, reportFreq, devID), m_aggregations(std::max<size_t>(maxStaleness, 1)), m_numPosted(0), m_numCompleted(0)
+        {
+            fprintf(stderr, "Parallel training (%d workers) using ModelAveraging with asynchronous aggregation (maxStaleness = %d)\n", (int)m_pMPI->NumNodesInUse(), (int)m_aggregations.size());
+        }
+
+        bool OnArrivingAtSyncPoint(
+            const std::list<ComputationNodeBasePtr>& learnableNodes,
+            std::list<Matrix<ElemType>>&             /*smoothedGradient*/,
+            size_t                                   samplesSinceLastSync) override
+        {
+            Timer syncPointTimer;
+            syncPointTimer.Start();
+            size_t totalSamplesProcessed = 0;
+            float secondsWaited = 0.0f;
+            auto profModelAggregation = ProfilerTimeBegin();
+            if (NumPending() == m_aggregations.size())
+                CompleteOldestAggregation(learnableNodes, totalSamplesProcessed, secondsWaited);
+
+            PostAggregation(learnableNodes, samplesSinceLastSync, false);
+            ProfilerTimeEnd(profModelAggregation, "Model Aggregation");
+            syncPointTimer.Stop();
+
+            m_numSyncPerformed++;
+            m_perfReporter.OnArriveAtSyncPoint(syncPointTimer.ElapsedSeconds(), true);
+            m_perfReporter.OnMAPerformed(samplesSinceLastSync, totalSamplesProcessed, secondsWaited);
+            return true;
+        }
+
+        void OnEpochEnd(const std::list<ComputationNodeBasePtr>& learnableNodes,
+                        std::list<Matrix<ElemType>>&             /*smoothedGradient*/,
+                        size_t                                   samplesSinceLastSync) override
+        {
+            Timer syncPointTimer;
+            syncPointTimer.Start();
+            size_t totalSamplesProcessed = 0;
+            float secondsWaited = 0.0f;
+
+            // keep aggregating until all workers are done
+            auto profModelAggregation = ProfilerTimeBegin();
+            PostAggregation(learnableNodes, samplesSinceLastSync, true);
+            bool allFinished = false;
+            while (NumPending() > 0)
+            {
+                allFinished = CompleteOldestAggregation(learnableNodes, totalSamplesProcessed, secondsWaited);
+                if (!allFinished && (NumPending() == 0))
+                    PostAggregation(learnableNodes, 0, true);
+            }
+
+            AverageModels(learnableNodes);
+            ProfilerTimeEnd(profModelAggregation, "Model Aggregation");
+            syncPointTimer.Stop();
+
+            m_numSyncPerformed++;
+            m_perfReporter.OnArriveAtSyncPoint(syncPointTimer.ElapsedSeconds(), true);
+            m_perfReporter.OnMAPerformed(samplesSinceLastSync, totalSamplesProcessed, secondsWaited);
+            m_pMPI->WaitAll();
+            m_perfReporter.OnEpochEnd();
+        }
+
+        void ModelAggregationProcessing(
+            size_t                                    /*samplesSinceLastSync*/,
+            const std::list<ComputationNodeBasePtr>&  /*learnableNodes*/,
+            std::list<Matrix<ElemType>>&              /*smoothedGradient*/,
+            size_t&                                   /*totalSamplesProcessed*/,
+            float&                                    /*secondsOnCommunication*/) override
+        {
+            LogicError("AsyncModelAveragingSGD: ModelAggregationProcessing is not used, aggregations are posted and completed at the sync points.");
+        }
+
+    private:
+        size_t NumPending() const
+        {
+            return m_numPosted - m_numCompleted;
+        }
+
+        std::vector<Matrix<ElemType>*> ModelsToAggregate(const std::list<ComputationNodeBasePtr>& learnableNodes)
+        {
+            std::vector<Matrix<ElemType>*> models;
+            for (auto& pBaseNode : learnableNodes)
+            {
+                if (pBaseNode->IsParameterUpdateRequired())
+                    models.push_back(&DownCast(pBaseNode)->Value());
+            }
+            return models;
+        }
+
+        void PostAggregation(const std::list<ComputationNodeBasePtr>& learnableNodes, size_t samples, bool finished)
+        {
+            auto models = ModelsToAggregate(learnableNodes);
+            auto& aggregation = m_aggregations[m_numPosted % m_aggregations.size()];
+
+            size_t numElements = 0;
+            for (auto model : models)
+                numElements += model->GetNumElements();
+            aggregation.buffer.resize(numElements + 2);
+            aggregation.sentModels.resize(models.size());
+
+            size_t offset = 0;
+            for (size_t i = 0; i < models.size(); i++)
+            {
+                auto& model = *models[i];
+                if (!aggregation.sentModels[i])
+                    aggregation.sentModels[i].reset(new Matrix<ElemType>(model.GetNumRows(), model.GetNumCols(), model.GetDeviceId()));
+                aggregation.sentModels[i]->AssignValuesOf(model);
+
+                ElemType* data = aggregation.buffer.data() + offset;
+                model.CopySection(model.GetNumRows(), model.GetNumCols(), data, model.GetNumRows());
+                for (size_t k = 0; k < model.GetNumElements(); k++)
+                    data[k] *= (ElemType)samples;
+                offset += model.GetNumElements();
+            }
+            aggregation.buffer[numElements] = (ElemType)samples;
+            aggregation.buffer[numElements + 1] = finished ? 1 : 0;
+
+            m_pMPI->AllReduceAsync(aggregation.buffer.data(), aggregation.buffer.size(), &aggregation.request);
+            aggregation.inFlightTimer.Restart();
+            m_numPosted++;
+            if (finished)
+                m_perfReporter.OnAsyncMAPostedAfterDataEnd();
+        }
+
+        // Returns whether all workers had finished the epoch when this aggregation was posted
+        bool CompleteOldestAggregation(const std::list<ComputationNodeBasePtr>& learnableNodes, size_t& totalSamplesProcessed, float& secondsWaited)
+        {
+            auto models = ModelsToAggregate(learnableNodes);
+            auto& aggregation = m_aggregations[m_numCompleted % m_aggregations.size()];
+
+            Timer waitTimer;
+            waitTimer.Start();
+            m_pMPI->Wait(&aggregation.request);
+            waitTimer.Stop();
+            aggregation.inFlightTimer.Stop();
+            secondsWaited += (float)waitTimer.ElapsedSeconds();
+            m_perfReporter.OnAsyncMACompleted(aggregation.inFlightTimer.ElapsedSeconds(), waitTimer.ElapsedSeconds());
+            m_numCompleted++;
+
+            size_t numElements = aggregation.buffer.size() - 2;
+            ElemType totalSamples = aggregation.buffer[numElements];
+            size_t numFinished = (size_t)aggregation.buffer[numElements + 1];
+            totalSamplesProcessed += (size_t)totalSamples;
+
+            if (totalSamples > 0)
+            {
+                size_t offset = 0;
+                for (size_t i = 0; i < models.size(); i++)
+                {
+                    // model += average - sentModel, computed in place of sentModel
+                    auto& model = *models[i];
+                    auto& sentModel = *aggregation.sentModels[i];
+                    ElemType* data = aggregation.buffer.data() + offset;
+                    for (size_t k = 0; k < model.GetNumElements(); k++)
+                        data[k] /= totalSamples;
+
+                    Matrix<ElemType> average(model.GetNumRows(), model.GetNumCols(), data, model.GetDeviceId());
+                    Matrix<ElemType>::ScaleAndAdd(-1, sentModel, average);
+                    Matrix<ElemType>::ScaleAndAdd(1, average, model);
+                    offset += model.GetNumElements();
+                }
+            }
+
+            return numFinished == m_numWorkers;
+        }
+
+        // synchronous, unweighted average of the models of all workers
+        void AverageModels(const std::list<ComputationNodeBasePtr>& learnableNodes)
+        {
+            auto models = ModelsToAggregate(learnableNodes);
+            for (auto model : models)
+            {
+                std::vector<ElemType> buffer(model->GetNumElements());
+                model->CopySection(model->GetNumRows(), model->GetNumCols(), buffer.data(), model->GetNumRows());
+                m_pMPI->AllReduce(buffer.data(), buffer.size());
+                for (auto& value : buffer)
+                    value /= (ElemType)m_numWorkers;
+                model->SetValue(model->GetNumRows(), model->GetNumCols(), model->GetDeviceId(), buffer.data());
+            }
+        }
+
+        std::vector<PendingAggregation> m_aggregations; // ring buffer of the aggregations in flight
+        size_t m_numPosted;
+        size_t m_numCompleted;
+    };
+
 } } }
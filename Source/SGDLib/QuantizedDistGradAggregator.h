@@ -0,0 +1,239 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#pragma once
+
+#include "Basics.h"
+#include "IDistGradAggregator.h"
+#include "MatrixQuantizerImpl.h"
+#include "TimerUtility.h"
+#include <climits>
+#include <memory>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// Quantized gradient aggregation for CPU training (see MatrixQuantizerCPU), for builds without the 1-bit SGD sources.
+// The columns of every gradient are split into one stripe per worker. Each worker
+//  - quantizes its gradient, keeping the quantization error as residual for the next minibatch,
+//  - sends stripe k to worker k, and sums up the stripes it receives,
+//  - quantizes that sum (again with a residual) and sends it to all other workers,
+//  - unquantizes the aggregated stripes of all workers into its gradient.
+// Every worker thus sends and receives twice the size of a quantized gradient, independent of the number of workers.
+// Gradients smaller than 'minQuantizedSizeInBytes' or with fewer columns than workers are all-reduced unquantized.
+template <class ElemType>
+class QuantizedDistGradAggregator : public IDistGradAggregator<ElemType>
+{
+    UsingIDistGradAggregatorMembers;
+
+    struct QuantizedGradient
+    {
+        size_t gradientIndex;
+        std::unique_ptr<Matrix<ElemType>> residual;
+        std::unique_ptr<QuantizedMatrix<ElemType>> quantized;               // this worker's gradient; stripe k is sent to worker k
+        std::unique_ptr<QuantizedMatrix<ElemType>> ownStripe;               // column slice MyRank() of 'quantized'
+        std::vector<std::unique_ptr<QuantizedMatrix<ElemType>>> received;   // stripe MyRank() of all other workers
+        std::unique_ptr<Matrix<ElemType>> stripeSum;
+        std::unique_ptr<Matrix<ElemType>> stripeResidual;
+        std::unique_ptr<QuantizedMatrix<ElemType>> aggregated;              // aggregated gradient; stripe k is received from worker k
+        std::unique_ptr<QuantizedMatrix<ElemType>> aggregatedOwnStripe;     // column slice MyRank() of 'aggregated'
+        std::vector<size_t> stripeBegin;                                     // first column of each stripe, plus the number of columns
+        size_t columnSizeInBytes;
+    };
+
+public:
+    QuantizedDistGradAggregator(const MPIWrapperPtr& mpi, int numGradientBits, bool zeroThresholdFor1Bit, int deviceId, int syncStatsTrace, size_t minQuantizedSizeInBytes = DEFAULT_PACK_THRESHOLD_SIZE_IN_BYTES)
+        : IDistGradAggregator<ElemType>(mpi), m_numGradientBits(numGradientBits), m_zeroThresholdFor1Bit(zeroThresholdFor1Bit),
+          m_syncStatsTrace(syncStatsTrace), m_iterationCount(0), m_minQuantizedSizeInBytes(minQuantizedSizeInBytes), m_initialized(false)
+    {
+        if (deviceId != CPUDEVICE)
+            InvalidArgument("QuantizedDistGradAggregator: Only gradients on the CPU are supported.");
+
+        m_quantizer.reset(MatrixQuantizerImpl<ElemType>::Create(CPUDEVICE, false /*useAsync*/));
+    }
+
+    bool AggregateGradients(const std::vector<Matrix<ElemType>*>& gradients, DistGradHeader* headerCPU, bool /*resetState*/) override
+    {
+        if (!m_initialized)
+            Initialize(gradients);
+
+        bool showSyncPerfStats = (m_syncStatsTrace > 0) && ((m_iterationCount % m_syncStatsTrace) == 0);
+        m_iterationCount++;
+
+        Timer aggregationTimer;
+        if (showSyncPerfStats)
+            aggregationTimer.Start();
+
+        if (headerCPU->numSamples == 0)
+        {
+            // If the current node did not process any samples, the gradients should be zero'd; its residuals are still sent
+            for (auto gradient : gradients)
+                gradient->SetValue(0);
+        }
+
+        for (size_t i : m_unquantizedGradientsIndex)
+            m_mpi->AllReduce(gradients[i]->Data(), gradients[i]->GetNumElements());
+
+        // Quantize, and exchange the stripes of the quantized gradients
+        const int myRank = (int) MyRank();
+        const int numProc = (int) NumProc();
+        const int numQuantized = (int) m_quantizedGradients.size();
+        std::vector<MPI_Request> sendRequests;
+        std::vector<std::vector<MPI_Request>> recvRequests(numQuantized);
+        for (int g = 0; g < numQuantized; g++)
+        {
+            auto& qg = m_quantizedGradients[g];
+            m_quantizer->QuantizeAsync(*gradients[qg.gradientIndex], *qg.residual, *qg.quantized, *qg.residual, m_zeroThresholdFor1Bit);
+            m_quantizer->WaitQuantizeAsyncDone();
+
+            for (int k = 0; k < numProc; k++)
+            {
+                if (k == myRank)
+                    continue;
+
+                sendRequests.push_back(MPI_REQUEST_NULL);
+                m_mpi->Isend(StripeBuffer(qg, *qg.quantized, k), (int) StripeSize(qg, k), MPI_CHAR, k, g, &sendRequests.back()) || MpiFail("QuantizedDistGradAggregator: MPI_Isend");
+                recvRequests[g].push_back(MPI_REQUEST_NULL);
+                m_mpi->Irecv(qg.received[k]->Buffer(), (int) StripeSize(qg, myRank), MPI_CHAR, k, g, &recvRequests[g].back()) || MpiFail("QuantizedDistGradAggregator: MPI_Irecv");
+            }
+        }
+
+        // Sum up this worker's stripe, and send the quantized sum to all other workers
+        for (int g = 0; g < numQuantized; g++)
+        {
+            auto& qg = m_quantizedGradients[g];
+            m_mpi->Waitall((int) recvRequests[g].size(), recvRequests[g].data(), MPI_STATUSES_IGNORE) || MpiFail("QuantizedDistGradAggregator: MPI_Waitall");
+
+            m_quantizer->UnquantizeAsync(*qg.ownStripe, *qg.stripeSum, false);
+            for (int k = 0; k < numProc; k++)
+            {
+                if (k != myRank)
+                    m_quantizer->UnquantizeAsync(*qg.received[k], *qg.stripeSum, true);
+            }
+            m_quantizer->WaitUnquantizeAsyncDone();
+
+            m_quantizer->QuantizeAsync(*qg.stripeSum, *qg.stripeResidual, *qg.aggregatedOwnStripe, *qg.stripeResidual, m_zeroThresholdFor1Bit);
+            m_quantizer->WaitQuantizeAsyncDone();
+
+            recvRequests[g].clear();
+            for (int k = 0; k < numProc; k++)
+            {
+                if (k == myRank)
+                    continue;
+
+                sendRequests.push_back(MPI_REQUEST_NULL);
+                m_mpi->Isend(qg.aggregatedOwnStripe->Buffer(), (int) StripeSize(qg, myRank), MPI_CHAR, k, numQuantized + g, &sendRequests.back()) || MpiFail("QuantizedDistGradAggregator: MPI_Isend");
+                recvRequests[g].push_back(MPI_REQUEST_NULL);
+                m_mpi->Irecv(StripeBuffer(qg, *qg.aggregated, k), (int) StripeSize(qg, k), MPI_CHAR, k, numQuantized + g, &recvRequests[g].back()) || MpiFail("QuantizedDistGradAggregator: MPI_Irecv");
+            }
+        }
+
+        // Unquantize the aggregated gradients
+        for (int g = 0; g < numQuantized; g++)
+        {
+            auto& qg = m_quantizedGradients[g];
+            m_mpi->Waitall((int) recvRequests[g].size(), recvRequests[g].data(), MPI_STATUSES_IGNORE) || MpiFail("QuantizedDistGradAggregator: MPI_Waitall");
+            m_quantizer->UnquantizeAsync(*qg.aggregated, *gradients[qg.gradientIndex], false);
+        }
+        m_quantizer->WaitUnquantizeAsyncDone();
+
+        // The send buffers are overwritten by the next call
+        m_mpi->Waitall((int) sendRequests.size(), sendRequests.data(), MPI_STATUSES_IGNORE) || MpiFail("QuantizedDistGradAggregator: MPI_Waitall");
+
+        AllReduceHeader(headerCPU);
+
+        if (showSyncPerfStats)
+        {
+            aggregationTimer.Stop();
+            size_t quantizedBytes = 0;
+            for (const auto& qg : m_quantizedGradients)
+                quantizedBytes += qg.quantized->GetSize();
+
+            fprintf(stderr, "%d-bit quantized gradient aggregation of %.3g MB: time %.6g\n",
+                    m_numGradientBits, quantizedBytes / 1e6, aggregationTimer.ElapsedSeconds());
+        }
+
+        return (headerCPU->numSamples != 0);
+    }
+
+private:
+    void Initialize(const std::vector<Matrix<ElemType>*>& gradients)
+    {
+        const size_t numProc = NumProc();
+        const size_t myRank = MyRank();
+        for (size_t i = 0; i < gradients.size(); i++)
+        {
+            Matrix<ElemType>* gradient = gradients[i];
+            if (gradient->GetMatrixType() != DENSE)
+                RuntimeError("QuantizedDistGradAggregator: Gradient aggregation for sparse gradient matrices is currently unsupported!");
+
+            if (gradient->GetDeviceId() != CPUDEVICE)
+                RuntimeError("QuantizedDistGradAggregator: Only gradients on the CPU are supported.");
+
+            const size_t numRows = gradient->GetNumRows();
+            const size_t numCols = gradient->GetNumCols();
+            if ((numCols < numProc) || (gradient->GetNumElements() * sizeof(ElemType) < m_minQuantizedSizeInBytes))
+            {
+                m_unquantizedGradientsIndex.push_back(i);
+                continue;
+            }
+
+            QuantizedGradient qg;
+            qg.gradientIndex = i;
+            qg.columnSizeInBytes = QuantizedColumn<ElemType>::QuantizedColumnSize(m_numGradientBits, numRows);
+            for (size_t k = 0; k <= numProc; k++)
+                qg.stripeBegin.push_back(numCols * k / numProc);
+
+            if (qg.columnSizeInBytes * ((numCols + numProc - 1) / numProc) > (size_t) INT_MAX)
+                RuntimeError("QuantizedDistGradAggregator: The quantized gradient of %d x %d elements is too large.", (int) numRows, (int) numCols);
+
+            const size_t ownStripeBegin = qg.stripeBegin[myRank];
+            const size_t ownStripeCols = qg.stripeBegin[myRank + 1] - ownStripeBegin;
+
+            qg.residual.reset(new Matrix<ElemType>(numRows, numCols, CPUDEVICE));
+            qg.quantized.reset(new QuantizedMatrix<ElemType>(numRows, numCols, m_numGradientBits, CPUDEVICE));
+            qg.ownStripe.reset(new QuantizedMatrix<ElemType>(qg.quantized->ColumnSlice(ownStripeBegin, ownStripeCols)));
+            qg.received.resize(numProc);
+            for (size_t k = 0; k < numProc; k++)
+            {
+                if (k != myRank)
+                    qg.received[k].reset(new QuantizedMatrix<ElemType>(numRows, ownStripeCols, m_numGradientBits, CPUDEVICE));
+            }
+
+            qg.stripeSum.reset(new Matrix<ElemType>(numRows, ownStripeCols, CPUDEVICE));
+            qg.stripeResidual.reset(new Matrix<ElemType>(numRows, ownStripeCols, CPUDEVICE));
+            qg.aggregated.reset(new QuantizedMatrix<ElemType>(numRows, numCols, m_numGradientBits, CPUDEVICE));
+            qg.aggregatedOwnStripe.reset(new QuantizedMatrix<ElemType>(qg.aggregated->ColumnSlice(ownStripeBegin, ownStripeCols)));
+
+            m_quantizedGradients.push_back(std::move(qg));
+        }
+
+        m_initialized = true;
+    }
+
+    static char* StripeBuffer(const QuantizedGradient& qg, const QuantizedMatrix<ElemType>& matrix, size_t k)
+    {
+        return matrix.Buffer() + (qg.columnSizeInBytes * qg.stripeBegin[k]);
+    }
+
+    static size_t StripeSize(const QuantizedGradient& qg, size_t k)
+    {
+        return qg.columnSizeInBytes * (qg.stripeBegin[k + 1] - qg.stripeBegin[k]);
+    }
+
+    std::unique_ptr<MatrixQuantizerImpl<ElemType>> m_quantizer;
+    const int m_numGradientBits;
+    const bool m_zeroThresholdFor1Bit;
+
+    int m_syncStatsTrace;
+    size_t m_iterationCount;
+
+    const size_t m_minQuantizedSizeInBytes;
+    bool m_initialized;
+
+    std::vector<size_t> m_unquantizedGradientsIndex;
+    std::vector<QuantizedGradient> m_quantizedGradients;
+};
+
+}}}
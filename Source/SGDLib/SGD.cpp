@@ -31,7 +31,9 @@
 #include "ASGDHelper.h"
 
 #include "CNTKLibraryInternals.h"
+#include "QuantizedDistGradAggregator.h"
 #include "SimpleDistGradAggregator.h"
+#include "TopKDistGradAggregator.h"
 #include "V2SimpleDistGradAggregator.h"
 #include "ProgressTracing.h"
 #include "PerformanceProfiler.h"
@@ -485,7 +487,7 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                                                   m_seqGammarCalcAMF, m_seqGammarCalcLMF, m_seqGammarCalcWP, m_seqGammarCalcbMMIFactor, m_seqGammarCalcUsesMBR);
     }
 
-    // Multiverso Warpper for ASGD logic init
+    // Multiverso Warpper or built-in parameter server for ASGD logic init
     if (m_parallelizationMethod == ParallelizationMethod::dataParallelASGD)
     {
         m_pASGDHelper.reset(NewASGDHelper<ElemType>(learnableNodes,
@@ -496,7 +498,10 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                                          m_adjustCoefficient,
                                          m_adjustPerMinibatches,
                                          m_traceLevel,
-                                         m_syncStatsTrace));
+                                         m_syncStatsTrace,
+                                         m_useDelayCompensation,
+                                         m_delayCompensationLambda,
+                                         m_mpi));
         m_pASGDHelper->InitModel(learnableNodes);
     }
 
@@ -507,6 +512,18 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
         tensorBoardWriter = make_shared<::CNTK::Internal::TensorBoardFileWriter>(m_tensorBoardLogDir, net);
     }
 
+    // Checkpoints are written in the background, unless the learning rate search reads them back,
+    // or model averaging adds state to them that is not part of the snapshot.
+    if (m_asyncCheckpointing && ((m_mpi == nullptr) || m_mpi->IsMainNode()))
+    {
+        if (m_autoLearnRateSearchType != LearningRateSearchAlgorithm::None)
+            LOGPRINTF(stderr, "SGD: asyncCheckpointing is ignored, since the learning rate search reads the checkpoints back.\n");
+        else if (m_pMASGDHelper)
+            LOGPRINTF(stderr, "SGD: asyncCheckpointing is ignored with model averaging and block momentum.\n");
+        else
+            m_checkpointWriter = make_shared<AsyncCheckpointWriter>();
+    }
+
     // --- MAIN EPOCH LOOP
     for (int i = startEpoch; i < (int) m_maxEpochs; i++) // TODO: why is this an int, and not a size_t?
     {
@@ -884,6 +901,46 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
                     prevCriterion,
                     chosenMinibatchSize);
             }
+            else if (m_checkpointWriter)
+            {
+                // Take a snapshot of the checkpoint and the model in CPU memory, and serialize it in the background.
+                // The snapshot of the previous epoch must be written first (back-pressure).
+                m_checkpointWriter->Wait();
+                auto smoothedGradientsSnapshot = make_shared<std::list<Matrix<ElemType>>>();
+                for (const auto& smoothedGradient : smoothedGradients)
+                {
+                    smoothedGradientsSnapshot->emplace_back(CPUDEVICE);
+                    smoothedGradientsSnapshot->back().AssignValuesOf(smoothedGradient);
+                }
+                auto modelSnapshot = net->TakeValueSnapshot();
+                auto criteriaBestEpoch = m_criteriaBestEpoch;
+
+                auto checkPointFileName = GetCheckPointFileNameForEpoch(i);
+                auto modelName = GetModelNameForEpoch(i);
+                auto previousCheckPointFileName = m_keepCheckPointFiles ? wstring() : GetCheckPointFileNameForEpoch(i - 1);
+                if (m_traceLevel > 0)
+                    LOGPRINTF(stderr, "SGD: Saving checkpoint model '%ls' in the background\n", modelName.c_str());
+                m_checkpointWriter->Start([this, net, modelSnapshot, smoothedGradientsSnapshot, smoothedCounts, totalTrainingSamplesSeen, learnRatePerSample, prevCriterion,
+                                           chosenMinibatchSize, criteriaBestEpoch, checkPointFileName, modelName, previousCheckPointFileName]()
+                {
+                    // the checkpoint goes first, so that a model file is never newer than its checkpoint
+                    AsyncCheckpointWriter::WriteFileAtomically(checkPointFileName, [&](const wstring& tempFileName)
+                    {
+                        File fstream(tempFileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsWrite);
+                        fstream.Setvbuf();
+                        SaveCheckPointInfo(fstream, totalTrainingSamplesSeen, learnRatePerSample, *smoothedGradientsSnapshot, smoothedCounts, prevCriterion, chosenMinibatchSize, criteriaBestEpoch);
+                    });
+                    AsyncCheckpointWriter::WriteFileAtomically(modelName, [&](const wstring& tempFileName)
+                    {
+                        File fstream(tempFileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsWrite);
+                        fstream.Setvbuf();
+                        net->Save(fstream, *modelSnapshot);
+                    });
+                    // delete previous checkpoint file to save space, once the new one is on disk
+                    if (!previousCheckPointFileName.empty())
+                        _wunlink(previousCheckPointFileName.c_str());
+                });
+            }
             else
             {
                 SaveCheckPointInfo(
@@ -936,6 +993,10 @@ void SGD<ElemType>::TrainOrAdaptModel(int startEpoch, ComputationNetworkPtr net,
     }
     // --- END OF MAIN EPOCH LOOP
 
+    // all checkpoints must be on disk before training is done
+    if (m_checkpointWriter)
+        m_checkpointWriter->Wait();
+
     // Check if we need to save best model per criterion and this is the main node as well.
     if (m_saveBestModelPerCriterion && ((m_mpi == nullptr) || m_mpi->IsMainNode()))
     {
@@ -1246,14 +1307,32 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
 
                 // compute eval node first since when gradient is computed the forward function values
                 // may be changed and need to be recomputed when gradient and function value share the same matrix
+                auto profForward = ProfilerTimeBegin();
                 net->ForwardProp(forwardPropRoots); // the bulk of this evaluation is reused in ComputeGradient() below
+                ProfilerTimeEnd(profForward, profilerEvtMainForward);
 
                 // ===========================================================
                 // backprop
                 // ===========================================================
 
                 if (learnRatePerSample > 0.01 * m_minLearnRate) // only compute gradient when learning rate is large enough
-                    net->Backprop(criterionNodes[0]);
+                {
+                    auto profBackward = ProfilerTimeBegin();
+                    // With overlapped aggregation, the all-reduce of a gradient starts as soon as backprop is done with it.
+                    // With sub-minibatching the gradients are only final after DoneWithCurrentMinibatch() has added up
+                    // the stored sub-minibatch gradients, so all buckets are started in AggregateGradients() instead.
+                    if (useGradientAggregation && m_distGradAgg->SupportsOverlappedAggregation() && (actualNumSubminibatches == 1))
+                    {
+                        net->Backprop(criterionNodes[0], [this](const ComputationNodeBasePtr& node)
+                        {
+                            if (node->IsParameterUpdateRequired())
+                                m_distGradAgg->OnGradientComplete(&dynamic_pointer_cast<ComputationNode<ElemType>>(node)->Gradient());
+                        });
+                    }
+                    else
+                        net->Backprop(criterionNodes[0]);
+                    ProfilerTimeEnd(profBackward, profilerEvtMainBackward);
+                }
 
                 // house-keeping for sub-minibatching
                 if (actualNumSubminibatches > 1)
@@ -1302,8 +1381,28 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
             if (learnParamsGradients.size() == 0)
             {
                 // lazily form the list of smoothedGradients to exchange
+                // With overlapped aggregation, list them in the order backprop completes them, i.e. in reverse evaluation order.
+                std::list<ComputationNodeBasePtr> gradientNodes = learnableNodes;
+                if (m_distGradAgg->SupportsOverlappedAggregation())
+                {
+                    gradientNodes.clear();
+                    const auto& evalOrder = net->GetEvalOrder(criterionNodes[0]);
+                    std::set<ComputationNodeBasePtr> learnableNodeSet(learnableNodes.begin(), learnableNodes.end());
+                    for (auto nodeIter = evalOrder.rbegin(); nodeIter != evalOrder.rend(); nodeIter++)
+                    {
+                        if (learnableNodeSet.erase(*nodeIter) > 0)
+                            gradientNodes.push_back(*nodeIter);
+                    }
+
+                    for (const auto& node : learnableNodes) // parameters the criterion does not depend on
+                    {
+                        if (learnableNodeSet.find(node) != learnableNodeSet.end())
+                            gradientNodes.push_back(node);
+                    }
+                }
+
                 learnParamsGradients.reserve(learnableNodes.size());
-                for (auto nodeIter = learnableNodes.begin(); nodeIter != learnableNodes.end(); nodeIter++)
+                for (auto nodeIter = gradientNodes.begin(); nodeIter != gradientNodes.end(); nodeIter++)
                 {
                     ComputationNodePtr node = dynamic_pointer_cast<ComputationNode<ElemType>>(*nodeIter);
                     if (node->IsParameterUpdateRequired())
@@ -1393,6 +1492,9 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
                     double nodeDependentLearningRatePerSample = learnRatePerSample * node->GetLearningRateMultiplier();
                     double nodeDependentRegMultiplier = dynamic_pointer_cast<LearnableParameter<ElemType>>(node)->GetRegMultiplier();
                     double momentumPerSample = GetMomentumPerSample(epochNumber /*BUGBUG workaround:*/, net->GetMBLayoutPtrOfNetwork()->GetNumParallelSequences());
+                    // the aggregation of this gradient may still be in flight
+                    if (useGradientAggregation)
+                        m_distGradAgg->WaitForGradient(&dynamic_pointer_cast<ComputationNode<ElemType>>(node)->Gradient());
                     // TODO: Check why l2Factor is not applied to L1. Bug?
                     // BUGBUG (Issue #95): Access to net MBLayout can no longer be done if we have multiple input layouts
                     UpdateWeights(dynamic_pointer_cast<ComputationNode<ElemType>>(node)->Value(),
@@ -1411,6 +1513,12 @@ size_t SGD<ElemType>::TrainOneEpoch(ComputationNetworkPtr net,
             }
         }
 
+        // with overlapped aggregation, the gradients of skipped updates may still be aggregating; finish before the next backprop
+        if (useGradientAggregation)
+        {
+            for (auto gradient : learnParamsGradients)
+                m_distGradAgg->WaitForGradient(gradient);
+        }
 
         // aggregation by model averaging or block momentum 
         if (useModelAggregation)
@@ -2276,7 +2384,9 @@ void SGD<ElemType>::InitDistGradAgg(int numEvalNodes, int numGradientBits, int d
         else
             m_distGradAgg = std::make_shared<AllReduceDistGradAggregator<ElemType>>(m_mpi, numGradientBits, m_zeroThresholdFor1Bit, true /*useQuantizationForSelfStripe*/, m_bufferedAsyncGradientAggregation, traceLevel, m_syncStatsTrace);
 #else
-        RuntimeError("Gradient quantization is unsupported in CNTK binaries built without quantized gradient aggregation support!");
+        if (deviceId != CPUDEVICE)
+            RuntimeError("Gradient quantization on GPUs is unsupported in CNTK binaries built without quantized gradient aggregation support!");
+        m_distGradAgg = std::make_shared<QuantizedDistGradAggregator<ElemType>>(m_mpi, numGradientBits, m_zeroThresholdFor1Bit, deviceId, m_syncStatsTrace, m_packThresholdSizeInBytes);
 #endif // !CNTK_PARALLEL_TRAINING_SUPPORT
     }
     else
@@ -2285,8 +2395,21 @@ void SGD<ElemType>::InitDistGradAgg(int numEvalNodes, int numGradientBits, int d
             fprintf(stderr, "Initializing dataParallelSGD with FP%d aggregation.\n", numGradientBits);
         if (Globals::UseV2Aggregator()) // Currently used to check V2 against baselines.
             m_distGradAgg = std::make_shared<V2SimpleDistGradAggregator<ElemType>>(m_mpi, m_bufferedAsyncGradientAggregation, deviceId, m_syncStatsTrace, ::CNTK::MPICommunicator(m_packThresholdSizeInBytes));
+        else if (m_gradientDensity < 1)
+        {
+            if (traceLevel > 0)
+                fprintf(stderr, "Sending %g of the entries of each large gradient, the rest is kept as local residual.\n", m_gradientDensity);
+            if (m_bufferedAsyncGradientAggregation || m_overlapGradientAggregation)
+                fprintf(stderr, "WARNING: useBufferedAsyncGradientAggregation and overlapGradientAggregation are not supported with gradientDensity < 1, they will be ignored.\n");
+            m_distGradAgg = std::make_shared<TopKDistGradAggregator<ElemType>>(m_mpi, deviceId, m_syncStatsTrace, m_gradientDensity, m_packThresholdSizeInBytes);
+        }
         else
-            m_distGradAgg = std::make_shared<SimpleDistGradAggregator<ElemType>>(m_mpi, m_bufferedAsyncGradientAggregation, deviceId, m_syncStatsTrace, m_packThresholdSizeInBytes);
+        {
+            if (m_overlapGradientAggregation && (m_bufferedAsyncGradientAggregation || deviceId != CPUDEVICE))
+                fprintf(stderr, "WARNING: overlapGradientAggregation is only supported for synchronous aggregation on the CPU, it will be ignored.\n");
+            m_distGradAgg = std::make_shared<SimpleDistGradAggregator<ElemType>>(m_mpi, m_bufferedAsyncGradientAggregation, deviceId, m_syncStatsTrace, m_packThresholdSizeInBytes,
+                                                                                 m_overlapGradientAggregation, m_gradientBucketSizeInBytes);
+        }
     }
 
     m_gradHeader.reset(DistGradHeader::Create(numEvalNodes), [](DistGradHeader* ptr) { DistGradHeader::Destroy(ptr); });
@@ -2301,7 +2424,10 @@ void SGD<ElemType>::InitModelAggregationHandler(int traceLevel, DEVICEID_TYPE de
     }
     if (GetParallelizationMethod() == ParallelizationMethod::modelAveragingSGD)
     {
-        m_pMASGDHelper = make_shared<BasicModelAveragingSGD<ElemType>>(m_mpi, traceLevel, devID);
+        if (m_asyncModelAggregation)
+            m_pMASGDHelper = make_shared<AsyncModelAveragingSGD<ElemType>>(m_mpi, traceLevel, devID, m_maxModelAggregationStaleness);
+        else
+            m_pMASGDHelper = make_shared<BasicModelAveragingSGD<ElemType>>(m_mpi, traceLevel, devID);
     }
     else if (GetParallelizationMethod() == ParallelizationMethod::blockMomentumSGD)
     {
@@ -2479,58 +2605,70 @@ void SGD<ElemType>::SaveCheckPointInfo(const size_t epoch, const size_t totalSam
             File fstream(tempFileName, FileOptions::fileOptionsBinary | FileOptions::fileOptionsWrite);
             // Buffer writes in memory then flush to filesystem, which reduces number of small writes
             fstream.Setvbuf();
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BVersion"); 
-            fstream << (size_t)CURRENT_CNTK_CHECKPOINT_VERSION; 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EVersion");
+            SaveCheckPointInfo(fstream, totalSamplesSeen, learnRatePerSample, smoothedGradients, smoothedCounts, prevCriterion, minibatchSize, m_criteriaBestEpoch);
+        }
 
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BCKP");
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BLearnRate");
-            fstream << totalSamplesSeen << learnRatePerSample << prevCriterion;
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ELearnRate");
+        _wunlink(checkPointFileName.c_str());
+        renameOrDie(tempFileName, checkPointFileName);
+    }
+}
 
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BMinibatchSize");
-            fstream << minibatchSize;
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EMinibatchSize");
+template <class ElemType>
+void SGD<ElemType>::SaveCheckPointInfo(File& fstream, const size_t totalSamplesSeen,
+                                       const double learnRatePerSample,
+                                       const std::list<Matrix<ElemType>>& smoothedGradients,
+                                       const std::vector<double>& smoothedCounts,
+                                       const double prevCriterion,
+                                       const size_t minibatchSize,
+                                       const std::map<std::wstring, BestEpoch>& criteriaBestEpoch)
+{
+    fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BVersion"); 
+    fstream << (size_t)CURRENT_CNTK_CHECKPOINT_VERSION; 
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EVersion");
 
-            fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BGradient");
+    fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BCKP");
+    fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BLearnRate");
+    fstream << totalSamplesSeen << learnRatePerSample << prevCriterion;
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ELearnRate");
 
-            for (auto smoothedGradientIter = smoothedGradients.begin(); smoothedGradientIter != smoothedGradients.end(); smoothedGradientIter++)
-            {
-                const Matrix<ElemType>& smoothedGradientValues = *smoothedGradientIter;
-                fstream << smoothedGradientValues;
-            }
+    fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BMinibatchSize");
+    fstream << minibatchSize;
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EMinibatchSize");
 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EGradient");
+    fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BGradient");
 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"BCount");
+    for (auto smoothedGradientIter = smoothedGradients.begin(); smoothedGradientIter != smoothedGradients.end(); smoothedGradientIter++)
+    {
+        const Matrix<ElemType>& smoothedGradientValues = *smoothedGradientIter;
+        fstream << smoothedGradientValues;
+    }
 
-            for (auto sc : smoothedCounts)
-                fstream << sc;
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"EGradient");
 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECount");
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"BCount");
 
-            if (m_saveBestModelPerCriterion)
-            {
-                fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BCriteria");
-                const int32_t criteriaSize = static_cast<int32_t>(m_criteriaBestEpoch.size());
-                fstream << criteriaSize;
-                for (const auto& criterion : m_criteriaBestEpoch)
-                {
-                    fstream << criterion.second.criterionMinValue << criterion.second.epochIndex;
-                }
-                fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECriteria");
-            }
+    for (auto sc : smoothedCounts)
+        fstream << sc;
 
-            fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECKP");
-            if (m_pMASGDHelper)
-                m_pMASGDHelper->SaveToCheckPoint(fstream);
-            // Ensuring that data is written
-            fstream.Flush();
-        }
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECount");
 
-        _wunlink(checkPointFileName.c_str());
-        renameOrDie(tempFileName, checkPointFileName);
+    if (m_saveBestModelPerCriterion)
+    {
+        fstream.PutMarker(FileMarker::fileMarkerBeginSection, L"BCriteria");
+        const int32_t criteriaSize = static_cast<int32_t>(criteriaBestEpoch.size());
+        fstream << criteriaSize;
+        for (const auto& criterion : criteriaBestEpoch)
+        {
+            fstream << criterion.second.criterionMinValue << criterion.second.epochIndex;
+        }
+        fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECriteria");
     }
+
+    fstream.PutMarker(FileMarker::fileMarkerEndSection, L"ECKP");
+    if (m_pMASGDHelper)
+        m_pMASGDHelper->SaveToCheckPoint(fstream);
+    // Ensuring that data is written
+    fstream.Flush();
 }
 
 template <class ElemType>
@@ -2855,7 +2993,6 @@ static LearningRateSearchAlgorithm ParseLearningRateSearchType(const wstring& s)
     else InvalidArgument("autoAdjustLR: Invalid learning rate search type. Valid values are (none | searchBeforeEpoch | adjustAfterEpoch)");
 }
   
-#ifdef ASGD_PARALLEL_SUPPORT
 static AdjustLearningRateAtBeginning AdjustLearningRateAtBeginningType(const wstring& s)
 {
     if      (EqualCI(s.c_str(), L"") || EqualCI(s.c_str(), L"none")) return AdjustLearningRateAtBeginning::None;
@@ -2863,7 +3000,6 @@ static AdjustLearningRateAtBeginning AdjustLearningRateAtBeginningType(const wst
     else if (EqualCI(s.c_str(), L"staircase"))                       return AdjustLearningRateAtBeginning::Staircase;
     else InvalidArgument("AdjustLearningRateatBeginningType: Invalid Type. Valid values are (None | Linearly | Staircase)");
 }
-#endif
   
 template<class ConfigRecordType>
 SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
@@ -3118,9 +3254,16 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
     m_numGradientBits = vector<int>{8 * (int)sizeofElemType}; // means no quantization
     m_zeroThresholdFor1Bit = true;
     m_bufferedAsyncGradientAggregation = false;
+    m_overlapGradientAggregation = false;
+    m_gradientBucketSizeInBytes = DEFAULT_GRADIENT_BUCKET_SIZE_IN_BYTES;
+    m_gradientDensity = 1.0;
     m_enableDistributedMBReading = false;
     m_parallelizationStartEpochNum = 0;
     m_modelAggregationBlockSize = 0; 
+    m_asyncModelAggregation = false;
+    m_maxModelAggregationStaleness = 1;
+    m_useDelayCompensation = false;
+    m_delayCompensationLambda = 0.04;
 
     if (configSGD.Exists(L"ParallelTrain"))
     {
@@ -3151,6 +3294,23 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
             m_numGradientBits = configDataParallelSGD(L"gradientBits", ConfigRecordType::Array(intargvector(vector<int>{defaultGradientBits})));
             m_zeroThresholdFor1Bit = configDataParallelSGD(L"useZeroThresholdFor1BitQuantization", true);
             m_bufferedAsyncGradientAggregation = configDataParallelSGD(L"useBufferedAsyncGradientAggregation", false);
+            m_overlapGradientAggregation = configDataParallelSGD(L"overlapGradientAggregation", false);
+            m_gradientBucketSizeInBytes = configDataParallelSGD(L"gradientBucketSizeInKB", DEFAULT_GRADIENT_BUCKET_SIZE_IN_KB) * 1024;
+            // fraction of the entries of every large gradient that is sent; the others are accumulated locally (top-k sparsification)
+            m_gradientDensity = configDataParallelSGD(L"gradientDensity", 1.0);
+            if (m_gradientDensity <= 0 || m_gradientDensity > 1)
+                InvalidArgument("gradientDensity must be in the range (0, 1].");
+            // gradients of at least ringAllReduceThresholdInKB are all-reduced with CNTK's ring all-reduce instead of MPI_Iallreduce
+            if (configDataParallelSGD.Exists(L"ringAllReduceThresholdInKB"))
+            {
+                size_t ringAllReduceThresholdInKB = configDataParallelSGD(L"ringAllReduceThresholdInKB");
+                Globals::SetRingAllReduceThresholdInBytes(ringAllReduceThresholdInKB * 1024);
+            }
+            if (configDataParallelSGD.Exists(L"ringAllReduceChunkSizeInKB"))
+            {
+                size_t ringAllReduceChunkSizeInKB = configDataParallelSGD(L"ringAllReduceChunkSizeInKB");
+                Globals::SetRingAllReduceChunkSizeInBytes(ringAllReduceChunkSizeInKB * 1024);
+            }
             for (size_t i = 0; i < m_numGradientBits.size(); i++)
             {
                 if (m_numGradientBits[i] < 1 || m_numGradientBits[i] > defaultGradientBits)
@@ -3171,6 +3331,11 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
             }
             else
                 m_modelAggregationBlockSize = 40000 * numMPIWorkers;    // default value 
+            // post the model aggregation asynchronously, and merge its result up to maxStaleness sync points later
+            m_asyncModelAggregation = configMASGD(L"useAsyncAggregation", false);
+            m_maxModelAggregationStaleness = configMASGD(L"maxStaleness", (size_t)1);
+            if (m_maxModelAggregationStaleness < 1)
+                InvalidArgument("maxStaleness must be at least 1.");
 #if 1           // legacy option 
             if (configMASGD.Exists(L"syncFrequencyInFrames"))
             {
@@ -3246,7 +3411,7 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
 
         if (configParallelTrain.Exists(L"DataParallelASGD"))
         {
-#ifndef ASGD_PARALLEL_SUPPORT
+#if !defined(ASGD_PARALLEL_SUPPORT) && !HAS_MPI
             InvalidArgument("DataParallelASGD is not enabled in this version.\n");
 #else
             const ConfigRecordType & configDataParallelASGD(configParallelTrain(L"DataParallelASGD", ConfigRecordType::Record()));
@@ -3261,6 +3426,12 @@ SGDParams::SGDParams(const ConfigRecordType& configSGD, size_t sizeofElemType)
 #endif
             m_isAsyncBufferEnabled = configDataParallelASGD(L"UsePipeline", false);
             m_isSimulateMA = configDataParallelASGD(L"SimModelAverage", false); // using parameter server-based version of ModelAveragingSGD
+            // delay-compensated ASGD (DC-ASGD): corrects every push for the updates of the other workers since the model was pulled.
+            // dcasgdLambda is relative to the pushed model change, i.e. it corresponds to lambda / learning rate in the DC-ASGD paper.
+            m_useDelayCompensation = configDataParallelASGD(L"useDCASGD", false);
+            m_delayCompensationLambda = configDataParallelASGD(L"dcasgdLambda", 0.04);
+            if (m_delayCompensationLambda < 0)
+                InvalidArgument("dcasgdLambda must be non-negative");
             if (configDataParallelASGD.Exists(L"AdjustLearningRateAtBeginning")) // adjust learning rate per m_adjustNumInBatch minibatchs until to original one,
                                                                                  // this option could be used to takcle the unstableness of DataParallelASGD if you get a chance
             {
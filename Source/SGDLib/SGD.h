@@ -20,6 +20,7 @@
 #include "Profiler.h"
 #include "MASGD.h"
 #include "ASGDHelper.h"
+#include "AsyncCheckpointWriter.h"
 #include <map>
 using namespace std; // ugh! TODO: get rid of this from .h files!!!
 
@@ -293,9 +294,14 @@ protected:
     intargvector m_numGradientBits;
     bool m_bufferedAsyncGradientAggregation;
     bool m_zeroThresholdFor1Bit;
+    bool m_overlapGradientAggregation; // start all-reducing gradients during backprop
+    size_t m_gradientBucketSizeInBytes;
+    double m_gradientDensity; // < 1: send only the largest entries of each gradient, see TopKDistGradAggregator
 
     // Parallel training related with MA / BM
     size_t m_modelAggregationBlockSize;
+    bool   m_asyncModelAggregation;        // ModelAveragingSGD: do not block on the aggregation, see AsyncModelAveragingSGD
+    size_t m_maxModelAggregationStaleness;
     bool   m_resetSGDMomentum; 
     bool   m_useNesterovBlockMomentum;
     double m_blockLearningRate; 
@@ -312,6 +318,8 @@ protected:
     AdjustLearningRateAtBeginning m_adjustLearningRateAtBeginning;
     double m_adjustCoefficient;
     size_t m_adjustPerMinibatches;
+    bool m_useDelayCompensation;     // DC-ASGD
+    double m_delayCompensationLambda;
 
     // sequence training
     double m_hSmoothingWeight;
@@ -353,6 +361,7 @@ public:
           // TODO: The next few do not belong into SGD any more than the network or reader we operate on. Either move network and reader in here, or move these out.
           m_modelPath((const wstring&) configSGD(L"modelPath")),
           m_keepCheckPointFiles(configSGD(L"keepCheckPointFiles", false)),
+          m_asyncCheckpointing(configSGD(L"asyncCheckpointing", false)),
           m_saveBestModelPerCriterion(configSGD(L"saveBestModelPerCriterion", false)),
           m_trainCriterionNodeName((const wstring&) configSGD(L"trainCriterionNodeName", L"")),
           m_evalCriterionNodeName ((const wstring&) configSGD(L"evalCriterionNodeName", L"")),
@@ -537,6 +546,13 @@ protected:
                             const std::vector<double>& smoothedCounts,
                             const double prevCriterion,
                             const size_t minibatchSize);
+    void SaveCheckPointInfo(File& fstream, const size_t totalSamplesSeen,
+                            const double learnRatePerSample,
+                            const std::list<Matrix<ElemType>>& smoothedGradients,
+                            const std::vector<double>& smoothedCounts,
+                            const double prevCriterion,
+                            const size_t minibatchSize,
+                            const std::map<std::wstring, BestEpoch>& criteriaBestEpoch);
 
     bool TryLoadCheckPointInfo(const size_t epochNumber,
                                /*out*/ size_t& totalSamplesSeen,
@@ -575,6 +591,7 @@ public:
 protected:
     std::wstring m_modelPath;
     bool m_keepCheckPointFiles;
+    bool m_asyncCheckpointing; // write the checkpoints of the epochs on a background thread
     bool m_saveBestModelPerCriterion;
     // Mapping from criterion to the best epoch on validation data set.
     std::map<std::wstring, BestEpoch> m_criteriaBestEpoch;
@@ -598,6 +615,7 @@ protected:
 private:
     void MarkDropoutNodesEvalTimeStampAsOutdated(const ComputationNetworkPtr& net, const ComputationNodeBasePtr& criterionNode);
     std::shared_ptr<ASGDHelper<ElemType>> m_pASGDHelper;
+    std::shared_ptr<AsyncCheckpointWriter> m_checkpointWriter;
 
     bool UsingGradientAggregation(size_t epochNumber) const
     {
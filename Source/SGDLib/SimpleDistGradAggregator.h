@@ -11,9 +11,12 @@
 #include "CUDAPageLockedMemAllocator.h"
 #include "NcclComm.h"
 #include <future>
+#include <unordered_map>
 #include "GPUDataTransferer.h"
 #include "TimerUtility.h"
 #include "MatrixQuantizerImpl.h"
+#include "RingAllReduce.h"
+#include "PerformanceProfiler.h"
 
 namespace Microsoft { namespace MSR { namespace CNTK {
 
@@ -23,9 +26,14 @@ class SimpleDistGradAggregator : public IDistGradAggregator<ElemType>
     UsingIDistGradAggregatorMembers;
 
 public:
-    SimpleDistGradAggregator(const MPIWrapperPtr& mpi, bool useAsyncAggregation, int deviceId, int syncStatsTrace, size_t packThresholdSizeInBytes = DEFAULT_PACK_THRESHOLD_SIZE_IN_BYTES)
+    // If 'overlapAggregation' is set, gradients are all-reduced in buckets of about 'bucketSizeInBytes' while backprop
+    // is still running (see OnGradientComplete()). This is only supported for synchronous aggregation on the CPU.
+    SimpleDistGradAggregator(const MPIWrapperPtr& mpi, bool useAsyncAggregation, int deviceId, int syncStatsTrace, size_t packThresholdSizeInBytes = DEFAULT_PACK_THRESHOLD_SIZE_IN_BYTES,
+                             bool overlapAggregation = false, size_t bucketSizeInBytes = DEFAULT_GRADIENT_BUCKET_SIZE_IN_BYTES)
         : IDistGradAggregator<ElemType>(mpi), m_useAsyncAggregation(useAsyncAggregation), m_initialized(false), m_bufferedGradHeader(nullptr), m_syncStatsTrace(syncStatsTrace),
-        m_iterationCount(0), m_nccl(deviceId, mpi), m_packThresholdSizeInBytes(packThresholdSizeInBytes)
+        m_iterationCount(0), m_nccl(deviceId, mpi), m_ringAllReduce(mpi), m_packThresholdSizeInBytes(packThresholdSizeInBytes),
+        m_overlapAggregation(overlapAggregation && !useAsyncAggregation && deviceId == CPUDEVICE), m_bucketSizeInBytes(bucketSizeInBytes),
+        m_nextBucketToStart(0), m_overlappedIterationStarted(false)
     {}
 
     ~SimpleDistGradAggregator()
@@ -44,7 +52,12 @@ public:
         bool showSyncPerfStats = (m_syncStatsTrace > 0) && ((m_iterationCount % m_syncStatsTrace) == 0);
         m_iterationCount++;
 
-        if (m_useAsyncAggregation)
+        if (m_overlapAggregation)
+        {
+            AggregateGradientsOverlapped(gradients, headerCPU, showSyncPerfStats);
+            return (headerCPU->numSamples != 0);
+        }
+        else if (m_useAsyncAggregation)
         {
             // If we are performing async gradient aggregation, let's wait for the pending gradient aggregation to finish
             // then swap the contents of the buffered gradients and the new gradient matrices and fire an async aggreagation
@@ -125,6 +138,35 @@ public:
         }
     }
 
+    bool SupportsOverlappedAggregation() const override
+    {
+        return m_overlapAggregation;
+    }
+
+    // Called during backprop when 'gradient' is final. Once all gradients of a bucket are final, its all-reduce is
+    // started, provided that all preceding buckets have been started (all ranks must issue them in the same order).
+    void OnGradientComplete(Matrix<ElemType>* gradient) override
+    {
+        // the buckets are formed during the first AggregateGradients() call
+        auto iter = m_bucketOfGradient.find(gradient);
+        if (!m_overlapAggregation || iter == m_bucketOfGradient.end())
+            return;
+
+        BeginOverlappedIteration();
+
+        auto& bucket = m_buckets[iter->second];
+        assert(bucket.m_numPendingGradients > 0);
+        if (--bucket.m_numPendingGradients == 0)
+            StartReadyBuckets();
+    }
+
+    void WaitForGradient(Matrix<ElemType>* gradient) override
+    {
+        auto iter = m_bucketOfGradient.find(gradient);
+        if (iter != m_bucketOfGradient.end())
+            CompleteBucket(iter->second);
+    }
+
 private:
     std::shared_ptr<ElemType> AllocateIntermediateBuffer(int deviceID, size_t numElements)
     {
@@ -168,7 +210,7 @@ private:
             size_t packedGradientsSizeInElements = 0;
             for (size_t i = 0; i < gradients.size(); i++)
             {
-                if (!m_useAsyncAggregation && sizeof(ElemType) * gradients[i]->GetNumElements() <= m_packThresholdSizeInBytes)
+                if (!m_useAsyncAggregation && !m_overlapAggregation && sizeof(ElemType) * gradients[i]->GetNumElements() <= m_packThresholdSizeInBytes)
                 {
                     packedGradientsSizeInElements += gradients[i]->GetNumElements();
                     m_packedGradientsIndex.push_back(i);
@@ -226,6 +268,9 @@ private:
                 m_bufferedGradHeader->Clear();
             }
 
+            if (m_overlapAggregation)
+                InitializeBuckets(gradients);
+
             if (m_mpi->IsMainNode())
             {
                 for (size_t i = 0; i < NumProc() - 1; ++i)
@@ -249,6 +294,181 @@ private:
         }
     }
 
+    // Groups the gradients, in the order in which backprop completes them, into fusion buckets of about m_bucketSizeInBytes.
+    void InitializeBuckets(const std::vector<Matrix<ElemType>*>& gradients)
+    {
+        m_overlapGradients = gradients;
+        size_t maxBucketSizeInElements = std::max<size_t>(1, m_bucketSizeInBytes / sizeof(ElemType));
+        size_t bucketSizeInElements = 0;
+        for (size_t i = 0; i < gradients.size(); i++)
+        {
+            size_t numElements = gradients[i]->GetNumElements();
+            if (m_buckets.empty() || (bucketSizeInElements > 0 && bucketSizeInElements + numElements > maxBucketSizeInElements))
+            {
+                m_buckets.push_back(GradientBucket());
+                bucketSizeInElements = 0;
+            }
+
+            m_buckets.back().m_gradientIndices.push_back(i);
+            m_bucketOfGradient[gradients[i]] = m_buckets.size() - 1;
+            bucketSizeInElements += numElements;
+        }
+
+        // Buckets with a single gradient are reduced in place, the others are packed into a continuous buffer
+        for (auto& bucket : m_buckets)
+        {
+            if (bucket.m_gradientIndices.size() == 1)
+                continue;
+
+            size_t numElements = 0;
+            for (size_t i : bucket.m_gradientIndices)
+                numElements += gradients[i]->GetNumElements();
+
+            bucket.m_buffer.reset(new Matrix<ElemType>(1, numElements, gradients[0]->GetDeviceId()));
+        }
+    }
+
+    // Makes sure the buckets of the previous minibatch are done and resets the per-minibatch state.
+    void BeginOverlappedIteration()
+    {
+        if (m_overlappedIterationStarted)
+            return;
+
+        for (size_t i = 0; i < m_buckets.size(); i++)
+        {
+            CompleteBucket(i);
+            m_buckets[i].m_numPendingGradients = m_buckets[i].m_gradientIndices.size();
+            m_buckets[i].m_started = false;
+            m_buckets[i].m_completed = false;
+        }
+
+        m_nextBucketToStart = 0;
+        m_overlappedIterationStarted = true;
+    }
+
+    void StartReadyBuckets()
+    {
+        while (m_nextBucketToStart < m_buckets.size() && m_buckets[m_nextBucketToStart].m_numPendingGradients == 0)
+        {
+            auto& bucket = m_buckets[m_nextBucketToStart++];
+            ElemType* reductionBuffer;
+            size_t numElements;
+            if (bucket.m_buffer)
+            {
+                size_t offset = 0;
+                for (size_t i : bucket.m_gradientIndices)
+                {
+                    auto gradient = m_overlapGradients[i];
+                    bucket.m_buffer->ColumnSlice(offset, gradient->GetNumElements()).AssignValuesOf(gradient->Reshaped(1, gradient->GetNumElements()));
+                    offset += gradient->GetNumElements();
+                }
+
+                reductionBuffer = bucket.m_buffer->Data();
+                numElements = bucket.m_buffer->GetNumElements();
+            }
+            else
+            {
+                reductionBuffer = m_overlapGradients[bucket.m_gradientIndices[0]]->Data();
+                numElements = m_overlapGradients[bucket.m_gradientIndices[0]]->GetNumElements();
+            }
+
+            bucket.m_profilerState = ProfilerTimeBegin();
+            bucket.m_numBytes = numElements * sizeof(ElemType);
+            m_mpi->Iallreduce(MPI_IN_PLACE, reductionBuffer, (int)numElements, MPIWrapper::GetDataType(reductionBuffer), MPI_SUM, &bucket.m_request) || MpiFail("MPI_Iallreduce");
+            bucket.m_started = true;
+        }
+    }
+
+    // Waits for the all-reduce of a bucket and copies the result back to its gradients.
+    void CompleteBucket(size_t bucketIndex)
+    {
+        auto& bucket = m_buckets[bucketIndex];
+        if (!bucket.m_started || bucket.m_completed)
+            return;
+
+        m_mpi->Wait(&bucket.m_request, MPI_STATUSES_IGNORE) || MpiFail("MPI_Wait");
+        ProfilerTimeEnd(bucket.m_profilerState, "All-Reduce Bucket", bucket.m_numBytes, -1);
+        if (bucket.m_buffer)
+        {
+            size_t offset = 0;
+            for (size_t i : bucket.m_gradientIndices)
+            {
+                auto gradient = m_overlapGradients[i];
+                gradient->AssignValuesOf(bucket.m_buffer->ColumnSlice(offset, gradient->GetNumElements()).Reshaped(gradient->GetNumRows(), gradient->GetNumCols()));
+                offset += gradient->GetNumElements();
+            }
+        }
+
+        bucket.m_completed = true;
+    }
+
+    // Starts the buckets backprop did not complete and aggregates the header. The gradient all-reduces stay
+    // in flight; WaitForGradient() completes them.
+    void AggregateGradientsOverlapped(const std::vector<Matrix<ElemType>*>& gradients, DistGradHeader* headerCPU, bool showSyncPerfStats)
+    {
+        Timer aggregationTimer;
+        if (showSyncPerfStats)
+            aggregationTimer.Start();
+
+        BeginOverlappedIteration();
+
+        if (headerCPU->numSamples == 0)
+        {
+            // No backprop happened, so no bucket has been started yet; the gradients must not contribute.
+            assert(m_nextBucketToStart == 0);
+            for (size_t i = 0; i < gradients.size(); ++i)
+                gradients[i]->SetValue(0);
+        }
+
+        for (auto& bucket : m_buckets)
+            bucket.m_numPendingGradients = 0;
+
+        size_t numBucketsStartedDuringBackprop = m_nextBucketToStart;
+        StartReadyBuckets();
+
+        // Aggregate the header on the main node and broadcast the result
+        auto profHeader = ProfilerTimeBegin();
+        size_t numGradMatrices = gradients.size();
+        std::vector<MPI_Request> recvHeaderRequests(NumProc() - 1);
+        if (m_mpi->IsMainNode())
+        {
+            for (size_t j = 0; j < NumProc() - 1; ++j)
+            {
+                int source = (j >= MyRank()) ? (j + 1) : j;
+                m_mpi->Irecv(m_recvHeaders[j], m_recvHeaders[j]->Size(), MPI_CHAR, source, numGradMatrices, &(recvHeaderRequests[j])) || MpiFail("MPI_Irecv");
+            }
+
+            for (size_t j = 0; j < NumProc() - 1; ++j)
+            {
+                int idx = MPI_UNDEFINED;
+                m_mpi->Waitany(recvHeaderRequests.size(), recvHeaderRequests.data(), &idx, MPI_STATUS_IGNORE) || MpiFail("MPI_Waitany");
+                if (idx == MPI_UNDEFINED)
+                    break;
+
+                headerCPU->Aggregate(m_recvHeaders[idx], true);
+            }
+        }
+        else
+        {
+            MPI_Request sendHeaderRequest;
+            m_mpi->Isend(headerCPU, headerCPU->Size(), MPI_CHAR, m_mpi->MainNodeRank(), numGradMatrices, &sendHeaderRequest) || MpiFail("MPI_Isend");
+            m_mpi->Wait(&sendHeaderRequest, MPI_STATUSES_IGNORE) || MpiFail("MPI_Wait");
+        }
+
+        m_mpi->Bcast(headerCPU, headerCPU->Size(), MPI_CHAR, m_mpi->MainNodeRank());
+        ProfilerTimeEnd(profHeader, "Aggregate Header", headerCPU->Size(), (int)m_mpi->MainNodeRank());
+
+        // The next OnGradientComplete() belongs to the next minibatch
+        m_overlappedIterationStarted = false;
+
+        if (showSyncPerfStats)
+        {
+            aggregationTimer.Stop();
+            fprintf(stderr, "Overlapped gradient aggregation: %d of %d buckets started during backprop, exposed time before update: %.6g\n",
+                    (int)numBucketsStartedDuringBackprop, (int)m_buckets.size(), aggregationTimer.ElapsedSeconds());
+        }
+    }
+
     void AggregateGradientsImpl(const std::vector<Matrix<ElemType>*>& gradients, DistGradHeader* headerCPU, bool showSyncPerfStats)
     {
         Timer aggregationTimer;
@@ -310,6 +530,7 @@ private:
         }
 
         // Initiate receive of the header on the main node
+        auto profHeader = ProfilerTimeBegin();
         std::vector<MPI_Request> recvHeaderRequests(NumProc() - 1);
         if (m_mpi->IsMainNode())
         {
@@ -328,14 +549,18 @@ private:
 
         // Perform async allreduce on the gradient data
         std::vector<MPI_Request> allReduceRequests;
+        std::vector<long long> allReduceProfilerStates; // per request, for the timeline
         if (!m_nccl.IsSupported())
         {
             size_t allReduceIndex = 0;
             ElemType* reductionBuffer;
+            std::vector<std::pair<ElemType*, size_t>> ringReductions; // large buffers, reduced with the ring all-reduce after all others have been started
             for (size_t i : m_gradientIndexToAggregate)
             {
                 allReduceRequests.push_back(MPI_Request());
+                allReduceProfilerStates.push_back(0);
                 reductionBuffer = (i == -1)? m_aggregationBuffer->Data() : gradients[i]->Data();
+                size_t numElements = (i == -1) ? m_aggregationBuffer->GetNumElements() : gradients[i]->GetNumElements();
                 if (m_mpi->UseGpuGdr() == 0 && deviceId != CPUDEVICE)
                 {
                     m_gpuDataTransferers[allReduceIndex]->WaitForCopyGPUToCPUAsync();
@@ -344,16 +569,28 @@ private:
 
                 if (m_mpi->UseGpuGdr() == 0)
                 {
-                    m_mpi->Iallreduce(MPI_IN_PLACE, reductionBuffer, (i == -1) ? m_aggregationBuffer->GetNumElements() : gradients[i]->GetNumElements(),
-                        MPIWrapper::GetDataType(reductionBuffer), MPI_SUM, &allReduceRequests.back()) || MpiFail("MPI_Iallreduce");
+                    if (RingAllReduce::IsPreferred(numElements * sizeof(ElemType)))
+                    {
+                        allReduceRequests.back() = MPI_REQUEST_NULL;
+                        ringReductions.push_back(std::make_pair(reductionBuffer, numElements));
+                    }
+                    else
+                    {
+                        allReduceProfilerStates.back() = ProfilerTimeBegin();
+                        m_mpi->Iallreduce(MPI_IN_PLACE, reductionBuffer, numElements,
+                            MPIWrapper::GetDataType(reductionBuffer), MPI_SUM, &allReduceRequests.back()) || MpiFail("MPI_Iallreduce");
+                    }
                     allReduceIndex++;
                 }
                 // TODO: Remove this when MPI_Iallreduce with CUDA - aware is supported
                 else
                 {
-                    m_mpi->AllReduce(reductionBuffer, (i == -1) ? m_aggregationBuffer->GetNumElements() : gradients[i]->GetNumElements());
+                    m_mpi->AllReduce(reductionBuffer, numElements);
                 }
             }
+
+            for (auto& reduction : ringReductions)
+                m_ringAllReduce.AllReduce(reduction.first, reduction.first, reduction.second, showSyncPerfStats);
         } 
         else
         {
@@ -388,6 +625,7 @@ private:
 
         // Broadcast the aggregated header to all nodes
         m_mpi->Bcast(headerCPU, headerCPU->Size(), MPI_CHAR, m_mpi->MainNodeRank());
+        ProfilerTimeEnd(profHeader, "Aggregate Header", headerCPU->Size(), (int)m_mpi->MainNodeRank());
 
         if (m_nccl.IsSupported())
         {
@@ -400,7 +638,11 @@ private:
             size_t gpuDataTransfersIdx = 0; // Index of allReduceRequest for each un-packed gradient
             for (size_t i : m_gradientIndexToAggregate)
             {
+                bool wasStarted = (allReduceRequests[gpuDataTransfersIdx] != MPI_REQUEST_NULL); // not the ring all-reduces, they are done already
                 m_mpi->Wait(&allReduceRequests[gpuDataTransfersIdx], MPI_STATUSES_IGNORE) || MpiFail("MPI_Wait");
+                if (wasStarted)
+                    ProfilerTimeEnd(allReduceProfilerStates[gpuDataTransfersIdx], "All-Reduce Gradient",
+                                    ((i == -1) ? m_aggregationBuffer->GetNumElements() : gradients[i]->GetNumElements()) * sizeof(ElemType), -1);
                 if (deviceId != CPUDEVICE)
                 {
                     m_gpuDataTransferers[gpuDataTransfersIdx]->CopyCPUToGPUAsync(m_intermediateCPUBuffers[gpuDataTransfersIdx].get(),
@@ -463,6 +705,27 @@ private:
     std::vector<size_t> m_packedGradientsIndex;
     std::vector<size_t> m_gradientIndexToAggregate;
 
+    // Overlapping aggregation with backprop: gradients are all-reduced in fusion buckets as soon as backprop has completed them
+    struct GradientBucket
+    {
+        std::vector<size_t> m_gradientIndices;      // into m_overlapGradients
+        std::unique_ptr<Matrix<ElemType>> m_buffer; // continuous buffer, only for buckets with more than one gradient
+        size_t m_numPendingGradients = 0;
+        bool m_started = false;
+        bool m_completed = false;
+        MPI_Request m_request;
+        long long m_profilerState = 0; // timeline: from the start of the all-reduce to its completion
+        long long m_numBytes = 0;
+    };
+
+    const bool m_overlapAggregation;
+    const size_t m_bucketSizeInBytes;
+    std::vector<Matrix<ElemType>*> m_overlapGradients;
+    std::vector<GradientBucket> m_buckets;
+    std::unordered_map<Matrix<ElemType>*, size_t> m_bucketOfGradient;
+    size_t m_nextBucketToStart;
+    bool m_overlappedIterationStarted;
+
     int m_syncStatsTrace;
 
     // Only used for controlling frequency of measuring/showing gradient aggregation perf stats
@@ -471,5 +734,7 @@ private:
     bool m_initialized;
 
     NcclComm m_nccl;
+
+    RingAllReduce m_ringAllReduce;
 };
 } } }
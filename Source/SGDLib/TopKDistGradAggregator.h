@@ -0,0 +1,320 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#pragma once
+
+#include "Basics.h"
+#include "IDistGradAggregator.h"
+#include "TimerUtility.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <random>
+#include <omp.h>
+
+namespace Microsoft { namespace MSR { namespace CNTK {
+
+// Sparsified gradient aggregation: of every large gradient, each worker only sends the entries of largest magnitude
+// (about 'density' of them) as index/value pairs, gathered by all workers with MPI_Allgatherv.
+// What is not sent stays in a local residual that is added to the gradient of the next minibatch (error feedback),
+// like the quantization residual of MatrixQuantizerImpl, so no part of the gradient is lost, only delayed.
+// Gradients of less than 'minSparseSizeInBytes' are all-reduced densely.
+template <class ElemType>
+class TopKDistGradAggregator : public IDistGradAggregator<ElemType>
+{
+    UsingIDistGradAggregatorMembers;
+
+    // Number of magnitudes sampled to estimate the selection threshold of a gradient
+    static const size_t s_numThresholdSamples = 8192;
+
+public:
+    TopKDistGradAggregator(const MPIWrapperPtr& mpi, int deviceId, int syncStatsTrace, double density, size_t minSparseSizeInBytes = DEFAULT_PACK_THRESHOLD_SIZE_IN_BYTES)
+        : IDistGradAggregator<ElemType>(mpi), m_deviceId(deviceId), m_syncStatsTrace(syncStatsTrace), m_iterationCount(0),
+          m_density(density), m_minSparseSizeInBytes(minSparseSizeInBytes), m_initialized(false), m_randomEngine((unsigned long)mpi->CurrentNodeRank())
+    {
+        if (density <= 0 || density >= 1)
+            InvalidArgument("TopKDistGradAggregator: The gradient density must be in (0, 1), %g was given.", density);
+    }
+
+    bool AggregateGradients(const std::vector<Matrix<ElemType>*>& gradients, DistGradHeader* headerCPU, bool /*resetState*/) override
+    {
+        if (!m_initialized)
+            Initialize(gradients);
+
+        bool showSyncPerfStats = (m_syncStatsTrace > 0) && ((m_iterationCount % m_syncStatsTrace) == 0);
+        m_iterationCount++;
+
+        Timer aggregationTimer;
+        if (showSyncPerfStats)
+            aggregationTimer.Start();
+
+        if (headerCPU->numSamples == 0)
+        {
+            // If the current node did not process any samples, the gradients should be zero'd; its residuals are still sent
+            for (auto gradient : gradients)
+                gradient->SetValue(0);
+        }
+
+        // Small gradients are all-reduced densely
+        for (size_t i : m_denseGradientsIndex)
+        {
+            ElemType* data = GetCPUData(i, gradients[i]);
+            m_mpi->AllReduce(data, gradients[i]->GetNumElements());
+            SetFromCPUData(i, gradients[i]);
+        }
+
+        // Select the entries to send; the rest goes to the residuals
+        m_sendCounts.assign(m_sparseGradientsIndex.size(), 0);
+        m_sendIndices.clear();
+        m_sendValues.clear();
+        for (size_t j = 0; j < m_sparseGradientsIndex.size(); j++)
+        {
+            size_t i = m_sparseGradientsIndex[j];
+            ElemType* data = GetCPUData(i, gradients[i]);
+            m_sendCounts[j] = SelectAndUpdateResidual(data, m_residuals[j].data(), gradients[i]->GetNumElements());
+        }
+
+        // Exchange the number of entries per gradient and worker, then all entries
+        size_t numSparse = m_sparseGradientsIndex.size();
+        std::vector<int> allCounts(numSparse * NumProc());
+        m_mpi->AllGather(m_sendCounts.data(), numSparse, allCounts.data(), numSparse);
+
+        std::vector<int> recvCounts(NumProc()), offsets(NumProc());
+        size_t totalCount = 0;
+        for (size_t r = 0; r < NumProc(); r++)
+        {
+            offsets[r] = (int)totalCount;
+            recvCounts[r] = 0;
+            for (size_t j = 0; j < numSparse; j++)
+                recvCounts[r] += allCounts[r * numSparse + j];
+            totalCount += recvCounts[r];
+        }
+
+        m_recvIndices.resize(totalCount);
+        m_recvValues.resize(totalCount);
+        m_mpi->AllGatherv(m_sendIndices.data(), m_sendIndices.size(), m_recvIndices.data(), recvCounts.data(), offsets.data());
+        m_mpi->AllGatherv(m_sendValues.data(), m_sendValues.size(), m_recvValues.data(), recvCounts.data(), offsets.data());
+
+        // Sum up the entries of all workers; different gradients can be done in parallel
+        std::vector<size_t> gradientOffsets(NumProc() * numSparse);
+        for (size_t r = 0; r < NumProc(); r++)
+        {
+            size_t offset = offsets[r];
+            for (size_t j = 0; j < numSparse; j++)
+            {
+                gradientOffsets[r * numSparse + j] = offset;
+                offset += allCounts[r * numSparse + j];
+            }
+        }
+
+#pragma omp parallel for
+        for (long j = 0; j < (long)numSparse; j++)
+        {
+            ElemType* data = m_cpuBuffers[m_sparseGradientsIndex[j]].data();
+            if (data == nullptr)
+                data = gradients[m_sparseGradientsIndex[j]]->Data();
+
+            std::fill(data, data + gradients[m_sparseGradientsIndex[j]]->GetNumElements(), (ElemType)0);
+            for (size_t r = 0; r < NumProc(); r++)
+            {
+                size_t begin = gradientOffsets[r * numSparse + j];
+                size_t end = begin + allCounts[r * numSparse + j];
+                for (size_t k = begin; k < end; k++)
+                    data[m_recvIndices[k]] += m_recvValues[k];
+            }
+        }
+
+        for (size_t i : m_sparseGradientsIndex)
+            SetFromCPUData(i, gradients[i]);
+
+        AllReduceHeader(headerCPU);
+
+        if (showSyncPerfStats)
+        {
+            aggregationTimer.Stop();
+            size_t numSparseElements = 0;
+            for (size_t i : m_sparseGradientsIndex)
+                numSparseElements += gradients[i]->GetNumElements();
+
+            fprintf(stderr, "Top-k gradient aggregation: sent %d of %d entries (%.3g%%), time %.6g\n",
+                    (int)m_sendValues.size(), (int)numSparseElements, 100.0 * m_sendValues.size() / std::max<size_t>(numSparseElements, 1), aggregationTimer.ElapsedSeconds());
+        }
+
+        return (headerCPU->numSamples != 0);
+    }
+
+private:
+    void Initialize(const std::vector<Matrix<ElemType>*>& gradients)
+    {
+        for (size_t i = 0; i < gradients.size(); i++)
+        {
+            if (gradients[i]->GetMatrixType() != DENSE)
+                RuntimeError("TopKDistGradAggregator: Gradient aggregation for sparse gradient matrices is currently unsupported!");
+
+            if (gradients[i]->GetNumElements() > (size_t)INT_MAX)
+                RuntimeError("TopKDistGradAggregator: Gradients of more than INT_MAX elements are currently unsupported!");
+
+            size_t sizeInBytes = gradients[i]->GetNumElements() * sizeof(ElemType);
+            if (sizeInBytes < m_minSparseSizeInBytes)
+                m_denseGradientsIndex.push_back(i);
+            else
+            {
+                m_sparseGradientsIndex.push_back(i);
+                m_residuals.push_back(std::vector<ElemType>(gradients[i]->GetNumElements(), 0));
+            }
+        }
+
+        // GPU gradients are sparsified on the CPU
+        m_cpuBuffers.resize(gradients.size());
+        if (m_deviceId != CPUDEVICE)
+        {
+            for (size_t i = 0; i < gradients.size(); i++)
+                m_cpuBuffers[i].resize(gradients[i]->GetNumElements());
+        }
+
+        m_initialized = true;
+    }
+
+    ElemType* GetCPUData(size_t i, Matrix<ElemType>* gradient)
+    {
+        if (m_deviceId == CPUDEVICE)
+            return gradient->Data();
+
+        gradient->CopySection(gradient->GetNumRows(), gradient->GetNumCols(), m_cpuBuffers[i].data(), gradient->GetNumRows());
+        return m_cpuBuffers[i].data();
+    }
+
+    void SetFromCPUData(size_t i, Matrix<ElemType>* gradient)
+    {
+        if (m_deviceId != CPUDEVICE)
+            gradient->SetValue(gradient->GetNumRows(), gradient->GetNumCols(), m_deviceId, m_cpuBuffers[i].data());
+    }
+
+    // Magnitude by which the entries are selected. NaN ranks above everything else, like +-Inf, so that non-finite
+    // entries are always sent (and show up in the aggregated gradient) instead of staying in the residual forever.
+    static ElemType SelectionMagnitude(ElemType value)
+    {
+        return std::isnan(value) ? std::numeric_limits<ElemType>::infinity() : std::fabs(value);
+    }
+
+    // Adds the residual to the gradient, and moves the entries of largest magnitude to the send buffers.
+    // All others become the new residual. Returns the number of entries selected.
+    int SelectAndUpdateResidual(const ElemType* gradient, ElemType* residual, size_t numElements)
+    {
+        // gradient + residual is kept in 'residual' until the selection is known
+#pragma omp parallel for
+        for (long k = 0; k < (long)numElements; k++)
+            residual[k] += gradient[k];
+
+        size_t numToSelect = std::max<size_t>((size_t)(m_density * numElements), 1);
+        ElemType threshold = EstimateThreshold(residual, numElements, numToSelect);
+
+        // Selection in one parallel pass: every thread first counts its entries, then writes them behind those of the threads before it
+        int numThreads = omp_get_max_threads();
+        std::vector<size_t> threadCounts(numThreads + 1, 0);
+        size_t sendOffset = m_sendValues.size();
+#pragma omp parallel num_threads(numThreads)
+        {
+            int t = omp_get_thread_num();
+            int n = omp_get_num_threads();
+            size_t begin = numElements * t / n;
+            size_t end = numElements * (t + 1) / n;
+
+            size_t count = 0;
+            for (size_t k = begin; k < end; k++)
+                count += (SelectionMagnitude(residual[k]) >= threshold) ? 1 : 0;
+            threadCounts[t + 1] = count;
+
+#pragma omp barrier
+#pragma omp single
+            {
+                for (int u = 0; u < n; u++)
+                    threadCounts[u + 1] += threadCounts[u];
+                m_sendIndices.resize(sendOffset + threadCounts[n]);
+                m_sendValues.resize(sendOffset + threadCounts[n]);
+            }
+
+            size_t out = sendOffset + threadCounts[t];
+            for (size_t k = begin; k < end; k++)
+            {
+                if (SelectionMagnitude(residual[k]) >= threshold)
+                {
+                    m_sendIndices[out] = (int)k;
+                    m_sendValues[out] = residual[k];
+                    residual[k] = 0;
+                    out++;
+                }
+            }
+        }
+
+        return (int)(m_sendValues.size() - sendOffset);
+    }
+
+    // Estimates the magnitude above which about 'numToSelect' of the values lie, from a random sample.
+    // If the estimate selects far too many values, the exact threshold is computed instead.
+    ElemType EstimateThreshold(const ElemType* values, size_t numElements, size_t numToSelect)
+    {
+        size_t numSamples = std::min(numElements, s_numThresholdSamples);
+        m_samples.resize(numSamples);
+        if (numSamples == numElements)
+        {
+            for (size_t k = 0; k < numElements; k++)
+                m_samples[k] = SelectionMagnitude(values[k]);
+        }
+        else
+        {
+            std::uniform_int_distribution<size_t> distribution(0, numElements - 1);
+            for (size_t k = 0; k < numSamples; k++)
+                m_samples[k] = SelectionMagnitude(values[distribution(m_randomEngine)]);
+        }
+
+        size_t rank = std::min(numSamples, std::max<size_t>((size_t)((double)numToSelect / numElements * numSamples), 1)) - 1;
+        std::nth_element(m_samples.begin(), m_samples.begin() + rank, m_samples.end(), std::greater<ElemType>());
+        ElemType threshold = m_samples[rank];
+
+        size_t count = 0;
+#pragma omp parallel for reduction(+ : count)
+        for (long k = 0; k < (long)numElements; k++)
+            count += (SelectionMagnitude(values[k]) >= threshold) ? 1 : 0;
+
+        if (count > 2 * numToSelect)
+        {
+            m_samples.resize(numElements);
+            for (size_t k = 0; k < numElements; k++)
+                m_samples[k] = SelectionMagnitude(values[k]);
+            std::nth_element(m_samples.begin(), m_samples.begin() + (numToSelect - 1), m_samples.end(), std::greater<ElemType>());
+            threshold = m_samples[numToSelect - 1];
+        }
+
+        // never send zeros
+        return std::max(threshold, std::numeric_limits<ElemType>::min());
+    }
+
+    int m_deviceId;
+    int m_syncStatsTrace;
+    size_t m_iterationCount;
+
+    const double m_density;
+    const size_t m_minSparseSizeInBytes;
+    bool m_initialized;
+
+    std::vector<size_t> m_denseGradientsIndex;
+    std::vector<size_t> m_sparseGradientsIndex;
+    std::vector<std::vector<ElemType>> m_residuals; // parallel to m_sparseGradientsIndex
+    std::vector<std::vector<ElemType>> m_cpuBuffers; // only used for GPU gradients
+
+    std::vector<int> m_sendCounts;
+    std::vector<int> m_sendIndices;
+    std::vector<ElemType> m_sendValues;
+    std::vector<int> m_recvIndices;
+    std::vector<ElemType> m_recvValues;
+
+    std::vector<ElemType> m_samples;
+    std::mt19937_64 m_randomEngine;
+};
+
+}}}
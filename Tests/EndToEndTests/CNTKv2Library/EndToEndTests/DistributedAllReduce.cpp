@@ -0,0 +1,374 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#define _CRT_SECURE_NO_WARNINGS // "secure" CRT not available on all platforms  --add this at the top of all CPP files that give "function or variable may be unsafe" warnings
+
+// These tests exercise the MPI wrapper that Cntk.Core uses internally, which is only exported on Linux.
+// Its headers do not mix with the test Common.h, so failures are reported through RuntimeError().
+#ifdef _WIN32
+
+#include <stdexcept>
+
+void TestHierarchicalAllReduce()
+{
+    throw std::runtime_error("The distributed all-reduce tests are not supported on Windows.");
+}
+
+void TestRingAllReduce()
+{
+    throw std::runtime_error("The distributed all-reduce tests are not supported on Windows.");
+}
+
+void TestTopKGradientAggregation()
+{
+    throw std::runtime_error("The distributed all-reduce tests are not supported on Windows.");
+}
+
+void TestQuantizedGradientAggregation()
+{
+    throw std::runtime_error("The distributed all-reduce tests are not supported on Windows.");
+}
+
+#else
+
+#include "MPIWrapper.h"
+#include "RingAllReduce.h"
+#include "Matrix.h"
+#include "TopKDistGradAggregator.h"
+#include "QuantizedDistGradAggregator.h"
+#include "QuantizedMatrix.h"
+#include "CNTKLibrary.h"
+
+using namespace Microsoft::MSR::CNTK;
+
+namespace
+{
+    // Small integers, so that every summation order gives exactly the same result.
+    template <typename ElemType>
+    std::vector<ElemType> WorkerData(size_t numElements, size_t rank)
+    {
+        std::vector<ElemType> data(numElements);
+        for (size_t i = 0; i < numElements; i++)
+            data[i] = (ElemType)((int)((i * 7 + rank * 13) % 101) - 50);
+        return data;
+    }
+
+    // The reference: a plain MPI_Allreduce over all ranks, bypassing the wrapper.
+    template <typename ElemType>
+    std::vector<ElemType> FlatAllReduce(std::vector<ElemType> data)
+    {
+        MPI_Allreduce(MPI_IN_PLACE, data.data(), (int)data.size(), MPIWrapper::GetDataType(data.data()), MPI_SUM, MPI_COMM_WORLD) || MpiFail("FlatAllReduce: MPI_Allreduce");
+        return data;
+    }
+
+    template <typename ElemType>
+    void TestHierarchicalAllReduce(const MPIWrapperPtr& mpi)
+    {
+        // below the size threshold, above it, and larger than one shared-memory slot (reduced in several pieces)
+        for (size_t numElements : { (size_t)10, (size_t)100003, (size_t)5000011 })
+        {
+            auto expected = FlatAllReduce(WorkerData<ElemType>(numElements, mpi->CurrentNodeRank()));
+
+            auto inPlace = WorkerData<ElemType>(numElements, mpi->CurrentNodeRank());
+            mpi->AllReduce(inPlace.data(), inPlace.size());
+            if (inPlace != expected)
+                RuntimeError("Hierarchical in-place all-reduce of %d elements does not match the flat all-reduce.", (int)numElements);
+
+            auto source = WorkerData<ElemType>(numElements, mpi->CurrentNodeRank());
+            std::vector<ElemType> outOfPlace(numElements);
+            mpi->AllReduce(source.data(), outOfPlace.data(), numElements);
+            if (outOfPlace != expected)
+                RuntimeError("Hierarchical all-reduce of %d elements does not match the flat all-reduce.", (int)numElements);
+
+            if (source != WorkerData<ElemType>(numElements, mpi->CurrentNodeRank()))
+                RuntimeError("Hierarchical all-reduce of %d elements has modified its input.", (int)numElements);
+
+            // The nonblocking variants, which the gradient aggregators use, with several of them outstanding at once.
+            auto asyncInPlace = WorkerData<ElemType>(numElements, mpi->CurrentNodeRank());
+            std::vector<ElemType> asyncOutOfPlace(numElements);
+            auto gradient = WorkerData<ElemType>(numElements, mpi->CurrentNodeRank());
+            std::vector<MPI_Request> requests(3);
+            mpi->AllReduceAsync(asyncInPlace.data(), numElements, &requests[0]);
+            mpi->AllReduceAsync(source.data(), asyncOutOfPlace.data(), numElements, &requests[1]);
+            mpi->Iallreduce(MPI_IN_PLACE, gradient.data(), (int)numElements, MPIWrapper::GetDataType(gradient.data()), MPI_SUM, &requests[2]) || MpiFail("MPI_Iallreduce");
+            mpi->Wait(&requests[2], MPI_STATUSES_IGNORE) || MpiFail("MPI_Wait");
+            mpi->WaitAll(requests);
+            if (asyncInPlace != expected || asyncOutOfPlace != expected || gradient != expected)
+                RuntimeError("Nonblocking hierarchical all-reduce of %d elements does not match the flat all-reduce.", (int)numElements);
+
+            if (source != WorkerData<ElemType>(numElements, mpi->CurrentNodeRank()))
+                RuntimeError("Nonblocking hierarchical all-reduce of %d elements has modified its input.", (int)numElements);
+        }
+    }
+
+    template <typename ElemType>
+    void TestRingAllReduce(const MPIWrapperPtr& mpi)
+    {
+        // Buffer lengths that the number of ranks does not divide (including fewer elements than ranks, i.e. empty
+        // segments), with chunk sizes that do not divide the segments; the last one hits the cap on the number of chunks.
+        for (size_t chunkSizeInBytes : { sizeof(ElemType), 3 * sizeof(ElemType), (size_t)64 * 1024 })
+        {
+            RingAllReduce ring(mpi, chunkSizeInBytes);
+            for (size_t numElements : { (size_t)1, mpi->NumNodesInUse() - 1, (size_t)10, (size_t)1001, (size_t)100003 })
+            {
+                auto expected = FlatAllReduce(WorkerData<ElemType>(numElements, mpi->CurrentNodeRank()));
+
+                auto inPlace = WorkerData<ElemType>(numElements, mpi->CurrentNodeRank());
+                ring.AllReduce(inPlace.data(), inPlace.data(), numElements);
+                if (inPlace != expected)
+                    RuntimeError("In-place ring all-reduce of %d elements in chunks of %d bytes does not match the flat all-reduce.", (int)numElements, (int)chunkSizeInBytes);
+
+                auto source = WorkerData<ElemType>(numElements, mpi->CurrentNodeRank());
+                std::vector<ElemType> outOfPlace(numElements);
+                ring.AllReduce(source.data(), outOfPlace.data(), numElements);
+                if (outOfPlace != expected)
+                    RuntimeError("Ring all-reduce of %d elements in chunks of %d bytes does not match the flat all-reduce.", (int)numElements, (int)chunkSizeInBytes);
+            }
+        }
+    }
+
+    // Every rank holds a permutation of the magnitudes 1..100 with alternating signs; without ties, a density of 0.1
+    // selects exactly the 10 entries of largest magnitude.
+    template <typename ElemType>
+    std::vector<ElemType> TopKWorkerGradient(size_t rank)
+    {
+        std::vector<ElemType> data(100);
+        for (size_t i = 0; i < data.size(); i++)
+            data[i] = (ElemType)((int)((i * 37 + rank * 11) % 100) + 1) * ((i % 2) ? -1 : 1);
+        return data;
+    }
+
+    template <typename ElemType>
+    std::vector<ElemType> AggregateTopK(TopKDistGradAggregator<ElemType>& aggregator, std::vector<ElemType> gradient)
+    {
+        Matrix<ElemType> matrix(gradient.size(), 1, gradient.data(), CPUDEVICE);
+        DistGradHeader* header = DistGradHeader::Create(0);
+        header->Clear();
+        header->numSamples = 1;
+        aggregator.AggregateGradients({ &matrix }, header, /*resetState =*/ false);
+        DistGradHeader::Destroy(header);
+        return std::vector<ElemType>(matrix.Data(), matrix.Data() + gradient.size());
+    }
+
+    template <typename ElemType>
+    void TestTopKGradientAggregation(const MPIWrapperPtr& mpi)
+    {
+        const size_t rank = mpi->CurrentNodeRank();
+        auto gradient = TopKWorkerGradient<ElemType>(rank);
+        auto expectedTotal = FlatAllReduce(gradient);
+
+        // The first aggregation sums up the top 10 entries of every rank.
+        TopKDistGradAggregator<ElemType> aggregator(mpi, CPUDEVICE, /*syncStatsTrace =*/ 0, /*density =*/ 0.1, /*minSparseSizeInBytes =*/ 0);
+        std::vector<ElemType> expected(gradient.size());
+        for (size_t i = 0; i < gradient.size(); i++)
+            expected[i] = (std::fabs(gradient[i]) > 90) ? gradient[i] : 0;
+        expected = FlatAllReduce(expected);
+
+        auto total = AggregateTopK(aggregator, gradient);
+        if (total != expected)
+            RuntimeError("Top-k aggregation has not selected the entries of largest magnitude.");
+
+        // The rest is carried over in the residual and sent with the following (here zero) gradients, 10 entries each time.
+        for (size_t iteration = 1; iteration < 10; iteration++)
+        {
+            auto aggregated = AggregateTopK(aggregator, std::vector<ElemType>(gradient.size(), 0));
+            for (size_t i = 0; i < gradient.size(); i++)
+                total[i] += aggregated[i];
+        }
+
+        if (total != expectedTotal)
+            RuntimeError("Top-k aggregation has lost part of the gradient in the residual.");
+
+        if (AggregateTopK(aggregator, std::vector<ElemType>(gradient.size(), 0)) != std::vector<ElemType>(gradient.size(), 0))
+            RuntimeError("Top-k aggregation has sent entries of an empty residual.");
+
+        // A non-finite entry is sent right away instead of staying in the residual, and does not disturb the selection of the others.
+        TopKDistGradAggregator<ElemType> nonFiniteAggregator(mpi, CPUDEVICE, /*syncStatsTrace =*/ 0, /*density =*/ 0.1, /*minSparseSizeInBytes =*/ 0);
+        const size_t nonFiniteIndex = 5;
+        auto nonFiniteGradient = gradient;
+        if (rank == 0)
+            nonFiniteGradient[nonFiniteIndex] = std::numeric_limits<ElemType>::quiet_NaN();
+
+        total = AggregateTopK(nonFiniteAggregator, nonFiniteGradient);
+        if (!std::isnan(total[nonFiniteIndex]))
+            RuntimeError("Top-k aggregation has not sent a NaN gradient entry.");
+
+        // rank 0 has sent only 9 finite entries so far
+        for (size_t iteration = 1; iteration <= 10; iteration++)
+        {
+            auto aggregated = AggregateTopK(nonFiniteAggregator, std::vector<ElemType>(gradient.size(), 0));
+            for (size_t i = 0; i < gradient.size(); i++)
+            {
+                if (!std::isfinite(aggregated[i]))
+                    RuntimeError("Top-k aggregation has kept a NaN gradient entry in the residual.");
+                if (i != nonFiniteIndex)
+                    total[i] += aggregated[i];
+            }
+        }
+
+        total[nonFiniteIndex] = expectedTotal[nonFiniteIndex] = 0;
+        if (total != expectedTotal)
+            RuntimeError("Top-k aggregation of a gradient with a NaN entry has lost part of the gradient.");
+    }
+
+    // Aggregates the gradients of all workers the way QuantizedDistGradAggregator does, on a single worker: every gradient
+    // is quantized with its residual, every stripe of columns is summed up in the order of the worker that owns it, and
+    // the sum is quantized again with the residual of that stripe.
+    template <typename ElemType>
+    class QuantizedAggregationReference
+    {
+    public:
+        QuantizedAggregationReference(size_t numRows, size_t numCols, size_t numWorkers, int numBits)
+            : m_numRows(numRows), m_numCols(numCols), m_numBits(numBits), m_quantizer(MatrixQuantizerImpl<ElemType>::Create(CPUDEVICE, false /*useAsync*/))
+        {
+            for (size_t k = 0; k <= numWorkers; k++)
+                m_stripeBegin.push_back(numCols * k / numWorkers);
+
+            for (size_t k = 0; k < numWorkers; k++)
+            {
+                m_residuals.emplace_back(new Matrix<ElemType>(numRows, numCols, CPUDEVICE));
+                m_residuals.back()->SetValue(0);
+                m_stripeResiduals.emplace_back(new Matrix<ElemType>(numRows, m_stripeBegin[k + 1] - m_stripeBegin[k], CPUDEVICE));
+                m_stripeResiduals.back()->SetValue(0);
+            }
+        }
+
+        std::vector<ElemType> Aggregate(std::vector<std::vector<ElemType>>& gradients)
+        {
+            const size_t numWorkers = m_residuals.size();
+            std::vector<std::unique_ptr<QuantizedMatrix<ElemType>>> quantized;
+            for (size_t k = 0; k < numWorkers; k++)
+            {
+                Matrix<ElemType> gradient(m_numRows, m_numCols, gradients[k].data(), CPUDEVICE);
+                quantized.emplace_back(new QuantizedMatrix<ElemType>(m_numRows, m_numCols, m_numBits, CPUDEVICE));
+                m_quantizer->QuantizeAsync(gradient, *m_residuals[k], *quantized[k], *m_residuals[k], /*zeroThresholdFor1Bit =*/ false);
+                m_quantizer->WaitQuantizeAsyncDone();
+            }
+
+            QuantizedMatrix<ElemType> aggregated(m_numRows, m_numCols, m_numBits, CPUDEVICE);
+            for (size_t owner = 0; owner < numWorkers; owner++)
+            {
+                const size_t begin = m_stripeBegin[owner];
+                const size_t numStripeCols = m_stripeBegin[owner + 1] - begin;
+                Matrix<ElemType> stripeSum(m_numRows, numStripeCols, CPUDEVICE);
+                QuantizedMatrix<ElemType> ownStripe = quantized[owner]->ColumnSlice(begin, numStripeCols);
+                m_quantizer->UnquantizeAsync(ownStripe, stripeSum, false);
+                for (size_t k = 0; k < numWorkers; k++)
+                {
+                    if (k == owner)
+                        continue;
+
+                    QuantizedMatrix<ElemType> stripe = quantized[k]->ColumnSlice(begin, numStripeCols);
+                    m_quantizer->UnquantizeAsync(stripe, stripeSum, true);
+                }
+                m_quantizer->WaitUnquantizeAsyncDone();
+
+                QuantizedMatrix<ElemType> aggregatedStripe = aggregated.ColumnSlice(begin, numStripeCols);
+                m_quantizer->QuantizeAsync(stripeSum, *m_stripeResiduals[owner], aggregatedStripe, *m_stripeResiduals[owner], /*zeroThresholdFor1Bit =*/ false);
+                m_quantizer->WaitQuantizeAsyncDone();
+            }
+
+            Matrix<ElemType> result(m_numRows, m_numCols, CPUDEVICE);
+            m_quantizer->UnquantizeAsync(aggregated, result, false);
+            m_quantizer->WaitUnquantizeAsyncDone();
+            return std::vector<ElemType>(result.Data(), result.Data() + result.GetNumElements());
+        }
+
+    private:
+        const size_t m_numRows;
+        const size_t m_numCols;
+        const int m_numBits;
+        std::unique_ptr<MatrixQuantizerImpl<ElemType>> m_quantizer;
+        std::vector<size_t> m_stripeBegin;
+        std::vector<std::unique_ptr<Matrix<ElemType>>> m_residuals;       // of every worker
+        std::vector<std::unique_ptr<Matrix<ElemType>>> m_stripeResiduals; // of the stripe of every worker
+    };
+
+    template <typename ElemType>
+    void TestQuantizedGradientAggregation(const MPIWrapperPtr& mpi, int numBits)
+    {
+        const size_t rank = mpi->CurrentNodeRank();
+        const size_t numWorkers = mpi->NumNodesInUse();
+
+        // The number of workers does not divide the columns of the first gradient into equal stripes.
+        // The second one has fewer columns than workers, and is all-reduced unquantized.
+        const size_t numRows = 37, numCols = 23;
+        const size_t numSmallRows = 5, numSmallCols = numWorkers - 1;
+
+        QuantizedDistGradAggregator<ElemType> aggregator(mpi, numBits, /*zeroThresholdFor1Bit =*/ false, CPUDEVICE, /*syncStatsTrace =*/ 0, /*minQuantizedSizeInBytes =*/ 0);
+        QuantizedAggregationReference<ElemType> reference(numRows, numCols, numWorkers, numBits);
+
+        // the later iterations also send the residuals of the earlier ones
+        for (size_t iteration = 0; iteration < 3; iteration++)
+        {
+            std::vector<std::vector<ElemType>> gradients;
+            for (size_t k = 0; k < numWorkers; k++)
+                gradients.push_back(WorkerData<ElemType>(numRows * numCols, k + iteration * numWorkers));
+
+            auto smallGradientData = WorkerData<ElemType>(numSmallRows * numSmallCols, rank + iteration * numWorkers);
+            Matrix<ElemType> gradient(numRows, numCols, gradients[rank].data(), CPUDEVICE);
+            Matrix<ElemType> smallGradient(numSmallRows, numSmallCols, smallGradientData.data(), CPUDEVICE);
+
+            DistGradHeader* header = DistGradHeader::Create(0);
+            header->Clear();
+            header->numSamples = 1;
+            aggregator.AggregateGradients({ &gradient, &smallGradient }, header, /*resetState =*/ false);
+            if (header->numSamples != numWorkers)
+                RuntimeError("%d-bit quantized aggregation has not aggregated the header.", numBits);
+            DistGradHeader::Destroy(header);
+
+            if (std::vector<ElemType>(gradient.Data(), gradient.Data() + gradient.GetNumElements()) != reference.Aggregate(gradients))
+                RuntimeError("%d-bit quantized aggregation does not match the sum of the quantized gradients (iteration %d).", numBits, (int)iteration);
+
+            if (std::vector<ElemType>(smallGradient.Data(), smallGradient.Data() + smallGradient.GetNumElements()) != FlatAllReduce(smallGradientData))
+                RuntimeError("%d-bit quantized aggregation does not match the flat all-reduce for a gradient that is not quantized.", numBits);
+        }
+    }
+}
+
+// Run with ranks on several simulated hosts (CNTK_MPI_HOSTNAME), at least one of them with more than one rank.
+void TestHierarchicalAllReduce()
+{
+    auto communicator = CNTK::MPICommunicator();
+    auto mpi = MPIWrapper::GetInstance();
+    if (!mpi->IsMultiHost())
+        RuntimeError("The hierarchical all-reduce test must run on more than one (simulated) host.");
+
+    TestHierarchicalAllReduce<float>(mpi);
+    TestHierarchicalAllReduce<double>(mpi);
+    printf("Hierarchical all-reduce matches the flat all-reduce.\n");
+}
+
+void TestRingAllReduce()
+{
+    auto communicator = CNTK::MPICommunicator();
+    auto mpi = MPIWrapper::GetInstance();
+    TestRingAllReduce<float>(mpi);
+    TestRingAllReduce<double>(mpi);
+    printf("Ring all-reduce matches the flat all-reduce.\n");
+}
+
+void TestTopKGradientAggregation()
+{
+    auto communicator = CNTK::MPICommunicator();
+    auto mpi = MPIWrapper::GetInstance();
+    TestTopKGradientAggregation<float>(mpi);
+    TestTopKGradientAggregation<double>(mpi);
+    printf("Top-k gradient aggregation carries the residual over.\n");
+}
+
+void TestQuantizedGradientAggregation()
+{
+    auto communicator = CNTK::MPICommunicator();
+    auto mpi = MPIWrapper::GetInstance();
+    for (int numBits : { 1, 2 })
+    {
+        TestQuantizedGradientAggregation<float>(mpi, numBits);
+        TestQuantizedGradientAggregation<double>(mpi, numBits);
+    }
+    printf("Quantized gradient aggregation matches the sum of the quantized gradients.\n");
+}
+
+#endif
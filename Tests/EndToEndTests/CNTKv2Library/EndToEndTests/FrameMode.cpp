@@ -235,3 +235,90 @@ void TestDistributedCheckpointing()
 
     sync->Barrier();
 }
+
+// A checkpoint of data-parallel training can be restored on a different number of workers: the test is run with save = true,
+// and then with save = false on another number of workers. All workers must then continue from the external state of the
+// main worker, with the learner state and the sample position of the checkpoint.
+void TestElasticCheckpointing(bool save)
+{
+    std::vector<DeviceDescriptor> devices;
+    if (ShouldRunOnCpu())
+        devices.push_back(DeviceDescriptor::CPUDevice());
+    if (ShouldRunOnGpu())
+        devices.push_back(DeviceDescriptor::GPUDevice(0));
+
+    auto sync = MPICommunicator();
+
+    auto numWorkers = sync->Workers().size();
+    auto workerRank = sync->CurrentWorker().m_globalRank;
+    const size_t numMinibatchesBeforeCheckpoint = 10;
+
+    for (size_t d = 0; d < devices.size(); d++)
+    {
+        auto device = devices[d];
+        auto checkpointFile = L"elastic_checkpoint_test." + to_wstring(d);
+        auto expectedLearnerStateFile = checkpointFile + L".learner";
+
+        auto ff = BuildFeedForwardClassifier(device);
+        auto learner = MomentumSGDLearner(ff.output->Parameters(), LearningRatePerSampleSchedule(0.02), MomentumAsTimeConstantSchedule(100));
+        auto distributedLearner = CreateDataParallelDistributedLearner(MPICommunicator(), learner, 0);
+        auto trainer = CreateTrainer(ff.output, ff.trainingLoss, ff.prediction, { distributedLearner });
+
+        // without randomization, every worker reads a part of each minibatch, whatever the number of workers
+        auto minibatchSource = TextFormatMinibatchSource(g_inputFile,
+            { { g_featureStreamName, ff.inputDim },
+              { g_labelsStreamName, ff.ouputDim } },
+            totalNumberOfSamples, false);
+
+        auto featureStreamInfo = minibatchSource->StreamInfo(g_featureStreamName);
+        auto labelStreamInfo = minibatchSource->StreamInfo(g_labelsStreamName);
+
+        auto trainMinibatch = [&]()
+        {
+            auto minibatchData = minibatchSource->GetNextMinibatch(0, minibatchSize, numWorkers, workerRank, device);
+            unordered_map<Variable, MinibatchData> minibatch = { { ff.features, minibatchData[featureStreamInfo] },{ ff.labels, minibatchData[labelStreamInfo] } };
+            trainer->TrainMinibatch(minibatch, device);
+        };
+
+        if (save)
+        {
+            for (size_t i = 0; i < numMinibatchesBeforeCheckpoint; i++)
+                trainMinibatch();
+
+            Dictionary externalState;
+            externalState[L"minibatchSource"] = minibatchSource->GetCheckpointState();
+            externalState[L"worker"] = workerRank;
+            trainer->SaveCheckpoint(checkpointFile, externalState);
+            if (sync->CurrentWorker().IsMain())
+                distributedLearner->CreateCheckpoint().Save(expectedLearnerStateFile);
+
+            sync->Barrier();
+            continue;
+        }
+
+        auto externalState = trainer->RestoreFromCheckpoint(checkpointFile);
+        if (externalState[L"worker"].Value<size_t>() != 0)
+            ReportFailure("Worker %d did not continue from the external state of the main worker", (int)workerRank);
+
+        auto minibatchSourceState = externalState[L"minibatchSource"].Value<Dictionary>();
+        minibatchSource->RestoreFromCheckpoint(minibatchSourceState);
+        if (!(minibatchSource->GetCheckpointState() == minibatchSourceState))
+            ReportFailure("The sample position of the minibatch source was not restored");
+
+        if (!(distributedLearner->CreateCheckpoint() == Dictionary::Load(expectedLearnerStateFile)))
+            ReportFailure("The learner state was not restored");
+
+        auto numSamplesSeen = trainer->TotalNumberOfSamplesSeen();
+        if (numSamplesSeen != numMinibatchesBeforeCheckpoint * minibatchSize)
+            ReportFailure("Unexpected number of samples seen after restoring the checkpoint: %d", (int)numSamplesSeen);
+
+        // the minibatch size is that of all workers together, so it does not change with the number of workers
+        trainMinibatch();
+        if (trainer->TotalNumberOfSamplesSeen() != numSamplesSeen + minibatchSize)
+            ReportFailure("Unexpected number of samples in a minibatch on %d workers: %d", (int)numWorkers, (int)(trainer->TotalNumberOfSamplesSeen() - numSamplesSeen));
+
+        sync->Barrier();
+    }
+
+    sync->Barrier();
+}
@@ -22,6 +22,11 @@ void TrainSequenceToSequenceTranslator();
 void TrainTruncatedLSTMAcousticModelClassifier();
 void TestFrameMode();
 void TestDistributedCheckpointing();
+void TestElasticCheckpointing(bool save);
+void TestHierarchicalAllReduce();
+void TestRingAllReduce();
+void TestTopKGradientAggregation();
+void TestQuantizedGradientAggregation();
 
 int main(int argc, char *argv[])
 {
@@ -45,7 +50,8 @@ int main(int argc, char *argv[])
 
     if (argc > 2)
     {
-        if (argc == 3 && !std::string(argv[1]).compare("Distribution")) {
+        if (argc == 3 && (!std::string(argv[1]).compare("Distribution") || !std::string(argv[1]).compare("DistributedAllReduce") ||
+                          !std::string(argv[1]).compare("ElasticCheckpointSave") || !std::string(argv[1]).compare("ElasticCheckpointRestore"))) {
             {
                 auto communicator = MPICommunicator();
                 std::string logFilename = argv[2] + std::to_string(communicator->CurrentWorker().m_globalRank);
@@ -57,11 +63,34 @@ int main(int argc, char *argv[])
                 }
             }
 
-            TestFrameMode();
+            std::string testsPassedMsg;
+            if (!std::string(argv[1]).compare("Distribution"))
+            {
+                TestFrameMode();
+
+                TestDistributedCheckpointing();
 
-            TestDistributedCheckpointing();
+                testsPassedMsg = "\nCNTKv2Library-Distribution tests: Passed\n";
+            }
+            else if (!std::string(argv[1]).compare("ElasticCheckpointSave") || !std::string(argv[1]).compare("ElasticCheckpointRestore"))
+            {
+                // saved and restored by two runs on different numbers of workers
+                TestElasticCheckpointing(!std::string(argv[1]).compare("ElasticCheckpointSave"));
 
-            std::string testsPassedMsg = "\nCNTKv2Library-Distribution tests: Passed\n";
+                testsPassedMsg = "\nCNTKv2Library-" + std::string(argv[1]) + " tests: Passed\n";
+            }
+            else
+            {
+                TestHierarchicalAllReduce();
+
+                TestRingAllReduce();
+
+                TestTopKGradientAggregation();
+
+                TestQuantizedGradientAggregation();
+
+                testsPassedMsg = "\nCNTKv2Library-DistributedAllReduce tests: Passed\n";
+            }
 
             printf("%s", testsPassedMsg.c_str());
 
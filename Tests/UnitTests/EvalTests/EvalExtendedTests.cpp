@@ -7,6 +7,7 @@
 #include "ComputationNode.h"
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
+#include <thread>
 
 using namespace Microsoft::MSR::CNTK;
 
@@ -227,6 +228,58 @@ BOOST_AUTO_TEST_CASE(EvalDenseTimesTest)
     eval->Destroy();
 }
 
+BOOST_AUTO_TEST_CASE(EvalBoundBuffersTest)
+{
+    std::string modelDefinition =
+        "deviceId = -1 \n"
+        "precision = \"float\" \n"
+        "traceLevel = 1 \n"
+        "run=NDLNetworkBuilder \n"
+        "NDLNetworkBuilder=[ \n"
+        "i1 = Input(2) \n"
+        "o1 = Times(Constant(2, rows=2, cols=2), i1, tag=\"output\") \n"
+        "FeatureNodes = (i1) \n"
+        "] \n";
+
+    VariableSchema inputLayouts;
+    VariableSchema outputLayouts;
+    IEvaluateModelExtended<float> *eval;
+    eval = SetupNetworkAndGetLayouts(modelDefinition, inputLayouts, outputLayouts);
+
+    // Input and output buffers are bound to the network on the CPU. Each call must only see its own buffers,
+    // and must leave the input buffers untouched.
+    std::vector<std::vector<float>> inputs{ { 1, 2, 3, 4 }, { 0, 1 }, { 1, 1, 2, 2, 3, 3 } };
+    std::vector<std::vector<float>> expected{ { 6, 6, 14, 14 }, { 2, 2 }, { 4, 4, 8, 8, 12, 12 } };
+    for (size_t k = 0; k < inputs.size(); ++k)
+    {
+        auto input = inputs[k];
+        std::vector<int> empty;
+        ValueRefs<float> inputRefs(1);
+        inputRefs[0].m_buffer.InitFrom(input);
+        inputRefs[0].m_colIndices.InitFrom(empty);
+        inputRefs[0].m_indices.InitFrom(empty);
+
+        std::vector<float> output(6, -1);
+        ValueRefs<float> outputRefs(1);
+        outputRefs[0].m_buffer.InitFrom(output.data(), output.capacity(), 0);
+
+        eval->ForwardPass(inputRefs, outputRefs);
+        BOOST_CHECK_EQUAL(outputRefs[0].m_buffer.size(), expected[k].size());
+        BOOST_CHECK_EQUAL_COLLECTIONS(output.begin(), output.begin() + expected[k].size(), expected[k].begin(), expected[k].end());
+        BOOST_CHECK_EQUAL_COLLECTIONS(input.begin(), input.end(), inputs[k].begin(), inputs[k].end());
+    }
+
+    // The copying path keeps working after buffers have been bound.
+    Values<float> inputBuffer(1);
+    inputBuffer[0].m_buffer = { 1, 2 };
+    Values<float> outputBuffer = outputLayouts.CreateBuffers<float>({ 1 });
+    eval->ForwardPass(inputBuffer, outputBuffer);
+    std::vector<float> expectedSingle{ 6, 6 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(outputBuffer[0].m_buffer.begin(), outputBuffer[0].m_buffer.end(), expectedSingle.begin(), expectedSingle.end());
+
+    eval->Destroy();
+}
+
 BOOST_AUTO_TEST_CASE(EvalSparseTimesTest)
 {
     std::string modelDefinition =
@@ -415,5 +468,107 @@ BOOST_AUTO_TEST_CASE(EvalRNNTest)
     eval->Destroy();
 }
 
+BOOST_AUTO_TEST_CASE(EvalConcurrentSessionsTest)
+{
+    std::string modelDefinition =
+        "deviceId = -1 \n"
+        "precision = \"float\" \n"
+        "traceLevel = 1 \n"
+        "run=NDLNetworkBuilder \n"
+        "NDLNetworkBuilder=[ \n"
+        "i1 = Input(1) \n"
+        "o1 = Times(Constant(3), i1, tag=\"output\") \n"
+        "FeatureNodes = (i1) \n"
+        "] \n";
+
+    VariableSchema inputLayouts;
+    VariableSchema outputLayouts;
+    IEvaluateModelExtended<float> *eval;
+    eval = SetupNetworkAndGetLayouts(modelDefinition, inputLayouts, outputLayouts);
+
+    // Create sessions sharing the parameters of 'eval', and run them concurrently
+    const size_t numSessions = 4;
+    std::vector<IEvaluateModelExtended<float>*> sessions;
+    for (size_t i = 0; i < numSessions; i++)
+    {
+        sessions.push_back(eval->CreateSession());
+        sessions.back()->StartForwardEvaluation({ outputLayouts[0].m_name });
+    }
+
+    std::vector<float> results(numSessions);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < numSessions; i++)
+    {
+        threads.push_back(std::thread([&, i]()
+        {
+            Values<float> inputBuffer(1);
+            Values<float> outputBuffer = outputLayouts.CreateBuffers<float>({ 1 });
+            for (size_t iter = 0; iter < 100; iter++)
+            {
+                inputBuffer[0].m_buffer = { (float)i };
+                sessions[i]->ForwardPass(inputBuffer, outputBuffer);
+            }
+            results[i] = outputBuffer[0].m_buffer[0];
+        }));
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    std::vector<float> expected{ 0, 3, 6, 9 };
+    BOOST_CHECK_EQUAL_COLLECTIONS(results.begin(), results.end(), expected.begin(), expected.end());
+
+    // sessions remain usable after the evaluator they were created from is gone
+    eval->Destroy();
+    Values<float> inputBuffer(1);
+    inputBuffer[0].m_buffer = { 5 };
+    Values<float> outputBuffer = outputLayouts.CreateBuffers<float>({ 1 });
+    sessions[0]->ForwardPass(inputBuffer, outputBuffer);
+    BOOST_CHECK_EQUAL(outputBuffer[0].m_buffer[0], 15);
+
+    for (auto session : sessions)
+        session->Destroy();
+}
+
+BOOST_AUTO_TEST_CASE(EvalHalfPrecisionWeightsTest)
+{
+    // 0.1 is not exact in half precision, so the output tells whether the weights are used in half precision
+    std::string modelDefinition =
+        "deviceId = -1 \n"
+        "precision = \"float\" \n"
+        "traceLevel = 1 \n"
+        "halfPrecisionWeights = true \n"
+        "run=NDLNetworkBuilder \n"
+        "NDLNetworkBuilder=[ \n"
+        "i1 = Input(4) \n"
+        "o1 = Times(Constant(0.1, rows=2, cols=4), i1, tag=\"output\") \n"
+        "FeatureNodes = (i1) \n"
+        "] \n";
+
+    VariableSchema inputLayouts;
+    VariableSchema outputLayouts;
+    IEvaluateModelExtended<float> *eval;
+    eval = SetupNetworkAndGetLayouts(modelDefinition, inputLayouts, outputLayouts);
+
+    // sessions share the weights in half precision
+    auto session = eval->CreateSession();
+    session->StartForwardEvaluation({ outputLayouts[0].m_name });
+
+    const float halfPrecisionWeight = 0.0999755859375f;
+    for (auto evaluator : { eval, session })
+    {
+        Values<float> inputBuffer(1);
+        inputBuffer[0].m_buffer = { 1, 2, 3, 4 };
+        Values<float> outputBuffer = outputLayouts.CreateBuffers<float>({ 1 });
+        evaluator->ForwardPass(inputBuffer, outputBuffer);
+
+        BOOST_REQUIRE_EQUAL(outputBuffer[0].m_buffer.size(), (size_t)2);
+        for (auto value : outputBuffer[0].m_buffer)
+            BOOST_CHECK_CLOSE(value, 10 * halfPrecisionWeight, 1e-4);
+    }
+
+    session->Destroy();
+    eval->Destroy();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 }}}}
@@ -0,0 +1,101 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+#include "stdafx.h"
+#include <limits>
+#include "../../../Source/Math/Matrix.h"
+#include "../../../Source/Math/HalfPrecision.h"
+
+using namespace Microsoft::MSR::CNTK;
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+// Rounds the values to half precision, so that products with the HalfPrecisionMatrix of 'a' can be compared with products with 'a'.
+static void RoundToHalfPrecision(Matrix<float>& a)
+{
+    std::vector<uint16_t> half(a.GetNumElements());
+    FloatToHalf(a.Data(), half.data(), half.size());
+    HalfToFloat(half.data(), a.Data(), half.size());
+}
+
+BOOST_AUTO_TEST_SUITE(HalfPrecisionSuite)
+
+BOOST_AUTO_TEST_CASE(HalfPrecisionConversion)
+{
+    for (float value : { 0.0f, -0.0f, 1.0f, -2.5f, 0.333251953125f, 65504.0f, 6.103515625e-05f /*smallest normal*/, 5.9604644775390625e-08f /*smallest subnormal*/ })
+        BOOST_CHECK_EQUAL(HalfToFloat(FloatToHalf(value)), value);
+
+    // round to nearest even
+    BOOST_CHECK_EQUAL(HalfToFloat(FloatToHalf(1.0f + 1.0f / 2048)), 1.0f);
+    BOOST_CHECK_EQUAL(HalfToFloat(FloatToHalf(1.0f + 3.0f / 2048)), 1.0f + 4.0f / 2048);
+    BOOST_CHECK_EQUAL(HalfToFloat(FloatToHalf(65520.0f)), std::numeric_limits<float>::infinity());
+    BOOST_CHECK_EQUAL(HalfToFloat(FloatToHalf(-1e-8f)), -0.0f);
+    BOOST_CHECK(std::isnan(HalfToFloat(FloatToHalf(std::numeric_limits<float>::quiet_NaN()))));
+
+    // the array conversion (F16C, if enabled) gives the same bits as the scalar one
+    std::vector<float> values(1001);
+    for (size_t i = 0; i < values.size(); i++)
+        values[i] = (float)((int)i - 500) * 0.37f;
+    std::vector<uint16_t> half(values.size());
+    FloatToHalf(values.data(), half.data(), values.size());
+    for (size_t i = 0; i < values.size(); i++)
+        BOOST_CHECK_EQUAL(half[i], FloatToHalf(values[i]));
+}
+
+BOOST_FIXTURE_TEST_CASE(HalfPrecisionTimesDense, RandomSeedFixture)
+{
+    // enough columns of A for several conversion blocks
+    const size_t m = 3, k = 50000, n = 4;
+    Matrix<float> a = Matrix<float>::RandomUniform(m, k, CPUDEVICE, -1.0f, 1.0f, IncrementCounter());
+    RoundToHalfPrecision(a);
+    HalfPrecisionMatrix halfA(m, k, a.Data());
+
+    Matrix<float> b = Matrix<float>::RandomUniform(k, n, CPUDEVICE, -1.0f, 1.0f, IncrementCounter());
+    Matrix<float> c = Matrix<float>::RandomUniform(m, n, CPUDEVICE, -1.0f, 1.0f, IncrementCounter());
+    Matrix<float> expected(c.DeepClone());
+
+    Matrix<float>::MultiplyAndWeightedAdd(0.5f, halfA, b, 2.0f, c);
+    Matrix<float>::MultiplyAndWeightedAdd(0.5f, a, false, b, false, 2.0f, expected);
+    BOOST_CHECK(c.IsEqualTo(expected, c_epsilonFloatE3));
+
+    // reshaped, with beta = 0
+    Matrix<float> d(CPUDEVICE);
+    Matrix<float> bReshaped = b.Reshaped(k / 2, n * 2);
+    Matrix<float>::MultiplyAndWeightedAdd(1.0f, halfA.Reshaped(m * 2, k / 2), bReshaped, 0.0f, d);
+    Matrix<float>::MultiplyAndWeightedAdd(1.0f, a.Reshaped(m * 2, k / 2), false, bReshaped, false, 0.0f, expected);
+    BOOST_CHECK(d.IsEqualTo(expected, c_epsilonFloatE3));
+}
+
+BOOST_FIXTURE_TEST_CASE(HalfPrecisionTimesSparse, RandomSeedFixture)
+{
+    // an embedding: one-hot columns, one of them empty
+    const size_t dim = 8, vocabulary = 1000, n = 5;
+    Matrix<float> a = Matrix<float>::RandomUniform(dim, vocabulary, CPUDEVICE, -1.0f, 1.0f, IncrementCounter());
+    RoundToHalfPrecision(a);
+    HalfPrecisionMatrix halfA(dim, vocabulary, a.Data());
+
+    std::vector<CPUSPARSE_INDEX_TYPE> columnStarts = { 0, 1, 2, 2, 4, 5 };
+    std::vector<CPUSPARSE_INDEX_TYPE> rows = { 17, 999, 0, 17, 523 };
+    std::vector<float> values = { 1.0f, 1.0f, 1.0f, 0.5f, 2.0f };
+    Matrix<float> b(vocabulary, n, CPUDEVICE, MatrixType::SPARSE, matrixFormatSparseCSC);
+    b.SetMatrixFromCSCFormat(columnStarts.data(), rows.data(), values.data(), values.size(), vocabulary, n);
+
+    Matrix<float> bDense(b.DeepClone());
+    bDense.SwitchToMatrixType(MatrixType::DENSE, matrixFormatDense, true);
+
+    Matrix<float> c = Matrix<float>::RandomUniform(dim, n, CPUDEVICE, -1.0f, 1.0f, IncrementCounter());
+    Matrix<float> expected(c.DeepClone());
+    Matrix<float>::MultiplyAndWeightedAdd(0.5f, halfA, b, 2.0f, c);
+    Matrix<float>::MultiplyAndWeightedAdd(0.5f, a, false, bDense, false, 2.0f, expected);
+    BOOST_CHECK(c.IsEqualTo(expected, c_epsilonFloatE4));
+
+    // a column slice of the sparse matrix
+    Matrix<float> d(CPUDEVICE);
+    Matrix<float>::MultiplyAndWeightedAdd(1.0f, halfA, b.ColumnSlice(2, 3), 0.0f, d);
+    Matrix<float>::MultiplyAndWeightedAdd(1.0f, a, false, bDense.ColumnSlice(2, 3), false, 0.0f, expected);
+    BOOST_CHECK(d.IsEqualTo(expected, c_epsilonFloatE4));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} } } }
@@ -34,6 +34,27 @@ BOOST_FIXTURE_TEST_CASE(CPUMatrixFileWriteRead, RandomSeedFixture)
     BOOST_CHECK(matrixCpuCopy.IsEqualTo(matrixCpuRead, c_epsilonFloatE5));
 }
 
+BOOST_FIXTURE_TEST_CASE(CPUMatrixBinaryFileWriteRead, RandomSeedFixture)
+{
+    CPUMatrix<float> matrixCpu1 = CPUMatrix<float>::RandomUniform(43, 10, -26.3f, 30.2f, IncrementCounter());
+    CPUMatrix<float> matrixCpu2 = CPUMatrix<float>::RandomUniform(7, 3, -26.3f, 30.2f, IncrementCounter());
+
+    std::wstring fileNameCpu(L"MCPU.bin");
+    File fileCpu(fileNameCpu, fileOptionsBinary | fileOptionsReadWrite);
+
+    fileCpu << matrixCpu1 << matrixCpu2;
+    fileCpu.SetPosition(0);
+
+    // the second read goes into a matrix that already holds a larger buffer
+    CPUMatrix<float> matrixCpuRead;
+    fileCpu >> matrixCpuRead;
+    BOOST_CHECK(matrixCpu1.IsEqualTo(matrixCpuRead, 0));
+    fileCpu >> matrixCpuRead;
+    BOOST_CHECK_EQUAL(7, matrixCpuRead.GetNumRows());
+    BOOST_CHECK_EQUAL(3, matrixCpuRead.GetNumCols());
+    BOOST_CHECK(matrixCpu2.IsEqualTo(matrixCpuRead, 0));
+}
+
 BOOST_FIXTURE_TEST_CASE(MatrixFileWriteRead, RandomSeedFixture)
 {
     // Test Matrix in Dense mode
@@ -453,6 +453,8 @@ BOOST_FIXTURE_TEST_CASE(CPUMatrix1BitQuantizeFloat, RandomSeedFixture)
     TestQuantization<float>(CPUDEVICE, 89, 23, -0.5f, +0.5f, 2715, 5);
     TestQuantization<float>(CPUDEVICE, 15, 35, -0.5f, +0.5f, 2815, 5);
     TestQuantization<float>(CPUDEVICE, 100, 50, -0.5f, +0.5f, 2915, 5);
+    // large enough to be quantized by multiple threads
+    TestQuantization<float>(CPUDEVICE, 737, 373, -0.5f, +0.5f, 3015, 2);
 }
 
 BOOST_FIXTURE_TEST_CASE(CPUMatrix1BitQuantizeDouble, RandomSeedFixture)
@@ -469,6 +471,8 @@ BOOST_FIXTURE_TEST_CASE(CPUMatrix1BitQuantizeDouble, RandomSeedFixture)
     TestQuantization<double>(CPUDEVICE, 89, 23, -0.5f, +0.5f, 2715, 5);
     TestQuantization<double>(CPUDEVICE, 15, 35, -0.5f, +0.5f, 2815, 5);
     TestQuantization<double>(CPUDEVICE, 100, 50, -0.5f, +0.5f, 2915, 5);
+    // large enough to be quantized by multiple threads
+    TestQuantization<double>(CPUDEVICE, 737, 373, -0.5f, +0.5f, 3015, 2);
 }
 
 /*
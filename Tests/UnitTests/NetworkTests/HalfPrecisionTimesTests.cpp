@@ -0,0 +1,148 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#include "stdafx.h"
+
+#include "../../../Source/ComputationNetworkLib/ComputationNetwork.h"
+#include "../../../Source/ComputationNetworkLib/ComputationNetworkBuilder.h"
+#include "../../../Source/ComputationNetworkLib/InputAndParamNodes.h"
+#include "../../../Source/Math/HalfPrecision.h"
+#include "TestHelpers.h"
+#include <memory>
+
+using namespace Microsoft::MSR::CNTK;
+using namespace std;
+
+namespace Microsoft { namespace MSR { namespace CNTK { namespace Test {
+
+// Values in half precision are only supported on the CPU.
+const DEVICEID_TYPE c_deviceId = CPUDEVICE;
+
+static const float c_epsilonFloatE5 = 0.00001f;
+
+// Weights that half precision does not represent exactly, so that the product tells which values were used.
+template <class ElemType>
+vector<ElemType> HalfPrecisionTestWeights(size_t numElements, bool roundToHalfPrecision)
+{
+    vector<ElemType> weights(numElements);
+    for (size_t i = 0; i < numElements; i++)
+    {
+        weights[i] = (ElemType)(0.1 * (int)(i % 7) - 0.3);
+        if (roundToHalfPrecision)
+            weights[i] = HalfToFloat(FloatToHalf((float)weights[i]));
+    }
+    return weights;
+}
+
+// out = Times(W, features, outputRank), where W is a constant of shape 'weightDims'
+template <class ElemType>
+ComputationNetworkPtr CreateTimesNetwork(const SmallVector<size_t>& weightDims, size_t outputRank, bool roundToHalfPrecision)
+{
+    auto net = make_shared<ComputationNetwork>(c_deviceId);
+    ComputationNetworkBuilder<ElemType> builder(*net);
+
+    TensorShape weightShape(weightDims);
+    SmallVector<size_t> inputDims;
+    for (size_t i = outputRank; i < weightDims.size(); i++)
+        inputDims.push_back(weightDims[i]);
+
+    auto features = builder.CreateInputNode(L"features", TensorShape(inputDims));
+    auto weight = builder.CreateLearnableParameter(L"W", weightShape);
+    auto weightValues = HalfPrecisionTestWeights<ElemType>(weightShape.GetNumElements(), roundToHalfPrecision);
+    copy(weightValues.begin(), weightValues.end(), weight->Value().Data());
+    dynamic_pointer_cast<LearnableParameter<ElemType>>(weight)->FreezeParameters(); // a constant
+
+    auto out = builder.Times(weight, features, outputRank, L"out");
+    net->AddToNodeGroup(L"feature", features);
+    net->AddToNodeGroup(L"output", out);
+    net->CompileNetwork();
+    return net;
+}
+
+template <class ElemType>
+vector<ElemType> EvaluateTimesNetwork(const ComputationNetworkPtr& net, vector<ElemType> inputValues)
+{
+    auto features = dynamic_pointer_cast<ComputationNode<ElemType>>(net->GetNodeFromName(L"features"));
+    ComputationNodeBasePtr outNode = net->GetNodeFromName(L"out");
+    auto out = dynamic_pointer_cast<ComputationNode<ElemType>>(outNode);
+    net->AllocateAllMatrices({}, { outNode }, nullptr);
+    net->StartEvaluateMinibatchLoop(outNode);
+
+    size_t numRows = features->GetSampleLayout().GetNumElements();
+    size_t numCols = inputValues.size() / numRows;
+    features->GetMBLayout()->Init(1, numCols);
+    features->GetMBLayout()->AddSequence(0, 0, 0, numCols);
+    features->Value().SetValue(numRows, numCols, c_deviceId, inputValues.data());
+
+    ComputationNetwork::BumpEvalTimeStamp(vector<ComputationNodeBasePtr>{ features });
+    net->ForwardProp(outNode);
+    return vector<ElemType>(out->Value().Data(), out->Value().Data() + out->Value().GetNumElements());
+}
+
+template <class ElemType>
+shared_ptr<LearnableParameter<ElemType>> TimesWeight(const ComputationNetworkPtr& net)
+{
+    return dynamic_pointer_cast<LearnableParameter<ElemType>>(net->GetNodeFromName(L"W"));
+}
+
+template <class ElemType>
+void CheckTimesOutput(const vector<ElemType>& actual, const vector<ElemType>& expected, const char* message)
+{
+    BOOST_REQUIRE_EQUAL(actual.size(), expected.size());
+    BOOST_CHECK_MESSAGE(AreEqual(actual.data(), expected.data(), actual.size(), c_epsilonFloatE5), message);
+}
+
+// Times with its left operand in half precision gives the product with the weights rounded to half precision, also in a
+// network that shares the parameters, and after the network has been saved (in full precision) and loaded again.
+template <class ElemType>
+void HalfPrecisionTimesTestImpl(const SmallVector<size_t>& weightDims, size_t outputRank)
+{
+    auto net = CreateTimesNetwork<ElemType>(weightDims, outputRank, /*roundToHalfPrecision =*/ false);
+    auto inputValues = HalfPrecisionTestWeights<ElemType>(net->GetNodeFromName(L"features")->GetSampleLayout().GetNumElements() * 3, false);
+    for (auto& value : inputValues)
+        value += 1;
+
+    auto expected = EvaluateTimesNetwork<ElemType>(CreateTimesNetwork<ElemType>(weightDims, outputRank, /*roundToHalfPrecision =*/ true), inputValues);
+
+    BOOST_REQUIRE_EQUAL(net->template StoreConstantsInHalfPrecision<ElemType>(), (size_t)1);
+    auto weight = TimesWeight<ElemType>(net);
+    BOOST_REQUIRE(weight->HalfPrecisionValue() != nullptr);
+    BOOST_CHECK_EQUAL(weight->Value().GetNumElements(), (size_t)0);
+    CheckTimesOutput(EvaluateTimesNetwork<ElemType>(net, inputValues), expected, "Times with a left operand in half precision is incorrect.");
+
+    auto clone = net->CloneWithSharedParameters();
+    BOOST_CHECK(TimesWeight<ElemType>(clone)->HalfPrecisionValue() == weight->HalfPrecisionValue());
+    CheckTimesOutput(EvaluateTimesNetwork<ElemType>(clone, inputValues), expected, "Times with a left operand in half precision is incorrect in a clone with shared parameters.");
+
+    const wstring modelPath = L"HalfPrecisionTimes.dnn";
+    net->Save(modelPath);
+    auto loaded = ComputationNetwork::CreateFromFile<ElemType>(c_deviceId, modelPath);
+    auto loadedWeight = TimesWeight<ElemType>(loaded);
+    BOOST_REQUIRE(loadedWeight->HalfPrecisionValue() == nullptr);
+    auto roundedWeights = HalfPrecisionTestWeights<ElemType>(loadedWeight->Value().GetNumElements(), true);
+    BOOST_CHECK(AreEqual(loadedWeight->Value().Data(), roundedWeights.data(), roundedWeights.size(), 1e-7f)); // (exact)
+    CheckTimesOutput(EvaluateTimesNetwork<ElemType>(loaded, inputValues), expected, "Times is incorrect after saving a value in half precision.");
+
+    BOOST_REQUIRE_EQUAL(loaded->template StoreConstantsInHalfPrecision<ElemType>(), (size_t)1);
+    CheckTimesOutput(EvaluateTimesNetwork<ElemType>(loaded, inputValues), expected, "Times with a left operand in half precision is incorrect after loading.");
+}
+
+BOOST_AUTO_TEST_SUITE(HalfPrecisionTimesTestSuite)
+
+BOOST_AUTO_TEST_CASE(HalfPrecisionTimes)
+{
+    HalfPrecisionTimesTestImpl<float>({ 3, 4 }, 1);
+    HalfPrecisionTimesTestImpl<double>({ 3, 4 }, 1);
+}
+
+BOOST_AUTO_TEST_CASE(HalfPrecisionTimesWithOutputRank)
+{
+    HalfPrecisionTimesTestImpl<float>({ 2, 3, 4, 5 }, 2);
+    HalfPrecisionTimesTestImpl<double>({ 2, 3, 4 }, 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}}}
@@ -0,0 +1,146 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE.md file in the project root for full license information.
+//
+
+#include "stdafx.h"
+#include "CNTKLibrary.h"
+#include "Common.h"
+#include <future>
+
+using namespace CNTK;
+
+namespace CNTK { namespace Test {
+
+template <typename ElementType>
+std::vector<ElementType> ValueToVector(const ValuePtr& value)
+{
+    auto data = value->Data()->DeepClone(DeviceDescriptor::CPUDevice());
+    const ElementType* buffer = data->DataBuffer<ElementType>();
+    return std::vector<ElementType>(buffer, buffer + data->Shape().TotalSize());
+}
+
+// Submits all 'requests' at once and compares each batched result with a separate Evaluate() of just that request.
+template <typename ElementType>
+void VerifyBatchedResultsMatchPerRequestEvaluation(const FunctionPtr& function, const Variable& input, const std::vector<std::vector<ElementType>>& requests,
+                                                   size_t maxBatchSize, const DeviceDescriptor& device)
+{
+    auto output = function->Output();
+    bool isSequenceInput = input.DynamicAxes().size() > 1;
+    auto evaluator = CreateBatchingEvaluator(function, {}, maxBatchSize, /*maxLatencyInMicroseconds =*/ 50000, device);
+
+    std::vector<std::future<std::unordered_map<Variable, ValuePtr>>> results;
+    for (const auto& request : requests)
+    {
+        auto sampleShape = isSequenceInput ? input.Shape().AppendShape({ request.size() / input.Shape().TotalSize() }) : input.Shape();
+        auto sample = MakeSharedObject<NDArrayView>(sampleShape, request);
+        results.push_back(evaluator->EvaluateAsync({ { input, sample } }));
+    }
+
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        auto batchedResult = ValueToVector<ElementType>(results[i].get().at(output));
+
+        auto inputValue = isSequenceInput ? Value::CreateSequence(input.Shape(), requests[i], device, true) : Value::CreateBatch(input.Shape(), requests[i], device, true);
+        std::unordered_map<Variable, ValuePtr> outputs = { { output, nullptr } };
+        function->Evaluate({ { input, inputValue } }, outputs, device);
+        std::vector<std::vector<ElementType>> expectedResult;
+        outputs[output]->CopyVariableValueTo(output, expectedResult);
+
+        FloatingPointVectorCompare(batchedResult, expectedResult[0], "Batched evaluation does not match per-request evaluation");
+    }
+
+    auto statistics = evaluator->Statistics();
+    BOOST_TEST(statistics.m_numRequests == requests.size());
+    BOOST_TEST(statistics.m_maxBatchSize <= maxBatchSize);
+    BOOST_TEST(statistics.m_numBatches >= (requests.size() + maxBatchSize - 1) / maxBatchSize);
+}
+
+template <typename ElementType>
+void TestBatchingEvaluatorFeedForward(const DeviceDescriptor& device)
+{
+    const size_t inputDim = 5;
+    const size_t outputDim = 3;
+    auto input = InputVariable({ inputDim }, AsDataType<ElementType>(), L"features", { Axis::DefaultBatchAxis() });
+    auto timesParam = Parameter(NDArrayView::RandomUniform<ElementType>({ outputDim, inputDim }, -0.5, 0.5, 1, device));
+    auto plusParam = Parameter(NDArrayView::RandomUniform<ElementType>({ outputDim }, -0.5, 0.5, 2, device));
+    auto function = Sigmoid(Plus(Times(timesParam, input), plusParam));
+
+    // 10 requests with a batch limit of 4 are served in batches of different sizes, the last one partially filled.
+    auto requests = GenerateSequences<ElementType>(std::vector<size_t>(10, 1), { inputDim });
+    VerifyBatchedResultsMatchPerRequestEvaluation<ElementType>(function, input, requests, 4, device);
+}
+
+template <typename ElementType>
+void TestBatchingEvaluatorSequences(const DeviceDescriptor& device)
+{
+    const size_t inputDim = 4;
+    const size_t outputDim = 3;
+    auto input = InputVariable({ inputDim }, AsDataType<ElementType>(), L"features");
+    auto timesParam = Parameter(NDArrayView::RandomUniform<ElementType>({ outputDim, inputDim }, -0.5, 0.5, 3, device));
+    auto recurrenceParam = Parameter(NDArrayView::RandomUniform<ElementType>({ outputDim, outputDim }, -0.5, 0.5, 4, device));
+    auto placeholder = PlaceholderVariable(NDShape({ outputDim }));
+    auto function = Tanh(Plus(Times(timesParam, input), Times(recurrenceParam, placeholder)));
+    function = function->ReplacePlaceholders({ { placeholder, PastValue(function) } });
+
+    // Sequences of different lengths are padded within a batch; each result must only hold its own sequence.
+    auto requests = GenerateSequences<ElementType>({ 3, 1, 5, 2, 4, 1, 6 }, { inputDim });
+    VerifyBatchedResultsMatchPerRequestEvaluation<ElementType>(function, input, requests, 3, device);
+}
+
+void TestBatchingEvaluatorRequiresTrailingBatchAxis()
+{
+    auto input = InputVariable({ 2 }, DataType::Float, L"features");
+    auto reduced = ReduceSum(Plus(input, Constant::Scalar(1.0f)), Axis::AllAxes());
+    VerifyException([&reduced]() { CreateBatchingEvaluator(reduced, {}, 4, 1000, DeviceDescriptor::CPUDevice()); },
+                    "Was able to create a batching evaluator for an output without a batch axis.");
+
+    auto staticInput = InputVariable({ 2 }, DataType::Float, L"static", {});
+    VerifyException([&staticInput]() { CreateBatchingEvaluator(Plus(staticInput, Constant::Scalar(1.0f)), {}, 4, 1000, DeviceDescriptor::CPUDevice()); },
+                    "Was able to create a batching evaluator for an argument without a batch axis.");
+
+    auto batchInput = InputVariable({ 2 }, DataType::Float, L"x", { Axis::DefaultBatchAxis() });
+    auto evaluator = CreateBatchingEvaluator(Plus(batchInput, Constant::Scalar(1.0f)), {}, 4, 1000, DeviceDescriptor::CPUDevice());
+    const std::vector<float> twoSamplesData(4, 0.0f);
+    auto twoSamples = MakeSharedObject<NDArrayView>(NDShape({ 2, 2 }), twoSamplesData);
+    VerifyException([&]() { evaluator->EvaluateAsync({ { batchInput, twoSamples } }); },
+                    "Was able to submit more than one sample for an argument without a sequence axis.");
+}
+
+BOOST_AUTO_TEST_SUITE(BatchingEvaluatorSuite)
+
+BOOST_AUTO_TEST_CASE(BatchingEvaluatorFeedForwardInCPU)
+{
+    if (ShouldRunOnCpu())
+    {
+        TestBatchingEvaluatorFeedForward<float>(DeviceDescriptor::CPUDevice());
+        TestBatchingEvaluatorFeedForward<double>(DeviceDescriptor::CPUDevice());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(BatchingEvaluatorFeedForwardInGPU)
+{
+    if (ShouldRunOnGpu())
+        TestBatchingEvaluatorFeedForward<float>(DeviceDescriptor::GPUDevice(0));
+}
+
+BOOST_AUTO_TEST_CASE(BatchingEvaluatorSequencesInCPU)
+{
+    if (ShouldRunOnCpu())
+        TestBatchingEvaluatorSequences<float>(DeviceDescriptor::CPUDevice());
+}
+
+BOOST_AUTO_TEST_CASE(BatchingEvaluatorSequencesInGPU)
+{
+    if (ShouldRunOnGpu())
+        TestBatchingEvaluatorSequences<double>(DeviceDescriptor::GPUDevice(0));
+}
+
+BOOST_AUTO_TEST_CASE(BatchingEvaluatorRequiresTrailingBatchAxis)
+{
+    TestBatchingEvaluatorRequiresTrailingBatchAxis();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}}
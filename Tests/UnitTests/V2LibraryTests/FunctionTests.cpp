@@ -5,6 +5,7 @@
 #include "stdafx.h"
 #include "CNTKLibrary.h"
 #include "Common.h"
+#include <thread>
 
 using namespace CNTK;
 
@@ -1001,6 +1002,118 @@ void TestFindName(const DeviceDescriptor& device)
     CheckFindAllWithNameResult(minusFunc4->FindAllWithName(aliasFuncName, true), aliasFuncName, 1);
 }
 
+void TestConcurrentEvaluationOfSharedParameterClones(const DeviceDescriptor& device)
+{
+    const size_t inputDim = 10;
+    const size_t numOutputClasses = 5;
+    const size_t hiddenLayerDim = 20;
+    const size_t numSamples = 4;
+    const size_t numClones = 4;
+
+    auto inputVar = InputVariable({ inputDim }, DataType::Float, L"features");
+    auto classifier = FullyConnectedFeedForwardClassifierNet(inputVar, numOutputClasses, hiddenLayerDim, 2, device, std::bind(Sigmoid, std::placeholders::_1, L""), L"classifierOutput");
+
+    std::vector<float> inputData(inputDim * numSamples);
+    for (size_t i = 0; i < inputData.size(); ++i)
+        inputData[i] = (float)((i * 7) % 11) / 11;
+    auto inputValue = Value::CreateBatch(NDShape({ inputDim }), inputData, device, /*readOnly =*/ true);
+
+    auto evaluate = [&](const FunctionPtr& function)
+    {
+        std::unordered_map<Variable, ValuePtr> outputs = { { function->Output(), nullptr } };
+        function->Evaluate({ { function->Arguments()[0], inputValue } }, outputs, device);
+        std::vector<std::vector<float>> result;
+        outputs[function->Output()]->CopyVariableValueTo(function->Output(), result);
+        return result;
+    };
+
+    auto expected = evaluate(classifier);
+
+    // The first clone to be evaluated compiles the network that the other clones derive theirs from
+    std::vector<FunctionPtr> clones;
+    for (size_t i = 0; i < numClones; ++i)
+        clones.push_back(classifier->Clone(ParameterCloningMethod::Share));
+
+    std::vector<std::vector<std::vector<float>>> results(numClones);
+    results[0] = evaluate(clones[0]);
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < numClones; ++i)
+        threads.emplace_back([&, i]() { results[i] = evaluate(clones[i]); });
+    for (auto& thread : threads)
+        thread.join();
+
+    for (const auto& result : results)
+    {
+        BOOST_REQUIRE(result.size() == expected.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+            FloatingPointVectorCompare(result[i], expected[i], "The output of a clone with shared parameters does not match the output of the original.");
+    }
+
+    // The clones see the updates of the shared parameters
+    for (auto& parameter : classifier->Parameters())
+        parameter.SetValue(MakeSharedObject<NDArrayView>(0.5f, parameter.Shape(), device));
+
+    expected = evaluate(classifier);
+    for (const auto& clone : clones)
+    {
+        auto result = evaluate(clone);
+        for (size_t i = 0; i < expected.size(); ++i)
+            FloatingPointVectorCompare(result[i], expected[i], "The output of a clone with shared parameters does not reflect updated parameter values.");
+    }
+}
+
+void TestEvaluateIntoSpecifiedOutputValue(const DeviceDescriptor& device)
+{
+    const size_t inputDim = 3;
+    const size_t outputDim = 2;
+
+    auto inputVar = InputVariable({ inputDim }, DataType::Float, L"features");
+    auto timesParam = Parameter(MakeSharedObject<NDArrayView>(0.5f, NDShape({ outputDim, inputDim }), device));
+    auto function = Plus(Times(timesParam, inputVar), Constant::Scalar(1.0f, device));
+    auto output = function->Output();
+
+    auto evaluate = [&](const std::vector<std::vector<float>>& sequences, const ValuePtr& outputValue) {
+        auto inputValue = Value::Create(NDShape({ inputDim }), sequences, device, /*readOnly =*/ true);
+        std::unordered_map<Variable, ValuePtr> outputs = { { output, outputValue } };
+        function->Evaluate({ { inputVar, inputValue } }, outputs, device);
+        if (outputValue && (outputs[output] != outputValue))
+            ReportFailure("Evaluate replaced the specified output Value object");
+
+        std::vector<std::vector<float>> result;
+        outputs[output]->CopyVariableValueTo(output, result);
+        return result;
+    };
+
+    // Sequences of different lengths are unpacked into the specified Value, and a single sequence is copied into it
+    std::vector<std::vector<std::vector<float>>> batches = {
+        { { 1, 2, 3, 4, 5, 6, 7, 8, 9 }, { 9, 8, 7 }, { 1, 1, 1, 2, 2, 2 } },
+        { { 3, 2, 1, 6, 5, 4 } }
+    };
+
+    for (const auto& sequences : batches)
+    {
+        size_t maxSequenceLength = 0;
+        for (const auto& sequence : sequences)
+            maxSequenceLength = std::max(maxSequenceLength, sequence.size() / inputDim);
+
+        NDShape maskShape({ maxSequenceLength, sequences.size() });
+        auto outputData = MakeSharedObject<NDArrayView>(DataType::Float, NDShape({ outputDim }).AppendShape(maskShape), device);
+        auto outputValue = MakeSharedObject<Value>(outputData, MakeSharedObject<NDMask>(maskShape, DeviceDescriptor::CPUDevice()));
+
+        auto expected = evaluate(sequences, nullptr);
+        for (size_t repeat = 0; repeat < 2; ++repeat)
+        {
+            auto result = evaluate(sequences, outputValue);
+            if (outputValue->Data() != outputData)
+                ReportFailure("Evaluate replaced the storage of the specified output Value object");
+
+            BOOST_REQUIRE(result.size() == expected.size());
+            for (size_t i = 0; i < expected.size(); ++i)
+                FloatingPointVectorCompare(result[i], expected[i], "The output written into the specified Value object does not match the output returned by Evaluate.");
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE(FunctionSuite)
 
 BOOST_AUTO_TEST_CASE(FindNameInCPU)
@@ -1078,6 +1191,30 @@ BOOST_AUTO_TEST_CASE(RecurrentFunctionCloning)
         TestRecurrentFunctionCloning();
 }
 
+BOOST_AUTO_TEST_CASE(ConcurrentEvaluationOfSharedParameterClonesInCPU)
+{
+    if (ShouldRunOnCpu())
+        TestConcurrentEvaluationOfSharedParameterClones(DeviceDescriptor::CPUDevice());
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentEvaluationOfSharedParameterClonesInGPU)
+{
+    if (ShouldRunOnGpu())
+        TestConcurrentEvaluationOfSharedParameterClones(DeviceDescriptor::GPUDevice(0));
+}
+
+BOOST_AUTO_TEST_CASE(EvaluateIntoSpecifiedOutputValueInCPU)
+{
+    if (ShouldRunOnCpu())
+        TestEvaluateIntoSpecifiedOutputValue(DeviceDescriptor::CPUDevice());
+}
+
+BOOST_AUTO_TEST_CASE(EvaluateIntoSpecifiedOutputValueInGPU)
+{
+    if (ShouldRunOnGpu())
+        TestEvaluateIntoSpecifiedOutputValue(DeviceDescriptor::GPUDevice(0));
+}
+
 BOOST_AUTO_TEST_CASE(TransposeInCPU)
 {
     if (ShouldRunOnCpu())
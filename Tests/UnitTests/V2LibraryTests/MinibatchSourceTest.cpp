@@ -5,6 +5,7 @@
 #include "stdafx.h"
 #include "CNTKLibrary.h"
 #include "Common.h"
+#include <fstream>
 
 using namespace CNTK;
 
@@ -271,6 +272,173 @@ void TestMaxSweeps(size_t maxSweeps, size_t mbSize, bool randomize)
 }
 
 
+void TestWeightedMinibatchSource(size_t mbSize)
+{
+    const size_t sweepSize = 603;
+    auto ctfInput = L"SimpleDataTest_cntk_text.txt";
+    std::vector<StreamConfiguration> streamConfig{ { L"features", 2 } };
+    auto cpuDevice = DeviceDescriptor::CPUDevice();
+
+    MinibatchSourceConfig config({ CTFDeserializer(ctfInput, streamConfig) }, /*randomize =*/ false);
+    config.maxSweeps = 1;
+    auto firstSource = CreateCompositeMinibatchSource(config);
+    auto secondSource = CreateCompositeMinibatchSource(config);
+    auto src = CreateWeightedMinibatchSource({ firstSource, secondSource }, { 3, 1 });
+
+    // The sources serve the requested samples in proportion to their weights.
+    for (size_t i = 0; i < 20; i++)
+    {
+        const auto& dataMap = src->GetNextMinibatch(mbSize, cpuDevice);
+        if (dataMap.at(src->StreamInfo(L"features")).numberOfSamples != mbSize)
+            ReportFailure("TestWeightedMinibatchSource failed: unexpected number of samples in the minibatch.");
+    }
+    if (src->NumSamplesRead()[0] != 15 * mbSize || src->NumSamplesRead()[1] != 5 * mbSize)
+        ReportFailure("TestWeightedMinibatchSource failed: the sources served %zu and %zu samples instead of %zu and %zu.",
+                      src->NumSamplesRead()[0], src->NumSamplesRead()[1], 15 * mbSize, 5 * mbSize);
+
+    // New weights apply from the next minibatch on.
+    src->SetWeights({ 0, 1 });
+    src->GetNextMinibatch(mbSize, cpuDevice);
+    if (src->NumSamplesRead()[0] != 15 * mbSize || src->NumSamplesRead()[1] != 6 * mbSize)
+        ReportFailure("TestWeightedMinibatchSource failed: the new weights were not applied.");
+
+    // An exhausted source drops out, and the remaining one serves the rest of its data.
+    src->SetWeights({ 1, 1 });
+    size_t sampleCount = 21 * mbSize;
+    for (;;)
+    {
+        const auto& dataMap = src->GetNextMinibatch(mbSize, cpuDevice);
+        if (dataMap.empty())
+            break;
+        sampleCount += dataMap.at(src->StreamInfo(L"features")).numberOfSamples;
+    }
+
+    BOOST_TEST(sampleCount == 2 * sweepSize);
+    BOOST_TEST(src->NumSamplesRead()[0] == sweepSize);
+    BOOST_TEST(src->NumSamplesRead()[1] == sweepSize);
+
+    // The reader wait time of the weighted source is that of its sources together.
+    BOOST_TEST(firstSource->ReaderWaitSeconds() >= 0);
+    BOOST_TEST(src->ReaderWaitSeconds() == firstSource->ReaderWaitSeconds() + secondSource->ReaderWaitSeconds());
+}
+void TestPrefetchDepth(size_t prefetchDepth, size_t mbSize)
+{
+    auto ctfInput = L"SimpleDataTest_cntk_text.txt";
+    std::vector<StreamConfiguration> streamConfig{ { L"features", 2 } };
+    auto cpuDevice = DeviceDescriptor::CPUDevice();
+
+    MinibatchSourceConfig config({ CTFDeserializer(ctfInput, streamConfig) }, /*randomize =*/ false);
+    config.maxSweeps = 2;
+    auto referenceSource = CreateCompositeMinibatchSource(config);
+    config.prefetchDepth = prefetchDepth;
+    auto src = CreateCompositeMinibatchSource(config);
+
+    // Reading ahead must not change the data, the end of sweep flags or the positions in the checkpoints.
+    for (;;)
+    {
+        const auto& referenceDataMap = referenceSource->GetNextMinibatch(mbSize, cpuDevice);
+        const auto& dataMap = src->GetNextMinibatch(mbSize, cpuDevice);
+        if (referenceDataMap.empty() || dataMap.empty())
+        {
+            if (referenceDataMap.empty() != dataMap.empty())
+                ReportFailure("TestPrefetchDepth failed: the data ended after a different number of minibatches.");
+            break;
+        }
+
+        const auto& referenceData = referenceDataMap.at(referenceSource->StreamInfo(L"features"));
+        const auto& data = dataMap.at(src->StreamInfo(L"features"));
+        if (data.numberOfSamples != referenceData.numberOfSamples || data.sweepEnd != referenceData.sweepEnd)
+            ReportFailure("TestPrefetchDepth failed: the minibatch has %zu samples instead of %zu.", data.numberOfSamples, referenceData.numberOfSamples);
+
+        auto referenceValue = referenceData.data->Data()->DeepClone(cpuDevice);
+        auto value = data.data->Data()->DeepClone(cpuDevice);
+        std::vector<float> expected(referenceValue->DataBuffer<float>(), referenceValue->DataBuffer<float>() + referenceValue->Shape().TotalSize());
+        std::vector<float> actual(value->DataBuffer<float>(), value->DataBuffer<float>() + value->Shape().TotalSize());
+        FloatingPointVectorCompare(actual, expected, "TestPrefetchDepth failed: the minibatch data differs.");
+
+        if (src->GetCheckpointState()[L"minibatchSourcePosition"].Value<size_t>() != referenceSource->GetCheckpointState()[L"minibatchSourcePosition"].Value<size_t>())
+            ReportFailure("TestPrefetchDepth failed: the checkpointed position differs.");
+    }
+}
+
+// Writes the samples [begin, end) of a fixed data set into a CTF file; the dimensions differ in mean and spread.
+std::wstring WriteStatisticsTestData(const std::wstring& fileName, size_t begin, size_t end, size_t dim)
+{
+    std::ofstream stream(std::string(fileName.begin(), fileName.end()));
+    for (size_t i = begin; i < end; i++)
+    {
+        stream << "|features";
+        for (size_t j = 0; j < dim; j++)
+            stream << " " << (double)((i * 7 + j * 13) % 23) * (j + 1) + ((i < 40) ? 0 : 10.0 * j);
+        stream << "\n";
+    }
+    return fileName;
+}
+
+std::pair<NDArrayViewPtr, NDArrayViewPtr> ComputeStatistics(const std::wstring& fileName, size_t dim, size_t maxNumSamples = MinibatchSource::InfinitelyRepeat)
+{
+    MinibatchSourceConfig config({ CTFDeserializer(fileName, { { L"features", dim } }) }, /*randomize =*/ false);
+    config.maxSweeps = 1;
+    auto src = CreateCompositeMinibatchSource(config);
+
+    std::unordered_map<StreamInformation, std::pair<NDArrayViewPtr, NDArrayViewPtr>> meanAndInvStdDevs = { { src->StreamInfo(L"features"), { nullptr, nullptr } } };
+    ComputeInputPerDimMeansAndInvStdDevs(src, meanAndInvStdDevs, maxNumSamples);
+    return meanAndInvStdDevs.begin()->second;
+}
+
+void CompareStatistics(const std::pair<NDArrayViewPtr, NDArrayViewPtr>& actual, const std::pair<NDArrayViewPtr, NDArrayViewPtr>& expected, const char* message)
+{
+    auto toVector = [](const NDArrayViewPtr& view) {
+        auto cpuView = view->DeepClone(DeviceDescriptor::CPUDevice());
+        return std::vector<float>(cpuView->DataBuffer<float>(), cpuView->DataBuffer<float>() + cpuView->Shape().TotalSize());
+    };
+
+    FloatingPointVectorCompare(toVector(actual.first), toVector(expected.first), message);
+    FloatingPointVectorCompare(toVector(actual.second), toVector(expected.second), message);
+}
+
+// The merge of the statistics of partitions of the data, as done across workers, must match a single pass over all of it.
+// Includes a partition of a single sample (zero variance) and an empty one.
+void TestMergeOfInputStatistics()
+{
+    const size_t dim = 3;
+    const std::vector<size_t> partitionEnds = { 1, 1, 18, 61, 100 };
+    auto expected = ComputeStatistics(WriteStatisticsTestData(L"InputStatistics_cntk_text.txt", 0, partitionEnds.back(), dim), dim);
+
+    std::vector<std::pair<NDArrayViewPtr, NDArrayViewPtr>> partitionStatistics;
+    std::vector<size_t> numSamples;
+    for (size_t k = 0, begin = 0; k < partitionEnds.size(); begin = partitionEnds[k++])
+    {
+        numSamples.push_back(partitionEnds[k] - begin);
+        if (numSamples.back() == 0)
+        {
+            partitionStatistics.push_back({ MakeSharedObject<NDArrayView>(0.0f, NDShape({ dim }), DeviceDescriptor::CPUDevice()),
+                                            MakeSharedObject<NDArrayView>(1.0f, NDShape({ dim }), DeviceDescriptor::CPUDevice()) });
+            continue;
+        }
+
+        auto fileName = L"InputStatistics" + std::to_wstring(k) + L"_cntk_text.txt";
+        partitionStatistics.push_back(ComputeStatistics(WriteStatisticsTestData(fileName, begin, partitionEnds[k], dim), dim));
+    }
+
+    CompareStatistics(Internal::MergeMeansAndInvStdDevs(partitionStatistics, numSamples), expected,
+                      "TestMergeOfInputStatistics failed: the merged statistics differ from a single pass over the data.");
+
+    VerifyException([]() { Internal::MergeMeansAndInvStdDevs({}, {}); }, "Was able to merge the statistics of no partitions.");
+}
+
+// With maxNumSamples, the statistics are those of the first maxNumSamples samples.
+void TestInputStatisticsWithMaxNumSamples()
+{
+    const size_t dim = 3;
+    auto fileName = WriteStatisticsTestData(L"InputStatistics_cntk_text.txt", 0, 100, dim);
+    for (size_t maxNumSamples : { 1, 37, 100 })
+    {
+        auto expected = ComputeStatistics(WriteStatisticsTestData(L"InputStatisticsPrefix_cntk_text.txt", 0, maxNumSamples, dim), dim);
+        CompareStatistics(ComputeStatistics(fileName, dim, maxNumSamples), expected,
+                          "TestInputStatisticsWithMaxNumSamples failed: the statistics differ from those of the first maxNumSamples samples.");
+    }
+}
 
 BOOST_AUTO_TEST_SUITE(MinibatchSourceSuite)
 
@@ -302,6 +470,29 @@ BOOST_AUTO_TEST_CASE(TestSettingMaximumNumberOfSweepsToRead)
     }
 }
 
+BOOST_AUTO_TEST_CASE(WeightedMinibatchSourceInterleavesSources)
+{
+    TestWeightedMinibatchSource(10);
+    TestWeightedMinibatchSource(30);
+}
+
+BOOST_AUTO_TEST_CASE(PrefetchingSeveralMinibatchesAhead)
+{
+    TestPrefetchDepth(2, 100);
+    TestPrefetchDepth(4, 30);
+    TestPrefetchDepth(4, 1000);
+}
+
+BOOST_AUTO_TEST_CASE(MergedInputStatisticsMatchSinglePass)
+{
+    TestMergeOfInputStatistics();
+}
+
+BOOST_AUTO_TEST_CASE(InputStatisticsOfFirstSamples)
+{
+    TestInputStatisticsWithMaxNumSamples();
+}
+
 BOOST_AUTO_TEST_CASE(NoRandomizedMinibatchSourceWarmStart)
 {
     TestMinibatchSourceWarmStart(64, 128, false, 1024);
@@ -376,6 +376,51 @@ void TestSimpleRecurrence(size_t inputDim,
     }
 }
 
+// Recurrent loops skip time steps at which only a single parallel sequence is active and compute just that sequence
+// (gap compaction). Evaluating several sequences of different lengths together must therefore give exactly the same
+// result as evaluating each sequence on its own, including state that is carried over from the previous minibatch
+// (truncated BPTT), which is read at t < offset.
+template <typename ElementType>
+void TestCompactedRecurrenceMatchesPerSequenceEvaluation(const DeviceDescriptor& device)
+{
+    const size_t inputDim = 3;
+    const size_t outputDim = 4;
+    const size_t offset = 2;
+
+    auto inputVar = InputVariable({ inputDim }, AsDataType<ElementType>(), L"input");
+    auto timesParam = Parameter(NDArrayView::RandomUniform<ElementType>({ outputDim, inputDim }, -0.5, 0.5, seed++, device));
+    auto recurrenceParam = Parameter(NDArrayView::RandomUniform<ElementType>({ outputDim, outputDim }, -0.5, 0.5, seed++, device));
+
+    auto placeholder = PlaceholderVariable(NDShape({ outputDim }));
+    auto output = Tanh(Plus(Times(timesParam, inputVar), Times(recurrenceParam, placeholder)), L"output");
+    output = output->ReplacePlaceholders({ { placeholder, PastValue(output, offset) } });
+
+    auto evaluate = [&](const std::vector<std::vector<ElementType>>& sequences, const std::vector<bool>& sequenceStartFlags) {
+        auto inputValue = Value::Create(NDShape({ inputDim }), sequences, sequenceStartFlags, device, true);
+        std::unordered_map<Variable, ValuePtr> outputs = { { output->Output(), nullptr } };
+        output->Forward({ { inputVar, inputValue } }, outputs, device);
+        std::vector<std::vector<ElementType>> result;
+        outputs[output->Output()]->CopyVariableValueTo(output->Output(), result);
+        return result;
+    };
+
+    // Two minibatches of a truncated-BPTT stream: in the second one both sequences continue from the first, and the
+    // longer one is alone from t = 1 on, so the carry-over at t = 1 is read for a single compacted sequence.
+    auto firstSequences = GenerateSequences<ElementType>({ 5, 2 }, { inputDim });
+    auto secondSequences = GenerateSequences<ElementType>({ 6, 1 }, { inputDim });
+
+    auto batchedFirst = evaluate(firstSequences, { true, true });
+    auto batchedSecond = evaluate(secondSequences, { false, false });
+
+    for (size_t i = 0; i < firstSequences.size(); ++i)
+    {
+        auto first = evaluate({ firstSequences[i] }, { true });
+        auto second = evaluate({ secondSequences[i] }, { false });
+        FloatingPointVectorCompare(batchedFirst[i], first[0], "Compacted recurrence does not match per-sequence evaluation");
+        FloatingPointVectorCompare(batchedSecond[i], second[0], "Compacted recurrence does not match per-sequence evaluation with carried-over state");
+    }
+}
+
 BOOST_AUTO_TEST_SUITE(RecurrentFunctionSuite)
 
 BOOST_AUTO_TEST_CASE(SimpleRecurrenceInCPU)
@@ -407,6 +452,18 @@ BOOST_AUTO_TEST_CASE(SimpleLargeRecurrenceInGPU)
     }
 }
 
+BOOST_AUTO_TEST_CASE(CompactedRecurrenceInCPU)
+{
+    TestCompactedRecurrenceMatchesPerSequenceEvaluation<float>(DeviceDescriptor::CPUDevice());
+    TestCompactedRecurrenceMatchesPerSequenceEvaluation<double>(DeviceDescriptor::CPUDevice());
+}
+
+BOOST_AUTO_TEST_CASE(CompactedRecurrenceInGPU)
+{
+    if (ShouldRunOnGpu())
+        TestCompactedRecurrenceMatchesPerSequenceEvaluation<float>(DeviceDescriptor::GPUDevice(0));
+}
+
 BOOST_AUTO_TEST_CASE(RecurrentNetworkCreationInCPU)
 {
     if (ShouldRunOnCpu())
@@ -7,7 +7,10 @@
 #include <boost/random/uniform_real_distribution.hpp>
 #include "CNTKLibrary.h"
 #include "PrimitiveOpType.h"
+#include "CheckpointSharding.h"
 #include "Common.h"
+#include <fstream>
+#include <set>
 #include <string>
 #include <random>
 #include <vector>
@@ -940,6 +943,153 @@ void TestLoadingModelFromMemoryBufferWithException()
     delete[] modelBuffer;
 }
 
+void TestStreamingModelFormat(const DeviceDescriptor& device)
+{
+    auto file = L"TestStreamingModelFormat.out";
+    auto inputVar = InputVariable({ 20 }, false, DataType::Float, L"features");
+    auto function = BuildFFClassifierNet(inputVar, 10, device);
+    function->Save(file, ModelFormat::CNTKv2Streaming);
+
+    auto reloadedFunction = Function::Load(file, device);
+    if (!AreEqual(function, reloadedFunction))
+        BOOST_ERROR("TestStreamingModelFormat: original and reloaded functions are not identical.");
+
+    ifstream modelFileStream("TestStreamingModelFormat.out", ifstream::binary);
+    std::vector<char> modelBuffer((std::istreambuf_iterator<char>(modelFileStream)), std::istreambuf_iterator<char>());
+    auto functionFromBuffer = Function::Load(modelBuffer.data(), modelBuffer.size(), device);
+    if (!AreEqual(function, functionFromBuffer))
+        BOOST_ERROR("TestStreamingModelFormat: original function and function loaded from memory buffer are not identical.");
+
+    // A model in the streaming format is only readable as a whole; a truncated file must not load.
+    modelBuffer.resize(modelBuffer.size() / 2);
+    VerifyException([&modelBuffer, &device]() {
+        Function::Load(modelBuffer.data(), modelBuffer.size(), device);
+    }, "Was able to load a truncated model in the streaming format.");
+}
+
+void TestStreamingFloat16ModelFormat(const DeviceDescriptor& device)
+{
+    auto file = L"TestStreamingFloat16ModelFormat.out";
+    auto inputVar = InputVariable({ 20 }, false, DataType::Float, L"features");
+    auto function = BuildFFClassifierNet(inputVar, 10, device);
+    function->Save(file, ModelFormat::CNTKv2StreamingFloat16);
+
+    // Half precision keeps 11 significant bits, so a parameter changes by at most 2^-11 of its magnitude.
+    auto reloadedFunction = Function::Load(file, device);
+    auto parameters = function->Parameters();
+    auto reloadedParameters = reloadedFunction->Parameters();
+    if (parameters.size() != reloadedParameters.size())
+        ReportFailure("TestStreamingFloat16ModelFormat: the reloaded function has %d parameters instead of %d.", (int)reloadedParameters.size(), (int)parameters.size());
+
+    for (size_t i = 0; i < parameters.size(); ++i)
+    {
+        if (parameters[i].Shape() != reloadedParameters[i].Shape())
+            ReportFailure("TestStreamingFloat16ModelFormat: the shape of parameter %d changed.", (int)i);
+
+        auto value = parameters[i].Value()->DeepClone(DeviceDescriptor::CPUDevice());
+        auto reloadedValue = reloadedParameters[i].Value()->DeepClone(DeviceDescriptor::CPUDevice());
+        const float* expected = value->DataBuffer<float>();
+        const float* actual = reloadedValue->DataBuffer<float>();
+        for (size_t j = 0; j < value->Shape().TotalSize(); ++j)
+        {
+            if (std::abs(actual[j] - expected[j]) > std::abs(expected[j]) / 2048 + 1e-7f)
+                ReportFailure("TestStreamingFloat16ModelFormat: parameter %d, element %d; Expected=%g, Actual=%g", (int)i, (int)j, expected[j], actual[j]);
+        }
+    }
+
+    // The values are stored in half of the space.
+    ifstream float16FileStream("TestStreamingFloat16ModelFormat.out", ifstream::binary | ifstream::ate);
+    auto float16FileSize = (size_t)float16FileStream.tellg();
+    function->Save(L"TestStreamingFloat16ModelFormatReference.out", ModelFormat::CNTKv2Streaming);
+    ifstream referenceFileStream("TestStreamingFloat16ModelFormatReference.out", ifstream::binary | ifstream::ate);
+    auto referenceFileSize = (size_t)referenceFileStream.tellg();
+    if (float16FileSize * 3 > referenceFileSize * 2)
+        ReportFailure("TestStreamingFloat16ModelFormat: the file (%d bytes) is not much smaller than in the CNTKv2Streaming format (%d bytes).", (int)float16FileSize, (int)referenceFileSize);
+}
+
+// Writes the files of a sharded checkpoint like the workers of distributed training: one shard file per worker other than
+// the main worker, which writes the model and trainer state files. The workers in 'failedWorkers' write nothing, which
+// leaves their shard files of an earlier checkpoint in place. Returns the number of NDArrayViews stored in shard files.
+size_t SaveShardedCheckpoint(const std::wstring& modelFile, const Dictionary& model, const Dictionary& state, size_t numShards, size_t checkpoint,
+                             const std::set<size_t>& failedWorkers = {})
+{
+    CheckpointSharding sharding(modelFile, numShards, checkpoint);
+    sharding.Add(L"model", model);
+    sharding.Add(L"state/learners", state[L"learners"].Value<std::vector<DictionaryValue>>());
+    sharding.Partition();
+
+    for (size_t shard = 1; shard < numShards; ++shard)
+    {
+        if (failedWorkers.count(shard) != 0)
+            continue;
+        auto shardFile = sharding.ShardFilePath(shard);
+        std::ofstream shardStream(std::string(shardFile.begin(), shardFile.end()), std::ios::binary);
+        SaveShard(sharding, shard, shardStream);
+    }
+
+    std::ofstream modelStream(std::string(modelFile.begin(), modelFile.end()), std::ios::binary);
+    SaveInStreamingFormat(model, modelStream, L"model", sharding);
+    std::ofstream stateStream(std::string(modelFile.begin(), modelFile.end()) + ".ckp", std::ios::binary);
+    SaveInStreamingFormat(state, stateStream, L"state", sharding);
+
+    size_t numShardedViews = 0;
+    for (const auto& view : sharding.Views())
+        numShardedViews += (sharding.ShardOf(view.first) != 0) ? 1 : 0;
+    return numShardedViews;
+}
+
+void VerifyShardedCheckpoint(const std::wstring& modelFile, const FunctionPtr& function, const Dictionary& state, const DeviceDescriptor& device)
+{
+    auto reloadedFunction = Function::Load(modelFile, device);
+    if (!AreEqual(function, reloadedFunction))
+        ReportFailure("TestShardedCheckpoint: original and reloaded functions are not identical.");
+
+    auto learners = state[L"learners"].Value<std::vector<DictionaryValue>>();
+    auto reloadedLearners = Dictionary::Load(modelFile + L".ckp")[L"learners"].Value<std::vector<DictionaryValue>>();
+    if (learners.size() != reloadedLearners.size())
+        ReportFailure("TestShardedCheckpoint: the reloaded learner state has %d values instead of %d.", (int)reloadedLearners.size(), (int)learners.size());
+    for (size_t i = 0; i < learners.size(); ++i)
+    {
+        if (!Internal::AreEqual(learners[i].Value<NDArrayView>(), reloadedLearners[i].Value<NDArrayView>()))
+            ReportFailure("TestShardedCheckpoint: learner state value %d is not identical after reloading.", (int)i);
+    }
+}
+
+void TestShardedCheckpoint(const DeviceDescriptor& device)
+{
+    const std::wstring modelFile = L"TestShardedCheckpoint.model";
+    auto inputVar = InputVariable({ 200 }, false, DataType::Float, L"features");
+    auto function = BuildFFClassifierNet(inputVar, 10, device);
+
+    // one value per parameter, like the smoothed gradients of a learner
+    std::vector<DictionaryValue> learners;
+    for (const auto& parameter : function->Parameters())
+        learners.push_back(*NDArrayView::RandomUniform<float>(parameter.Shape(), -1.0, 1.0, (unsigned long)learners.size(), DeviceDescriptor::CPUDevice()));
+    Dictionary state;
+    state[L"learners"] = learners;
+
+    // written by 3 workers
+    if (SaveShardedCheckpoint(modelFile, function->Serialize(), state, 3, /*checkpoint =*/ 100) == 0)
+        ReportFailure("TestShardedCheckpoint: no value was stored in a shard file.");
+    VerifyShardedCheckpoint(modelFile, function, state, device);
+
+    // restored by 2 workers, which write the next checkpoint in 2 shards; the third shard file of the previous one is ignored
+    auto restoredFunction = Function::Load(modelFile, device);
+    auto restoredState = Dictionary::Load(modelFile + L".ckp");
+    if (SaveShardedCheckpoint(modelFile, restoredFunction->Serialize(), restoredState, 2, /*checkpoint =*/ 200) == 0)
+        ReportFailure("TestShardedCheckpoint: no value was stored in a shard file.");
+    VerifyShardedCheckpoint(modelFile, function, state, device);
+
+    // a worker that fails to write its shard leaves the one of the previous checkpoint behind, which must not be mixed in
+    SaveShardedCheckpoint(modelFile, restoredFunction->Serialize(), restoredState, 2, /*checkpoint =*/ 300, /*failedWorkers =*/ { 1 });
+    VerifyException([&modelFile, &device]() {
+        Function::Load(modelFile, device);
+    }, "Was able to load a model that refers to a shard file of an earlier checkpoint.");
+    VerifyException([&modelFile]() {
+        Dictionary::Load(modelFile + L".ckp");
+    }, "Was able to load a trainer state that refers to a shard file of an earlier checkpoint.");
+}
+
 BOOST_AUTO_TEST_SUITE(SerializationSuite)
 
 BOOST_AUTO_TEST_CASE(LoadingModelFromMemoryBuffer)
@@ -1002,6 +1152,21 @@ BOOST_AUTO_TEST_CASE(FunctionSerializationInCPU)
     TestFunctionSerialization(DeviceDescriptor::CPUDevice());
 }
 
+BOOST_AUTO_TEST_CASE(StreamingModelFormatInCPU)
+{
+    TestStreamingModelFormat(DeviceDescriptor::CPUDevice());
+}
+
+BOOST_AUTO_TEST_CASE(StreamingFloat16ModelFormatInCPU)
+{
+    TestStreamingFloat16ModelFormat(DeviceDescriptor::CPUDevice());
+}
+
+BOOST_AUTO_TEST_CASE(ShardedCheckpointInCPU)
+{
+    TestShardedCheckpoint(DeviceDescriptor::CPUDevice());
+}
+
 BOOST_AUTO_TEST_CASE(ModelSerializationDuringTrainingInCPU)
 {
     TestModelSerializationDuringTraining(DeviceDescriptor::CPUDevice());
@@ -263,6 +263,10 @@ SWIG_STD_VECTOR_ENHANCED(CNTK::DeviceDescriptor)
 %ignore_function CNTK::CreateTrainer;
 %ignore_class CNTK::Evaluator;
 %ignore_function CNTK::CreateEvaluator;
+%ignore_class CNTK::BatchingEvaluator;
+%ignore_function CNTK::CreateBatchingEvaluator;
+%ignore_struct CNTK::BatchingEvaluatorStatistics;
+%ignore_struct CNTK::LatencyHistogram;
 %ignore_struct CNTK::StreamInformation;
 %ignore_struct std::hash<::CNTK::StreamInformation>;
 
@@ -646,6 +646,8 @@ public:
 %ignore CNTK::ProgressWriter::WriteTrainingSummary;
 %ignore CNTK::ProgressWriter::WriteTestSummary;
 
+%ignore CNTK::BatchingEvaluator::EvaluateAsync;
+
 %feature("director") CNTK::SwigMinibatchSource;
 %feature("nodirector") CNTK::SwigMinibatchSource::StreamInfos();
 %feature("nodirector") CNTK::SwigMinibatchSource::GetNextMinibatch;//(size_t minibatchSizeInSamples, size_t minibatchSizeInSequences, size_t numberOfWorkers, size_t workerRank, const DeviceDescriptor&); 
@@ -11,6 +11,8 @@ def start_profiler(dir='profiler', sync_gpu=True, reserve_mem=cntk_py.default_pr
     Start profiler to prepare performance statistics gathering. Note that
     the profiler is not enabled after start
     (:cntkwiki:`example <BrainScript-and-Python-Performance-Profiler#for-python>`).
+    In distributed training, all workers must start the profiler, so that
+    their timelines (the ``*_trace_<rank>.json`` files) can be aligned.
 
     Args:
         dir: directory for profiler output
@@ -122,7 +122,7 @@ class MinibatchData(cntk_py.MinibatchData, ArrayMixin):
 
 class MinibatchSource(cntk_py.MinibatchSource):
     '''
-    MinibatchSource(deserializers, max_samples=cntk.io.INFINITELY_REPEAT, max_sweeps=cntk.io.INFINITELY_REPEAT, randomization_window_in_chunks=cntk.io.DEFAULT_RANDOMIZATION_WINDOW, randomization_window_in_samples=0, trace_level=cntk.logging.get_trace_level(), multithreaded_deserializer=False, frame_mode=False, truncation_length=0, randomize=None, randomization_window=None, sample_based_randomization_window=None, epoch_size=None)
+    MinibatchSource(deserializers, max_samples=cntk.io.INFINITELY_REPEAT, max_sweeps=cntk.io.INFINITELY_REPEAT, randomization_window_in_chunks=cntk.io.DEFAULT_RANDOMIZATION_WINDOW, randomization_window_in_samples=0, trace_level=cntk.logging.get_trace_level(), multithreaded_deserializer=False, frame_mode=False, truncation_length=0, randomize=None, randomization_window=None, sample_based_randomization_window=None, epoch_size=None, prefetch_depth=1)
 
     Args:
         deserializers (a single deserializer or a `list`): deserializers to be used in the composite reader
@@ -163,6 +163,9 @@ class MinibatchSource(cntk_py.MinibatchSource):
         sample_based_randomization_window (`bool`, defaults to `None`): !DEPRECATED! please use
           randomization_window_in_chunks or randomization_window_in_samples instead
         epoch_size (`int`, defaults to `None`): !DEPRECATED! please use max_samples or max_sweeps instead
+        prefetch_depth (`int`, defaults to `1`): the number of minibatches the reader reads ahead on its
+          background thread. Reading further ahead hides the variance of the reading time, at the cost of
+          one set of input buffers per minibatch on the compute device.
     '''
     def __init__(self,
         deserializers,
@@ -179,7 +182,9 @@ class MinibatchSource(cntk_py.MinibatchSource):
         randomization_window=None,
         sample_based_randomization_window=None,
         epoch_size=None,
-        distributed_after=None):
+        distributed_after=None,
+        # not deprecated; it comes last to keep the positions of the parameters above
+        prefetch_depth=1):
 
         if not isinstance(deserializers, (list,tuple)):
             deserializers = [ deserializers ]
@@ -192,6 +197,7 @@ class MinibatchSource(cntk_py.MinibatchSource):
         config.is_multithreaded = multithreaded_deserializer
         config.is_frame_mode_enabled = frame_mode
         config.truncation_length = truncation_length
+        config.prefetch_depth = prefetch_depth
 
         if isinstance(trace_level, TraceLevel):
             trace_level = trace_level.value
@@ -367,6 +373,15 @@ class MinibatchSource(cntk_py.MinibatchSource):
         '''
         super(MinibatchSource, self).restore_from_checkpoint(checkpoint)
 
+    @property
+    def reader_wait_seconds(self):
+        '''
+        The total time in seconds :meth:`next_minibatch` has spent waiting for data the reader
+        had not prefetched yet, i.e. the time the reader has not kept up with training.
+        If it grows, a larger ``prefetch_depth`` may help.
+        '''
+        return super(MinibatchSource, self).reader_wait_seconds()
+
     @property
     def is_distributed(self):
         '''
@@ -251,6 +251,27 @@ def test_minibatch_source_config_other_properties(tmpdir):
     assert 123 == dictionary['truncationLength']
 
 
+def test_minibatch_source_config_prefetch_depth(tmpdir):
+    ctf = create_ctf_deserializer(tmpdir)
+    config = MinibatchSourceConfig([ctf])
+
+    dictionary = to_dictionary(config)
+    assert 'prefetchDepth' not in dictionary.keys()
+
+    config.prefetch_depth = 3
+    dictionary = to_dictionary(config)
+    assert 3 == dictionary['prefetchDepth']
+
+
+def test_minibatch_source_reader_wait_seconds(tmpdir):
+    mb_source = MinibatchSource(create_ctf_deserializer(tmpdir), max_sweeps=1, prefetch_depth=2)
+    assert mb_source.reader_wait_seconds == 0
+
+    while mb_source.next_minibatch(1):
+        pass
+    assert mb_source.reader_wait_seconds >= 0
+
+
 def test_image():
     map_file = "input.txt"
     mean_file = "mean.txt"
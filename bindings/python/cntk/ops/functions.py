@@ -42,6 +42,36 @@ class CloneMethod(Enum):
     '''
 
 
+@unique
+class ModelFormat(Enum):
+    '''
+    Describes the file formats of :func:`~cntk.ops.functions.Function.save`.
+    :func:`~cntk.ops.functions.Function.load` detects the format of a model
+    file automatically.
+    '''
+
+    CNTKv2 = cntk_py.ModelFormat_CNTKv2
+    '''
+    A single protobuf message, limited to models of less than 2 GB
+    '''
+
+    CNTKv2Streaming = cntk_py.ModelFormat_CNTKv2Streaming
+    '''
+    The graph as a protobuf message and the parameter values as raw, aligned
+    payloads next to it. There is no limit on the model size, and loading
+    memory-maps the file instead of parsing the parameter values. Not readable
+    by versions of CNTK that predate it.
+    '''
+
+    CNTKv2StreamingFloat16 = cntk_py.ModelFormat_CNTKv2StreamingFloat16
+    '''
+    Like :attr:`CNTKv2Streaming`, but the single precision parameter values
+    are stored in half precision, which halves the file size. They are
+    converted back to single precision on load; the conversion is lossy
+    (about 3 significant decimal digits), so use it for inference only.
+    '''
+
+
 class Function(cntk_py.Function):
     '''
     Base class of all primitive tensor operators.
@@ -1058,7 +1088,7 @@ class Function(cntk_py.Function):
         return graph.find_by_name(self, name, depth)
 
     @typemap
-    def save(self, filename):
+    def save(self, filename, format=ModelFormat.CNTKv2):
         '''
         Save this function graph into a model file using protobuf-based
         serialization.
@@ -1068,8 +1098,11 @@ class Function(cntk_py.Function):
 
         Args:
             filename (str): model path
+            format (:class:`ModelFormat`, default ModelFormat.CNTKv2): the
+             file format; use ModelFormat.CNTKv2Streaming for models of 2 GB
+             or more
         '''
-        return super(Function, self).save(filename)
+        return super(Function, self).save(filename, ModelFormat(format).value)
 
     def save_model(self, filename): # legacy name
         warnings.warn('This will be removed in future versions. Please use '
@@ -31,6 +31,45 @@ def test_load_save_constant(tmpdir):
     loaded_result = loaded_node.eval()
     assert np.allclose(loaded_result, expected)
 
+def test_load_save_streaming_format(tmpdir):
+    from cntk.ops.functions import ModelFormat
+    from cntk.layers import Dense
+    from cntk.initializer import glorot_uniform
+
+    i1 = input(4, name='i1')
+    root_node = Dense(3, init=glorot_uniform(seed=1))(i1)
+    input1 = np.asarray([[1, -2, 3, -4]], dtype=np.float32)
+    expected = root_node.eval({i1: input1})
+
+    filename = str(tmpdir / 'dense.mod')
+    root_node.save(filename, format=ModelFormat.CNTKv2Streaming)
+
+    loaded_node = Function.load(filename)
+    assert np.allclose(loaded_node.eval([input1]), expected)
+
+    with open(filename, 'rb') as f:
+        loaded_node = Function.load(f.read())
+    assert np.allclose(loaded_node.eval([input1]), expected)
+
+    root_node.restore(filename)
+    assert np.allclose(root_node.eval({i1: input1}), expected)
+
+def test_load_save_streaming_float16_format(tmpdir):
+    from cntk.ops.functions import ModelFormat
+    from cntk.layers import Dense
+    from cntk.initializer import glorot_uniform
+
+    i1 = input(4, name='i1')
+    root_node = Dense(3, init=glorot_uniform(seed=1))(i1)
+    input1 = np.asarray([[1, -2, 3, -4]], dtype=np.float32)
+    expected = root_node.eval({i1: input1})
+
+    filename = str(tmpdir / 'dense.mod')
+    root_node.save(filename, format=ModelFormat.CNTKv2StreamingFloat16)
+
+    loaded_node = Function.load(filename)
+    assert np.allclose(loaded_node.eval([input1]), expected, rtol=1e-2, atol=1e-2)
+
 def test_load_save_input_legacy_names(tmpdir):
     i1 = input((1,2), name='i1')
     root_node = abs(i1)
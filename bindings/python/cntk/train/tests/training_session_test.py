@@ -5,8 +5,10 @@
 # ==============================================================================
 
 import os
+import sys
 import math
 import re
+import signal
 import numpy as np
 from os import listdir
 from shutil import copyfile
@@ -297,6 +299,86 @@ def test_session_restart_from_end_checkpoint(tmpdir, device_id):
     assert(writer.testing_summary_counter == 0)
 
 
+def test_session_async_checkpointing(tmpdir, device_id):
+    device = cntk_device(device_id)
+    writer = MockProgressWriter()
+    t, feature, label = create_sample_model(device, writer)
+    mbs = mb_source(tmpdir, "training", max_samples=INFINITELY_REPEAT)
+
+    input_map = {
+        feature: mbs.streams.features,
+        label: mbs.streams.labels
+    }
+
+    test_dir = str(tmpdir)
+
+    training_session(trainer=t, mb_source=mbs,
+        mb_size=4, model_inputs_to_streams=input_map,
+        max_samples=60, progress_frequency=20,
+        checkpoint_config = CheckpointConfig(frequency=20, preserve_all=True, async_checkpointing=True,
+                                             filename=str(tmpdir / "async_checkpoint"))
+    ).train(device)
+
+    # all checkpoints are on disk once the session is done, and none of the temporary files is left
+    candidates = [f for f in listdir(test_dir) if isfile(
+        join(test_dir, f)) and f.startswith("async_checkpoint")]
+
+    for i in range(3):
+        assert("async_checkpoint%d" % i in candidates)
+        assert("async_checkpoint%d.ckp" % i in candidates)
+    assert(not [f for f in candidates if f.endswith(".tmp")])
+
+    # restoring from the last one does not train any further
+    writer.minibatch_info = []
+    mbs = mb_source(tmpdir, "training", max_samples=INFINITELY_REPEAT)
+    training_session(trainer=t, mb_source=mbs,
+        mb_size=4, model_inputs_to_streams=input_map,
+        max_samples=60, progress_frequency=20,
+        checkpoint_config = CheckpointConfig(frequency=20, restore=True, async_checkpointing=True,
+                                             filename=str(tmpdir / "async_checkpoint"))
+    ).train(device)
+
+    assert(len(writer.minibatch_info) == 0)
+
+
+def test_session_sharded_checkpointing_single_worker(tmpdir, device_id):
+    device = cntk_device(device_id)
+    writer = MockProgressWriter()
+    t, feature, label = create_sample_model(device, writer)
+    mbs = mb_source(tmpdir, "training", max_samples=INFINITELY_REPEAT)
+
+    input_map = {
+        feature: mbs.streams.features,
+        label: mbs.streams.labels
+    }
+
+    test_dir = str(tmpdir)
+
+    training_session(trainer=t, mb_source=mbs,
+        mb_size=4, model_inputs_to_streams=input_map,
+        max_samples=60, progress_frequency=20,
+        checkpoint_config = CheckpointConfig(frequency=20, sharded_checkpointing=True,
+                                             filename=str(tmpdir / "sharded_checkpoint"))
+    ).train(device)
+
+    # without distributed training, there is nobody to share the checkpoint with
+    candidates = [f for f in listdir(test_dir) if isfile(
+        join(test_dir, f)) and f.startswith("sharded_checkpoint")]
+
+    assert(sorted(candidates) == ["sharded_checkpoint", "sharded_checkpoint.ckp"])
+
+    writer.minibatch_info = []
+    mbs = mb_source(tmpdir, "training", max_samples=INFINITELY_REPEAT)
+    training_session(trainer=t, mb_source=mbs,
+        mb_size=4, model_inputs_to_streams=input_map,
+        max_samples=60, progress_frequency=20,
+        checkpoint_config = CheckpointConfig(frequency=20, restore=True, sharded_checkpointing=True,
+                                             filename=str(tmpdir / "sharded_checkpoint"))
+    ).train(device)
+
+    assert(len(writer.minibatch_info) == 0)
+
+
 def test_session_restart_from_checkpoint_preserve_all(tmpdir, device_id):
     device = cntk_device(device_id)
     writer = MockProgressWriter()
@@ -403,6 +485,68 @@ def test_session_restart_from_checkpoint_preserve_all(tmpdir, device_id):
     assert(first_run_minibatch_info == writer.minibatch_info)
 
 
+class TerminatingProgressWriter(MockProgressWriter):
+    def __init__(self, terminate_after_minibatches):
+        super(TerminatingProgressWriter, self).__init__()
+        self.terminate_after_minibatches = terminate_after_minibatches
+
+    def on_write_training_update(self, samples, updates, aggregate_loss, aggregate_metric):
+        super(TerminatingProgressWriter, self).on_write_training_update(samples, updates, aggregate_loss, aggregate_metric)
+        if len(self.minibatch_info) == self.terminate_after_minibatches:
+            os.kill(os.getpid(), signal.SIGTERM)
+
+
+@pytest.mark.skipif(sys.platform == 'win32', reason="SIGTERM cannot be delivered to a handler on Windows")
+def test_session_checkpoint_on_termination(tmpdir, device_id):
+    device = cntk_device(device_id)
+    writer = TerminatingProgressWriter(terminate_after_minibatches=3)
+    t, feature, label = create_sample_model(device, writer)
+    mbs = mb_source(tmpdir, "training", max_samples=INFINITELY_REPEAT)
+
+    input_map = {
+        feature: mbs.streams.features,
+        label: mbs.streams.labels
+    }
+
+    test_dir = str(tmpdir)
+
+    training_session(trainer=t, mb_source=mbs,
+        mb_size=4, model_inputs_to_streams=input_map,
+        max_samples=60, progress_frequency=20,
+        checkpoint_config = CheckpointConfig(frequency=20, checkpoint_on_termination=True,
+                                             filename=str(tmpdir / "terminated"))
+    ).train(device)
+
+    # the session stopped right after the minibatch that received the signal, with a checkpoint
+    assert(len(writer.minibatch_info) == 3)
+    samples_at_termination = t.total_number_of_samples_seen
+    assert(samples_at_termination < 20)
+
+    candidates = [f for f in listdir(test_dir) if isfile(
+        join(test_dir, f)) and f.startswith("terminated")]
+    assert("terminated" in candidates)
+    assert("terminated.ckp" in candidates)
+
+    # a new session continues from there until the end
+    writer = MockProgressWriter()
+    t, feature, label = create_sample_model(device, writer)
+    mbs = mb_source(tmpdir, "training", max_samples=INFINITELY_REPEAT)
+    input_map = {
+        feature: mbs.streams.features,
+        label: mbs.streams.labels
+    }
+
+    training_session(trainer=t, mb_source=mbs,
+        mb_size=4, model_inputs_to_streams=input_map,
+        max_samples=60, progress_frequency=20,
+        checkpoint_config = CheckpointConfig(frequency=20, restore=True, checkpoint_on_termination=True,
+                                             filename=str(tmpdir / "terminated"))
+    ).train(device)
+
+    assert(t.total_number_of_samples_seen >= 60)
+    assert(sum(i[1][2] for i in writer.minibatch_info) == t.total_number_of_samples_seen - samples_at_termination)
+
+
 def test_session_cv_callback_3_times(tmpdir, device_id):
     device = cntk_device(device_id)
     t, feature, label = create_sample_model(device)
@@ -466,6 +610,34 @@ def test_session_cv_callback_with_cross_validation_3_times(tmpdir, device_id):
     assert(t.total_number_of_samples_seen == 61)
 
 
+def test_session_cv_callback_with_cross_validation_error(tmpdir, device_id):
+    device = cntk_device(device_id)
+    writer = MockProgressWriter(expected_test_summary=[[92, 25], [92, 25], [92, 25]])
+    t, feature, label = create_sample_model(device, writer)
+    mbs = mb_source(tmpdir, "training", max_samples=INFINITELY_REPEAT)
+    cv_mbs = mb_source(tmpdir, "cv")
+
+    input_map = {
+        feature: mbs.streams.features,
+        label: mbs.streams.labels
+    }
+
+    # the error passed to the callback is that of the test summary, in every cross validation
+    errors = []
+    def cv_callback(index, average_error, num_samples, num_mb):
+        errors.append((index, average_error, num_samples))
+        return True
+
+    training_session(
+        trainer=t, mb_source=mbs, mb_size=4,
+        model_inputs_to_streams=input_map, max_samples=60,
+        cv_config = CrossValidationConfig(source=cv_mbs, mb_size=2, frequency=20, callback=cv_callback)
+    ).train(device)
+
+    assert(writer.test_summary_counter == 3)
+    assert(errors == [(0, 0.92, 25), (1, 0.92, 25), (2, 0.92, 25)])
+
+
 def test_session_cv_callback_early_exit(tmpdir, device_id):
     device = cntk_device(device_id)
     t, feature, label = create_sample_model(device)
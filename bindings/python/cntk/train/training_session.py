@@ -21,9 +21,18 @@ class CheckpointConfig(cntk_py.CheckpointConfig):
           If ``sys.maxsize``, a single checkpoint is taken at the end of the training.
         preserve_all (bool): saves all checkpoints, using ``filename`` as prefix and checkpoint index as a suffix.
         restore (bool): flag, indicating whether to restore from available checkpoint before the start of the training
+        checkpoint_on_termination (bool): if ``True``, a termination signal (SIGTERM, e.g. sent by a scheduler on preemption)
+          to any worker makes all workers save a checkpoint after the current minibatch and stop the training.
+          Checkpoints of distributed training can be restored on a different number of workers.
+        async_checkpointing (bool): if ``True``, the periodic checkpoints are written on a background thread; training only waits
+          for a snapshot of the model and trainer state, or for the previous checkpoint if it is still being written.
+        sharded_checkpointing (bool): if ``True``, every worker of distributed training writes a part of the parameters and
+          learner state to a shard file of its own (``filename`` with the suffix ``.shard<N>``), so that the workers write in parallel.
+          Sharded checkpoints are restored like others, also on a different number of workers.
     '''
     def __init__(self, filename, frequency=None,
-                 restore=True, preserve_all=False):
+                 restore=True, preserve_all=False, checkpoint_on_termination=False,
+                 async_checkpointing=False, sharded_checkpointing=False):
         '''Sets configuration of checkpointing behavior.
 
         Args:
@@ -32,6 +41,11 @@ class CheckpointConfig(cntk_py.CheckpointConfig):
               If ``sys.maxsize``, a single checkpoint is taken at the end of the training.
             preserve_all (bool): saves all checkpoints, using ``filename`` as prefix and checkpoint index as a suffix.
             restore (bool): flag, indicating whether to restore from available checkpoint before the start of the training
+            checkpoint_on_termination (bool): if ``True``, a termination signal (SIGTERM, e.g. sent by a scheduler on preemption)
+              to any worker makes all workers save a checkpoint after the current minibatch and stop the training.
+            async_checkpointing (bool): if ``True``, the periodic checkpoints are written on a background thread.
+            sharded_checkpointing (bool): if ``True``, the workers of distributed training write the checkpoints in parallel,
+              each a shard of it.
 
         Returns:
             Reconfigured self.
@@ -47,7 +61,8 @@ class CheckpointConfig(cntk_py.CheckpointConfig):
             frequency = sys.maxsize
 
         super(CheckpointConfig, self).__init__(filename, frequency,
-                                               restore, preserve_all)
+                                               restore, preserve_all, checkpoint_on_termination,
+                                               async_checkpointing, sharded_checkpointing)
 
 class CrossValidationConfig(cntk_py.CrossValidationConfig):
     '''